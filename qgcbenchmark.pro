@@ -0,0 +1,186 @@
+#-------------------------------------------------
+#
+# Offscreen rendering benchmark of the instruments
+#
+# Renders HUD, HSI, HDD gauges and the line chart
+# into images with the raster engine, no GPU needed,
+# and measures the receive path with a simulated
+# swarm of vehicles.
+# Needs a display connection, run it headless with
+# xvfb-run ./qgcbenchmark
+#
+#-------------------------------------------------
+
+QT       += network \
+            opengl \
+            phonon \
+            testlib \
+            svg
+
+TEMPLATE = app
+
+TARGET = qgcbenchmark
+
+BASEDIR = $$IN_PWD
+TESTDIR = $$BASEDIR/qgcunittest
+TARGETDIR = $$OUT_PWD
+BUILDDIR = $$TARGETDIR/build-benchmark
+LANGUAGE = C++
+
+CONFIG   += console
+CONFIG   -= app_bundle
+
+OBJECTS_DIR = $$BUILDDIR/obj
+MOC_DIR = $$BUILDDIR/moc
+UI_HEADERS_DIR = src/ui/generated
+MAVLINK_CONF = ""
+
+# If the user config file exists, it will be included.
+exists(user_config.pri) {
+    include(user_config.pri)
+}
+
+INCLUDEPATH += $$BASEDIR/../mavlink/include/common
+contains(MAVLINK_CONF, pixhawk) {
+    INCLUDEPATH -= $$BASEDIR/../mavlink/include/common
+    INCLUDEPATH += $$BASEDIR/../mavlink/include/pixhawk
+    DEFINES += QGC_USE_PIXHAWK_MESSAGES
+}
+contains(MAVLINK_CONF, slugs) {
+    INCLUDEPATH -= $$BASEDIR/../mavlink/include/common
+    INCLUDEPATH += $$BASEDIR/../mavlink/include/slugs
+    DEFINES += QGC_USE_SLUGS_MESSAGES
+}
+contains(MAVLINK_CONF, ualberta) {
+    INCLUDEPATH -= $$BASEDIR/../mavlink/include/common
+    INCLUDEPATH += $$BASEDIR/../mavlink/include/ualberta
+    DEFINES += QGC_USE_UALBERTA_MESSAGES
+}
+contains(MAVLINK_CONF, ardupilotmega) {
+    INCLUDEPATH -= $$BASEDIR/../mavlink/include/common
+    INCLUDEPATH += $$BASEDIR/../mavlink/include/ardupilotmega
+    DEFINES += QGC_USE_ARDUPILOTMEGA_MESSAGES
+}
+
+# Include general settings for QGroundControl
+include(qgroundcontrol.pri)
+# Reset QMAKE_POST_LINK to prevent file copy operations
+QMAKE_POST_LINK = ""
+
+include(lib/QMapControl/QMapControl.pri)
+include(src/lib/qextserialport/qextserialport.pri)
+include(src/lib/qwt/qwt.pri)
+# Heap allocations per frame are counted by wrapping the allocator of glibc,
+# see qgcunittest/benchmarkMain.cc
+linux-g++* {
+    DEFINES += QGC_COUNT_ALLOCATIONS
+}
+
+DEPENDPATH += . \
+    lib/QMapControl \
+    lib/QMapControl/src \
+    plugins
+INCLUDEPATH += . \
+    lib/QMapControl \
+    $$BASEDIR/../mavlink/include \
+    $$BASEDIR/src/uas \
+    $$BASEDIR/src/comm \
+    $$BASEDIR/src/ \
+    $$BASEDIR/src/ui/ \
+    $$BASEDIR/src/ui/linechart \
+    $$BASEDIR/src/ui/map \
+    $$BASEDIR/src/ui/uas \
+    $$BASEDIR/src/ui/RadioCalibration
+
+FORMS += src/ui/HDDisplay.ui \
+    src/ui/UASView.ui
+
+SOURCES +=  src/uas/UAS.cc \
+            src/comm/MAVLinkProtocol.cc \
+            src/uas/UASWaypointManager.cc \
+            src/Waypoint.cc \
+            src/ui/RadioCalibration/RadioCalibrationData.cc \
+            src/uas/SlugsMAV.cc \
+            src/uas/PxQuadMAV.cc \
+            src/uas/ArduPilotMegaMAV.cc \
+            src/GAudioOutput.cc \
+            src/uas/UASManager.cc \
+            src/comm/LinkManager.cc \
+            src/QGC.cc \
+            src/comm/SerialLink.cc \
+            src/comm/MAVLinkSimulationLink.cc \
+            src/comm/MAVLinkSimulationMAV.cc \
+            src/comm/MAVLinkSimulationWaypointPlanner.cc \
+            src/comm/MAVLinkSwarmSimulationLink.cc \
+            src/uas/QGCHeartbeatSupervisor.cc \
+            src/uas/QGCUASImageTransfer.cc \
+            src/uas/QGCUASParamCache.cc \
+            src/uas/QGCUASParamTransfer.cc \
+            src/uas/WaypointFileLoader.cc \
+            src/uas/QGCMAVLinkUASFactory.cc \
+            src/ui/QGCRawVideoBuffer.cc \
+            src/ui/QGCFrameScheduler.cc \
+            src/ui/QGCLabelCache.cc \
+            src/ui/QGCGeometry.cc \
+            src/ui/HUD.cc \
+            src/ui/HDDisplay.cc \
+            src/ui/HSIDisplay.cc \
+            src/ui/linechart/LinechartPlot.cc \
+            src/ui/linechart/Scrollbar.cc \
+            src/ui/linechart/ScrollZoomer.cc \
+            src/ui/map/Waypoint2DIcon.cc \
+            src/ui/map/MAV2DIcon.cc \
+            src/ui/uas/UASView.cc \
+            $$TESTDIR/InstrumentRenderBenchmark.cc \
+            $$TESTDIR/QGCLabelCacheTest.cc \
+            $$TESTDIR/SwarmScalingTest.cc \
+            $$TESTDIR/UASViewTest.cc \
+            $$TESTDIR/benchmarkMain.cc
+
+HEADERS += src/uas/UASInterface.h \
+            src/uas/UAS.h \
+            src/comm/MAVLinkProtocol.h \
+            src/comm/ProtocolInterface.h \
+            src/uas/UASWaypointManager.h \
+            src/Waypoint.h \
+            src/ui/RadioCalibration/RadioCalibrationData.h \
+            src/uas/SlugsMAV.h \
+            src/uas/PxQuadMAV.h \
+            src/uas/ArduPilotMegaMAV.h \
+            src/GAudioOutput.h \
+            src/uas/UASManager.h \
+            src/comm/LinkManager.h \
+            src/comm/LinkInterface.h \
+            src/QGC.h \
+            src/comm/SerialLinkInterface.h \
+            src/comm/SerialLink.h \
+            src/comm/MAVLinkSimulationLink.h \
+            src/comm/MAVLinkSimulationMAV.h \
+            src/comm/MAVLinkSimulationWaypointPlanner.h \
+            src/comm/MAVLinkSwarmSimulationLink.h \
+            src/uas/QGCHeartbeatSupervisor.h \
+            src/uas/QGCUASImageTransfer.h \
+            src/uas/QGCUASParamCache.h \
+            src/uas/QGCUASParamTransfer.h \
+            src/uas/WaypointFileLoader.h \
+            src/uas/QGCMAVLinkUASFactory.h \
+            src/ui/QGCRawVideoBuffer.h \
+            src/ui/QGCFrameScheduler.h \
+            src/ui/QGCLabelCache.h \
+            src/ui/QGCGeometry.h \
+            src/ui/HUD.h \
+            src/ui/HDDisplay.h \
+            src/ui/HSIDisplay.h \
+            src/ui/linechart/LinechartPlot.h \
+            src/ui/linechart/Scrollbar.h \
+            src/ui/linechart/ScrollZoomer.h \
+            src/ui/map/Waypoint2DIcon.h \
+            src/ui/map/MAV2DIcon.h \
+            src/ui/uas/UASView.h \
+            $$TESTDIR/InstrumentRenderBenchmark.h \
+            $$TESTDIR/QGCLabelCacheTest.h \
+            $$TESTDIR/SwarmScalingTest.h \
+            $$TESTDIR/UASViewTest.h \
+            $$TESTDIR/AutoTest.h
+
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
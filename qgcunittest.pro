@@ -112,7 +112,33 @@ SOURCES +=  src/uas/UAS.cc \
             src/comm/LinkManager.cc \
             src/QGC.cc \
             src/comm/SerialLink.cc \
+            src/comm/MAVLinkLoadGeneratorLink.cc \
+            src/comm/MAVLinkSimulationLink.cc \
+            src/comm/MAVLinkSimulationMAV.cc \
+            src/comm/MAVLinkSimulationWaypointPlanner.cc \
+            src/uas/QGCHeartbeatSupervisor.cc \
+            src/uas/QGCUASImageTransfer.cc \
+            src/uas/QGCUASParamCache.cc \
+            src/uas/QGCUASParamTransfer.cc \
+            src/uas/WaypointFileLoader.cc \
+            src/ui/QGCRawVideoBuffer.cc \
+            src/ui/QGCFrameScheduler.cc \
+            src/ui/QGCGeometry.cc \
+            src/comm/TCPLink.cc \
+            $$TESTDIR/MAVLinkLoadGeneratorLinkTest.cc \
+            $$TESTDIR/MAVLinkProtocolTest.cc \
+            $$TESTDIR/QGCFrameSchedulerTest.cc \
+            $$TESTDIR/QGCGeometryTest.cc \
+            $$TESTDIR/QGCHeartbeatSupervisorTest.cc \
+            $$TESTDIR/QGCRawVideoBufferTest.cc \
+            $$TESTDIR/QGCUASImageTransferTest.cc \
+            $$TESTDIR/QGCUASParamCacheTest.cc \
+            $$TESTDIR/QGCUASParamTransferTest.cc \
+            $$TESTDIR/WaypointFileTest.cc \
+            $$TESTDIR/WaypointIndexTest.cc \
+            $$TESTDIR/WaypointTransferTest.cc \
             $$TESTDIR/SlugsMavUnitTest.cc \
+            $$TESTDIR/TCPLinkTest.cc \
             $$TESTDIR/testSuite.cc \
             $$TESTDIR/UASUnitTest.cc \
     src/uas/QGCMAVLinkUASFactory.cc
@@ -135,7 +161,33 @@ HEADERS += src/uas/UASInterface.h \
             src/QGC.h \
             src/comm/SerialLinkInterface.h \
             src/comm/SerialLink.h \
+            src/comm/MAVLinkLoadGeneratorLink.h \
+            src/comm/MAVLinkSimulationLink.h \
+            src/comm/MAVLinkSimulationMAV.h \
+            src/comm/MAVLinkSimulationWaypointPlanner.h \
+            src/uas/QGCHeartbeatSupervisor.h \
+            src/uas/QGCUASImageTransfer.h \
+            src/uas/QGCUASParamCache.h \
+            src/uas/QGCUASParamTransfer.h \
+            src/uas/WaypointFileLoader.h \
+            src/ui/QGCRawVideoBuffer.h \
+            src/ui/QGCFrameScheduler.h \
+            src/ui/QGCGeometry.h \
+            src/comm/TCPLink.h \
+            $$TESTDIR/MAVLinkLoadGeneratorLinkTest.h \
+            $$TESTDIR/MAVLinkProtocolTest.h \
+            $$TESTDIR/QGCFrameSchedulerTest.h \
+            $$TESTDIR/QGCGeometryTest.h \
+            $$TESTDIR/QGCHeartbeatSupervisorTest.h \
+            $$TESTDIR/QGCRawVideoBufferTest.h \
+            $$TESTDIR/QGCUASImageTransferTest.h \
+            $$TESTDIR/QGCUASParamCacheTest.h \
+            $$TESTDIR/QGCUASParamTransferTest.h \
+            $$TESTDIR/WaypointFileTest.h \
+            $$TESTDIR/WaypointIndexTest.h \
+            $$TESTDIR/WaypointTransferTest.h \
             $$TESTDIR//SlugsMavUnitTest.h \
+            $$TESTDIR/TCPLinkTest.h \
             $$TESTDIR/AutoTest.h \
             $$TESTDIR/UASUnitTest.h \
     src/uas/QGCMAVLinkUASFactory.h
@@ -144,4 +196,22 @@ HEADERS += src/uas/UASInterface.h \
 
 
 
+# TCPLink sets socket buffer sizes through the native socket API
+win32: {
+    LIBS += -lws2_32
+}
+
+# Shared memory link for co-located simulators (POSIX shared memory)
+unix: {
+    HEADERS += src/comm/SharedMemoryLink.h \
+        src/comm/QGCShmRing.h \
+        $$TESTDIR/SharedMemoryLinkTest.h
+    SOURCES += src/comm/SharedMemoryLink.cc \
+        $$TESTDIR/SharedMemoryLinkTest.cc
+    DEFINES += QGC_SHM_LINK
+    linux-g++|linux-g++-64: {
+        LIBS += -lrt
+    }
+}
+
 DEFINES += SRCDIR=\\\"$$PWD/\\\"
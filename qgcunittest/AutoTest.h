@@ -8,6 +8,7 @@
 #define AUTOTEST_H
 
 #include <QTest>
+#include <QApplication>
 #include <QList>
 #include <QString>
 #include <QSharedPointer>
@@ -76,9 +77,12 @@ public:
 
 #define DECLARE_TEST(className) static Test<className> t(#className);
 
+// Like QTEST_MAIN, the tests wait on timers, sockets and queued signals
+// and need the event dispatcher of an application object
 #define TEST_MAIN \
     int main(int argc, char *argv[]) \
     { \
+      QApplication app(argc, argv); \
       return AutoTest::run(argc, argv); \
   }
 
@@ -0,0 +1,361 @@
+#include <cmath>
+#include <limits>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QSettings>
+#include <QTextStream>
+#include <QtAlgorithms>
+#include "InstrumentRenderBenchmark.h"
+#include "HUD.h"
+#include "HDDisplay.h"
+#include "HSIDisplay.h"
+#include "LinechartPlot.h"
+#include "Waypoint.h"
+#include "UASWaypointManager.h"
+#include "QGCLabelCache.h"
+
+#define RENDER_TEST_WARMUP 20
+#define RENDER_TEST_FRAMES 500
+#define RENDER_TEST_LOG SRCDIR "demo-log.txt"
+#define RENDER_TEST_BASELINE SRCDIR "qgcunittest/instrument_render_baseline.ini"
+#define RENDER_TEST_REPORT "instrument_render.json"
+#define RENDER_TEST_TOLERANCE 25
+
+#if defined(QGC_COUNT_ALLOCATIONS) && defined(__GLIBC__)
+#define RENDER_TEST_COUNT_ALLOCATIONS
+/** @brief Heap allocations of the process so far, counted in benchmarkMain.cc */
+quint64 benchmarkAllocations();
+#endif
+
+InstrumentRenderBenchmark::InstrumentRenderBenchmark() :
+    mav(NULL),
+    uas(NULL),
+    x(0.0),
+    y(0.0)
+{
+}
+
+void InstrumentRenderBenchmark::initTestCase()
+{
+    loadTelemetry(RENDER_TEST_LOG);
+    QVERIFY(timestamps.size() > 0);
+    QVERIFY(channels.contains("roll_IMU"));
+
+    // A system with a short local mission for the HSI
+    mav = new MAVLinkProtocol();
+    uas = new UAS(mav, 42);
+    for (int i = 0; i < 10; i++)
+    {
+        Waypoint* wp = new Waypoint(i, 2.0 * cos(i * 0.6), 2.0 * sin(i * 0.6), -1.0, 0.5, 0.0, 0.0, 0.0, true, i == 0, MAV_FRAME_LOCAL);
+        uas->getWaypointManager()->addWaypoint(wp);
+    }
+}
+
+void InstrumentRenderBenchmark::cleanupTestCase()
+{
+    delete uas;
+    delete mav;
+
+    QString fileName = qgetenv("QGC_RENDER_REPORT");
+    if (fileName.isEmpty()) fileName = RENDER_TEST_REPORT;
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text));
+    QTextStream out(&file);
+    out << "{\n  \"frames\": " << RENDER_TEST_FRAMES << ",\n  \"runs\": [\n    "
+        << results.join(",\n    ") << "\n  ]\n}\n";
+    qDebug() << "INSTRUMENT RENDERING report written to" << fileName;
+}
+
+void InstrumentRenderBenchmark::loadTelemetry(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+    QTextStream in(&file);
+
+    // Tab separated, the first column is the time in milliseconds
+    QStringList header = in.readLine().split('\t');
+    header.removeFirst();
+    while (!header.isEmpty() && header.last().trimmed().isEmpty()) header.removeLast();
+    channels = header;
+    minimum.fill(std::numeric_limits<double>::max(), channels.size());
+    maximum.fill(-std::numeric_limits<double>::max(), channels.size());
+
+    while (!in.atEnd())
+    {
+        QStringList fields = in.readLine().split('\t');
+        bool ok;
+        quint64 time = fields.first().toULongLong(&ok);
+        if (!ok) continue;
+
+        QVector<double> row(channels.size(), std::numeric_limits<double>::quiet_NaN());
+        for (int i = 0; i < channels.size() && i + 1 < fields.size(); i++)
+        {
+            double v = fields.at(i + 1).toDouble(&ok);
+            if (!ok) continue;
+            row[i] = v;
+            minimum[i] = qMin(minimum[i], v);
+            maximum[i] = qMax(maximum[i], v);
+        }
+        timestamps.append(time);
+        samples.append(row);
+    }
+}
+
+double InstrumentRenderBenchmark::value(int row, const QString& channel) const
+{
+    int i = channels.indexOf(channel);
+    if (i < 0 || isnan(samples.at(row).at(i))) return 0.0;
+    return samples.at(row).at(i);
+}
+
+QString InstrumentRenderBenchmark::instrumentName(int instrument)
+{
+    switch (instrument)
+    {
+    case INSTRUMENT_HUD:
+        return "hud";
+    case INSTRUMENT_HSI:
+        return "hsi";
+    case INSTRUMENT_HDD:
+        return "hdd";
+    case INSTRUMENT_LINECHART:
+        return "linechart";
+    }
+    return "unknown";
+}
+
+quint64 InstrumentRenderBenchmark::percentile(const QVector<quint64>& sorted, double q)
+{
+    if (sorted.isEmpty()) return 0;
+    return sorted.at(qMin(sorted.size() - 1, (int)(q * sorted.size())));
+}
+
+QWidget* InstrumentRenderBenchmark::createInstrument(int instrument)
+{
+    switch (instrument)
+    {
+    case INSTRUMENT_HUD:
+        return new HUD();
+    case INSTRUMENT_HSI:
+    {
+        x = 0.0;
+        y = 0.0;
+        HSIDisplay* hsi = new HSIDisplay();
+        hsi->setActiveUAS(uas);
+        for (int i = 0; i < 12; i++)
+        {
+            hsi->updateSatellite(uas->getUASID(), i, 10.0f + 6.0f * i, 30.0f * i, 10.0f + 3.0f * i, i % 3 != 0);
+        }
+        return hsi;
+    }
+    case INSTRUMENT_HDD:
+    {
+        // One gauge per channel of the log, scaled to its range
+        QStringList gauges;
+        for (int i = 0; i < channels.size(); i++)
+        {
+            if (minimum.at(i) > maximum.at(i)) continue;
+            gauges.append(QString("%1,%2,,%3").arg(minimum.at(i)).arg(channels.at(i)).arg(maximum.at(i) > minimum.at(i) ? maximum.at(i) : minimum.at(i) + 1.0));
+        }
+        return new HDDisplay(&gauges, "Render Benchmark");
+    }
+    case INSTRUMENT_LINECHART:
+    {
+        LinechartPlot* plot = new LinechartPlot();
+        plot->enforceGroundTime(false);
+        return plot;
+    }
+    }
+    return NULL;
+}
+
+void InstrumentRenderBenchmark::feed(QWidget* widget, int instrument, int frame)
+{
+    // Continue the time when starting over at the beginning of the log
+    const int row = frame % timestamps.size();
+    const quint64 span = timestamps.last() - timestamps.first() + 20;
+    const quint64 time = timestamps.at(row) + (frame / timestamps.size()) * span;
+
+    const double roll = value(row, "roll_IMU");
+    const double pitch = value(row, "pitch_IMU");
+    const double yaw = value(row, "yaw_IMU");
+    // The log has no speed, the accelerations in mG make a lively stand-in
+    const double vx = value(row, "Accel._X") / 1000.0;
+    const double vy = value(row, "Accel._Y") / 1000.0;
+    const double vz = value(row, "Accel._Z") / 1000.0 - 1.0;
+
+    switch (instrument)
+    {
+    case INSTRUMENT_HUD:
+    {
+        HUD* hud = static_cast<HUD*>(widget);
+        hud->updateAttitude(NULL, roll, pitch, yaw, time * 1000);
+        hud->updateSpeed(NULL, vx, vy, vz, time * 1000);
+        hud->updateLocalPosition(NULL, 0.0, 0.0, -value(row, "Ground_Dist."), time * 1000);
+        // Changing texts repaint the text layer
+        if (frame % 50 == 0)
+        {
+            hud->updateBattery(NULL, 12.6 - frame * 0.001, 100.0 - frame * 0.1, 3600 - frame);
+        }
+        break;
+    }
+    case INSTRUMENT_HSI:
+    {
+        HSIDisplay* hsi = static_cast<HSIDisplay*>(widget);
+        x += cos(yaw) * 0.01;
+        y += sin(yaw) * 0.01;
+        hsi->updateAttitude(uas, roll, pitch, yaw, time * 1000);
+        hsi->updateSpeed(uas, vx, vy, vz, time * 1000);
+        hsi->updateLocalPosition(uas, x, y, -1.0, time * 1000);
+        break;
+    }
+    case INSTRUMENT_HDD:
+    {
+        HDDisplay* hdd = static_cast<HDDisplay*>(widget);
+        for (int i = 0; i < channels.size(); i++)
+        {
+            double v = samples.at(row).at(i);
+            if (!isnan(v)) hdd->updateValue(uas->getUASID(), channels.at(i), QString(), v, time);
+        }
+        break;
+    }
+    case INSTRUMENT_LINECHART:
+    {
+        LinechartPlot* plot = static_cast<LinechartPlot*>(widget);
+        for (int i = 0; i < channels.size(); i++)
+        {
+            double v = samples.at(row).at(i);
+            if (!isnan(v)) plot->appendData(channels.at(i), time, v);
+        }
+        break;
+    }
+    }
+}
+
+void InstrumentRenderBenchmark::render(QWidget* widget, int instrument, QImage* image)
+{
+    switch (instrument)
+    {
+    case INSTRUMENT_HUD:
+        static_cast<HUD*>(widget)->renderOffscreen(image);
+        break;
+    case INSTRUMENT_HSI:
+    case INSTRUMENT_HDD:
+        static_cast<HDDisplay*>(widget)->renderOffscreen(image);
+        break;
+    case INSTRUMENT_LINECHART:
+        static_cast<LinechartPlot*>(widget)->renderOffscreen(image);
+        break;
+    }
+}
+
+void InstrumentRenderBenchmark::render_benchmark_data()
+{
+    QTest::addColumn<int>("instrument");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+
+    const int sizes[][2] = {{640, 480}, {1280, 720}, {1920, 1080}};
+    for (int instrument = INSTRUMENT_HUD; instrument <= INSTRUMENT_LINECHART; instrument++)
+    {
+        for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        {
+            QString name = QString("%1_%2x%3").arg(instrumentName(instrument)).arg(sizes[i][0]).arg(sizes[i][1]);
+            QTest::newRow(name.toAscii().constData()) << instrument << sizes[i][0] << sizes[i][1];
+        }
+    }
+}
+
+void InstrumentRenderBenchmark::render_benchmark()
+{
+    QFETCH(int, instrument);
+    QFETCH(int, width);
+    QFETCH(int, height);
+    const QString name = QTest::currentDataTag();
+
+    QWidget* widget = createInstrument(instrument);
+    QVERIFY(widget);
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+
+    // The first frames build the cached layers, they are not measured.
+    // Every frame is timed on its own in nanoseconds.
+    QVector<quint64> times;
+    times.reserve(RENDER_TEST_FRAMES);
+    quint64 allocated = 0;
+    QElapsedTimer timer;
+    for (int frame = 0; frame < RENDER_TEST_WARMUP + RENDER_TEST_FRAMES; frame++)
+    {
+        feed(widget, instrument, frame);
+        image.fill(0);
+
+#ifdef RENDER_TEST_COUNT_ALLOCATIONS
+        quint64 allocationsBefore = benchmarkAllocations();
+#endif
+        timer.start();
+        render(widget, instrument, &image);
+        quint64 time = timer.nsecsElapsed();
+        if (frame == RENDER_TEST_WARMUP - 1) QGCLabelCache::instance()->resetStatistics();
+        if (frame < RENDER_TEST_WARMUP) continue;
+
+#ifdef RENDER_TEST_COUNT_ALLOCATIONS
+        allocated += benchmarkAllocations() - allocationsBefore;
+#endif
+        times.append(time);
+    }
+    delete widget;
+    const float labelHitRate = QGCLabelCache::instance()->getHitRate();
+
+    qSort(times);
+    const double p50 = percentile(times, 0.5) / 1000.0;
+    const double p99 = percentile(times, 0.99) / 1000.0;
+#ifdef RENDER_TEST_COUNT_ALLOCATIONS
+    const double allocationsPerFrame = (double)allocated / RENDER_TEST_FRAMES;
+#else
+    const double allocationsPerFrame = -1.0;
+#endif
+    QTest::setBenchmarkResult(p50 / 1000.0, QTest::WalltimeMilliseconds);
+
+    results.append(QString("{\"instrument\": \"%1\", \"width\": %2, \"height\": %3, "
+                           "\"frame_us\": {\"p50\": %4, \"p90\": %5, \"p99\": %6, \"max\": %7}, "
+                           "\"allocations_per_frame\": %8, \"label_cache_hit_rate\": %9}")
+                   .arg(instrumentName(instrument)).arg(width).arg(height)
+                   .arg(p50, 0, 'f', 1).arg(percentile(times, 0.9) / 1000.0, 0, 'f', 1)
+                   .arg(p99, 0, 'f', 1).arg(times.last() / 1000.0, 0, 'f', 1)
+                   .arg(allocationsPerFrame < 0 ? QString("null") : QString::number(allocationsPerFrame, 'f', 1))
+                   .arg(labelHitRate, 0, 'f', 3));
+
+    qDebug() << "INSTRUMENT RENDERING" << name << ":" << p50 << "us median," << p99 << "us p99,"
+             << allocationsPerFrame << "allocations per frame," << labelHitRate << "label cache hit rate";
+
+    // Compare with the baseline, or record it
+    QString baselineFile = qgetenv("QGC_RENDER_BASELINE");
+    if (baselineFile.isEmpty()) baselineFile = RENDER_TEST_BASELINE;
+    QSettings baseline(baselineFile, QSettings::IniFormat);
+    baseline.beginGroup(name);
+    if (qgetenv("QGC_RENDER_BASELINE_UPDATE") == "1")
+    {
+        baseline.setValue("p50_us", QString::number(p50, 'f', 1));
+        baseline.setValue("p99_us", QString::number(p99, 'f', 1));
+        if (allocationsPerFrame >= 0) baseline.setValue("allocations_per_frame", QString::number(allocationsPerFrame, 'f', 1));
+        return;
+    }
+
+    bool ok;
+    int tolerance = QString(qgetenv("QGC_RENDER_TOLERANCE")).toInt(&ok);
+    if (!ok) tolerance = RENDER_TEST_TOLERANCE;
+
+    // Without a baseline nothing is checked, that must not pass silently
+    double baselineTime = baseline.value("p50_us").toDouble(&ok);
+    QVERIFY2(ok && baselineTime > 0,
+             qPrintable(QString("no frame time baseline for %1 in %2, record it with QGC_RENDER_BASELINE_UPDATE=1").arg(name, baselineFile)));
+    QVERIFY2(p50 * 100 <= baselineTime * (100 + tolerance),
+             qPrintable(QString("median frame time %1 us, baseline %2 us").arg(p50).arg(baselineTime)));
+    if (allocationsPerFrame >= 0)
+    {
+        double baselineAllocations = baseline.value("allocations_per_frame").toDouble(&ok);
+        QVERIFY2(ok, qPrintable(QString("no allocation baseline for %1 in %2, record it with QGC_RENDER_BASELINE_UPDATE=1").arg(name, baselineFile)));
+        QVERIFY2(allocationsPerFrame <= baselineAllocations * 1.1 + 1.0,
+                 qPrintable(QString("%1 allocations per frame, baseline %2").arg(allocationsPerFrame).arg(baselineAllocations)));
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef INSTRUMENTRENDERBENCHMARK_H
+#define INSTRUMENTRENDERBENCHMARK_H
+
+#include <QObject>
+#include <QVector>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtTest/QtTest>
+#include "MAVLinkProtocol.h"
+#include "UAS.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Offscreen rendering cost of the instruments
+ *
+ * Every row renders one instrument at one resolution into a QImage with the
+ * raster engine, fed frame by frame with the recorded telemetry of
+ * demo-log.txt. It measures the time of every frame with QElapsedTimer, the
+ * hit rate of the label cache and, on Linux, the heap allocations per frame.
+ * The median frame time is the benchmark result of the row.
+ *
+ * The results are written as JSON to the file named by QGC_RENDER_REPORT,
+ * instrument_render.json by default. The median frame time and the
+ * allocations are checked against qgcunittest/instrument_render_baseline.ini,
+ * QGC_RENDER_TOLERANCE sets the allowed slowdown in percent. A row without a
+ * baseline value fails. Run with QGC_RENDER_BASELINE_UPDATE=1 on the
+ * reference machine to record the baseline.
+ *
+ * This needs a QApplication and is built as its own target, qgcbenchmark.pro.
+ */
+class InstrumentRenderBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    InstrumentRenderBenchmark();
+
+    enum Instrument
+    {
+        INSTRUMENT_HUD,
+        INSTRUMENT_HSI,
+        INSTRUMENT_HDD,
+        INSTRUMENT_LINECHART
+    };
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void render_benchmark_data();
+    void render_benchmark();
+
+protected:
+    QStringList channels;              ///< Column names of the log without the timestamp
+    QVector<quint64> timestamps;       ///< Time of every log row in milliseconds
+    QVector<QVector<double> > samples; ///< Values of every log row, NaN if empty
+    QVector<double> minimum;           ///< Smallest value of every channel
+    QVector<double> maximum;           ///< Largest value of every channel
+    MAVLinkProtocol* mav;
+    UAS* uas;                          ///< Provides the waypoints of the HSI
+    double x;                          ///< Dead reckoned position of the HSI
+    double y;
+    QStringList results;               ///< One JSON object per row
+
+    void loadTelemetry(const QString& fileName);
+    /** @brief Value of a named channel in a row, 0 if empty */
+    double value(int row, const QString& channel) const;
+    QWidget* createInstrument(int instrument);
+    /** @brief Pass one row of the log to the instrument, cycling through the log */
+    void feed(QWidget* widget, int instrument, int frame);
+    void render(QWidget* widget, int instrument, QImage* image);
+
+    static QString instrumentName(int instrument);
+    /** @brief Value below which the fraction q of the sorted samples lies */
+    static quint64 percentile(const QVector<quint64>& sorted, double q);
+};
+
+DECLARE_TEST(InstrumentRenderBenchmark)
+
+#endif // INSTRUMENTRENDERBENCHMARK_H
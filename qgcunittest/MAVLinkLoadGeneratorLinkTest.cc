@@ -0,0 +1,146 @@
+#include <QSet>
+#include "MAVLinkLoadGeneratorLinkTest.h"
+#include "QGC.h"
+
+#define LOAD_TEST_SYSTEMS 10
+#define LOAD_TEST_MESSAGES 100000
+
+MAVLinkLoadGeneratorLinkTest::MAVLinkLoadGeneratorLinkTest()
+{
+}
+
+void MAVLinkLoadGeneratorLinkTest::initTestCase()
+{
+    mav = new MAVLinkProtocol();
+}
+
+void MAVLinkLoadGeneratorLinkTest::cleanupTestCase()
+{
+    delete mav;
+}
+
+void MAVLinkLoadGeneratorLinkTest::deterministic_test()
+{
+    MAVLinkLoadGeneratorLink a(10000, LOAD_TEST_SYSTEMS, 42);
+    MAVLinkLoadGeneratorLink b(10000, LOAD_TEST_SYSTEMS, 42);
+    MAVLinkLoadGeneratorLink c(10000, LOAD_TEST_SYSTEMS, 43);
+
+    QByteArray streamA = a.generate(1000);
+    QByteArray streamB = b.generate(1000);
+    QByteArray streamC = c.generate(1000);
+    QCOMPARE(streamA, streamB);
+    QVERIFY(streamA != streamC);
+
+    // Reset restarts the stream from the seed
+    a.reset();
+    QCOMPARE(a.generate(1000), streamB);
+}
+
+void MAVLinkLoadGeneratorLinkTest::validPackets_test()
+{
+    MAVLinkLoadGeneratorLink link(10000, LOAD_TEST_SYSTEMS, 7);
+    QByteArray stream = link.generate(5000);
+
+    mavlink_message_t msg;
+    mavlink_status_t status;
+    memset(&status, 0, sizeof(status));
+    QSet<int> systems;
+    QHash<int, int> lastSeq;
+    int parsed = 0;
+    int seqErrors = 0;
+    for (int i = 0; i < stream.size(); i++)
+    {
+        if (mavlink_parse_char(MAVLINK_COMM_0, (uint8_t)stream.at(i), &msg, &status))
+        {
+            parsed++;
+            systems.insert(msg.sysid);
+            // Every system numbers its own packets
+            if (lastSeq.contains(msg.sysid) && (uint8_t)(lastSeq.value(msg.sysid) + 1) != msg.seq) seqErrors++;
+            lastSeq.insert(msg.sysid, msg.seq);
+        }
+    }
+
+    // One heartbeat per system plus the requested messages
+    QCOMPARE(parsed, 5000 + LOAD_TEST_SYSTEMS);
+    QCOMPARE(systems.size(), LOAD_TEST_SYSTEMS);
+    QCOMPARE(seqErrors, 0);
+    QCOMPARE(link.getMessagesGenerated(), (quint64)parsed);
+}
+
+void MAVLinkLoadGeneratorLinkTest::heartbeat_test()
+{
+    // A heartbeat round every rate messages, independent of how
+    // the messages are split into calls and how long they take
+    MAVLinkLoadGeneratorLink a(100, LOAD_TEST_SYSTEMS, 5);
+    MAVLinkLoadGeneratorLink b(100, LOAD_TEST_SYSTEMS, 5);
+    QByteArray streamA = a.generate(1000);
+    QByteArray streamB;
+    for (int i = 0; i < 10; i++)
+    {
+        streamB.append(b.generate(70));
+        QTest::qWait(150);
+    }
+    streamB.append(b.generate(300));
+    QCOMPARE(streamA, streamB);
+
+    mavlink_message_t msg;
+    mavlink_status_t status;
+    memset(&status, 0, sizeof(status));
+    int heartbeats = 0;
+    for (int i = 0; i < streamA.size(); i++)
+    {
+        if (mavlink_parse_char(MAVLINK_COMM_2, (uint8_t)streamA.at(i), &msg, &status) && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) heartbeats++;
+    }
+    QCOMPARE(heartbeats, 10 * LOAD_TEST_SYSTEMS);
+}
+
+void MAVLinkLoadGeneratorLinkTest::messageMix_test()
+{
+    MAVLinkLoadGeneratorLink link(10000, 1, 1);
+    QMap<int, int> mix = link.getMessageMix();
+
+    QMap<int, int> unsupported;
+    unsupported.insert(MAVLINK_MSG_ID_ATTITUDE, 1);
+    unsupported.insert(MAVLINK_MSG_ID_PARAM_VALUE, 1);
+    QVERIFY(!link.setMessageMix(unsupported));
+    QCOMPARE(link.getMessageMix(), mix);
+
+    QMap<int, int> attitude;
+    attitude.insert(MAVLINK_MSG_ID_ATTITUDE, 1);
+    QVERIFY(link.setMessageMix(attitude));
+    QCOMPARE(link.getMessageMix(), attitude);
+}
+
+void MAVLinkLoadGeneratorLinkTest::parse_benchmark()
+{
+    MAVLinkLoadGeneratorLink link(10000, LOAD_TEST_SYSTEMS, 1);
+    QByteArray stream = link.generate(LOAD_TEST_MESSAGES);
+
+    mavlink_message_t msg;
+    mavlink_status_t status;
+    memset(&status, 0, sizeof(status));
+    int parsed = 0;
+    quint64 start = QGC::groundTimeUsecs();
+    for (int i = 0; i < stream.size(); i++)
+    {
+        if (mavlink_parse_char(MAVLINK_COMM_1, (uint8_t)stream.at(i), &msg, &status)) parsed++;
+    }
+    quint64 elapsed = QGC::groundTimeUsecs() - start;
+    QCOMPARE((quint64)parsed, link.getMessagesGenerated());
+
+    qDebug() << "MAVLINK PARSER:" << (double)parsed * 1000000 / qMax(elapsed, (quint64)1) << "msg/s,"
+             << (double)stream.size() / qMax(elapsed, (quint64)1) << "MB/s";
+}
+
+void MAVLinkLoadGeneratorLinkTest::protocol_benchmark()
+{
+    // Full receive path including duplicate filter and UAS decoding
+    MAVLinkLoadGeneratorLink link(10000, LOAD_TEST_SYSTEMS, 1);
+    QByteArray stream = link.generate(LOAD_TEST_MESSAGES);
+
+    quint64 start = QGC::groundTimeUsecs();
+    mav->receiveBytes(&link, stream);
+    quint64 elapsed = QGC::groundTimeUsecs() - start;
+
+    qDebug() << "MAVLINK PROTOCOL:" << (double)link.getMessagesGenerated() * 1000000 / qMax(elapsed, (quint64)1) << "msg/s";
+}
@@ -0,0 +1,33 @@
+#ifndef MAVLINKLOADGENERATORLINKTEST_H
+#define MAVLINKLOADGENERATORLINKTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "MAVLinkLoadGeneratorLink.h"
+#include "MAVLinkProtocol.h"
+#include "AutoTest.h"
+
+class MAVLinkLoadGeneratorLinkTest : public QObject
+{
+    Q_OBJECT
+public:
+    MAVLinkLoadGeneratorLinkTest();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void deterministic_test();
+    void validPackets_test();
+    void heartbeat_test();
+    void messageMix_test();
+    void parse_benchmark();
+    void protocol_benchmark();
+
+protected:
+    MAVLinkProtocol* mav;
+};
+
+DECLARE_TEST(MAVLinkLoadGeneratorLinkTest)
+
+#endif // MAVLINKLOADGENERATORLINKTEST_H
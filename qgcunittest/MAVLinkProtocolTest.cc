@@ -0,0 +1,79 @@
+#include "MAVLinkProtocolTest.h"
+#include "MAVLinkLoadGeneratorLink.h"
+
+// Less than the duplicate window per chunk, a copy arrives within it
+#define PROTOCOL_TEST_CHUNK 40
+#define PROTOCOL_TEST_CHUNKS 20
+
+MAVLinkProtocolTest::MAVLinkProtocolTest()
+{
+}
+
+void MAVLinkProtocolTest::receiveMessage(LinkInterface* link, mavlink_message_t message)
+{
+    Q_UNUSED(message);
+    delivered[link]++;
+}
+
+void MAVLinkProtocolTest::initTestCase()
+{
+    mav = new MAVLinkProtocol();
+    connect(mav, SIGNAL(messageReceived(LinkInterface*,mavlink_message_t)), this, SLOT(receiveMessage(LinkInterface*,mavlink_message_t)), Qt::DirectConnection);
+}
+
+void MAVLinkProtocolTest::cleanupTestCase()
+{
+    delete mav;
+}
+
+void MAVLinkProtocolTest::init()
+{
+    delivered.clear();
+}
+
+void MAVLinkProtocolTest::duplicate_test()
+{
+    mav->enableDuplicateFilter(true);
+
+    // The generator is only the packet source, the two links are the radios
+    MAVLinkLoadGeneratorLink source(10000, 1, 11);
+    MAVLinkLoadGeneratorLink primary(10000, 1, 1);
+    MAVLinkLoadGeneratorLink secondary(10000, 1, 1);
+
+    // The first chunk starts with the heartbeat which creates the system
+    for (int i = 0; i < PROTOCOL_TEST_CHUNKS; i++)
+    {
+        QByteArray chunk = source.generate(PROTOCOL_TEST_CHUNK);
+        mav->receiveBytes(&primary, chunk);
+        mav->receiveBytes(&secondary, chunk);
+    }
+    const int sent = (int)source.getMessagesGenerated();
+
+    // Every packet is delivered once, over the link it arrived first on
+    QCOMPARE(delivered.value(&primary), sent);
+    QCOMPARE(delivered.value(&secondary), 0);
+    QCOMPARE(mav->getFirstArrivals(&primary), (quint64)sent);
+    QCOMPARE(mav->getDuplicateArrivals(&primary), (quint64)0);
+    QCOMPARE(mav->getFirstArrivals(&secondary), (quint64)0);
+    QCOMPARE(mav->getDuplicateArrivals(&secondary), (quint64)sent);
+}
+
+void MAVLinkProtocolTest::duplicateFilterDisabled_test()
+{
+    mav->enableDuplicateFilter(false);
+
+    MAVLinkLoadGeneratorLink source(10000, 1, 12);
+    MAVLinkLoadGeneratorLink primary(10000, 1, 1);
+    MAVLinkLoadGeneratorLink secondary(10000, 1, 1);
+
+    QByteArray stream = source.generate(PROTOCOL_TEST_CHUNK);
+    mav->receiveBytes(&primary, stream);
+    mav->receiveBytes(&secondary, stream);
+
+    // Without the filter both copies reach the application
+    const int sent = (int)source.getMessagesGenerated();
+    QCOMPARE(delivered.value(&primary), sent);
+    QCOMPARE(delivered.value(&secondary), sent);
+
+    mav->enableDuplicateFilter(true);
+}
@@ -0,0 +1,36 @@
+#ifndef MAVLINKPROTOCOLTEST_H
+#define MAVLINKPROTOCOLTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "MAVLinkProtocol.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Feeds the same packets over two links into one MAVLinkProtocol
+ */
+class MAVLinkProtocolTest : public QObject
+{
+    Q_OBJECT
+public:
+    MAVLinkProtocolTest();
+
+public slots:
+    void receiveMessage(LinkInterface* link, mavlink_message_t message);
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void duplicate_test();
+    void duplicateFilterDisabled_test();
+
+protected:
+    MAVLinkProtocol* mav;
+    QHash<LinkInterface*, int> delivered; ///< Messages delivered per link
+};
+
+DECLARE_TEST(MAVLinkProtocolTest)
+
+#endif // MAVLINKPROTOCOLTEST_H
@@ -0,0 +1,169 @@
+#include "QGCFrameSchedulerTest.h"
+#include "QGC.h"
+
+#define SCHEDULER_TEST_START 1000000
+
+FrameSchedulerTestClient::FrameSchedulerTestClient(QGCFrameScheduler* scheduler, int cost, bool animated) :
+    paints(0),
+    cost(cost),
+    animated(animated),
+    unregister(false),
+    scheduler(scheduler)
+{
+}
+
+void FrameSchedulerTestClient::paint()
+{
+    paints++;
+    quint64 start = QGC::groundTimeUsecs();
+    while (QGC::groundTimeUsecs() - start < (quint64)cost) {}
+    if (animated) scheduler->markDirty(this);
+    if (unregister) scheduler->unregisterClient(this);
+}
+
+QGCFrameSchedulerTest::QGCFrameSchedulerTest()
+{
+}
+
+void QGCFrameSchedulerTest::dirty_test()
+{
+    QGCFrameScheduler scheduler;
+    FrameSchedulerTestClient client(&scheduler);
+    scheduler.registerClient(&client, "paint");
+    quint64 t = SCHEDULER_TEST_START;
+
+    // A new client is painted once, then only after new data
+    QVERIFY(scheduler.isDirty(&client));
+    scheduler.paintFrame(t);
+    QCOMPARE(client.paints, 1);
+    QVERIFY(!scheduler.isDirty(&client));
+    for (int i = 1; i <= 10; i++) scheduler.paintFrame(t + i * 20000);
+    QCOMPARE(client.paints, 1);
+
+    // Many updates between two frames cause a single repaint
+    for (int i = 0; i < 100; i++) scheduler.markDirty(&client);
+    scheduler.paintFrame(t + 300000);
+    QCOMPARE(client.paints, 2);
+    QCOMPARE(scheduler.getRepaints(), (quint64)2);
+}
+
+void QGCFrameSchedulerTest::minInterval_test()
+{
+    QGCFrameScheduler scheduler;
+    FrameSchedulerTestClient client(&scheduler);
+    scheduler.registerClient(&client, "paint", 100);
+    quint64 t = SCHEDULER_TEST_START;
+
+    scheduler.paintFrame(t);
+    QCOMPARE(client.paints, 1);
+
+    // Too early, stays dirty until the interval has passed
+    scheduler.markDirty(&client);
+    scheduler.paintFrame(t + 50000);
+    QCOMPARE(client.paints, 1);
+    QVERIFY(scheduler.isDirty(&client));
+    scheduler.paintFrame(t + 100000);
+    QCOMPARE(client.paints, 2);
+
+    // A longer interval takes effect immediately
+    scheduler.setMinInterval(&client, 500);
+    scheduler.markDirty(&client);
+    scheduler.paintFrame(t + 400000);
+    QCOMPARE(client.paints, 2);
+    scheduler.paintFrame(t + 600000);
+    QCOMPARE(client.paints, 3);
+}
+
+void QGCFrameSchedulerTest::animation_test()
+{
+    QGCFrameScheduler scheduler;
+    FrameSchedulerTestClient animated(&scheduler, 0, true);
+    FrameSchedulerTestClient idle(&scheduler);
+    scheduler.registerClient(&animated, "paint");
+    scheduler.registerClient(&idle, "paint");
+    quint64 t = SCHEDULER_TEST_START;
+
+    for (int i = 0; i < 20; i++) scheduler.paintFrame(t + i * 20000);
+    QCOMPARE(animated.paints, 20);
+    QCOMPARE(idle.paints, 1);
+
+    animated.animated = false;
+    scheduler.paintFrame(t + 20 * 20000);
+    scheduler.paintFrame(t + 21 * 20000);
+    QCOMPARE(animated.paints, 21);
+}
+
+void QGCFrameSchedulerTest::budget_test()
+{
+    QGCFrameScheduler scheduler;
+    QCOMPARE(scheduler.getInterval(), (int)QGCFrameScheduler::minFrameInterval);
+
+    // Three instruments of 5 ms each take about 15 ms per frame, which
+    // needs 50 ms per frame to stay within 30 percent. The clock has
+    // millisecond resolution, allow for 4 ms per instrument.
+    FrameSchedulerTestClient a(&scheduler, 5000, true);
+    FrameSchedulerTestClient b(&scheduler, 5000, true);
+    FrameSchedulerTestClient c(&scheduler, 5000, true);
+    scheduler.registerClient(&a, "paint");
+    scheduler.registerClient(&b, "paint");
+    scheduler.registerClient(&c, "paint");
+    quint64 t = SCHEDULER_TEST_START;
+    for (int i = 0; i < 30; i++)
+    {
+        t += scheduler.getInterval() * 1000;
+        scheduler.paintFrame(t);
+    }
+    QVERIFY(scheduler.getFrameCost() >= 11.0f);
+    QVERIFY(scheduler.getInterval() >= 36);
+    QVERIFY(scheduler.getInterval() <= QGCFrameScheduler::maxFrameInterval);
+
+    // Cheap frames bring the cadence back to the minimum
+    a.cost = b.cost = c.cost = 0;
+    for (int i = 0; i < 60; i++)
+    {
+        t += scheduler.getInterval() * 1000;
+        scheduler.paintFrame(t);
+    }
+    QCOMPARE(scheduler.getInterval(), (int)QGCFrameScheduler::minFrameInterval);
+}
+
+void QGCFrameSchedulerTest::destroyed_test()
+{
+    QGCFrameScheduler scheduler;
+    FrameSchedulerTestClient* first = new FrameSchedulerTestClient(&scheduler);
+    FrameSchedulerTestClient second(&scheduler);
+    scheduler.registerClient(first, "paint");
+    scheduler.registerClient(&second, "paint");
+    QCOMPARE(scheduler.getClientCount(), 2);
+
+    delete first;
+    QCOMPARE(scheduler.getClientCount(), 1);
+    scheduler.markDirty(&second);
+    scheduler.paintFrame(SCHEDULER_TEST_START);
+    QCOMPARE(second.paints, 1);
+
+    scheduler.unregisterClient(&second);
+    QCOMPARE(scheduler.getClientCount(), 0);
+    scheduler.markDirty(&second);
+    scheduler.paintFrame(SCHEDULER_TEST_START + 100000);
+    QCOMPARE(second.paints, 1);
+}
+
+void QGCFrameSchedulerTest::unregister_test()
+{
+    QGCFrameScheduler scheduler;
+    FrameSchedulerTestClient first(&scheduler);
+    FrameSchedulerTestClient second(&scheduler);
+    FrameSchedulerTestClient third(&scheduler);
+    first.unregister = true;
+    scheduler.registerClient(&first, "paint");
+    scheduler.registerClient(&second, "paint");
+    scheduler.registerClient(&third, "paint");
+
+    // The clients after one which unregisters during the frame are still painted
+    scheduler.paintFrame(SCHEDULER_TEST_START);
+    QCOMPARE(first.paints, 1);
+    QCOMPARE(second.paints, 1);
+    QCOMPARE(third.paints, 1);
+    QCOMPARE(scheduler.getClientCount(), 2);
+}
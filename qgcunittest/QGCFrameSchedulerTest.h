@@ -0,0 +1,46 @@
+#ifndef QGCFRAMESCHEDULERTEST_H
+#define QGCFRAMESCHEDULERTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "QGCFrameScheduler.h"
+#include "AutoTest.h"
+
+/** @brief Instrument stand-in counting its repaints */
+class FrameSchedulerTestClient : public QObject
+{
+    Q_OBJECT
+public:
+    FrameSchedulerTestClient(QGCFrameScheduler* scheduler, int cost = 0, bool animated = false);
+
+    int paints;
+    int cost;       ///< Time spent per repaint in microseconds
+    bool animated;  ///< Mark dirty again from within the repaint
+    bool unregister; ///< Unregister from within the repaint
+
+public slots:
+    void paint();
+
+protected:
+    QGCFrameScheduler* scheduler;
+};
+
+class QGCFrameSchedulerTest : public QObject
+{
+    Q_OBJECT
+public:
+    QGCFrameSchedulerTest();
+
+private slots:
+    void dirty_test();
+    void minInterval_test();
+    void animation_test();
+    void budget_test();
+    void destroyed_test();
+    void unregister_test();
+};
+
+DECLARE_TEST(QGCFrameSchedulerTest)
+
+#endif // QGCFRAMESCHEDULERTEST_H
@@ -0,0 +1,173 @@
+#include <cmath>
+#include "QGCGeometryTest.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+QGCGeometryTest::QGCGeometryTest()
+{
+}
+
+void QGCGeometryTest::rotatePerVertex(QPolygonF& p, float angle, QPointF origin)
+{
+    for (int i = 0; i < p.size(); i++)
+    {
+        QPointF curr = p.at(i);
+
+        const float x = curr.x();
+        const float y = curr.y();
+
+        curr.setX(((cos(angle) * (x-origin.x())) + (-sin(angle) * (y-origin.y()))) + origin.x());
+        curr.setY(((sin(angle) * (x-origin.x())) + (cos(angle) * (y-origin.y()))) + origin.y());
+        p.replace(i, curr);
+    }
+}
+
+QPolygonF QGCGeometryTest::needle(int vertices)
+{
+    QPolygonF p(vertices);
+    for (int i = 0; i < vertices; i++)
+    {
+        p[i] = QPointF(40.0 + 10.0 * cos(i * 0.7), 30.0 - 25.0 * sin(i * 0.3));
+    }
+    return p;
+}
+
+bool QGCGeometryTest::fuzzyCompare(const QPolygonF& a, const QPolygonF& b)
+{
+    if (a.size() != b.size()) return false;
+    for (int i = 0; i < a.size(); i++)
+    {
+        if (fabs(a.at(i).x() - b.at(i).x()) > 1e-4 || fabs(a.at(i).y() - b.at(i).y()) > 1e-4) return false;
+    }
+    return true;
+}
+
+void QGCGeometryTest::rotate_test()
+{
+    // A quarter turn is clockwise on screen, where y points down
+    QPointF p(1.0, 0.0);
+    QGCGeometry::rotate(p, M_PI / 2.0);
+    QVERIFY(fabs(p.x()) < 1e-6);
+    QVERIFY(fabs(p.y() - 1.0) < 1e-6);
+
+    QPointF q(12.0, 10.0);
+    QGCGeometry::rotate(q, M_PI, QPointF(10.0, 10.0));
+    QVERIFY(fabs(q.x() - 8.0) < 1e-5);
+    QVERIFY(fabs(q.y() - 10.0) < 1e-5);
+
+    // Same result as the per vertex rotation it replaces
+    for (int i = -8; i <= 8; i++)
+    {
+        QPolygonF expected = needle(6);
+        QPolygonF p = expected;
+        rotatePerVertex(expected, i * 0.4f, QPointF(40.0, 30.0));
+        QGCGeometry::rotate(p, i * 0.4f, QPointF(40.0, 30.0));
+        QVERIFY(fuzzyCompare(p, expected));
+    }
+}
+
+void QGCGeometryTest::scale_test()
+{
+    QPolygonF p = needle(7);
+    QPolygonF screen;
+    QGCGeometry::scale(p, 2.5f, screen);
+    QCOMPARE(screen.size(), 7);
+    for (int i = 0; i < p.size(); i++)
+    {
+        QCOMPARE(screen.at(i), p.at(i) * 2.5);
+    }
+
+    QGCGeometry::scale(QPolygonF(), 2.5f, screen);
+    QVERIFY(screen.isEmpty());
+}
+
+void QGCGeometryTest::rotateScale_test()
+{
+    QPolygonF expected = needle(6);
+    rotatePerVertex(expected, 1.1f, QPointF(35.0, 20.0));
+    QPolygonF scaled;
+    QGCGeometry::scale(expected, 3.2f, scaled);
+
+    QPolygonF screen;
+    QGCGeometry::rotateScale(needle(6), 1.1f, QPointF(35.0, 20.0), 3.2f, screen);
+    QVERIFY(fuzzyCompare(screen, scaled));
+
+    // In place
+    QPolygonF p = needle(6);
+    QGCGeometry::rotateScale(p, 1.1f, QPointF(35.0, 20.0), 3.2f, p);
+    QVERIFY(fuzzyCompare(p, scaled));
+
+    // The source stays untouched if it shares its data with the result
+    QPolygonF source = needle(6);
+    QPolygonF shared = source;
+    QGCGeometry::rotateScale(source, 1.1f, QPointF(35.0, 20.0), 3.2f, shared);
+    QCOMPARE(source, needle(6));
+    QVERIFY(fuzzyCompare(shared, scaled));
+}
+
+void QGCGeometryTest::buffer_test()
+{
+    // A buffer of the largest polygon is reused for smaller ones
+    QPolygonF screen;
+    screen.reserve(64);
+    const QPointF* data = screen.constData();
+    QGCGeometry::scale(needle(64), 2.0f, screen);
+    QGCGeometry::scale(needle(6), 2.0f, screen);
+    QGCGeometry::rotateScale(needle(32), 0.5f, QPointF(), 2.0f, screen);
+    QCOMPARE(screen.size(), 32);
+    QCOMPARE(screen.constData(), data);
+}
+
+void QGCGeometryTest::transform_benchmark_data()
+{
+    QTest::addColumn<int>("vertices");
+    QTest::addColumn<bool>("batch");
+
+    QTest::newRow("needle per vertex") << 6 << false;
+    QTest::newRow("needle batch") << 6 << true;
+    QTest::newRow("ladder per vertex") << 256 << false;
+    QTest::newRow("ladder batch") << 256 << true;
+}
+
+void QGCGeometryTest::transform_benchmark()
+{
+    QFETCH(int, vertices);
+    QFETCH(bool, batch);
+
+    // Rotate a needle and scale it to the screen, like drawing a gauge
+    const QPolygonF ref = needle(vertices);
+    const QPointF origin(40.0, 30.0);
+    const float scalingFactor = 4.8f;
+    float angle = 0.0f;
+    QPolygonF screen;
+
+    if (batch)
+    {
+        QBENCHMARK
+        {
+            angle += 0.01f;
+            QGCGeometry::rotateScale(ref, angle, origin, scalingFactor, screen);
+        }
+    }
+    else
+    {
+        QBENCHMARK
+        {
+            angle += 0.01f;
+            QPolygonF p = ref;
+            rotatePerVertex(p, angle, origin);
+            QPolygonF draw(p.size());
+            for (int i = 0; i < p.size(); i++)
+            {
+                QPointF curr;
+                curr.setX(scalingFactor * p.at(i).x());
+                curr.setY(scalingFactor * p.at(i).y());
+                draw.replace(i, curr);
+            }
+            screen = draw;
+        }
+    }
+    QCOMPARE(screen.size(), vertices);
+}
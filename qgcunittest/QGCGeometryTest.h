@@ -0,0 +1,33 @@
+#ifndef QGCGEOMETRYTEST_H
+#define QGCGEOMETRYTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "QGCGeometry.h"
+#include "AutoTest.h"
+
+class QGCGeometryTest : public QObject
+{
+    Q_OBJECT
+public:
+    QGCGeometryTest();
+
+private slots:
+    void rotate_test();
+    void scale_test();
+    void rotateScale_test();
+    void buffer_test();
+    void transform_benchmark_data();
+    void transform_benchmark();
+
+protected:
+    /** @brief The former per vertex rotation of the instruments */
+    static void rotatePerVertex(QPolygonF& p, float angle, QPointF origin);
+    static QPolygonF needle(int vertices);
+    static bool fuzzyCompare(const QPolygonF& a, const QPolygonF& b);
+};
+
+DECLARE_TEST(QGCGeometryTest)
+
+#endif // QGCGEOMETRYTEST_H
@@ -0,0 +1,160 @@
+#include <QSignalSpy>
+#include "QGCHeartbeatSupervisorTest.h"
+
+#define SUPERVISOR_TEST_START 1000000
+
+QGCHeartbeatSupervisorTest::QGCHeartbeatSupervisorTest()
+{
+}
+
+void QGCHeartbeatSupervisorTest::initTestCase()
+{
+    qRegisterMetaType<quint64>("quint64");
+}
+
+void QGCHeartbeatSupervisorTest::run(QGCHeartbeatSupervisor& supervisor, quint64 from, quint64 to)
+{
+    for (quint64 now = from; now <= to; now += QGCHeartbeatSupervisor::tickInterval)
+    {
+        supervisor.advance(now);
+    }
+}
+
+void QGCHeartbeatSupervisorTest::transitions_test()
+{
+    QGCHeartbeatSupervisor supervisor;
+    QSignalSpy spy(&supervisor, SIGNAL(stateChanged(int,int,quint64)));
+    quint64 t = SUPERVISOR_TEST_START;
+
+    // Regular heartbeats cause no signal at all
+    for (int i = 0; i < 10; i++)
+    {
+        supervisor.heartbeat(7, t);
+        run(supervisor, t, t + 1000);
+        t += 1000;
+    }
+    QCOMPARE(spy.count(), 0);
+    QCOMPARE(supervisor.getState(7), QGCHeartbeatSupervisor::HEARTBEAT_ALIVE);
+
+    // Silence: timeout after two seconds, lost after ten, each signalled once
+    quint64 last = t;
+    supervisor.heartbeat(7, last);
+    run(supervisor, last, last + supervisor.getTimeout() - QGCHeartbeatSupervisor::tickInterval);
+    QCOMPARE(spy.count(), 0);
+    run(supervisor, last + supervisor.getTimeout() - QGCHeartbeatSupervisor::tickInterval, last + 20000);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(0).at(1).toInt(), (int)QGCHeartbeatSupervisor::HEARTBEAT_TIMEOUT);
+    QVERIFY(spy.at(0).at(2).toULongLong() >= (quint64)supervisor.getTimeout());
+    QVERIFY(spy.at(0).at(2).toULongLong() < (quint64)supervisor.getTimeout() + 2 * QGCHeartbeatSupervisor::tickInterval);
+    QCOMPARE(spy.at(1).at(1).toInt(), (int)QGCHeartbeatSupervisor::HEARTBEAT_LOST);
+    QCOMPARE(supervisor.getState(7), QGCHeartbeatSupervisor::HEARTBEAT_LOST);
+
+    // The next heartbeat revives it, and it times out again later
+    t = last + 20000;
+    supervisor.heartbeat(7, t);
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(spy.at(2).at(1).toInt(), (int)QGCHeartbeatSupervisor::HEARTBEAT_ALIVE);
+    run(supervisor, t, t + 3000);
+    QCOMPARE(spy.count(), 4);
+    QCOMPARE(spy.at(3).at(1).toInt(), (int)QGCHeartbeatSupervisor::HEARTBEAT_TIMEOUT);
+
+    // A heartbeat before the lost timeout revives it, the stale
+    // lost deadline in the wheel must not fire
+    for (quint64 now = t + 3000; now < t + 15000; now += 1000)
+    {
+        supervisor.heartbeat(7, now);
+        run(supervisor, now, now + 1000);
+    }
+    QCOMPARE(spy.count(), 5);
+    QCOMPARE(supervisor.getState(7), QGCHeartbeatSupervisor::HEARTBEAT_ALIVE);
+}
+
+void QGCHeartbeatSupervisorTest::lateTimer_test()
+{
+    QGCHeartbeatSupervisor supervisor;
+    QSignalSpy spy(&supervisor, SIGNAL(stateChanged(int,int,quint64)));
+
+    // The event loop was blocked for 30 seconds, both transitions in order
+    supervisor.heartbeat(1, SUPERVISOR_TEST_START);
+    supervisor.advance(SUPERVISOR_TEST_START + 30000);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(0).at(1).toInt(), (int)QGCHeartbeatSupervisor::HEARTBEAT_TIMEOUT);
+    QCOMPARE(spy.at(1).at(1).toInt(), (int)QGCHeartbeatSupervisor::HEARTBEAT_LOST);
+}
+
+void QGCHeartbeatSupervisorTest::longTimeout_test()
+{
+    // Deadlines beyond the inner wheel go through the outer one
+    QGCHeartbeatSupervisor supervisor;
+    supervisor.setTimeout(15000);
+    supervisor.setLostTimeout(600000);
+    QSignalSpy spy(&supervisor, SIGNAL(stateChanged(int,int,quint64)));
+
+    supervisor.heartbeat(3, SUPERVISOR_TEST_START);
+    run(supervisor, SUPERVISOR_TEST_START, SUPERVISOR_TEST_START + 14900);
+    QCOMPARE(spy.count(), 0);
+    run(supervisor, SUPERVISOR_TEST_START + 14900, SUPERVISOR_TEST_START + 15100);
+    QCOMPARE(spy.count(), 1);
+    run(supervisor, SUPERVISOR_TEST_START + 15100, SUPERVISOR_TEST_START + 599900);
+    QCOMPARE(spy.count(), 1);
+    run(supervisor, SUPERVISOR_TEST_START + 599900, SUPERVISOR_TEST_START + 600100);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(1).toInt(), (int)QGCHeartbeatSupervisor::HEARTBEAT_LOST);
+}
+
+void QGCHeartbeatSupervisorTest::swarm_benchmark_data()
+{
+    QTest::addColumn<int>("systems");
+
+    QTest::newRow("10 systems") << 10;
+    QTest::newRow("100 systems") << 100;
+    QTest::newRow("250 systems") << 250;
+}
+
+void QGCHeartbeatSupervisorTest::simulateSwarm(QGCHeartbeatSupervisor& supervisor, int systems, int seconds)
+{
+    // One heartbeat per second and system, every tenth
+    // system goes silent after half of the time
+    for (quint64 now = SUPERVISOR_TEST_START; now < SUPERVISOR_TEST_START + seconds * 1000; now += QGCHeartbeatSupervisor::tickInterval)
+    {
+        if ((now - SUPERVISOR_TEST_START) % 1000 == 0)
+        {
+            for (int i = 0; i < systems; i++)
+            {
+                if (i % 10 != 0 || now < SUPERVISOR_TEST_START + seconds * 500)
+                {
+                    supervisor.heartbeat(i, now);
+                }
+            }
+        }
+        supervisor.advance(now);
+    }
+}
+
+void QGCHeartbeatSupervisorTest::swarm_benchmark()
+{
+    QFETCH(int, systems);
+    const int seconds = 60;
+
+    QBENCHMARK
+    {
+        QGCHeartbeatSupervisor supervisor;
+        simulateSwarm(supervisor, systems, seconds);
+    }
+
+    QGCHeartbeatSupervisor supervisor;
+    QSignalSpy spy(&supervisor, SIGNAL(stateChanged(int,int,quint64)));
+    simulateSwarm(supervisor, systems, seconds);
+
+    // Only the silent systems changed their state, to timeout and then lost
+    int silent = (systems + 9) / 10;
+    QCOMPARE(spy.count(), silent * 2);
+    for (int i = 0; i < systems; i++)
+    {
+        QCOMPARE(supervisor.getState(i), (i % 10 == 0) ? QGCHeartbeatSupervisor::HEARTBEAT_LOST : QGCHeartbeatSupervisor::HEARTBEAT_ALIVE);
+    }
+    // About one check per system and timeout period, independent of the heartbeat rate
+    QVERIFY(supervisor.getEntriesProcessed() <= (quint64)(systems * (seconds * 1000 / supervisor.getTimeout() + 2)));
+    qDebug() << "SUPERVISION of" << systems << "systems for" << seconds << "s:" << supervisor.getEntriesProcessed() << "wheel entries processed,"
+             << spy.count() << "state changes";
+}
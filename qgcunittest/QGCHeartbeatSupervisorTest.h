@@ -0,0 +1,33 @@
+#ifndef QGCHEARTBEATSUPERVISORTEST_H
+#define QGCHEARTBEATSUPERVISORTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "QGCHeartbeatSupervisor.h"
+#include "AutoTest.h"
+
+class QGCHeartbeatSupervisorTest : public QObject
+{
+    Q_OBJECT
+public:
+    QGCHeartbeatSupervisorTest();
+
+private slots:
+    void initTestCase();
+    void transitions_test();
+    void lateTimer_test();
+    void longTimeout_test();
+    void swarm_benchmark_data();
+    void swarm_benchmark();
+
+protected:
+    /** @brief Advance the supervisor in steps of one tick */
+    void run(QGCHeartbeatSupervisor& supervisor, quint64 from, quint64 to);
+    /** @brief Heartbeats of a swarm in which every tenth system goes silent halfway */
+    void simulateSwarm(QGCHeartbeatSupervisor& supervisor, int systems, int seconds);
+};
+
+DECLARE_TEST(QGCHeartbeatSupervisorTest)
+
+#endif // QGCHEARTBEATSUPERVISORTEST_H
@@ -0,0 +1,92 @@
+#include <QImage>
+#include <QPainter>
+#include "QGCLabelCacheTest.h"
+
+#define LABEL_TEST_BOUNDS QSize(640, 60)
+
+QGCLabelCacheTest::QGCLabelCacheTest()
+{
+}
+
+void QGCLabelCacheTest::hit_test()
+{
+    QGCLabelCache cache;
+    QCOMPARE(cache.getHitRate(), 0.0f);
+
+    // Only the first lookup renders
+    QVERIFY(!cache.label("10", Qt::white, 12, LABEL_TEST_BOUNDS).isNull());
+    for (int i = 0; i < 9; i++) cache.label("10", Qt::white, 12, LABEL_TEST_BOUNDS);
+    QCOMPARE(cache.getMisses(), (quint64)1);
+    QCOMPARE(cache.getHits(), (quint64)9);
+    QCOMPARE(cache.getHitRate(), 0.9f);
+    QCOMPARE(cache.getCount(), 1);
+
+    cache.resetStatistics();
+    QCOMPARE(cache.getHits(), (quint64)0);
+    QCOMPARE(cache.getCount(), 1);
+
+    // Nothing to draw
+    QVERIFY(cache.label("", Qt::white, 12, LABEL_TEST_BOUNDS).isNull());
+    QCOMPARE(cache.getCount(), 1);
+}
+
+void QGCLabelCacheTest::key_test()
+{
+    QGCLabelCache cache;
+    cache.label("20", Qt::white, 12, LABEL_TEST_BOUNDS);
+    cache.label("20", Qt::red, 12, LABEL_TEST_BOUNDS);
+    cache.label("20", Qt::white, 14, LABEL_TEST_BOUNDS);
+    cache.label("20", Qt::white, 12, QSize(320, 30));
+    cache.label("-20", Qt::white, 12, LABEL_TEST_BOUNDS);
+    QCOMPARE(cache.getCount(), 5);
+    QCOMPARE(cache.getHits(), (quint64)0);
+
+    // Larger text needs a larger label
+    QVERIFY(cache.label("20", Qt::white, 14, LABEL_TEST_BOUNDS).height() >
+            cache.label("20", Qt::white, 12, LABEL_TEST_BOUNDS).height());
+    QCOMPARE(cache.getHits(), (quint64)2);
+}
+
+void QGCLabelCacheTest::eviction_test()
+{
+    // Every label costs at least one kilobyte
+    QGCLabelCache cache(8);
+    for (int i = 0; i < 8; i++) cache.label(QString::number(i), Qt::white, 10, LABEL_TEST_BOUNDS);
+    QCOMPARE(cache.getCount(), 8);
+
+    // Keep label 0 recently used, the oldest other one goes
+    cache.label("0", Qt::white, 10, LABEL_TEST_BOUNDS);
+    cache.label("8", Qt::white, 10, LABEL_TEST_BOUNDS);
+    QCOMPARE(cache.getCount(), 8);
+    cache.resetStatistics();
+    cache.label("0", Qt::white, 10, LABEL_TEST_BOUNDS);
+    QCOMPARE(cache.getHits(), (quint64)1);
+    cache.label("1", Qt::white, 10, LABEL_TEST_BOUNDS);
+    QCOMPARE(cache.getMisses(), (quint64)1);
+
+    // A label larger than the cache is drawn without evicting the others
+    QVERIFY(!cache.label("a much longer label which needs more than eight kilobytes", Qt::white, 40, LABEL_TEST_BOUNDS).isNull());
+    QCOMPARE(cache.getCount(), 8);
+
+    cache.clear();
+    QCOMPARE(cache.getCount(), 0);
+}
+
+void QGCLabelCacheTest::rendering_test()
+{
+    // The blit must look like the text drawn directly
+    QGCLabelCache cache;
+    const QPixmap& label = cache.label("35", Qt::white, 20, LABEL_TEST_BOUNDS);
+    QImage expected(label.size(), QImage::Format_ARGB32_Premultiplied);
+    expected.fill(0);
+    {
+        QFont font(QGCLabelCache::fontFamily);
+        font.setPixelSize(20);
+        QPainter painter(&expected);
+        painter.setPen(Qt::white);
+        painter.setFont(font);
+        painter.setRenderHint(QPainter::TextAntialiasing);
+        painter.drawText(0, 0, label.width(), label.height(), Qt::AlignCenter | Qt::TextWordWrap, "35");
+    }
+    QCOMPARE(label.toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied), expected);
+}
@@ -0,0 +1,30 @@
+#ifndef QGCLABELCACHETEST_H
+#define QGCLABELCACHETEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "QGCLabelCache.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Hit counting and eviction of the label cache
+ *
+ * Rendering text needs a QApplication, so this runs in qgcbenchmark.
+ */
+class QGCLabelCacheTest : public QObject
+{
+    Q_OBJECT
+public:
+    QGCLabelCacheTest();
+
+private slots:
+    void hit_test();
+    void key_test();
+    void eviction_test();
+    void rendering_test();
+};
+
+DECLARE_TEST(QGCLabelCacheTest)
+
+#endif // QGCLABELCACHETEST_H
@@ -0,0 +1,153 @@
+#include <QSet>
+#include "QGCRawVideoBufferTest.h"
+
+// Odd width to exercise the scalar tail of the vectorized conversions
+#define VIDEO_TEST_WIDTH 37
+#define VIDEO_TEST_HEIGHT 5
+
+QGCRawVideoBufferTest::QGCRawVideoBufferTest()
+{
+}
+
+void QGCRawVideoBufferTest::fillRaw(QGCRawVideoBuffer& buffer, int seed)
+{
+    unsigned char* raw = buffer.getRawBuffer();
+    for (int i = 0; i < buffer.getRawSize(); i++)
+    {
+        raw[i] = (unsigned char)(i * 7 + seed);
+    }
+}
+
+void QGCRawVideoBufferTest::conversion_test_data()
+{
+    QTest::addColumn<int>("channels");
+    QTest::newRow("grey") << 1;
+    QTest::newRow("bgr") << 3;
+    QTest::newRow("bgra") << 4;
+}
+
+void QGCRawVideoBufferTest::conversion_test()
+{
+    QFETCH(int, channels);
+
+    QGCRawVideoBuffer buffer;
+    QVERIFY(buffer.setFormat(VIDEO_TEST_WIDTH, VIDEO_TEST_HEIGHT, 8, channels));
+    QCOMPARE(buffer.getRawSize(), VIDEO_TEST_WIDTH * VIDEO_TEST_HEIGHT * channels);
+    fillRaw(buffer, 3);
+    buffer.commit();
+    QVERIFY(buffer.acquire());
+
+    // RGBA bytes, the bottom line of the raw image first
+    const unsigned char* raw = buffer.getRawBuffer();
+    const uchar* pixels = buffer.getFrontPixels();
+    for (int y = 0; y < VIDEO_TEST_HEIGHT; y++)
+    {
+        for (int x = 0; x < VIDEO_TEST_WIDTH; x++)
+        {
+            const unsigned char* src = raw + (y * VIDEO_TEST_WIDTH + x) * channels;
+            const uchar* dst = pixels + ((VIDEO_TEST_HEIGHT - 1 - y) * VIDEO_TEST_WIDTH + x) * 4;
+            if (channels == 1)
+            {
+                QCOMPARE(dst[0], src[0]);
+                QCOMPARE(dst[1], src[0]);
+                QCOMPARE(dst[2], src[0]);
+                QCOMPARE(dst[3], (uchar)255);
+            }
+            else
+            {
+                QCOMPARE(dst[0], src[2]);
+                QCOMPARE(dst[1], src[1]);
+                QCOMPARE(dst[2], src[0]);
+                QCOMPARE(dst[3], (channels == 4) ? src[3] : (uchar)255);
+            }
+        }
+    }
+
+    // Saving restores the image orientation
+    QImage image = buffer.toImage();
+    const unsigned char* first = raw;
+    if (channels == 1) QCOMPARE(image.pixel(0, 0), qRgb(first[0], first[0], first[0]));
+    else QCOMPARE(qRed(image.pixel(0, 0)), (int)first[2]);
+}
+
+void QGCRawVideoBufferTest::tripleBuffer_test()
+{
+    QGCRawVideoBuffer buffer;
+    QVERIFY(buffer.setFormat(VIDEO_TEST_WIDTH, VIDEO_TEST_HEIGHT, 8, 1));
+    QVERIFY(!buffer.acquire());
+
+    // Three frames before the painter runs, only the latest is shown
+    for (int i = 0; i < 3; i++)
+    {
+        buffer.getRawBuffer()[0] = (unsigned char)(10 + i);
+        buffer.commit();
+    }
+    QCOMPARE(buffer.getFramesCommitted(), (quint64)3);
+    QCOMPARE(buffer.getFramesDropped(), (quint64)2);
+    QVERIFY(buffer.acquire());
+    const int firstPixel = (VIDEO_TEST_HEIGHT - 1) * VIDEO_TEST_WIDTH * 4;
+    QCOMPARE(buffer.getFrontPixels()[firstPixel], (uchar)12);
+    QVERIFY(!buffer.acquire());
+
+    // The front frame stays untouched while the next one is converted
+    buffer.getRawBuffer()[0] = 20;
+    buffer.commit();
+    QCOMPARE(buffer.getFrontPixels()[firstPixel], (uchar)12);
+    QVERIFY(buffer.acquire());
+    QCOMPARE(buffer.getFrontPixels()[firstPixel], (uchar)20);
+    QCOMPARE(buffer.getFramesDropped(), (quint64)2);
+
+    // Unsupported formats are not converted
+    QVERIFY(!buffer.setFormat(VIDEO_TEST_WIDTH, VIDEO_TEST_HEIGHT, 16, 1));
+    buffer.commit();
+    QVERIFY(!buffer.hasFrame());
+}
+
+void QGCRawVideoBufferTest::persistentBuffers_test()
+{
+    QGCRawVideoBuffer buffer;
+    QVERIFY(buffer.setFormat(640, 480, 8, 1));
+    unsigned char* raw = buffer.getRawBuffer();
+
+    // Frames rotate through three buffers allocated once
+    QSet<const uchar*> frames;
+    for (int i = 0; i < 20; i++)
+    {
+        fillRaw(buffer, i);
+        buffer.commit();
+        if (i % 3 != 0) buffer.acquire();
+        frames.insert(buffer.getFrontPixels());
+        QVERIFY(buffer.getRawBuffer() == raw);
+    }
+    QVERIFY(frames.size() <= 3);
+
+    // Setting the same format again keeps the buffers
+    QVERIFY(buffer.setFormat(640, 480, 8, 1));
+    QVERIFY(buffer.getRawBuffer() == raw);
+    QVERIFY(buffer.hasFrame());
+}
+
+void QGCRawVideoBufferTest::commit_benchmark_data()
+{
+    QTest::addColumn<int>("channels");
+    QTest::newRow("grey 640x480") << 1;
+    QTest::newRow("bgr 640x480") << 3;
+    QTest::newRow("bgra 640x480") << 4;
+}
+
+void QGCRawVideoBufferTest::commit_benchmark()
+{
+    QFETCH(int, channels);
+
+    QGCRawVideoBuffer buffer;
+    QVERIFY(buffer.setFormat(640, 480, 8, channels));
+    fillRaw(buffer, 1);
+
+    QBENCHMARK
+    {
+        buffer.commit();
+        buffer.acquire();
+    }
+
+    qDebug() << "RAW VIDEO" << channels << "channels:" << buffer.getConversionTime() << "us per frame";
+}
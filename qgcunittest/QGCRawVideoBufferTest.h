@@ -0,0 +1,31 @@
+#ifndef QGCRAWVIDEOBUFFERTEST_H
+#define QGCRAWVIDEOBUFFERTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "QGCRawVideoBuffer.h"
+#include "AutoTest.h"
+
+class QGCRawVideoBufferTest : public QObject
+{
+    Q_OBJECT
+public:
+    QGCRawVideoBufferTest();
+
+private slots:
+    void conversion_test_data();
+    void conversion_test();
+    void tripleBuffer_test();
+    void persistentBuffers_test();
+    void commit_benchmark_data();
+    void commit_benchmark();
+
+protected:
+    /** @brief Fill the raw buffer with a pattern depending on the seed */
+    void fillRaw(QGCRawVideoBuffer& buffer, int seed);
+};
+
+DECLARE_TEST(QGCRawVideoBufferTest)
+
+#endif // QGCRAWVIDEOBUFFERTEST_H
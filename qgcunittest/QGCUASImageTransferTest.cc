@@ -0,0 +1,185 @@
+#include <QBuffer>
+#include <QSignalSpy>
+#include "QGCUASImageTransferTest.h"
+#include "QGC.h"
+
+#define IMAGE_TEST_PAYLOAD 253
+#define IMAGE_TEST_TIMEOUT_MS 5000
+
+QGCUASImageTransferTest::QGCUASImageTransferTest()
+{
+}
+
+void QGCUASImageTransferTest::initTestCase()
+{
+    qsrand(42);
+    // Noise does not compress, the image needs many packets
+    original = QImage(80, 60, QImage::Format_RGB32);
+    for (int y = 0; y < original.height(); ++y)
+    {
+        for (int x = 0; x < original.width(); ++x)
+        {
+            original.setPixel(x, y, qRgb(qrand() % 256, qrand() % 256, qrand() % 256));
+        }
+    }
+    QBuffer buffer(&encoded);
+    buffer.open(QIODevice::WriteOnly);
+    original.save(&buffer, "PNG");
+    QVERIFY(encoded.size() > 20 * IMAGE_TEST_PAYLOAD);
+}
+
+void QGCUASImageTransferTest::handshake(QGCUASImageTransfer& transfer, int component, const QByteArray& data)
+{
+    int packets = (data.size() + IMAGE_TEST_PAYLOAD - 1) / IMAGE_TEST_PAYLOAD;
+    transfer.startTransfer(component, data.size(), packets, IMAGE_TEST_PAYLOAD);
+}
+
+void QGCUASImageTransferTest::send(QGCUASImageTransfer& transfer, int component, const QByteArray& data, const QList<int>& packets)
+{
+    foreach (int seq, packets)
+    {
+        // Packets always carry a full payload, the last one is padded
+        QByteArray packet = data.mid(seq * IMAGE_TEST_PAYLOAD, IMAGE_TEST_PAYLOAD);
+        packet.resize(IMAGE_TEST_PAYLOAD);
+        transfer.receivePacket(component, seq, packet.constData(), packet.size());
+    }
+}
+
+QList<int> QGCUASImageTransferTest::allPackets(const QByteArray& data)
+{
+    QList<int> packets;
+    for (int i = 0; i * IMAGE_TEST_PAYLOAD < data.size(); ++i) packets.append(i);
+    return packets;
+}
+
+bool QGCUASImageTransferTest::waitFor(QSignalSpy& spy, int count)
+{
+    quint64 start = QGC::groundTimeMilliseconds();
+    while (spy.count() < count && QGC::groundTimeMilliseconds() - start < IMAGE_TEST_TIMEOUT_MS)
+    {
+        QTest::qWait(5);
+    }
+    return spy.count() >= count;
+}
+
+void QGCUASImageTransferTest::inOrder_test()
+{
+    QGCUASImageTransfer transfer;
+    QSignalSpy ready(&transfer, SIGNAL(imageReady(int,QImage)));
+
+    handshake(transfer, 100, encoded);
+    QVERIFY(transfer.isActive(100));
+    send(transfer, 100, encoded, allPackets(encoded));
+    QVERIFY(!transfer.isActive());
+
+    // Decoded in the pool, delivered through the event loop
+    QVERIFY(waitFor(ready, 1));
+    QCOMPARE(ready.at(0).at(0).toInt(), 100);
+    QImage image = qvariant_cast<QImage>(ready.at(0).at(1));
+    QCOMPARE(image.size(), original.size());
+    QCOMPARE(image.pixel(17, 23), original.pixel(17, 23));
+    QCOMPARE(transfer.getFramesDecoded(), (quint64)1);
+    QCOMPARE(transfer.getLossRate(), 0.0f);
+}
+
+void QGCUASImageTransferTest::reorderLoss_test()
+{
+    QGCUASImageTransfer transfer;
+    QSignalSpy ready(&transfer, SIGNAL(imageReady(int,QImage)));
+    QSignalSpy requests(&transfer, SIGNAL(requestImage(int)));
+
+    // Shuffled, every fourth packet lost
+    QList<int> packets = allPackets(encoded);
+    for (int i = packets.size() - 1; i > 0; --i) packets.swap(i, qrand() % (i + 1));
+    QList<int> lost;
+    QList<int> arriving;
+    for (int i = 0; i < packets.size(); ++i)
+    {
+        if (i % 4 == 0) lost.append(packets[i]);
+        else arriving.append(packets[i]);
+    }
+    qSort(lost);
+
+    handshake(transfer, 100, encoded);
+    send(transfer, 100, encoded, arriving);
+    QCOMPARE(transfer.getMissingPackets(100), lost);
+
+    // Once the stream stalls the image is dropped and a new one requested
+    QVERIFY(waitFor(requests, 1));
+    QCOMPARE(requests.at(0).at(0).toInt(), 100);
+    QVERIFY(!transfer.isActive(100));
+    QCOMPARE(transfer.getFramesLost(), (quint64)1);
+    QCOMPARE(ready.count(), 0);
+
+    // The vehicle answers with a new capture
+    handshake(transfer, 100, encoded);
+    send(transfer, 100, encoded, packets);
+    QVERIFY(waitFor(ready, 1));
+    QImage image = qvariant_cast<QImage>(ready.at(0).at(1));
+    QCOMPARE(image.pixel(79, 59), original.pixel(79, 59));
+    QVERIFY(transfer.getLossRate() > 0.1f);
+    QCOMPARE(transfer.getImagesRequested(), (quint64)1);
+}
+
+void QGCUASImageTransferTest::newCapture_test()
+{
+    QGCUASImageTransfer transfer;
+
+    // A handshake has no image id, one of the same size is still a new image
+    QList<int> packets = allPackets(encoded);
+    handshake(transfer, 100, encoded);
+    send(transfer, 100, encoded, packets.mid(0, packets.size() / 2));
+    handshake(transfer, 100, encoded);
+    QCOMPARE(transfer.getMissingPackets(100), packets);
+    QCOMPARE(transfer.getFramesLost(), (quint64)1);
+}
+
+void QGCUASImageTransferTest::concurrent_test()
+{
+    QGCUASImageTransfer transfer;
+    QSignalSpy ready(&transfer, SIGNAL(imageReady(int,QImage)));
+
+    // A second camera sends a smaller image at the same time
+    QByteArray small;
+    QBuffer buffer(&small);
+    buffer.open(QIODevice::WriteOnly);
+    original.scaled(40, 30).save(&buffer, "PNG");
+
+    handshake(transfer, 100, encoded);
+    handshake(transfer, 101, small);
+    QList<int> packets = allPackets(encoded);
+    QList<int> smallPackets = allPackets(small);
+    for (int i = 0; i < packets.size(); ++i)
+    {
+        send(transfer, 100, encoded, QList<int>() << packets[i]);
+        if (i < smallPackets.size()) send(transfer, 101, small, QList<int>() << smallPackets[i]);
+    }
+
+    QVERIFY(waitFor(ready, 2));
+    for (int i = 0; i < 2; ++i)
+    {
+        int component = ready.at(i).at(0).toInt();
+        QImage image = qvariant_cast<QImage>(ready.at(i).at(1));
+        QCOMPARE(image.width(), component == 100 ? 80 : 40);
+    }
+}
+
+void QGCUASImageTransferTest::giveUp_test()
+{
+    QGCUASImageTransfer transfer;
+    QSignalSpy ready(&transfer, SIGNAL(imageReady(int,QImage)));
+    QSignalSpy requests(&transfer, SIGNAL(requestImage(int)));
+
+    QList<int> packets = allPackets(encoded);
+    packets.removeAt(5);
+    handshake(transfer, 100, encoded);
+    send(transfer, 100, encoded, packets);
+
+    // No answer to any request, the image is dropped instead of shown corrupt
+    QVERIFY(waitFor(requests, QGCUASImageTransfer::maxRequests));
+    QVERIFY(!transfer.isActive());
+    QTest::qWait(QGCUASImageTransfer::requestTimeout + 2 * QGCUASImageTransfer::gapTimeout);
+    QCOMPARE(requests.count(), (int)QGCUASImageTransfer::maxRequests);
+    QCOMPARE(transfer.getFramesLost(), (quint64)1);
+    QCOMPARE(ready.count(), 0);
+}
@@ -0,0 +1,42 @@
+#ifndef QGCUASIMAGETRANSFERTEST_H
+#define QGCUASIMAGETRANSFERTEST_H
+
+#include <QObject>
+#include <QList>
+#include <QImage>
+#include <QByteArray>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "QGCUASImageTransfer.h"
+#include "AutoTest.h"
+
+class QGCUASImageTransferTest : public QObject
+{
+    Q_OBJECT
+public:
+    QGCUASImageTransferTest();
+
+private slots:
+    void initTestCase();
+    void inOrder_test();
+    void reorderLoss_test();
+    void newCapture_test();
+    void concurrent_test();
+    void giveUp_test();
+
+protected:
+    /** @brief Announce the encoded image to the transfer */
+    void handshake(QGCUASImageTransfer& transfer, int component, const QByteArray& data);
+    /** @brief Send the given packets of the encoded image */
+    void send(QGCUASImageTransfer& transfer, int component, const QByteArray& data, const QList<int>& packets);
+    /** @brief Process events until the spy has count entries */
+    bool waitFor(QSignalSpy& spy, int count);
+    QList<int> allPackets(const QByteArray& data);
+
+    QImage original;
+    QByteArray encoded;
+};
+
+DECLARE_TEST(QGCUASImageTransferTest)
+
+#endif // QGCUASIMAGETRANSFERTEST_H
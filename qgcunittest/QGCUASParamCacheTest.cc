@@ -0,0 +1,99 @@
+#include <QDir>
+#include <QFile>
+#include "QGCUASParamCacheTest.h"
+
+#define CACHE_TEST_PARAMS 300
+
+QGCUASParamCacheTest::QGCUASParamCacheTest()
+{
+    for (int i = 0; i < CACHE_TEST_PARAMS; ++i)
+    {
+        names.append(QString("PARAM_%1").arg(i));
+        values.append(i * 0.1f);
+    }
+}
+
+void QGCUASParamCacheTest::init()
+{
+    directory = QDir::tempPath() + QString("/qgc-param-cache-test-%1").arg(QCoreApplication::applicationPid());
+    removeDirectory();
+}
+
+void QGCUASParamCacheTest::cleanup()
+{
+    removeDirectory();
+}
+
+void QGCUASParamCacheTest::removeDirectory()
+{
+    QDir dir(directory);
+    foreach (QString file, dir.entryList(QDir::Files))
+    {
+        dir.remove(file);
+    }
+    QDir().rmdir(directory);
+}
+
+void QGCUASParamCacheTest::storeLoad_test()
+{
+    QGCUASParamCache cache(directory);
+    QVERIFY(cache.getComponents(42, 1).isEmpty());
+
+    QVERIFY(cache.store(42, 200, 1, names, values));
+    QVERIFY(cache.store(42, 25, 1, names.mid(0, 10), values.mid(0, 10)));
+
+    QList<int> components = cache.getComponents(42, 1);
+    qSort(components);
+    QCOMPARE(components, QList<int>() << 25 << 200);
+
+    QVector<QString> loadedNames;
+    QVector<float> loadedValues;
+    QVERIFY(cache.load(42, 200, 1, &loadedNames, &loadedValues));
+    QCOMPARE(loadedNames, names);
+    QCOMPARE(loadedValues, values);
+
+    // Values are replaced, not merged
+    values[7] = 123.456f;
+    QVERIFY(cache.store(42, 200, 1, names, values));
+    QVERIFY(cache.load(42, 200, 1, &loadedNames, &loadedValues));
+    QCOMPARE(loadedValues.at(7), 123.456f);
+
+    cache.remove(42, 25, 1);
+    QCOMPARE(cache.getComponents(42, 1), QList<int>() << 200);
+}
+
+void QGCUASParamCacheTest::fingerprint_test()
+{
+    QGCUASParamCache cache(directory);
+    QVERIFY(cache.store(42, 200, 1, names, values));
+
+    QVector<QString> loadedNames;
+    QVector<float> loadedValues;
+    // Other system, other component, other autopilot
+    QVERIFY(!cache.load(43, 200, 1, &loadedNames, &loadedValues));
+    QVERIFY(!cache.load(42, 201, 1, &loadedNames, &loadedValues));
+    QVERIFY(!cache.load(42, 200, 3, &loadedNames, &loadedValues));
+    QVERIFY(cache.getComponents(42, 3).isEmpty());
+    QVERIFY(cache.getComponents(43, 1).isEmpty());
+}
+
+void QGCUASParamCacheTest::corrupt_test()
+{
+    QGCUASParamCache cache(directory);
+    QVERIFY(cache.store(42, 200, 1, names, values));
+
+    // Truncate the file
+    QString fileName = QDir(directory).absoluteFilePath(QDir(directory).entryList(QDir::Files).first());
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.resize(file.size() / 2));
+    file.close();
+
+    QVector<QString> loadedNames;
+    QVector<float> loadedValues;
+    QVERIFY(!cache.load(42, 200, 1, &loadedNames, &loadedValues));
+    QVERIFY(loadedNames.isEmpty());
+
+    // Lists with a different size are refused
+    QVERIFY(!cache.store(42, 200, 1, names, values.mid(1)));
+}
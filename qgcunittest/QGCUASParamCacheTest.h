@@ -0,0 +1,33 @@
+#ifndef QGCUASPARAMCACHETEST_H
+#define QGCUASPARAMCACHETEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "QGCUASParamCache.h"
+#include "AutoTest.h"
+
+class QGCUASParamCacheTest : public QObject
+{
+    Q_OBJECT
+public:
+    QGCUASParamCacheTest();
+
+private slots:
+    void init();
+    void cleanup();
+    void storeLoad_test();
+    void fingerprint_test();
+    void corrupt_test();
+
+protected:
+    QString directory;
+    QVector<QString> names;
+    QVector<float> values;
+
+    void removeDirectory();
+};
+
+DECLARE_TEST(QGCUASParamCacheTest)
+
+#endif // QGCUASPARAMCACHETEST_H
@@ -0,0 +1,207 @@
+#include "QGCUASParamTransferTest.h"
+#include "QGC.h"
+
+#define PARAM_TEST_COUNT 300
+#define PARAM_TEST_TIMEOUT_MS 60000
+#define PARAM_TEST_BATCH 1000
+
+SimulatedParamVehicle::SimulatedParamVehicle(QGCUASParamTransfer* transfer, int count, int latency, int loss) :
+    transfer(transfer),
+    latency(latency),
+    loss(loss)
+{
+    for (int i = 0; i < count; i++)
+    {
+        names.append(QString("GROUP%1_PARAM%2").arg(i / 10).arg(i));
+        values.append(i * 0.5f);
+    }
+    connect(transfer, SIGNAL(requestParameter(int,int)), this, SLOT(requestParameter(int,int)));
+    connect(transfer, SIGNAL(writeParameter(int,QString,float)), this, SLOT(writeParameter(int,QString,float)));
+    connect(&timer, SIGNAL(timeout()), this, SLOT(deliver()));
+    timer.start(1);
+}
+
+void SimulatedParamVehicle::streamList()
+{
+    quint64 now = QGC::groundTimeMilliseconds();
+    for (int i = 0; i < names.size(); i++)
+    {
+        queueReply(i, now + latency + i * streamInterval);
+    }
+}
+
+void SimulatedParamVehicle::queueReply(int index, quint64 due)
+{
+    if (lost()) return;
+    Reply reply;
+    reply.due = due;
+    reply.index = index;
+    replies.append(reply);
+}
+
+void SimulatedParamVehicle::requestParameter(int component, int index)
+{
+    Q_UNUSED(component);
+    if (lost()) return;
+    // Request travels to the vehicle, answer travels back
+    queueReply(index, QGC::groundTimeMilliseconds() + 2 * latency);
+}
+
+void SimulatedParamVehicle::writeParameter(int component, QString name, float value)
+{
+    Q_UNUSED(component);
+    if (lost()) return;
+    int index = names.indexOf(name);
+    values[index] = value;
+    queueReply(index, QGC::groundTimeMilliseconds() + 2 * latency);
+}
+
+void SimulatedParamVehicle::deliver()
+{
+    quint64 now = QGC::groundTimeMilliseconds();
+    // Requests may be answered before the rest of the stream,
+    // answers are not ordered by due time
+    for (int i = 0; i < replies.size(); i++)
+    {
+        if (replies.at(i).due <= now)
+        {
+            Reply reply = replies.takeAt(i--);
+            transfer->receiveParameter(component, names.size(), reply.index, names.at(reply.index), values.at(reply.index));
+        }
+    }
+}
+
+QGCUASParamTransferTest::QGCUASParamTransferTest()
+{
+}
+
+void QGCUASParamTransferTest::init()
+{
+    // Same loss pattern on every run
+    qsrand(42);
+    finished = false;
+    missingRead = 0;
+    missingWrite = 0;
+    progressSignals = 0;
+    progressTotal = 0;
+}
+
+void QGCUASParamTransferTest::writeProgress(int done, int total)
+{
+    Q_UNUSED(done);
+    progressSignals++;
+    progressTotal = total;
+}
+
+void QGCUASParamTransferTest::transferFinished(int missingRead, int missingWrite)
+{
+    finished = true;
+    this->missingRead = missingRead;
+    this->missingWrite = missingWrite;
+}
+
+bool QGCUASParamTransferTest::waitFinished()
+{
+    quint64 start = QGC::groundTimeMilliseconds();
+    while (!finished && QGC::groundTimeMilliseconds() - start < PARAM_TEST_TIMEOUT_MS) QTest::qWait(5);
+    return finished;
+}
+
+void QGCUASParamTransferTest::listTransfer_test_data()
+{
+    QTest::addColumn<int>("latency");
+    QTest::addColumn<int>("loss");
+
+    QTest::newRow("no latency") << 0 << 0;
+    QTest::newRow("100 ms RTT") << 50 << 0;
+    QTest::newRow("100 ms RTT, 5% loss") << 50 << 5;
+    QTest::newRow("200 ms RTT, 20% loss") << 100 << 20;
+}
+
+void QGCUASParamTransferTest::listTransfer_test()
+{
+    QFETCH(int, latency);
+    QFETCH(int, loss);
+
+    QGCUASParamTransfer transfer;
+    SimulatedParamVehicle vehicle(&transfer, PARAM_TEST_COUNT, latency, loss);
+    connect(&transfer, SIGNAL(transferFinished(int,int)), this, SLOT(transferFinished(int,int)));
+
+    transfer.startList();
+    vehicle.streamList();
+    QVERIFY(waitFinished());
+
+    QCOMPARE(missingRead, 0);
+    QCOMPARE(transfer.getMissingCount(), 0);
+    QCOMPARE(transfer.getTotalCount(), PARAM_TEST_COUNT);
+    if (loss == 0) QCOMPARE(transfer.getLastTransferRetries(), 0);
+    else QVERIFY(transfer.getLastTransferRetries() > 0);
+
+    qDebug() << "LIST of" << PARAM_TEST_COUNT << "parameters, latency" << latency << "ms, loss" << loss
+             << "%:" << transfer.getLastTransferTime() << "ms," << transfer.getLastTransferRetries() << "retries, RTT"
+             << transfer.getRoundTripTime() << "ms, burst" << transfer.getBurstSize();
+}
+
+void QGCUASParamTransferTest::write_test()
+{
+    QGCUASParamTransfer transfer;
+    SimulatedParamVehicle vehicle(&transfer, PARAM_TEST_COUNT, 20, 20);
+    connect(&transfer, SIGNAL(transferFinished(int,int)), this, SLOT(transferFinished(int,int)));
+
+    for (int i = 0; i < PARAM_TEST_COUNT; i += 3)
+    {
+        transfer.startWrite(1, vehicle.getName(i), 1000.0f + i);
+    }
+    QVERIFY(waitFinished());
+
+    QCOMPARE(missingWrite, 0);
+    QCOMPARE(transfer.getMissingWriteCount(), 0);
+    for (int i = 0; i < PARAM_TEST_COUNT; i++)
+    {
+        QCOMPARE(vehicle.getValue(i), (i % 3 == 0) ? 1000.0f + i : i * 0.5f);
+    }
+
+    // A parameter value arriving before the write was sent is no echo,
+    // the write stays queued
+    QGCUASParamTransfer lone;
+    lone.startWrite(1, vehicle.getName(1), 5.0f);
+    QCOMPARE(lone.receiveParameter(1, PARAM_TEST_COUNT, 1, vehicle.getName(1), 0.5f), QGCUASParamTransfer::PARAM_UNEXPECTED);
+    QCOMPARE(lone.getMissingWriteCount(), 1);
+
+    // An echo of a different value is reported as mismatch
+    QTest::qWait(100);
+    float written = 0;
+    QCOMPARE(lone.receiveParameter(1, PARAM_TEST_COUNT, 1, vehicle.getName(1), 6.0f, &written), QGCUASParamTransfer::PARAM_WRITE_MISMATCH);
+    QCOMPARE(written, 5.0f);
+    QCOMPARE(lone.getMissingWriteCount(), 0);
+}
+
+void QGCUASParamTransferTest::writeBatch_test()
+{
+    QGCUASParamTransfer transfer;
+    SimulatedParamVehicle vehicle(&transfer, PARAM_TEST_BATCH, 10, 5);
+    connect(&transfer, SIGNAL(transferFinished(int,int)), this, SLOT(transferFinished(int,int)));
+    connect(&transfer, SIGNAL(writeProgress(int,int)), this, SLOT(writeProgress(int,int)));
+
+    for (int i = 0; i < PARAM_TEST_BATCH; i++)
+    {
+        transfer.startWrite(1, vehicle.getName(i), -1.0f);
+    }
+    // Changing a pending write does not add a second one
+    transfer.startWrite(1, vehicle.getName(0), -2.0f);
+    QCOMPARE(transfer.getWriteTotal(), PARAM_TEST_BATCH);
+    QCOMPARE(transfer.getWriteProgress(), 0.0f);
+
+    QVERIFY(waitFinished());
+    QCOMPARE(missingWrite, 0);
+    QCOMPARE(progressSignals, PARAM_TEST_BATCH);
+    QCOMPARE(progressTotal, PARAM_TEST_BATCH);
+    QCOMPARE(transfer.getWriteProgress(), 100.0f);
+    QCOMPARE(vehicle.getValue(0), -2.0f);
+    QCOMPARE(vehicle.getValue(PARAM_TEST_BATCH - 1), -1.0f);
+    QVERIFY(transfer.getWriteThroughput() > 0);
+
+    qDebug() << "WRITE of" << PARAM_TEST_BATCH << "parameters, latency 10 ms, loss 5 %:" << transfer.getLastTransferTime()
+             << "ms," << transfer.getWriteThroughput() << "parameters/s," << transfer.getLastTransferRetries() << "retries, send interval"
+             << transfer.getSendInterval() << "ms";
+}
@@ -0,0 +1,87 @@
+#ifndef QGCUASPARAMTRANSFERTEST_H
+#define QGCUASPARAMTRANSFERTEST_H
+
+#include <QObject>
+#include <QTimer>
+#include <QList>
+#include <QVector>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "QGCUASParamTransfer.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Onboard parameter storage behind a link with latency and loss
+ *
+ * Answers the requests and writes of a QGCUASParamTransfer directly,
+ * without MAVLink encoding.
+ */
+class SimulatedParamVehicle : public QObject
+{
+    Q_OBJECT
+public:
+    SimulatedParamVehicle(QGCUASParamTransfer* transfer, int count, int latency, int loss);
+    /** @brief Stream the whole list like after PARAM_REQUEST_LIST */
+    void streamList();
+    float getValue(int index) const { return values.at(index); }
+    QString getName(int index) const { return names.at(index); }
+
+public slots:
+    void requestParameter(int component, int index);
+    void writeParameter(int component, QString name, float value);
+    /** @brief Deliver all parameters whose latency has passed */
+    void deliver();
+
+protected:
+    struct Reply
+    {
+        quint64 due;
+        int index;
+    };
+
+    QGCUASParamTransfer* transfer;
+    QVector<QString> names;
+    QVector<float> values;
+    QList<Reply> replies;
+    int latency;    ///< One way latency in milliseconds
+    int loss;       ///< Loss probability in percent, per direction
+    QTimer timer;
+
+    bool lost() { return (qrand() % 100) < loss; }
+    void queueReply(int index, quint64 due);
+
+    static const int component = 1;
+    static const int streamInterval = 1; ///< Milliseconds per streamed parameter
+};
+
+class QGCUASParamTransferTest : public QObject
+{
+    Q_OBJECT
+public:
+    QGCUASParamTransferTest();
+
+public slots:
+    void transferFinished(int missingRead, int missingWrite);
+    void writeProgress(int done, int total);
+
+private slots:
+    void init();
+    void listTransfer_test_data();
+    void listTransfer_test();
+    void write_test();
+    void writeBatch_test();
+
+protected:
+    bool finished;
+    int missingRead;
+    int missingWrite;
+    int progressSignals;
+    int progressTotal;
+
+    /** @brief Wait for transferFinished(), returns false on timeout */
+    bool waitFinished();
+};
+
+DECLARE_TEST(QGCUASParamTransferTest)
+
+#endif // QGCUASPARAMTRANSFERTEST_H
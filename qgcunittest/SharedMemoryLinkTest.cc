@@ -0,0 +1,159 @@
+#include <QUdpSocket>
+#include "SharedMemoryLinkTest.h"
+#include "QGC.h"
+
+#define SHM_TEST_SEGMENT "/qgcunittest"
+#define SHM_TEST_EXISTING_SEGMENT "/qgcunittest-existing"
+#define SHM_TEST_PACKET_LEN 38  // Size of an ATTITUDE packet
+
+void ShmEchoThread::run()
+{
+    // Wait for the link to create the segment
+    qgc_shm_region_t* shm = NULL;
+    while (running && !shm)
+    {
+        shm = qgc_shm_attach(segment.toLocal8Bit().constData(), 0, NULL);
+        if (!shm) QGC::SLEEP::msleep(1);
+    }
+
+    uint8_t buf[1024];
+    while (running)
+    {
+        uint32_t seq = qgc_shm_ring_sequence(&shm->from_gcs);
+        uint32_t len = qgc_shm_ring_read(&shm->from_gcs, buf, sizeof(buf));
+        if (len > 0)
+        {
+            qgc_shm_ring_write(&shm->to_gcs, buf, len);
+        }
+        else
+        {
+            qgc_shm_ring_wait(&shm->from_gcs, seq, 10);
+        }
+    }
+    qgc_shm_detach(shm, segment.toLocal8Bit().constData(), 0);
+}
+
+SharedMemoryLinkTest::SharedMemoryLinkTest()
+{
+}
+
+void SharedMemoryLinkTest::receiveBytes(LinkInterface* link, QByteArray data)
+{
+    Q_UNUSED(link);
+    lastReceived = data;
+    received.release();
+}
+
+void SharedMemoryLinkTest::initTestCase()
+{
+    link = new SharedMemoryLink(SHM_TEST_SEGMENT);
+    // Deliver directly from the reader thread, the test waits on the semaphore
+    connect(link, SIGNAL(bytesReceived(LinkInterface*,QByteArray)), this, SLOT(receiveBytes(LinkInterface*,QByteArray)), Qt::DirectConnection);
+    QVERIFY(link->connect());
+    echo = new ShmEchoThread(SHM_TEST_SEGMENT);
+    echo->start();
+}
+
+void SharedMemoryLinkTest::cleanupTestCase()
+{
+    echo->stop();
+    echo->wait();
+    delete echo;
+    link->disconnect();
+    delete link;
+}
+
+void SharedMemoryLinkTest::echo_test()
+{
+    QByteArray packet("\x55\x03\x01\x32\xc8\x00\x01\x02", 8);
+    link->writeBytes(packet.constData(), packet.size());
+    QVERIFY(received.tryAcquire(1, 1000));
+    QCOMPARE(lastReceived, packet);
+    QCOMPARE(link->getBitsSent(), (qint64)packet.size() * 8);
+    QCOMPARE(link->getBytesDropped(), (qint64)0);
+}
+
+void SharedMemoryLinkTest::existingSegment_test()
+{
+    // The simulator was started first and has already written to the segment
+    shm_unlink(SHM_TEST_EXISTING_SEGMENT);
+    int created = 0;
+    qgc_shm_region_t* shm = qgc_shm_attach(SHM_TEST_EXISTING_SEGMENT, 1, &created);
+    QVERIFY(shm);
+    QCOMPARE(created, 1);
+    QByteArray packet("\x55\x03\x02\x32\xc8\x00\x01\x02", 8);
+    qgc_shm_ring_write(&shm->to_gcs, (const uint8_t*)packet.constData(), packet.size());
+
+    // The link attaches without clearing, the waiting bytes arrive
+    SharedMemoryLink existing(SHM_TEST_EXISTING_SEGMENT);
+    connect(&existing, SIGNAL(bytesReceived(LinkInterface*,QByteArray)), this, SLOT(receiveBytes(LinkInterface*,QByteArray)), Qt::DirectConnection);
+    QVERIFY(existing.connect());
+    QVERIFY(received.tryAcquire(1, 1000));
+    QCOMPARE(lastReceived, packet);
+    QCOMPARE(existing.bytesAvailable(), (qint64)0);
+
+    // It did not create the segment, so it leaves it in place
+    existing.disconnect();
+    QCOMPARE(existing.bytesAvailable(), (qint64)0);
+    qgc_shm_region_t* again = qgc_shm_attach(SHM_TEST_EXISTING_SEGMENT, 0, NULL);
+    QVERIFY(again);
+    qgc_shm_detach(again, SHM_TEST_EXISTING_SEGMENT, 0);
+    qgc_shm_detach(shm, SHM_TEST_EXISTING_SEGMENT, created);
+}
+
+void SharedMemoryLinkTest::segmentName_test()
+{
+    // A second link does not share the segment of the first one
+    SharedMemoryLink second(SHM_TEST_SEGMENT);
+    QCOMPARE(second.getSegmentName(), QString(SHM_TEST_SEGMENT "-2"));
+
+    // Taken and invalid names are rejected
+    second.setSegmentName(SHM_TEST_SEGMENT);
+    QCOMPARE(second.getSegmentName(), QString(SHM_TEST_SEGMENT "-2"));
+    second.setSegmentName("/qgc/unittest");
+    QCOMPARE(second.getSegmentName(), QString(SHM_TEST_SEGMENT "-2"));
+
+    // The name is free again once the first link is gone
+    SharedMemoryLink* third = new SharedMemoryLink(SHM_TEST_EXISTING_SEGMENT);
+    QCOMPARE(third->getSegmentName(), QString(SHM_TEST_EXISTING_SEGMENT));
+    delete third;
+    SharedMemoryLink fourth(SHM_TEST_EXISTING_SEGMENT);
+    QCOMPARE(fourth.getSegmentName(), QString(SHM_TEST_EXISTING_SEGMENT));
+}
+
+void SharedMemoryLinkTest::roundTripShm_benchmark()
+{
+    QByteArray packet(SHM_TEST_PACKET_LEN, 0x55);
+
+    QBENCHMARK
+    {
+        link->writeBytes(packet.constData(), packet.size());
+        QVERIFY(received.tryAcquire(1, 1000));
+    }
+    QCOMPARE(lastReceived, packet);
+    QCOMPARE(link->getBytesDropped(), (qint64)0);
+}
+
+void SharedMemoryLinkTest::roundTripUdp_benchmark()
+{
+    // Same ping-pong over loopback sockets as UDPLink would use them
+    QUdpSocket gcs;
+    QUdpSocket sim;
+    QVERIFY(gcs.bind(QHostAddress::LocalHost, 0));
+    QVERIFY(sim.bind(QHostAddress::LocalHost, 0));
+
+    char packet[SHM_TEST_PACKET_LEN];
+    char buf[1024];
+    memset(packet, 0x55, sizeof(packet));
+
+    QBENCHMARK
+    {
+        gcs.writeDatagram(packet, sizeof(packet), QHostAddress::LocalHost, sim.localPort());
+        QVERIFY(sim.waitForReadyRead(1000));
+        qint64 len = sim.readDatagram(buf, sizeof(buf));
+        QCOMPARE(len, (qint64)sizeof(packet));
+        sim.writeDatagram(buf, len, QHostAddress::LocalHost, gcs.localPort());
+        QVERIFY(gcs.waitForReadyRead(1000));
+        QCOMPARE(gcs.readDatagram(buf, sizeof(buf)), (qint64)sizeof(packet));
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef SHAREDMEMORYLINKTEST_H
+#define SHAREDMEMORYLINKTEST_H
+
+#include <QObject>
+#include <QThread>
+#include <QSemaphore>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "SharedMemoryLink.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Echoes everything QGroundControl writes back to it, like a simulator would
+ */
+class ShmEchoThread : public QThread
+{
+public:
+    ShmEchoThread(const QString& segment) : segment(segment), running(true) {}
+    void run();
+    void stop() { running = false; }
+protected:
+    QString segment;
+    volatile bool running;
+};
+
+class SharedMemoryLinkTest : public QObject
+{
+    Q_OBJECT
+public:
+    SharedMemoryLinkTest();
+
+public slots:
+    void receiveBytes(LinkInterface* link, QByteArray data);
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void echo_test();
+    void existingSegment_test();
+    void segmentName_test();
+    void roundTripShm_benchmark();
+    void roundTripUdp_benchmark();
+
+protected:
+    SharedMemoryLink* link;
+    ShmEchoThread* echo;
+    QSemaphore received;
+    QByteArray lastReceived;
+};
+
+DECLARE_TEST(SharedMemoryLinkTest)
+
+#endif // SHAREDMEMORYLINKTEST_H
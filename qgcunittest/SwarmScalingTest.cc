@@ -0,0 +1,163 @@
+#include <ctime>
+#include <QFile>
+#include <QTextStream>
+#include <QTime>
+#include <QtAlgorithms>
+#include "SwarmScalingTest.h"
+#include "UASManager.h"
+#include "QGC.h"
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+#define SWARM_TEST_WARMUP 1000
+#define SWARM_TEST_TIMEOUT 10000
+#define SWARM_TEST_DURATION 3000
+#define SWARM_TEST_REPORT "swarm_scaling.json"
+
+SwarmScalingTest::SwarmScalingTest() :
+    mav(NULL),
+    swarm(NULL),
+    measuring(false)
+{
+}
+
+void SwarmScalingTest::initTestCase()
+{
+    mav = new MAVLinkProtocol();
+}
+
+void SwarmScalingTest::cleanupTestCase()
+{
+    delete mav;
+
+    QString fileName = qgetenv("QGC_SWARM_REPORT");
+    if (fileName.isEmpty()) fileName = SWARM_TEST_REPORT;
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text));
+    QTextStream out(&file);
+    out << "{\n  \"duration_ms\": " << SWARM_TEST_DURATION << ",\n  \"runs\": [\n    "
+        << results.join(",\n    ") << "\n  ]\n}\n";
+    qDebug() << "SWARM SCALING report written to" << fileName;
+}
+
+qint64 SwarmScalingTest::residentBytes()
+{
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/statm");
+    if (!file.open(QIODevice::ReadOnly)) return -1;
+    QList<QByteArray> fields = QByteArray(file.readAll()).split(' ');
+    if (fields.size() < 2) return -1;
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return -1;
+#endif
+}
+
+quint64 SwarmScalingTest::percentile(const QVector<quint64>& sorted, double q)
+{
+    if (sorted.isEmpty()) return 0;
+    return sorted.at(qMin(sorted.size() - 1, (int)(q * sorted.size())));
+}
+
+void SwarmScalingTest::receiveBytes(LinkInterface* link, QByteArray data)
+{
+    quint64 start = QGC::groundTimeUsecs();
+    mav->receiveBytes(link, data);
+    quint64 now = QGC::groundTimeUsecs();
+
+    // Chunks emitted by the link thread and not yet decoded, including this one
+    int depth = swarm->getPendingChunks();
+    QVector<quint64> sent = swarm->takeChunkSendTimes();
+    if (!measuring) return;
+
+    receiveTime += now - start;
+    messages += sent.size();
+    foreach (quint64 time, sent)
+    {
+        latencies.append(now - time);
+    }
+    depthSum += depth;
+    depthSamples++;
+    depthMax = qMax(depthMax, depth);
+}
+
+void SwarmScalingTest::scaling_benchmark_data()
+{
+    QTest::addColumn<int>("systems");
+    QTest::newRow("1 vehicle") << 1;
+    QTest::newRow("10 vehicles") << 10;
+    QTest::newRow("50 vehicles") << 50;
+    QTest::newRow("100 vehicles") << 100;
+    QTest::newRow("250 vehicles") << (int)MAVLinkSwarmSimulationLink::maxSystems;
+}
+
+void SwarmScalingTest::scaling_benchmark()
+{
+    QFETCH(int, systems);
+
+    // Systems of earlier tests stay in the manager
+    const QList<UASInterface*> existing = UASManager::instance()->getUASList();
+    qint64 memoryBefore = residentBytes();
+    swarm = new MAVLinkSwarmSimulationLink();
+    swarm->setSystemCount(systems);
+    swarm->setLatencyTracking(true);
+    connect(swarm, SIGNAL(bytesReceived(LinkInterface*,QByteArray)), this, SLOT(receiveBytes(LinkInterface*,QByteArray)));
+
+    // Every vehicle sends its heartbeat first, wait until all exist
+    swarm->connect();
+    QTime timeout;
+    timeout.start();
+    while (UASManager::instance()->getUASList().size() < existing.size() + systems && timeout.elapsed() < SWARM_TEST_TIMEOUT)
+    {
+        QTest::qWait(10);
+    }
+    QCOMPARE(UASManager::instance()->getUASList().size(), existing.size() + systems);
+    QTest::qWait(SWARM_TEST_WARMUP);
+
+    messages = 0;
+    receiveTime = 0;
+    latencies.clear();
+    depthSum = 0;
+    depthSamples = 0;
+    depthMax = 0;
+    measuring = true;
+    quint64 sentBefore = swarm->getMessagesSent();
+    clock_t cpuStart = clock();
+    QTest::qWait(SWARM_TEST_DURATION);
+    clock_t cpuTime = clock() - cpuStart;
+    quint64 sent = swarm->getMessagesSent() - sentBefore;
+    measuring = false;
+    qint64 memoryAfter = residentBytes();
+
+    // Decode what is still queued before the link goes away
+    swarm->disconnect();
+    for (int i = 0; i < 100 && swarm->getPendingChunks() > 0; i++) QTest::qWait(10);
+    delete swarm;
+    swarm = NULL;
+    foreach (UASInterface* uas, UASManager::instance()->getUASList())
+    {
+        if (!existing.contains(uas)) delete uas;
+    }
+
+    QVERIFY(messages > 0);
+    qSort(latencies);
+    double cpuPerMessage = (double)cpuTime * 1000000 / CLOCKS_PER_SEC / messages;
+    double receivePerMessage = (double)receiveTime / messages;
+    qint64 memoryPerVehicle = (memoryBefore < 0 || memoryAfter < 0) ? -1 : (memoryAfter - memoryBefore) / systems;
+    QVERIFY(percentile(latencies, 0.5) <= percentile(latencies, 0.99));
+
+    results.append(QString("{\"vehicles\": %1, \"messages_sent\": %2, \"messages_decoded\": %3, "
+                           "\"cpu_us_per_msg\": %4, \"receive_us_per_msg\": %5, \"memory_bytes_per_vehicle\": %6, "
+                           "\"latency_us\": {\"p50\": %7, \"p90\": %8, \"p99\": %9, \"max\": %10}, "
+                           "\"queue_depth\": {\"mean\": %11, \"max\": %12}}")
+                   .arg(systems).arg(sent).arg(messages)
+                   .arg(cpuPerMessage, 0, 'f', 3).arg(receivePerMessage, 0, 'f', 3)
+                   .arg(memoryPerVehicle < 0 ? QString("null") : QString::number(memoryPerVehicle))
+                   .arg(percentile(latencies, 0.5)).arg(percentile(latencies, 0.9))
+                   .arg(percentile(latencies, 0.99)).arg(latencies.last())
+                   .arg(depthSamples ? (double)depthSum / depthSamples : 0.0, 0, 'f', 2).arg(depthMax));
+
+    qDebug() << "SWARM SCALING" << systems << "vehicles:" << messages << "msgs," << cpuPerMessage << "us CPU/msg,"
+             << percentile(latencies, 0.99) << "us p99 latency, queue depth max" << depthMax;
+}
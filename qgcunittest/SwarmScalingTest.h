@@ -0,0 +1,58 @@
+#ifndef SWARMSCALINGTEST_H
+#define SWARMSCALINGTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtTest/QtTest>
+#include "MAVLinkSwarmSimulationLink.h"
+#include "MAVLinkProtocol.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Headless scaling harness over the number of simulated vehicles
+ *
+ * Every row connects a MAVLinkSwarmSimulationLink with that many vehicles
+ * and feeds its packets through MAVLinkProtocol into UASManager and the UAS
+ * objects. The results of all rows are written as JSON to the file named by
+ * the QGC_SWARM_REPORT environment variable, swarm_scaling.json by default.
+ *
+ * The rows run for seconds each, so this is built with qgcbenchmark.pro.
+ */
+class SwarmScalingTest : public QObject
+{
+    Q_OBJECT
+public:
+    SwarmScalingTest();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void scaling_benchmark_data();
+    void scaling_benchmark();
+
+protected slots:
+    /** @brief Pass a chunk to the protocol and account for its messages */
+    void receiveBytes(LinkInterface* link, QByteArray data);
+
+protected:
+    MAVLinkProtocol* mav;
+    MAVLinkSwarmSimulationLink* swarm;
+    bool measuring;
+    quint64 messages;
+    quint64 receiveTime;          ///< Time spent in the receive path in microseconds
+    QVector<quint64> latencies;   ///< Send to decoded in microseconds, one per message
+    quint64 depthSum;
+    int depthSamples;
+    int depthMax;
+    QStringList results;          ///< One JSON object per row
+
+    /** @brief Resident set size of this process in bytes, -1 if unknown */
+    static qint64 residentBytes();
+    /** @brief Value below which the fraction q of the sorted samples lies */
+    static quint64 percentile(const QVector<quint64>& sorted, double q);
+};
+
+DECLARE_TEST(SwarmScalingTest)
+
+#endif // SWARMSCALINGTEST_H
@@ -0,0 +1,111 @@
+#include <QTcpServer>
+#include <QTcpSocket>
+#include "TCPLinkTest.h"
+#include "QGC.h"
+
+#define TCP_TEST_TIMEOUT_MS 2000
+
+TCPLinkTest::TCPLinkTest()
+{
+}
+
+void TCPLinkTest::receiveBytes(LinkInterface* link, QByteArray data)
+{
+    Q_UNUSED(link);
+    received.append(data);
+}
+
+void TCPLinkTest::init()
+{
+    received.clear();
+}
+
+bool TCPLinkTest::waitReceived(int size)
+{
+    quint64 start = QGC::groundTimeMilliseconds();
+    while (received.size() < size && QGC::groundTimeMilliseconds() - start < TCP_TEST_TIMEOUT_MS) QTest::qWait(5);
+    return received.size() >= size;
+}
+
+bool TCPLinkTest::waitReadable(QTcpSocket* socket, int size)
+{
+    quint64 start = QGC::groundTimeMilliseconds();
+    while (socket->bytesAvailable() < size && QGC::groundTimeMilliseconds() - start < TCP_TEST_TIMEOUT_MS) QTest::qWait(5);
+    return socket->bytesAvailable() >= size;
+}
+
+void TCPLinkTest::client_test()
+{
+    // The vehicle side, a bridge listening on a free port
+    QTcpServer vehicle;
+    QVERIFY(vehicle.listen(QHostAddress::LocalHost, 0));
+
+    TCPLink link("127.0.0.1", vehicle.serverPort(), TCPLink::TCP_CLIENT);
+    connect(&link, SIGNAL(bytesReceived(LinkInterface*,QByteArray)), this, SLOT(receiveBytes(LinkInterface*,QByteArray)));
+    QVERIFY(link.connect());
+
+    // The link connects asynchronously from the event loop
+    quint64 start = QGC::groundTimeMilliseconds();
+    while ((!link.isConnected() || !vehicle.hasPendingConnections()) && QGC::groundTimeMilliseconds() - start < TCP_TEST_TIMEOUT_MS) QTest::qWait(5);
+    QVERIFY(link.isConnected());
+    QTcpSocket* socket = vehicle.nextPendingConnection();
+    QVERIFY(socket);
+
+    // Vehicle to ground station
+    QByteArray packet("\x55\x03\x01\x32\xc8\x00\x01\x02", 8);
+    socket->write(packet);
+    socket->flush();
+    QVERIFY(waitReceived(packet.size()));
+    QCOMPARE(received, packet);
+
+    // Ground station to vehicle, two writes are coalesced into one stream
+    link.writeBytes(packet.constData(), packet.size());
+    link.writeBytes(packet.constData(), packet.size());
+    QVERIFY(waitReadable(socket, 2 * packet.size()));
+    QCOMPARE(socket->readAll(), packet + packet);
+    QCOMPARE(link.getBitsSent(), (qint64)packet.size() * 2 * 8);
+    QCOMPARE(link.getBitsReceived(), (qint64)packet.size() * 8);
+
+    QVERIFY(link.disconnect());
+    QVERIFY(!link.isConnected());
+}
+
+void TCPLinkTest::server_test()
+{
+    // Find a free port for the link to listen on
+    QTcpServer probe;
+    QVERIFY(probe.listen(QHostAddress::LocalHost, 0));
+    quint16 port = probe.serverPort();
+    probe.close();
+
+    TCPLink link("", port, TCPLink::TCP_SERVER);
+    connect(&link, SIGNAL(bytesReceived(LinkInterface*,QByteArray)), this, SLOT(receiveBytes(LinkInterface*,QByteArray)));
+    QVERIFY(link.connect());
+    QVERIFY(link.isConnected());
+
+    QTcpSocket vehicle;
+    vehicle.connectToHost(QHostAddress::LocalHost, port);
+    QVERIFY(vehicle.waitForConnected(TCP_TEST_TIMEOUT_MS));
+    quint64 start = QGC::groundTimeMilliseconds();
+    while (link.getClientCount() == 0 && QGC::groundTimeMilliseconds() - start < TCP_TEST_TIMEOUT_MS) QTest::qWait(5);
+    QCOMPARE(link.getClientCount(), 1);
+
+    QByteArray packet("\x55\x03\x01\x32\xc8\x00\x01\x02", 8);
+    vehicle.write(packet);
+    vehicle.flush();
+    QVERIFY(waitReceived(packet.size()));
+    QCOMPARE(received, packet);
+
+    link.writeBytes(packet.constData(), packet.size());
+    QVERIFY(waitReadable(&vehicle, packet.size()));
+    QCOMPARE(vehicle.readAll(), packet);
+
+    // The vehicle going away leaves the link listening
+    vehicle.disconnectFromHost();
+    start = QGC::groundTimeMilliseconds();
+    while (link.getClientCount() > 0 && QGC::groundTimeMilliseconds() - start < TCP_TEST_TIMEOUT_MS) QTest::qWait(5);
+    QCOMPARE(link.getClientCount(), 0);
+    QVERIFY(link.isConnected());
+
+    QVERIFY(link.disconnect());
+}
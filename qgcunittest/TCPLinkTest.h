@@ -0,0 +1,38 @@
+#ifndef TCPLINKTEST_H
+#define TCPLINKTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "TCPLink.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Connects TCPLink over loopback in both modes and checks both directions
+ */
+class TCPLinkTest : public QObject
+{
+    Q_OBJECT
+public:
+    TCPLinkTest();
+
+public slots:
+    void receiveBytes(LinkInterface* link, QByteArray data);
+
+private slots:
+    void init();
+    void client_test();
+    void server_test();
+
+protected:
+    QByteArray received;
+
+    /** @brief Process events until the link received size bytes, returns false on timeout */
+    bool waitReceived(int size);
+    /** @brief Process events until the socket has size bytes to read, returns false on timeout */
+    bool waitReadable(QTcpSocket* socket, int size);
+};
+
+DECLARE_TEST(TCPLinkTest)
+
+#endif // TCPLINKTEST_H
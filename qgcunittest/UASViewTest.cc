@@ -0,0 +1,72 @@
+#include <QLabel>
+#include <QProgressBar>
+#include "UASViewTest.h"
+#include "MAVLinkProtocol.h"
+#include "SerialLink.h"
+
+#define VIEW_TEST_SYSTEM 77
+
+UASViewTest::UASViewTest()
+{
+}
+
+void UASViewTest::sendStatus(UAS& uas, LinkInterface* link, int mode, int navMode, int status, int battery, int throttle)
+{
+    mavlink_message_t msg;
+    mavlink_sys_status_t state;
+    memset(&state, 0, sizeof(state));
+    state.mode = mode;
+    state.nav_mode = navMode;
+    state.status = status;
+    state.vbat = 12000;
+    state.battery_remaining = battery;
+    mavlink_msg_sys_status_encode(uas.getUASID(), MAV_COMP_ID_IMU, &msg, &state);
+    uas.receiveMessage(link, msg);
+
+    mavlink_vfr_hud_t hud;
+    memset(&hud, 0, sizeof(hud));
+    hud.throttle = throttle;
+    mavlink_msg_vfr_hud_encode(uas.getUASID(), MAV_COMP_ID_IMU, &msg, &hud);
+    uas.receiveMessage(link, msg);
+}
+
+QString UASViewTest::labelText(UASView* tile, const QString& name)
+{
+    QLabel* label = tile->findChild<QLabel*>(name);
+    return label ? label->text() : QString();
+}
+
+void UASViewTest::tileRecreation_test()
+{
+    MAVLinkProtocol mav;
+    SerialLink link;
+    UAS uas(&mav, VIEW_TEST_SYSTEM);
+
+    // The first status arrives while the tile is on screen
+    UASView* tile = new UASView(&uas);
+    sendStatus(uas, &link, MAV_MODE_MANUAL, MAV_NAV_HOLD, MAV_STATE_STANDBY, 900, 20);
+    tile->refresh();
+    QCOMPARE(labelText(tile, "modeLabel"), QString("MANUAL MODE"));
+
+    // Scrolled out of view, the list drops the tile and the system goes on
+    delete tile;
+    sendStatus(uas, &link, MAV_MODE_AUTO, MAV_NAV_WAYPOINT, MAV_STATE_ACTIVE, 800, 60);
+    mavlink_message_t msg;
+    mavlink_waypoint_current_t wpc;
+    wpc.seq = 3;
+    mavlink_msg_waypoint_current_encode(uas.getUASID(), MAV_COMP_ID_WAYPOINTPLANNER, &msg, &wpc);
+    uas.receiveMessage(&link, msg);
+
+    // Scrolled back, the new tile shows the current values without further updates
+    tile = new UASView(&uas);
+    tile->refresh();
+    QVERIFY(!uas.getShortState().isEmpty());
+    QCOMPARE(labelText(tile, "stateLabel"), uas.getShortState());
+    QCOMPARE(labelText(tile, "statusTextLabel"), uas.getStateDescription());
+    QCOMPARE(labelText(tile, "modeLabel"), QString("AUTO MODE"));
+    QCOMPARE(labelText(tile, "navLabel"), QString("WAYPOINT"));
+    QCOMPARE(labelText(tile, "waypointLabel"), QString("WP3"));
+    QCOMPARE(tile->findChild<QProgressBar*>("batteryBar")->value(), 80);
+    QCOMPARE(tile->findChild<QProgressBar*>("thrustBar")->value(), 60);
+    delete tile;
+}
@@ -0,0 +1,34 @@
+#ifndef UASVIEWTEST_H
+#define UASVIEWTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "UAS.h"
+#include "UASView.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Status tiles rebuilt by the virtualized UAS list
+ *
+ * The tiles are widgets, so this runs in qgcbenchmark.
+ */
+class UASViewTest : public QObject
+{
+    Q_OBJECT
+public:
+    UASViewTest();
+
+private slots:
+    void tileRecreation_test();
+
+protected:
+    /** @brief Let the system receive a status and a HUD message */
+    void sendStatus(UAS& uas, LinkInterface* link, int mode, int navMode, int status, int battery, int throttle);
+    /** @brief Text of a label of the tile */
+    static QString labelText(UASView* tile, const QString& name);
+};
+
+DECLARE_TEST(UASViewTest)
+
+#endif // UASVIEWTEST_H
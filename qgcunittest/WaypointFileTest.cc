@@ -0,0 +1,168 @@
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include "WaypointFileTest.h"
+#include "UASWaypointManager.h"
+#include "WaypointFileLoader.h"
+#include "QGC.h"
+
+#define WP_FILE_TEST_SYSTEM 1
+#define WP_FILE_TEST_COUNT 50
+#define WP_FILE_BENCHMARK_COUNT 5000
+#define WP_FILE_TEST_TIMEOUT_MS 10000
+
+WaypointFileTest::WaypointFileTest() :
+    mav(NULL)
+{
+}
+
+void WaypointFileTest::initTestCase()
+{
+    mav = new MAVLinkProtocol();
+}
+
+void WaypointFileTest::cleanupTestCase()
+{
+    delete mav;
+}
+
+void WaypointFileTest::cleanup()
+{
+    QFile::remove(testFile("txt"));
+    QFile::remove(testFile("wpb"));
+}
+
+QString WaypointFileTest::testFile(const QString& suffix)
+{
+    return QDir::tempPath() + QString("/qgc-waypoint-file-test-%1.%2").arg(QCoreApplication::applicationPid()).arg(suffix);
+}
+
+void WaypointFileTest::createMission(UASWaypointManager* manager, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        // Survey grid with full double precision coordinates
+        MAV_FRAME frame = (i % 7 == 0) ? MAV_FRAME_LOCAL : MAV_FRAME_GLOBAL;
+        MAV_CMD command = (i % 11 == 0) ? MAV_CMD_NAV_LOITER_TURNS : MAV_CMD_NAV_WAYPOINT;
+        manager->addWaypoint(new Waypoint(0, 47.3763451234567 + (i / 50) * 0.000123456789, 8.5481234567891 + (i % 50) * 0.000123456789,
+                                          550.25 + i, i % 3, 2.5, 10.0 + i, i * 0.1, i % 5 != 0, false, frame, command));
+    }
+}
+
+void WaypointFileTest::roundTrip_test_data()
+{
+    QTest::addColumn<QString>("suffix");
+
+    QTest::newRow("text") << "txt";
+    QTest::newRow("binary") << "wpb";
+}
+
+void WaypointFileTest::roundTrip_test()
+{
+    QFETCH(QString, suffix);
+    QString fileName = testFile(suffix);
+
+    UAS uas(mav, WP_FILE_TEST_SYSTEM);
+    UAS other(mav, WP_FILE_TEST_SYSTEM + 1);
+    createMission(uas.getWaypointManager(), WP_FILE_TEST_COUNT);
+    uas.getWaypointManager()->saveWaypoints(fileName);
+    other.getWaypointManager()->loadWaypoints(fileName, true);
+
+    const QVector<Waypoint*>& saved = uas.getWaypointManager()->getWaypointList();
+    const QVector<Waypoint*>& loaded = other.getWaypointManager()->getWaypointList();
+    QCOMPARE(loaded.size(), saved.size());
+    for (int i = 0; i < saved.size(); i++)
+    {
+        QCOMPARE(loaded[i]->getId(), (quint16)i);
+        QCOMPARE(loaded[i]->getCurrent(), saved[i]->getCurrent());
+        QCOMPARE(loaded[i]->getFrame(), saved[i]->getFrame());
+        QCOMPARE(loaded[i]->getAction(), saved[i]->getAction());
+        QCOMPARE(loaded[i]->getAutoContinue(), saved[i]->getAutoContinue());
+        QCOMPARE(loaded[i]->getParam1(), saved[i]->getParam1());
+        QCOMPARE(loaded[i]->getParam2(), saved[i]->getParam2());
+        QCOMPARE(loaded[i]->getParam3(), saved[i]->getParam3());
+        QCOMPARE(loaded[i]->getParam4(), saved[i]->getParam4());
+        QCOMPARE(loaded[i]->getX(), saved[i]->getX());
+        QCOMPARE(loaded[i]->getY(), saved[i]->getY());
+        QCOMPARE(loaded[i]->getZ(), saved[i]->getZ());
+    }
+    QCOMPARE(other.getWaypointManager()->getLocalFrameCount(), uas.getWaypointManager()->getLocalFrameCount());
+}
+
+void WaypointFileTest::asyncLoad_test()
+{
+    UAS uas(mav, WP_FILE_TEST_SYSTEM);
+    createMission(uas.getWaypointManager(), WP_FILE_TEST_COUNT);
+    uas.getWaypointManager()->saveWaypoints(testFile("wpb"));
+
+    UAS other(mav, WP_FILE_TEST_SYSTEM + 1);
+    UASWaypointManager* manager = other.getWaypointManager();
+    createMission(manager, 3);
+    QSignalSpy changed(manager, SIGNAL(waypointListChanged()));
+    QSignalSpy waypointChanged(manager, SIGNAL(waypointChanged(int,Waypoint*)));
+    QSignalSpy loaded(manager, SIGNAL(loadWPFile()));
+
+    manager->loadWaypoints(testFile("wpb"));
+    // A second load while the first one runs is ignored
+    manager->loadWaypoints(testFile("txt"));
+    quint64 start = QGC::groundTimeMilliseconds();
+    while (loaded.count() == 0 && QGC::groundTimeMilliseconds() - start < WP_FILE_TEST_TIMEOUT_MS)
+    {
+        QTest::qWait(5);
+    }
+
+    // The whole list is replaced with one notification
+    QCOMPARE(loaded.count(), 1);
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(waypointChanged.count(), 0);
+    QCOMPARE(manager->getWaypointList().size(), WP_FILE_TEST_COUNT);
+    foreach (Waypoint* wp, manager->getWaypointList())
+    {
+        QVERIFY(wp->thread() == manager->thread());
+    }
+}
+
+void WaypointFileTest::incompatible_test()
+{
+    QFile file(testFile("txt"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("QGC WPL 100\r\n0\t1\t0\t16\t0\t0\t0\t0\t47\t8\t550\t1\r\n");
+    file.close();
+
+    // An incompatible file does not replace the list
+    UAS uas(mav, WP_FILE_TEST_SYSTEM);
+    createMission(uas.getWaypointManager(), 3);
+    uas.getWaypointManager()->loadWaypoints(testFile("txt"), true);
+    QCOMPARE(uas.getWaypointManager()->getWaypointList().size(), 3);
+
+    // Neither does a missing one
+    uas.getWaypointManager()->loadWaypoints(testFile("missing"), true);
+    QCOMPARE(uas.getWaypointManager()->getWaypointList().size(), 3);
+}
+
+void WaypointFileTest::load_benchmark_data()
+{
+    QTest::addColumn<QString>("suffix");
+
+    QTest::newRow("text") << "txt";
+    QTest::newRow("binary") << "wpb";
+}
+
+void WaypointFileTest::load_benchmark()
+{
+    QFETCH(QString, suffix);
+    QString fileName = testFile(suffix);
+
+    UAS uas(mav, WP_FILE_TEST_SYSTEM);
+    UASWaypointManager* manager = uas.getWaypointManager();
+    createMission(manager, WP_FILE_BENCHMARK_COUNT);
+    manager->saveWaypoints(fileName);
+
+    QBENCHMARK
+    {
+        manager->loadWaypoints(fileName, true);
+    }
+    QCOMPARE(manager->getWaypointList().size(), WP_FILE_BENCHMARK_COUNT);
+    qDebug() << "FILE SIZE of" << WP_FILE_BENCHMARK_COUNT << "waypoints (" << suffix << "):" << QFileInfo(fileName).size() << "bytes";
+}
@@ -0,0 +1,38 @@
+#ifndef WAYPOINTFILETEST_H
+#define WAYPOINTFILETEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "MAVLinkProtocol.h"
+#include "UAS.h"
+#include "AutoTest.h"
+
+class WaypointFileTest : public QObject
+{
+    Q_OBJECT
+public:
+    WaypointFileTest();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+    void roundTrip_test_data();
+    void roundTrip_test();
+    void asyncLoad_test();
+    void incompatible_test();
+    void load_benchmark_data();
+    void load_benchmark();
+
+protected:
+    /** @brief Fill the manager with count waypoints of varying frames and commands */
+    void createMission(UASWaypointManager* manager, int count);
+    QString testFile(const QString& suffix);
+
+    MAVLinkProtocol* mav;
+};
+
+DECLARE_TEST(WaypointFileTest)
+
+#endif // WAYPOINTFILETEST_H
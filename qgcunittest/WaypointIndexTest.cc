@@ -0,0 +1,131 @@
+#include <QDir>
+#include <QFile>
+#include "WaypointIndexTest.h"
+#include "UASWaypointManager.h"
+#include "QGC.h"
+
+#define WP_INDEX_TEST_SYSTEM 1
+#define WP_INDEX_TEST_COUNT 60
+#define WP_INDEX_BENCHMARK_COUNT 5000
+
+static MAV_FRAME testFrame(int i)
+{
+    // Uneven mix so the frame lists differ in length
+    static const MAV_FRAME frames[] = { MAV_FRAME_GLOBAL, MAV_FRAME_GLOBAL, MAV_FRAME_LOCAL, MAV_FRAME_MISSION, MAV_FRAME_GLOBAL };
+    return frames[i % 5];
+}
+
+WaypointIndexTest::WaypointIndexTest() :
+    mav(NULL)
+{
+}
+
+void WaypointIndexTest::initTestCase()
+{
+    mav = new MAVLinkProtocol();
+    qsrand(42);
+}
+
+void WaypointIndexTest::cleanupTestCase()
+{
+    delete mav;
+}
+
+bool WaypointIndexTest::verifyIndex(UASWaypointManager* manager)
+{
+    int global = 0;
+    int local = 0;
+    int mission = 0;
+    QVector<Waypoint*> globalList;
+    foreach (Waypoint* wp, manager->getWaypointList())
+    {
+        int expectedGlobal = (wp->getFrame() == MAV_FRAME_GLOBAL) ? global++ : -1;
+        int expectedLocal = (wp->getFrame() == MAV_FRAME_LOCAL) ? local++ : -1;
+        int expectedMission = (wp->getFrame() == MAV_FRAME_MISSION) ? mission++ : -1;
+        if (wp->getFrame() == MAV_FRAME_GLOBAL) globalList.append(wp);
+
+        if (manager->getGlobalFrameIndexOf(wp) != expectedGlobal) return false;
+        if (manager->getLocalFrameIndexOf(wp) != expectedLocal) return false;
+        if (manager->getMissionFrameIndexOf(wp) != expectedMission) return false;
+    }
+    return manager->getGlobalFrameCount() == global
+            && manager->getLocalFrameCount() == local
+            && manager->getMissionFrameCount() == mission
+            && manager->getGlobalFrameWaypointList() == globalList;
+}
+
+void WaypointIndexTest::index_test()
+{
+    UAS uas(mav, WP_INDEX_TEST_SYSTEM);
+    UASWaypointManager* manager = uas.getWaypointManager();
+    QVERIFY(verifyIndex(manager));
+
+    for (int i = 0; i < WP_INDEX_TEST_COUNT; i++)
+    {
+        manager->addWaypoint(new Waypoint(0, 47.376 + i * 0.0001, 8.548, 550 + i, 0, 0, 0, 0, true, false, testFrame(i)));
+    }
+    QVERIFY(verifyIndex(manager));
+    QCOMPARE(manager->getLocalFrameCount(), WP_INDEX_TEST_COUNT / 5);
+
+    // Moves in both directions, across and within frames
+    manager->moveWaypoint(0, 17);
+    QVERIFY(verifyIndex(manager));
+    manager->moveWaypoint(40, 3);
+    QVERIFY(verifyIndex(manager));
+    manager->moveWaypoint(10, 11);
+    QVERIFY(verifyIndex(manager));
+    for (int i = 0; i < 200; i++)
+    {
+        manager->moveWaypoint(qrand() % manager->getWaypointList().size(), qrand() % manager->getWaypointList().size());
+    }
+    QVERIFY(verifyIndex(manager));
+
+    manager->removeWaypoint(0);
+    manager->removeWaypoint(25);
+    manager->removeWaypoint(manager->getWaypointList().size() - 1);
+    QVERIFY(verifyIndex(manager));
+
+    // Changing the frame moves a waypoint to another frame list
+    manager->getWaypointList().at(5)->setFrame(MAV_FRAME_LOCAL);
+    manager->getWaypointList().at(6)->setFrame(MAV_FRAME_MISSION);
+    QVERIFY(verifyIndex(manager));
+
+    // A waypoint not in the list has no index
+    Waypoint other;
+    QCOMPARE(manager->getGlobalFrameIndexOf(&other), -1);
+
+    while (manager->getWaypointList().size() > 0) manager->removeWaypoint(0);
+    QVERIFY(verifyIndex(manager));
+}
+
+void WaypointIndexTest::load_benchmark()
+{
+    QString fileName = QDir::tempPath() + QString("/qgc-waypoint-index-test-%1.txt").arg(QCoreApplication::applicationPid());
+
+    UAS uas(mav, WP_INDEX_TEST_SYSTEM);
+    UASWaypointManager* manager = uas.getWaypointManager();
+    for (int i = 0; i < WP_INDEX_BENCHMARK_COUNT; i++)
+    {
+        manager->addWaypoint(new Waypoint(0, 47.376 + i * 0.0001, 8.548, 550 + i, 0, 0, 0, 0, true, false, testFrame(i)));
+    }
+    manager->saveWaypoints(fileName);
+
+    // Loading and one redraw of a map view, which asks for
+    // the index of every waypoint and the count of its frame
+    quint64 start = QGC::groundTimeMilliseconds();
+    int sum = 0;
+    QBENCHMARK
+    {
+        manager->loadWaypoints(fileName, true);
+        foreach (Waypoint* wp, manager->getWaypointList())
+        {
+            sum += manager->getGlobalFrameIndexOf(wp) + manager->getGlobalFrameCount();
+        }
+    }
+    qDebug() << "LOAD AND QUERY of" << WP_INDEX_BENCHMARK_COUNT << "waypoints:" << QGC::groundTimeMilliseconds() - start << "ms in total";
+    QFile::remove(fileName);
+
+    QCOMPARE(manager->getWaypointList().size(), WP_INDEX_BENCHMARK_COUNT);
+    QVERIFY(sum != 0);
+    QVERIFY(verifyIndex(manager));
+}
@@ -0,0 +1,32 @@
+#ifndef WAYPOINTINDEXTEST_H
+#define WAYPOINTINDEXTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "MAVLinkProtocol.h"
+#include "UAS.h"
+#include "AutoTest.h"
+
+class WaypointIndexTest : public QObject
+{
+    Q_OBJECT
+public:
+    WaypointIndexTest();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void index_test();
+    void load_benchmark();
+
+protected:
+    /** @brief Compare the per-frame queries with a linear scan of the list */
+    bool verifyIndex(UASWaypointManager* manager);
+
+    MAVLinkProtocol* mav;
+};
+
+DECLARE_TEST(WaypointIndexTest)
+
+#endif // WAYPOINTINDEXTEST_H
@@ -0,0 +1,325 @@
+#include "WaypointTransferTest.h"
+#include "UASWaypointManager.h"
+#include "QGC.h"
+
+#define WP_TEST_SYSTEM 1
+#define WP_TEST_COUNT 50
+#define WP_TEST_TIMEOUT_MS 120000
+
+BenchmarkWaypointPlanner::BenchmarkWaypointPlanner(MAVLinkSimulationLink* link, int sysid, int count) :
+    MAVLinkSimulationWaypointPlanner(link, sysid)
+{
+    verbose = false;
+
+    for (int i = 0; i < count; i++)
+    {
+        mavlink_waypoint_t* wp = new mavlink_waypoint_t;
+        memset(wp, 0, sizeof(mavlink_waypoint_t));
+        wp->seq = i;
+        wp->frame = MAV_FRAME_GLOBAL;
+        wp->command = MAV_CMD_NAV_WAYPOINT;
+        wp->autocontinue = 1;
+        wp->current = (i == 0);
+        wp->x = 47.376 + i * 0.0001;
+        wp->y = 8.548;
+        wp->z = 550 + i;
+        waypoints->push_back(wp);
+    }
+}
+
+BenchmarkWaypointPlanner::~BenchmarkWaypointPlanner()
+{
+    for (unsigned int i = 0; i < waypoints->size(); i++)
+    {
+        delete waypoints->at(i);
+    }
+}
+
+PartialUpdatePlanner::PartialUpdatePlanner(MAVLinkSimulationLink* link, int sysid, int count) :
+    BenchmarkWaypointPlanner(link, sysid, count),
+    updates(0)
+{
+    // Look at every message before the planner does, which leaves
+    // the idle state with the last waypoint of a list transaction
+    disconnect(link, SIGNAL(messageReceived(mavlink_message_t)), this, SLOT(handleMessage(mavlink_message_t)));
+    connect(link, SIGNAL(messageReceived(mavlink_message_t)), this, SLOT(updateInPlace(mavlink_message_t)));
+    connect(link, SIGNAL(messageReceived(mavlink_message_t)), this, SLOT(handleMessage(mavlink_message_t)));
+}
+
+void PartialUpdatePlanner::updateInPlace(const mavlink_message_t& msg)
+{
+    if (msg.msgid != MAVLINK_MSG_ID_WAYPOINT || current_state != PX_WPP_IDLE) return;
+
+    mavlink_waypoint_t wp;
+    mavlink_msg_waypoint_decode(&msg, &wp);
+    if (wp.target_system != systemid || wp.target_component != compid) return;
+
+    if (wp.seq < waypoints->size())
+    {
+        // The active waypoint only changes through WAYPOINT_SET_CURRENT
+        mavlink_waypoint_t* stored = waypoints->at(wp.seq);
+        uint8_t current = stored->current;
+        memcpy(stored, &wp, sizeof(mavlink_waypoint_t));
+        stored->current = current;
+        updates++;
+        send_waypoint_ack(msg.sysid, msg.compid, 0);
+    }
+    else
+    {
+        send_waypoint_ack(msg.sysid, msg.compid, 1);
+    }
+}
+
+ImpairedSimulationLink::ImpairedSimulationLink(int latency, int dropReply) :
+    latency(latency),
+    dropReply(dropReply),
+    replies(0),
+    uas(NULL)
+{
+    _isConnected = true;
+    connect(this, SIGNAL(bytesReceived(LinkInterface*,QByteArray)), this, SLOT(queueReply(LinkInterface*,QByteArray)));
+    connect(&timer, SIGNAL(timeout()), this, SLOT(deliver()));
+    timer.start(1);
+}
+
+void ImpairedSimulationLink::writeBytes(const char* data, qint64 size)
+{
+    // Every write of the groundstation is one packet
+    toVehicle.append(DelayedPacket(QGC::groundTimeMilliseconds() + latency, QByteArray(data, size)));
+}
+
+void ImpairedSimulationLink::queueReply(LinkInterface* link, QByteArray data)
+{
+    Q_UNUSED(link);
+    if (data.isEmpty() || replies++ == dropReply) return;
+    toGroundstation.append(DelayedPacket(QGC::groundTimeMilliseconds() + latency, data));
+}
+
+void ImpairedSimulationLink::deliver()
+{
+    quint64 now = QGC::groundTimeMilliseconds();
+    while (!toVehicle.isEmpty() && toVehicle.first().first <= now)
+    {
+        QByteArray packet = toVehicle.takeFirst().second;
+        MAVLinkSimulationLink::writeBytes(packet.constData(), packet.size());
+        // Collect the planner's answer to this packet as one reply
+        readBytes();
+    }
+    while (!toGroundstation.isEmpty() && toGroundstation.first().first <= now)
+    {
+        QByteArray packet = toGroundstation.takeFirst().second;
+        mavlink_message_t msg;
+        mavlink_status_t status;
+        for (int i = 0; i < packet.size(); i++)
+        {
+            if (mavlink_parse_char(getId(), (uint8_t)packet.at(i), &msg, &status) && uas)
+            {
+                uas->receiveMessage(this, msg);
+            }
+        }
+    }
+}
+
+WaypointTransferTest::WaypointTransferTest() :
+    finished(false)
+{
+}
+
+void WaypointTransferTest::initTestCase()
+{
+    mav = new MAVLinkProtocol();
+}
+
+void WaypointTransferTest::cleanupTestCase()
+{
+    delete mav;
+}
+
+void WaypointTransferTest::transferFinished(bool reading)
+{
+    if (!reading) finished = true;
+}
+
+qint64 WaypointTransferTest::download(int count, int latency, bool windowed)
+{
+    // Declared in this order so the link outlives the system and the planner
+    ImpairedSimulationLink link(latency);
+    UAS uas(mav, WP_TEST_SYSTEM);
+    BenchmarkWaypointPlanner planner(&link, WP_TEST_SYSTEM, count);
+    link.setUAS(&uas);
+    uas.addLink(&link);
+
+    UASWaypointManager* manager = uas.getWaypointManager();
+    manager->setTransferWindowEnabled(windowed);
+    connect(manager, SIGNAL(readGlobalWPFromUAS(bool)), this, SLOT(transferFinished(bool)));
+
+    finished = false;
+    manager->readWaypoints();
+    quint64 start = QGC::groundTimeMilliseconds();
+    while (!finished && QGC::groundTimeMilliseconds() - start < WP_TEST_TIMEOUT_MS)
+    {
+        QTest::qWait(5);
+    }
+
+    if (!finished || manager->getWaypointList().size() != count) return -1;
+    for (int i = 0; i < count; i++)
+    {
+        // Order and content must survive reordering and gaps
+        if (manager->getWaypointList().at(i)->getId() != (quint16)i) return -1;
+        if (manager->getWaypointList().at(i)->getZ() != 550 + i) return -1;
+    }
+    qDebug() << (windowed ? "WINDOWED" : "STOP-AND-WAIT") << "download of" << count << "waypoints, latency" << latency
+             << "ms:" << manager->getLastTransferTime() << "ms, window" << manager->getTransferWindow()
+             << ", RTT" << manager->getRoundTripTime() << "ms, resent" << manager->getLastTransferRetransmissions();
+    return manager->getLastTransferTime();
+}
+
+void WaypointTransferTest::stopAndWait_test()
+{
+    QVERIFY(download(WP_TEST_COUNT, 20, false) >= 0);
+
+    // The setting is stored per system
+    UAS uas(mav, WP_TEST_SYSTEM);
+    QVERIFY(!uas.getWaypointManager()->getTransferWindowEnabled());
+    uas.getWaypointManager()->setTransferWindowEnabled(true);
+    UAS again(mav, WP_TEST_SYSTEM);
+    QVERIFY(again.getWaypointManager()->getTransferWindowEnabled());
+}
+
+void WaypointTransferTest::windowed_test()
+{
+    // Requests in order are answered by a vehicle which only takes the next one
+    QVERIFY(download(WP_TEST_COUNT, 20, true) >= 0);
+}
+
+void WaypointTransferTest::windowFallback_test()
+{
+    ImpairedSimulationLink link(20, 6);
+    UAS uas(mav, WP_TEST_SYSTEM);
+    BenchmarkWaypointPlanner planner(&link, WP_TEST_SYSTEM, WP_TEST_COUNT);
+    link.setUAS(&uas);
+    uas.addLink(&link);
+
+    UASWaypointManager* manager = uas.getWaypointManager();
+    manager->setTransferWindowEnabled(true);
+    connect(manager, SIGNAL(readGlobalWPFromUAS(bool)), this, SLOT(transferFinished(bool)));
+
+    // The answer after the count carries waypoint 5. Once it is lost the planner
+    // is ahead and ignores the request for it, the download starts over
+    finished = false;
+    manager->readWaypoints();
+    quint64 start = QGC::groundTimeMilliseconds();
+    while (!finished && QGC::groundTimeMilliseconds() - start < WP_TEST_TIMEOUT_MS) QTest::qWait(5);
+
+    QVERIFY(finished);
+    QVERIFY(manager->getTransferWindowIgnored());
+    QCOMPARE(manager->getWaypointList().size(), WP_TEST_COUNT);
+    for (int i = 0; i < WP_TEST_COUNT; i++)
+    {
+        QCOMPARE(manager->getWaypointList().at(i)->getId(), (quint16)i);
+        QCOMPARE(manager->getWaypointList().at(i)->getZ(), 550.0 + i);
+    }
+    qDebug() << "FALLBACK download of" << WP_TEST_COUNT << "waypoints:" << manager->getLastTransferTime() << "ms";
+}
+
+void WaypointTransferTest::deltaUpload_test()
+{
+    ImpairedSimulationLink link(20);
+    UAS uas(mav, WP_TEST_SYSTEM);
+    PartialUpdatePlanner planner(&link, WP_TEST_SYSTEM, WP_TEST_COUNT);
+    link.setUAS(&uas);
+    uas.addLink(&link);
+
+    UASWaypointManager* manager = uas.getWaypointManager();
+    manager->setDeltaUploadEnabled(true);
+    connect(manager, SIGNAL(readGlobalWPFromUAS(bool)), this, SLOT(transferFinished(bool)));
+    finished = false;
+    manager->readWaypoints();
+    for (int i = 0; i < WP_TEST_TIMEOUT_MS / 5 && !finished; i++) QTest::qWait(5);
+    QVERIFY(finished);
+
+    // The downloaded mission is what is on the vehicle, nothing to send
+    manager->writeWaypoints();
+    QCOMPARE(manager->getLastUploadSize(), 0);
+
+    // Swapping two waypoints changes the order, the whole list is sent
+    manager->moveWaypoint(3, 4);
+    quint64 start = QGC::groundTimeMilliseconds();
+    manager->writeWaypoints();
+    QCOMPARE(manager->getLastUploadSize(), WP_TEST_COUNT);
+    while (planner.getStoredZ(3) != 554 && QGC::groundTimeMilliseconds() - start < WP_TEST_TIMEOUT_MS) QTest::qWait(5);
+    QCOMPARE(planner.getStoredZ(3), 554.0f);
+    QCOMPARE(planner.updates, 0);
+    // Wait for the acknowledgement, afterwards the vehicle mission matches again
+    QTest::qWait(200);
+
+    // Moving one waypoint sends only that one
+    manager->getWaypointList().at(10)->setZ(1000);
+    start = QGC::groundTimeMilliseconds();
+    manager->writeWaypoints();
+    QCOMPARE(manager->getLastUploadSize(), 1);
+    while (planner.getStoredZ(10) != 1000 && QGC::groundTimeMilliseconds() - start < WP_TEST_TIMEOUT_MS) QTest::qWait(5);
+    QCOMPARE(planner.getStoredZ(10), 1000.0f);
+    QCOMPARE(planner.getStoredZ(11), 561.0f);
+    QCOMPARE(planner.updates, 1);
+    qDebug() << "DELTA UPLOAD of 1 of" << WP_TEST_COUNT << "waypoints:" << QGC::groundTimeMilliseconds() - start << "ms";
+
+    QTest::qWait(200);
+    manager->writeWaypoints();
+    QCOMPARE(manager->getLastUploadSize(), 0);
+    QVERIFY(manager->getDeltaUploadEnabled());
+}
+
+void WaypointTransferTest::deltaFallback_test()
+{
+    ImpairedSimulationLink link(20);
+    UAS uas(mav, WP_TEST_SYSTEM);
+    BenchmarkWaypointPlanner planner(&link, WP_TEST_SYSTEM, WP_TEST_COUNT);
+    link.setUAS(&uas);
+    uas.addLink(&link);
+
+    UASWaypointManager* manager = uas.getWaypointManager();
+    manager->setDeltaUploadEnabled(true);
+    connect(manager, SIGNAL(readGlobalWPFromUAS(bool)), this, SLOT(transferFinished(bool)));
+    finished = false;
+    manager->readWaypoints();
+    for (int i = 0; i < WP_TEST_TIMEOUT_MS / 5 && !finished; i++) QTest::qWait(5);
+    QVERIFY(finished);
+
+    // The planner ignores a waypoint outside of a list transaction,
+    // after the timeout the whole list is sent
+    manager->getWaypointList().at(10)->setZ(1000);
+    quint64 start = QGC::groundTimeMilliseconds();
+    manager->writeWaypoints();
+    QCOMPARE(manager->getLastUploadSize(), 1);
+    while (planner.getStoredZ(10) != 1000 && QGC::groundTimeMilliseconds() - start < WP_TEST_TIMEOUT_MS) QTest::qWait(5);
+    QCOMPARE(planner.getStoredZ(10), 1000.0f);
+    QCOMPARE(planner.getStoredZ(11), 561.0f);
+    QCOMPARE(manager->getLastUploadSize(), WP_TEST_COUNT);
+    qDebug() << "FALLBACK UPLOAD of" << WP_TEST_COUNT << "waypoints:" << QGC::groundTimeMilliseconds() - start << "ms";
+
+    // The failure is remembered for this system
+    QVERIFY(!manager->getDeltaUploadEnabled());
+    UAS again(mav, WP_TEST_SYSTEM);
+    QVERIFY(!again.getWaypointManager()->getDeltaUploadEnabled());
+}
+
+void WaypointTransferTest::transfer_benchmark_data()
+{
+    QTest::addColumn<int>("latency");
+
+    QTest::newRow("no latency") << 0;
+    QTest::newRow("100 ms RTT") << 50;
+    QTest::newRow("200 ms RTT") << 100;
+}
+
+void WaypointTransferTest::transfer_benchmark()
+{
+    QFETCH(int, latency);
+
+    qint64 stopAndWait = download(WP_TEST_COUNT, latency, false);
+    qint64 windowed = download(WP_TEST_COUNT, latency, true);
+    QVERIFY(stopAndWait >= 0);
+    QVERIFY(windowed >= 0);
+    qDebug() << "SPEEDUP:" << (double)stopAndWait / qMax(windowed, (qint64)1);
+}
@@ -0,0 +1,108 @@
+#ifndef WAYPOINTTRANSFERTEST_H
+#define WAYPOINTTRANSFERTEST_H
+
+#include <QObject>
+#include <QTimer>
+#include <QList>
+#include <QPair>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include "MAVLinkSimulationLink.h"
+#include "MAVLinkSimulationWaypointPlanner.h"
+#include "MAVLinkProtocol.h"
+#include "UAS.h"
+#include "AutoTest.h"
+
+/**
+ * @brief The simulator's waypoint planner, preloaded with a mission
+ *
+ * Like the onboard planner it only answers requests for the waypoint
+ * it sent last or the next one.
+ */
+class BenchmarkWaypointPlanner : public MAVLinkSimulationWaypointPlanner
+{
+public:
+    BenchmarkWaypointPlanner(MAVLinkSimulationLink* link, int sysid, int count);
+    ~BenchmarkWaypointPlanner();
+    /** @brief Altitude of a waypoint as stored on the vehicle */
+    float getStoredZ(int seq) { return waypoints->at(seq)->z; }
+};
+
+/**
+ * @brief Planner which also replaces a single waypoint sent outside of a list transaction
+ */
+class PartialUpdatePlanner : public BenchmarkWaypointPlanner
+{
+    Q_OBJECT
+public:
+    PartialUpdatePlanner(MAVLinkSimulationLink* link, int sysid, int count);
+    int updates;    ///< Number of waypoints replaced in place
+
+public slots:
+    void updateInPlace(const mavlink_message_t& msg);
+};
+
+/**
+ * @brief Simulation link with latency which can lose one of the planner's answers
+ *
+ * The link is never connected in the simulator sense, no simulated MAV
+ * is running. Packets written by the groundstation are handed to the
+ * planner after the latency, its answers travel back the same way.
+ */
+class ImpairedSimulationLink : public MAVLinkSimulationLink
+{
+    Q_OBJECT
+public:
+    ImpairedSimulationLink(int latency, int dropReply=-1);
+    /** @brief Set the system receiving the planner's answers */
+    void setUAS(UAS* uas) { this->uas = uas; }
+    void writeBytes(const char* data, qint64 size);
+
+public slots:
+    /** @brief Deliver all packets whose latency has passed */
+    void deliver();
+    /** @brief Queue the planner's answers for delivery to the groundstation */
+    void queueReply(LinkInterface* link, QByteArray data);
+
+protected:
+    typedef QPair<quint64, QByteArray> DelayedPacket;
+    QList<DelayedPacket> toVehicle;
+    QList<DelayedPacket> toGroundstation;
+    int latency;    ///< One way latency in milliseconds
+    int dropReply;  ///< Number of the planner's answer to lose, -1 for none
+    int replies;    ///< Number of answers the planner sent
+    UAS* uas;
+    QTimer timer;
+};
+
+class WaypointTransferTest : public QObject
+{
+    Q_OBJECT
+public:
+    WaypointTransferTest();
+
+public slots:
+    void transferFinished(bool reading);
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void stopAndWait_test();
+    void windowed_test();
+    void windowFallback_test();
+    void deltaUpload_test();
+    void deltaFallback_test();
+    void transfer_benchmark_data();
+    void transfer_benchmark();
+
+protected:
+    /** @brief Download count waypoints, returns the transfer time in milliseconds or -1 on failure */
+    qint64 download(int count, int latency, bool windowed);
+
+    MAVLinkProtocol* mav;
+    bool finished;
+};
+
+DECLARE_TEST(WaypointTransferTest)
+
+#endif // WAYPOINTTRANSFERTEST_H
@@ -0,0 +1,61 @@
+/**
+ * @brief Entry point of the offscreen rendering benchmark
+ *
+ * Unlike the unit tests the instruments need an application object. The
+ * raster graphics system keeps the measurement independent of the GPU and
+ * its driver.
+ */
+
+#include <cstdlib>
+#include <QApplication>
+#include "AutoTest.h"
+
+// The benchmark counts the heap allocations per rendered frame by wrapping
+// the allocator of glibc, operator new ends up in malloc() as well. The
+// wrappers replace malloc() for the whole process, so they live in the main
+// file of qgcbenchmark and neither the application nor the unit tests get them.
+#if defined(QGC_COUNT_ALLOCATIONS) && defined(__GLIBC__)
+static volatile quint64 allocations = 0;
+
+quint64 benchmarkAllocations()
+{
+    return allocations;
+}
+
+extern "C"
+{
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size)
+{
+    __sync_fetch_and_add(&allocations, 1);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    __sync_fetch_and_add(&allocations, 1);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    __sync_fetch_and_add(&allocations, 1);
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    QApplication::setGraphicsSystem("raster");
+    QApplication app(argc, argv);
+
+    // Keep the gauge settings of the benchmark apart from the user's
+    app.setOrganizationName("QGroundControl");
+    app.setApplicationName("qgcbenchmark");
+
+    return AutoTest::run(argc, argv);
+}
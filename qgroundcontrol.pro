@@ -158,6 +158,8 @@ FORMS += src/ui/MainWindow.ui \
     src/ui/QGCWaypointListMulti.ui \
     src/ui/mission/QGCCustomWaypointAction.ui \
     src/ui/QGCUDPLinkConfiguration.ui \
+    src/ui/QGCTCPLinkConfiguration.ui \
+    src/ui/QGCLoadGeneratorLinkConfiguration.ui \
     src/ui/QGCSettingsWidget.ui \
     src/ui/mission/QGCMissionDoWidget.ui \
     src/ui/mission/QGCMissionConditionWidget.ui
@@ -207,6 +209,8 @@ HEADERS += src/MG.h \
     src/ui/CameraView.h \
     src/comm/MAVLinkSimulationLink.h \
     src/comm/UDPLink.h \
+    src/comm/TCPLink.h \
+    src/comm/MAVLinkLoadGeneratorLink.h \
     src/ui/ParameterInterface.h \
     src/ui/WaypointList.h \
     src/Waypoint.h \
@@ -273,10 +277,21 @@ HEADERS += src/MG.h \
     src/uas/QGCMAVLinkUASFactory.h \
     src/ui/QGCWaypointListMulti.h \
     src/ui/QGCUDPLinkConfiguration.h \
+    src/ui/QGCTCPLinkConfiguration.h \
+    src/ui/QGCLoadGeneratorLinkConfiguration.h \
     src/ui/QGCSettingsWidget.h \
     src/ui/mission/QGCMissionDoWidget.h \
     src/ui/mission/QGCMissionConditionWidget.h \
-    src/uas/QGCUASParamManager.h
+    src/uas/QGCUASParamManager.h \
+    src/uas/QGCUASParamCache.h \
+    src/uas/QGCUASParamTransfer.h \
+    src/uas/WaypointFileLoader.h \
+    src/uas/QGCUASImageTransfer.h \
+    src/uas/QGCHeartbeatSupervisor.h \
+    src/ui/QGCRawVideoBuffer.h \
+    src/ui/QGCFrameScheduler.h \
+    src/ui/QGCLabelCache.h \
+    src/ui/QGCGeometry.h
 
 # Google Earth is only supported on Mac OS and Windows with Visual Studio Compiler
 macx|win32-msvc2008: {
@@ -339,6 +354,8 @@ SOURCES += src/main.cc \
     src/ui/CameraView.cc \
     src/comm/MAVLinkSimulationLink.cc \
     src/comm/UDPLink.cc \
+    src/comm/TCPLink.cc \
+    src/comm/MAVLinkLoadGeneratorLink.cc \
     src/ui/ParameterInterface.cc \
     src/ui/WaypointList.cc \
     src/Waypoint.cc \
@@ -404,10 +421,21 @@ SOURCES += src/main.cc \
     src/uas/QGCMAVLinkUASFactory.cc \
     src/ui/QGCWaypointListMulti.cc \
     src/ui/QGCUDPLinkConfiguration.cc \
+    src/ui/QGCTCPLinkConfiguration.cc \
+    src/ui/QGCLoadGeneratorLinkConfiguration.cc \
     src/ui/QGCSettingsWidget.cc \
     src/ui/mission/QGCMissionDoWidget.cc \
     src/ui/mission/QGCMissionConditionWidget.cc \
-    src/uas/QGCUASParamManager.cc
+    src/uas/QGCUASParamManager.cc \
+    src/uas/QGCUASParamCache.cc \
+    src/uas/QGCUASParamTransfer.cc \
+    src/uas/WaypointFileLoader.cc \
+    src/uas/QGCUASImageTransfer.cc \
+    src/uas/QGCHeartbeatSupervisor.cc \
+    src/ui/QGCRawVideoBuffer.cc \
+    src/ui/QGCFrameScheduler.cc \
+    src/ui/QGCLabelCache.cc \
+    src/ui/QGCGeometry.cc
 
 macx|win32-msvc2008: {
     SOURCES += src/ui/map3D/QGCGoogleEarthView.cc
@@ -446,6 +474,25 @@ contains(DEPENDENCIES_PRESENT, libfreenect) {
     # Enable only if libfreenect is available
     SOURCES += src/input/Freenect.cc
 }
+# TCPLink sets socket buffer sizes through the native socket API
+win32: {
+    LIBS += -lws2_32
+}
+
+# Shared memory link for co-located simulators (POSIX shared memory)
+unix: {
+    HEADERS += src/comm/SharedMemoryLink.h \
+        src/comm/QGCShmRing.h \
+        src/ui/QGCSharedMemoryLinkConfiguration.h
+    SOURCES += src/comm/SharedMemoryLink.cc \
+        src/ui/QGCSharedMemoryLinkConfiguration.cc
+    FORMS += src/ui/QGCSharedMemoryLinkConfiguration.ui
+    DEFINES += QGC_SHM_LINK
+    linux-g++|linux-g++-64: {
+        LIBS += -lrt
+    }
+}
+
 RESOURCES += mavground.qrc
 
 # Include RT-LAB Library
@@ -92,6 +92,35 @@ bool Waypoint::load(QTextStream &loadStream)
     return false;
 }
 
+void Waypoint::save(QDataStream &saveStream)
+{
+    // Same fields as the text format, without the index
+    saveStream << (quint8)current << (quint8)frame << (quint16)action << (quint8)autocontinue
+               << param1 << param2 << orbit << yaw << x << y << z;
+}
+
+bool Waypoint::load(QDataStream &loadStream)
+{
+    quint8 wpCurrent, wpFrame, wpAutocontinue;
+    quint16 wpAction;
+    double p1, p2, p3, p4, wpX, wpY, wpZ;
+    loadStream >> wpCurrent >> wpFrame >> wpAction >> wpAutocontinue >> p1 >> p2 >> p3 >> p4 >> wpX >> wpY >> wpZ;
+    if (loadStream.status() != QDataStream::Ok) return false;
+
+    this->current = (wpCurrent == 1);
+    this->frame = (MAV_FRAME) wpFrame;
+    this->action = (MAV_CMD) wpAction;
+    this->autocontinue = (wpAutocontinue == 1);
+    this->param1 = p1;
+    this->param2 = p2;
+    this->orbit = p3;
+    this->yaw = p4;
+    this->x = wpX;
+    this->y = wpY;
+    this->z = wpZ;
+    return true;
+}
+
 
 void Waypoint::setId(quint16 id)
 {
@@ -36,6 +36,7 @@ This file is part of the PIXHAWK project
 #include <QObject>
 #include <QString>
 #include <QTextStream>
+#include <QDataStream>
 #include "QGCMAVLink.h"
 
 class Waypoint : public QObject
@@ -74,6 +75,8 @@ public:
 
     void save(QTextStream &saveStream);
     bool load(QTextStream &loadStream);
+    void save(QDataStream &saveStream);     ///< Writes the binary record, the id is implied by the position in the file
+    bool load(QDataStream &loadStream);
 
 
 protected:
@@ -91,13 +91,34 @@ void LinkManager::addProtocol(LinkInterface* link, ProtocolInterface* protocol)
         connect(link, SIGNAL(bytesReceived(LinkInterface*, QByteArray)), protocol, SLOT(receiveBytes(LinkInterface*, QByteArray)));
         // Store the connection information in the protocol links map
         protocolLinks.insertMulti(protocol, link);
+        updateProtocolLinkSnapshots();
     }
     //qDebug() << __FILE__ << __LINE__ << "ADDED LINK TO PROTOCOL" << link->getName() << protocol->getName() << "NEW SIZE OF LINK LIST:" << protocolLinks.size();
 }
 
 QList<LinkInterface*> LinkManager::getLinksForProtocol(ProtocolInterface* protocol)
 {
-    return protocolLinks.values(protocol);
+    // Only the reference count of the shared list is touched here,
+    // the lock is held for a pointer copy and never allocates.
+    QMutexLocker locker(&snapshotMutex);
+    return protocolLinkSnapshots.value(protocol);
+}
+
+/**
+ * Builds a fresh set of link lists and swaps it in as a whole. Readers which
+ * still hold a copy of an old list keep iterating it undisturbed, it is freed
+ * once the last of them releases it.
+ */
+void LinkManager::updateProtocolLinkSnapshots()
+{
+    QHash<ProtocolInterface*, QList<LinkInterface*> > snapshots;
+    foreach (ProtocolInterface* protocol, protocolLinks.uniqueKeys())
+    {
+        snapshots.insert(protocol, protocolLinks.values(protocol));
+    }
+
+    QMutexLocker locker(&snapshotMutex);
+    protocolLinkSnapshots = snapshots;
 }
 
 
@@ -142,10 +163,15 @@ bool LinkManager::disconnectLink(LinkInterface* link)
 
 void LinkManager::removeLink(QObject* link)
 {
-    LinkInterface* linkInterface = dynamic_cast<LinkInterface*>(link);
-    if (linkInterface)
+    // Called from destroyed(), the object is no LinkInterface
+    // anymore and can only be found by its address
+    foreach (LinkInterface* linkInterface, links)
     {
-        removeLink(linkInterface);
+        if (static_cast<QObject*>(linkInterface) == link)
+        {
+            removeLink(linkInterface);
+            break;
+        }
     }
 }
 
@@ -166,6 +192,7 @@ bool LinkManager::removeLink(LinkInterface* link)
             {
                 protocolLinks.remove(proto, link);
             }
+            if (!protocols.isEmpty()) updateProtocolLinkSnapshots();
             return true;
         }
         return false;
@@ -35,6 +35,8 @@ This file is part of the PIXHAWK project
 #include <QThread>
 #include <QList>
 #include <QMultiMap>
+#include <QHash>
+#include <QMutex>
 #include <LinkInterface.h>
 #include <ProtocolInterface.h>
 
@@ -54,6 +56,14 @@ public:
 
     void run();
 
+    /**
+     * @brief Get the links attached to a protocol
+     *
+     * Returns an implicitly shared snapshot which is only rebuilt when links
+     * are added or removed. Copying it is a reference count increment, so this
+     * is safe to call on every sent packet from any thread. Iterate it with
+     * const iterators or foreach to avoid detaching.
+     */
     QList<LinkInterface*> getLinksForProtocol(ProtocolInterface* protocol);
 
     /** @brief Get the link for this id */
@@ -83,6 +93,11 @@ protected:
     LinkManager();
     QList<LinkInterface*> links;
     QMultiMap<ProtocolInterface*,LinkInterface*> protocolLinks;
+    QHash<ProtocolInterface*, QList<LinkInterface*> > protocolLinkSnapshots; ///< Immutable per-protocol link lists, rebuilt on change
+    QMutex snapshotMutex;   ///< Protects swapping of protocolLinkSnapshots
+
+    /** @brief Rebuild the per-protocol link snapshots from protocolLinks */
+    void updateProtocolLinkSnapshots();
 
 private:
     static LinkManager* _instance;
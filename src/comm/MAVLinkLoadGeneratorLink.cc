@@ -0,0 +1,440 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the MAVLink load generator link
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#include <cstring>
+#include <QDebug>
+#include "MAVLinkLoadGeneratorLink.h"
+#include "LinkManager.h"
+#include "QGC.h"
+
+MAVLinkLoadGeneratorLink::MAVLinkLoadGeneratorLink(int rate, int systems, quint32 seed, QObject* parent) :
+    LinkInterface(parent),
+    connectState(false),
+    rate(qBound((int)minRate, rate, (int)maxRate)),
+    systemCount(qBound(1, systems, (int)maxSystems)),
+    seed(seed),
+    dataGenerated(0),
+    nextHeartbeat(0),
+    messagesGenerated(0),
+    achievedRate(0),
+    bitsReceivedTotal(0),
+    connectionStartTime(0)
+{
+    // Default mix, roughly what an autopilot streams
+    messageMix.insert(MAVLINK_MSG_ID_ATTITUDE, 10);
+    messageMix.insert(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, 5);
+    messageMix.insert(MAVLINK_MSG_ID_VFR_HUD, 4);
+    messageMix.insert(MAVLINK_MSG_ID_RAW_PRESSURE, 4);
+    messageMix.insert(MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, 2);
+    messageMix.insert(MAVLINK_MSG_ID_SYS_STATUS, 1);
+    updateMixTable();
+    reset();
+
+    this->id = getNextLinkId();
+    updateName();
+    LinkManager::instance()->add(this);
+}
+
+MAVLinkLoadGeneratorLink::~MAVLinkLoadGeneratorLink()
+{
+    disconnect();
+}
+
+void MAVLinkLoadGeneratorLink::reset()
+{
+    randomState = seed ? seed : 1; // xorshift must not start at zero
+    txSeq.fill(0, systemCount + 1);
+    dataGenerated = 0;
+    nextHeartbeat = 0;
+    messagesGenerated = 0;
+}
+
+quint32 MAVLinkLoadGeneratorLink::nextRandom()
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+void MAVLinkLoadGeneratorLink::setRate(int rate)
+{
+    this->rate = qBound((int)minRate, rate, (int)maxRate);
+    updateName();
+}
+
+void MAVLinkLoadGeneratorLink::setSystemCount(int systems)
+{
+    bool reconnect = connectState;
+    if (reconnect) disconnect();
+    systemCount = qBound(1, systems, (int)maxSystems);
+    reset();
+    updateName();
+    if (reconnect) connect();
+}
+
+void MAVLinkLoadGeneratorLink::setSeed(int seed)
+{
+    bool reconnect = connectState;
+    if (reconnect) disconnect();
+    this->seed = seed;
+    reset();
+    if (reconnect) connect();
+}
+
+bool MAVLinkLoadGeneratorLink::isSupportedMessage(int msgid)
+{
+    switch (msgid)
+    {
+    case MAVLINK_MSG_ID_ATTITUDE:
+    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+    case MAVLINK_MSG_ID_VFR_HUD:
+    case MAVLINK_MSG_ID_RAW_PRESSURE:
+    case MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT:
+    case MAVLINK_MSG_ID_SYS_STATUS:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool MAVLinkLoadGeneratorLink::setMessageMix(const QMap<int, int>& mix)
+{
+    foreach (int msgid, mix.keys())
+    {
+        if (!isSupportedMessage(msgid))
+        {
+            qWarning() << "Load generator can not generate message" << msgid << ", keeping the previous mix";
+            return false;
+        }
+    }
+
+    bool reconnect = connectState;
+    if (reconnect) disconnect();
+    messageMix = mix;
+    updateMixTable();
+    if (reconnect) connect();
+    return true;
+}
+
+void MAVLinkLoadGeneratorLink::updateMixTable()
+{
+    mixTable.clear();
+    QMap<int, int>::const_iterator i;
+    for (i = messageMix.constBegin(); i != messageMix.constEnd(); ++i)
+    {
+        for (int w = 0; w < i.value(); w++)
+        {
+            mixTable.append(i.key());
+        }
+    }
+    if (mixTable.isEmpty()) mixTable.append(MAVLINK_MSG_ID_ATTITUDE);
+}
+
+void MAVLinkLoadGeneratorLink::updateName()
+{
+    name = tr("Load Generator (%1 msg/s, %2 systems)").arg(rate).arg(systemCount);
+    emit nameChanged(name);
+}
+
+/**
+ * The encode functions number packets per channel, while a real vehicle
+ * numbers its own packets. The sequence is therefore kept per system and
+ * the message finalized again, otherwise the loss statistics would be wrong.
+ */
+void MAVLinkLoadGeneratorLink::append(QByteArray& stream, mavlink_message_t* msg, int sysid)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    mavlink_status_t* status = mavlink_get_channel_status(id);
+    status->current_tx_seq = txSeq[sysid];
+    mavlink_finalize_message_chan(msg, sysid, componentId, id, msg->len);
+    txSeq[sysid] = status->current_tx_seq;
+
+    int len = mavlink_msg_to_send_buffer(buffer, msg);
+    stream.append((const char*)buffer, len);
+    messagesGenerated++;
+}
+
+void MAVLinkLoadGeneratorLink::appendHeartbeats(QByteArray& stream)
+{
+    mavlink_message_t msg;
+    for (int sysid = 1; sysid <= systemCount; sysid++)
+    {
+        mavlink_msg_heartbeat_pack(sysid, componentId, &msg, MAV_QUADROTOR, MAV_AUTOPILOT_GENERIC);
+        append(stream, &msg, sysid);
+    }
+}
+
+void MAVLinkLoadGeneratorLink::appendMessage(QByteArray& stream, int msgid, int sysid)
+{
+    mavlink_message_t msg;
+    // Random but plausible values, bounded so the widgets do not clip
+    const float r = (nextRandom() % 2000) / 1000.0f - 1.0f;
+
+    switch (msgid)
+    {
+    case MAVLINK_MSG_ID_ATTITUDE:
+    {
+        mavlink_attitude_t attitude;
+        memset(&attitude, 0, sizeof(attitude));
+        attitude.usec = messagesGenerated;
+        attitude.roll = r * 0.5f;
+        attitude.pitch = r * 0.3f;
+        attitude.yaw = r * M_PI;
+        mavlink_msg_attitude_encode(sysid, componentId, &msg, &attitude);
+    }
+        break;
+    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+    {
+        mavlink_global_position_int_t pos;
+        memset(&pos, 0, sizeof(pos));
+        pos.lat = (47.376389 + sysid * 0.001 + r * 0.0001) * 1E7;
+        pos.lon = (8.548056 + r * 0.0001) * 1E7;
+        pos.alt = (500.0 + r * 10.0) * 1000.0;
+        pos.vx = r * 1000;
+        mavlink_msg_global_position_int_encode(sysid, componentId, &msg, &pos);
+    }
+        break;
+    case MAVLINK_MSG_ID_VFR_HUD:
+    {
+        mavlink_vfr_hud_t hud;
+        memset(&hud, 0, sizeof(hud));
+        hud.airspeed = 15.0f + r;
+        hud.groundspeed = 14.0f + r;
+        hud.alt = 500.0f + r * 10.0f;
+        hud.heading = (int)((r + 1.0f) * 180.0f) % 360;
+        hud.throttle = 60;
+        mavlink_msg_vfr_hud_encode(sysid, componentId, &msg, &hud);
+    }
+        break;
+    case MAVLINK_MSG_ID_RAW_PRESSURE:
+    {
+        mavlink_raw_pressure_t pressure;
+        memset(&pressure, 0, sizeof(pressure));
+        pressure.press_abs = 1000 + r * 10;
+        pressure.temperature = 18150;
+        mavlink_msg_raw_pressure_encode(sysid, componentId, &msg, &pressure);
+    }
+        break;
+    case MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT:
+    {
+        mavlink_nav_controller_output_t nav;
+        memset(&nav, 0, sizeof(nav));
+        nav.nav_roll = r * 20.0f;
+        nav.wp_dist = 100.0f + r * 50.0f;
+        mavlink_msg_nav_controller_output_encode(sysid, componentId, &msg, &nav);
+    }
+        break;
+    case MAVLINK_MSG_ID_SYS_STATUS:
+    {
+        mavlink_sys_status_t status;
+        memset(&status, 0, sizeof(status));
+        status.mode = MAV_MODE_AUTO;
+        status.status = MAV_STATE_ACTIVE;
+        status.load = 300 + r * 100;
+        status.vbat = 11500 + r * 500;
+        status.battery_remaining = 800;
+        mavlink_msg_sys_status_encode(sysid, componentId, &msg, &status);
+    }
+        break;
+    default:
+        // Rejected by setMessageMix()
+        return;
+    }
+
+    append(stream, &msg, sysid);
+}
+
+QByteArray MAVLinkLoadGeneratorLink::generate(int count)
+{
+    QByteArray stream;
+    stream.reserve((count + systemCount) * MAVLINK_MAX_PACKET_LEN);
+
+    for (int i = 0; i < count; i++)
+    {
+        // Heartbeats first, the UAS objects are only created on heartbeats.
+        // They are scheduled by message count, not by time, to keep the
+        // stream reproducible
+        if (dataGenerated >= nextHeartbeat)
+        {
+            appendHeartbeats(stream);
+            nextHeartbeat = dataGenerated + rate;
+        }
+
+        int sysid = 1 + nextRandom() % systemCount;
+        int msgid = mixTable.at(nextRandom() % mixTable.size());
+        appendMessage(stream, msgid, sysid);
+        dataGenerated++;
+    }
+    return stream;
+}
+
+/**
+ * @brief Emit messages at the configured rate
+ *
+ * The number of due messages is computed from the time since connect, so
+ * the rate is drift free. At high rates several thousand messages are
+ * emitted per signal to keep the per-signal overhead out of the measurement.
+ */
+void MAVLinkLoadGeneratorLink::run()
+{
+    quint64 start = QGC::groundTimeUsecs();
+    quint64 scheduled = 0;
+    quint64 rateWindowStart = start;
+    quint64 rateWindowCount = messagesGenerated;
+    int currentRate = rate;
+
+    while (connectState)
+    {
+        quint64 now = QGC::groundTimeUsecs();
+        // Rate changed through the GUI, restart the schedule
+        if (rate != currentRate)
+        {
+            currentRate = rate;
+            start = now;
+            scheduled = 0;
+        }
+        quint64 due = (now - start) * currentRate / 1000000 - scheduled;
+        if (due > (quint64)maxBatch) due = maxBatch;
+
+        if (due > 0)
+        {
+            QByteArray b = generate(due);
+            scheduled += due;
+            bitsReceivedTotal += b.size() * 8;
+            emit bytesReceived(this, b);
+        }
+        else
+        {
+            QGC::SLEEP::usleep(500);
+        }
+
+        if (now - rateWindowStart >= 1000000)
+        {
+            achievedRate = (messagesGenerated - rateWindowCount) * 1000000 / (now - rateWindowStart);
+            rateWindowStart = now;
+            rateWindowCount = messagesGenerated;
+        }
+    }
+}
+
+void MAVLinkLoadGeneratorLink::readBytes()
+{
+    // Data is emitted directly from run()
+}
+
+void MAVLinkLoadGeneratorLink::writeBytes(const char* data, qint64 size)
+{
+    // Commands of the groundstation are ignored
+    Q_UNUSED(data);
+    Q_UNUSED(size);
+}
+
+qint64 MAVLinkLoadGeneratorLink::bytesAvailable()
+{
+    return 0;
+}
+
+bool MAVLinkLoadGeneratorLink::connect()
+{
+    if (connectState) return true;
+    reset();
+    connectState = true;
+    connectionStartTime = QGC::groundTimeUsecs()/1000;
+    emit connected();
+    emit connected(true);
+    start(LowPriority);
+    return true;
+}
+
+bool MAVLinkLoadGeneratorLink::disconnect()
+{
+    if (!connectState) return true;
+    connectState = false;
+    wait();
+    emit disconnected();
+    emit connected(false);
+    return true;
+}
+
+bool MAVLinkLoadGeneratorLink::isConnected()
+{
+    return connectState;
+}
+
+QString MAVLinkLoadGeneratorLink::getName()
+{
+    return name;
+}
+
+int MAVLinkLoadGeneratorLink::getId()
+{
+    return id;
+}
+
+qint64 MAVLinkLoadGeneratorLink::getNominalDataRate()
+{
+    return (qint64)rate * 8 * MAVLINK_MAX_PACKET_LEN;
+}
+
+qint64 MAVLinkLoadGeneratorLink::getTotalUpstream()
+{
+    return 0;
+}
+
+qint64 MAVLinkLoadGeneratorLink::getCurrentUpstream()
+{
+    return 0;
+}
+
+qint64 MAVLinkLoadGeneratorLink::getMaxUpstream()
+{
+    return 0;
+}
+
+qint64 MAVLinkLoadGeneratorLink::getBitsSent()
+{
+    return 0;
+}
+
+qint64 MAVLinkLoadGeneratorLink::getBitsReceived()
+{
+    return bitsReceivedTotal;
+}
+
+int MAVLinkLoadGeneratorLink::getLinkQuality()
+{
+    return 100;
+}
+
+bool MAVLinkLoadGeneratorLink::isFullDuplex()
+{
+    return true;
+}
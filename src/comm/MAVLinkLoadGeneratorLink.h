@@ -0,0 +1,156 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Synthetic high-rate MAVLink traffic for benchmarking
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#ifndef MAVLINKLOADGENERATORLINK_H
+#define MAVLINKLOADGENERATORLINK_H
+
+#include <QMap>
+#include <QVector>
+#include <QByteArray>
+#include <inttypes.h>
+#include "QGCMAVLink.h"
+#include "LinkInterface.h"
+
+/**
+ * @brief Link which synthesizes telemetry of many systems at a fixed aggregate rate
+ *
+ * Unlike MAVLinkSimulationLink this does not simulate vehicle behaviour, it
+ * only produces a configurable mix of valid packets as fast as requested, so
+ * the parser, UAS decoding and widgets can be driven to their limits. The
+ * output is fully determined by the seed: the same settings always produce
+ * the same byte stream. Every system sends a heartbeat first and then once
+ * every rate messages, i.e. once per second at the configured rate.
+ *
+ * Headless users (qgcunittest) can call generate() directly without
+ * starting the thread.
+ */
+class MAVLinkLoadGeneratorLink : public LinkInterface
+{
+    Q_OBJECT
+
+public:
+    MAVLinkLoadGeneratorLink(int rate = 10000, int systems = 1, quint32 seed = 1, QObject* parent = 0);
+    ~MAVLinkLoadGeneratorLink();
+
+    bool isConnected();
+    qint64 bytesAvailable();
+
+    void run();
+
+    int getRate() const { return rate; }
+    int getSystemCount() const { return systemCount; }
+    quint32 getSeed() const { return seed; }
+    /** @brief Relative weights of the generated message IDs */
+    QMap<int, int> getMessageMix() const { return messageMix; }
+    /** @brief Number of messages generated since connect, including heartbeats */
+    quint64 getMessagesGenerated() const { return messagesGenerated; }
+    /** @brief Rate actually achieved over the last second in messages per second */
+    quint64 getAchievedRate() const { return achievedRate; }
+
+    /**
+     * @brief Generate the next count messages as a MAVLink byte stream
+     *
+     * Heartbeat rounds are inserted every rate messages. Not thread safe,
+     * do not call it while the link is connected.
+     */
+    QByteArray generate(int count);
+
+    /* Extensive statistics for scientific purposes */
+    qint64 getNominalDataRate();
+    qint64 getTotalUpstream();
+    qint64 getCurrentUpstream();
+    qint64 getMaxUpstream();
+    qint64 getBitsSent();
+    qint64 getBitsReceived();
+
+    QString getName();
+    int getId();
+    int getLinkQuality();
+    bool isFullDuplex();
+
+    static const int minRate = 1;
+    static const int maxRate = 1000000;
+    static const int maxSystems = 250;
+
+    /** @brief True if messages with this ID can be generated */
+    static bool isSupportedMessage(int msgid);
+
+public slots:
+    void setRate(int rate);
+    void setSystemCount(int systems);
+    void setSeed(int seed);
+    /**
+     * @brief Set the message mix, keys are message IDs, values relative weights
+     *
+     * @return false if the mix contains a message which can not be generated, the mix is left unchanged then
+     */
+    bool setMessageMix(const QMap<int, int>& mix);
+    /** @brief Restart the byte stream from the seed */
+    void reset();
+
+    void writeBytes(const char* data, qint64 size);
+    bool connect();
+    bool disconnect();
+
+protected slots:
+    void readBytes();
+
+protected:
+    int id;
+    QString name;
+    volatile bool connectState;
+    volatile int rate;
+    int systemCount;
+    quint32 seed;
+    quint32 randomState;
+    QMap<int, int> messageMix;
+    QVector<int> mixTable;       ///< Message IDs repeated by weight, indexed by random number
+    QVector<quint8> txSeq;       ///< Next sequence number per system
+    quint64 dataGenerated;       ///< Number of messages generated since reset, without heartbeats
+    quint64 nextHeartbeat;       ///< Value of dataGenerated at which the next heartbeat round is due
+    quint64 messagesGenerated;
+    quint64 achievedRate;
+    quint64 bitsReceivedTotal;
+    quint64 connectionStartTime;
+
+    /** @brief Deterministic xorshift random number generator */
+    quint32 nextRandom();
+    void updateName();
+    void updateMixTable();
+    /** @brief Finalize a message with its own per-system sequence number and append it */
+    void append(QByteArray& stream, mavlink_message_t* msg, int sysid);
+    void appendHeartbeats(QByteArray& stream);
+    void appendMessage(QByteArray& stream, int msgid, int sysid);
+
+    static const int componentId = 1;
+    static const int maxBatch = 4096;    ///< Maximum messages emitted in one bytesReceived() call
+};
+
+#endif // MAVLINKLOADGENERATORLINK_H
@@ -16,6 +16,7 @@
 #include <QMessageBox>
 #include <QSettings>
 #include <QDesktopServices>
+#include <QMutexLocker>
 
 //#include "MG.h"
 #include "MAVLinkProtocol.h"
@@ -42,6 +43,7 @@ MAVLinkProtocol::MAVLinkProtocol() :
         heartbeatRate(MAVLINK_HEARTBEAT_DEFAULT_RATE),
         m_heartbeatsEnabled(false),
         m_loggingEnabled(false),
+        m_duplicateFilterEnabled(true),
         m_logfile(NULL),
         m_enable_version_check(true),
         m_paramRetransmissionTimeout(350),
@@ -81,6 +83,7 @@ void MAVLinkProtocol::loadSettings()
     enableHeartbeats(settings.value("HEARTBEATS_ENABLED", m_heartbeatsEnabled).toBool());
     enableVersionCheck(settings.value("VERSION_CHECK_ENABLED", m_enable_version_check).toBool());
     enableMultiplexing(settings.value("MULTIPLEXING_ENABLED", m_multiplexingEnabled).toBool());
+    enableDuplicateFilter(settings.value("DUPLICATE_FILTER_ENABLED", m_duplicateFilterEnabled).toBool());
 
     // Only set logfile if there is a name present in settings
     if (settings.contains("LOGFILE_NAME") && m_logfile == NULL)
@@ -120,6 +123,7 @@ void MAVLinkProtocol::storeSettings()
     settings.setValue("LOGGING_ENABLED", m_loggingEnabled);
     settings.setValue("VERSION_CHECK_ENABLED", m_enable_version_check);
     settings.setValue("MULTIPLEXING_ENABLED", m_multiplexingEnabled);
+    settings.setValue("DUPLICATE_FILTER_ENABLED", m_duplicateFilterEnabled);
     settings.setValue("GCS_SYSTEM_ID", systemId);
     if (m_logfile)
     {
@@ -187,6 +191,13 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
 
         if (decodeState == 1)
         {
+            // Drop packets which already arrived over a redundant link
+            // before they are logged, counted as loss or decoded
+            if (m_duplicateFilterEnabled && isDuplicate(link, message))
+            {
+                continue;
+            }
+
             // Log data
             if (m_loggingEnabled && m_logfile)
             {
@@ -326,7 +337,7 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
                 if (m_multiplexingEnabled)
                 {
                     // Get all links connected to this unit
-                    QList<LinkInterface*> links = LinkManager::instance()->getLinksForProtocol(this);
+                    const QList<LinkInterface*> links = LinkManager::instance()->getLinksForProtocol(this);
 
                     // Emit message on all links that are currently connected
                     foreach (LinkInterface* currLink, links)
@@ -342,6 +353,79 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
     receiveMutex.unlock();
 }
 
+/**
+ * The check is O(1): the fingerprint of each delivered packet is stored in the
+ * slot of its sequence number in the window of its source. A packet with the
+ * same sequence number, message ID and checksum seen less than
+ * duplicateWindowSize packets ago is a copy received over a second link.
+ *
+ * @param link The link the message was received on
+ * @param message The decoded message
+ * @return true if the message was already delivered and has to be dropped
+ */
+bool MAVLinkProtocol::isDuplicate(LinkInterface* link, const mavlink_message_t& message)
+{
+    const int source = (message.sysid << 8) | message.compid;
+    if (!duplicateWindows.contains(source))
+    {
+        DuplicateWindow empty;
+        memset(&empty, 0, sizeof(empty));
+        duplicateWindows.insert(source, empty);
+    }
+    DuplicateWindow& window = duplicateWindows[source];
+
+    // Bit 24 marks the slot as used
+    const quint32 fingerprint = (1u << 24) | (message.ck_b << 16) | (message.ck_a << 8) | message.msgid;
+    const bool duplicate = (window.fingerprint[message.seq] == fingerprint)
+                           && (window.counter - window.stamp[message.seq] < (quint32)duplicateWindowSize);
+
+    if (!duplicate)
+    {
+        window.counter++;
+        window.fingerprint[message.seq] = fingerprint;
+        window.stamp[message.seq] = window.counter;
+    }
+
+    // Per-link arrival statistics
+    const int linkId = link->getId();
+    quint64& first = linkFirstArrivals[linkId];
+    quint64& copies = linkDuplicateArrivals[linkId];
+    if (duplicate)
+    {
+        copies++;
+    }
+    else
+    {
+        first++;
+    }
+
+    // Only report links which actually see redundant traffic
+    if (copies > 0 && (first + copies) % 64 == 0)
+    {
+        emit linkFirstArrivalChanged(link, 100.0f * (double)first / (double)(first + copies));
+    }
+
+    return duplicate;
+}
+
+/**
+ * The counters are written while packets are received, so this locks the
+ * receive mutex. Do not call it from a slot connected directly to
+ * messageReceived().
+ */
+quint64 MAVLinkProtocol::getFirstArrivals(LinkInterface* link) const
+{
+    QMutexLocker locker(&receiveMutex);
+    return linkFirstArrivals.value(link->getId(), 0);
+}
+
+/** @see getFirstArrivals() */
+quint64 MAVLinkProtocol::getDuplicateArrivals(LinkInterface* link) const
+{
+    QMutexLocker locker(&receiveMutex);
+    return linkDuplicateArrivals.value(link->getId(), 0);
+}
+
 /**
  * @return The name of this protocol
  **/
@@ -373,11 +457,12 @@ int MAVLinkProtocol::getComponentId()
 void MAVLinkProtocol::sendMessage(mavlink_message_t message)
 {
     // Get all links connected to this unit
-    QList<LinkInterface*> links = LinkManager::instance()->getLinksForProtocol(this);
+    const QList<LinkInterface*> links = LinkManager::instance()->getLinksForProtocol(this);
 
     // Emit message on all links that are currently connected
-    QList<LinkInterface*>::iterator i;
-    for (i = links.begin(); i != links.end(); ++i)
+    // (const iteration, the shared link snapshot must not detach)
+    QList<LinkInterface*>::const_iterator i;
+    for (i = links.constBegin(); i != links.constEnd(); ++i)
     {
         sendMessage(*i, message);
         //qDebug() << __FILE__ << __LINE__ << "SENT MESSAGE OVER" << ((LinkInterface*)*i)->getName() << "LIST SIZE:" << links.size();
@@ -435,6 +520,15 @@ void MAVLinkProtocol::enableMultiplexing(bool enabled)
     if (changed) emit multiplexingChanged(m_multiplexingEnabled);
 }
 
+void MAVLinkProtocol::enableDuplicateFilter(bool enabled)
+{
+    if (enabled != m_duplicateFilterEnabled)
+    {
+        m_duplicateFilterEnabled = enabled;
+        emit duplicateFilterChanged(m_duplicateFilterEnabled);
+    }
+}
+
 void MAVLinkProtocol::enableParamGuard(bool enabled)
 {
     if (enabled != m_paramGuardEnabled)
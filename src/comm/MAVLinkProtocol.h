@@ -36,6 +36,7 @@ This file is part of the QGROUNDCONTROL project
 #include <QTimer>
 #include <QFile>
 #include <QMap>
+#include <QHash>
 #include <QByteArray>
 #include "ProtocolInterface.h"
 #include "LinkInterface.h"
@@ -73,6 +74,12 @@ public:
     bool versionCheckEnabled() const { return m_enable_version_check; }
     /** @brief Get the multiplexing state */
     bool multiplexingEnabled() const { return m_multiplexingEnabled; }
+    /** @brief Get the duplicate packet filter state */
+    bool duplicateFilterEnabled() const { return m_duplicateFilterEnabled; }
+    /** @brief Get the number of packets of this link which were the first copy to arrive */
+    quint64 getFirstArrivals(LinkInterface* link) const;
+    /** @brief Get the number of packets of this link which were dropped as duplicates */
+    quint64 getDuplicateArrivals(LinkInterface* link) const;
     /** @brief Get the protocol version */
     int getVersion() { return MAVLINK_VERSION; }
     /** @brief Get the name of the packet log file */
@@ -109,6 +116,9 @@ public slots:
     /** @brief Enabled/disable packet multiplexing */
     void enableMultiplexing(bool enabled);
 
+    /** @brief Enable/disable dropping of packets already received over another link */
+    void enableDuplicateFilter(bool enabled);
+
     /** @brief Enable / disable parameter retransmission */
     void enableParamGuard(bool enabled);
 
@@ -139,11 +149,32 @@ public slots:
     void storeSettings();
 
 protected:
+    /** @brief Number of packets per source after which a sequence number may legitimately repeat */
+    static const int duplicateWindowSize = 64;
+
+    /**
+     * @brief Sliding window of recently delivered packets of one (sysid, compid) source
+     *
+     * Slots are indexed by the packet sequence number. As the window is smaller
+     * than the sequence number space, a matching fingerprint within the window
+     * can only be a second copy of the same packet.
+     */
+    struct DuplicateWindow
+    {
+        quint32 fingerprint[256]; ///< Message ID and checksum of the packet last seen with this sequence number
+        quint32 stamp[256];       ///< Value of counter when the slot was written
+        quint32 counter;          ///< Number of packets delivered from this source
+    };
+
+    /** @brief Check if this message was already delivered over another link and update the per-link arrival statistics */
+    bool isDuplicate(LinkInterface* link, const mavlink_message_t& message);
+
     QTimer* heartbeatTimer;    ///< Timer to emit heartbeats
     int heartbeatRate;         ///< Heartbeat rate, controls the timer interval
     bool m_heartbeatsEnabled;  ///< Enabled/disable heartbeat emission
     bool m_loggingEnabled;     ///< Enable/disable packet logging
     bool m_multiplexingEnabled; ///< Enable/disable packet multiplexing
+    bool m_duplicateFilterEnabled; ///< Enable/disable dropping of duplicate packets from redundant links
     QFile* m_logfile;           ///< Logfile
     bool m_enable_version_check; ///< Enable checking of version match of MAV and QGC
     int m_paramRetransmissionTimeout; ///< Timeout for parameter retransmission
@@ -151,8 +182,11 @@ protected:
     bool m_paramGuardEnabled;       ///< Parameter retransmission/rewrite enabled
     bool m_actionGuardEnabled;       ///< Action request retransmission enabled
     int m_actionRetransmissionTimeout; ///< Timeout for parameter retransmission
-    QMutex receiveMutex;       ///< Mutex to protect receiveBytes function
+    mutable QMutex receiveMutex; ///< Mutex to protect receiveBytes function and the arrival counters
     int lastIndex[256][256];
+    QHash<int, DuplicateWindow> duplicateWindows; ///< Recently delivered packets, key is sysid << 8 | compid
+    QHash<int, quint64> linkFirstArrivals;     ///< Packets per link ID which were delivered first
+    QHash<int, quint64> linkDuplicateArrivals; ///< Packets per link ID which were dropped as duplicates
     int totalReceiveCounter;
     int totalLossCounter;
     int currReceiveCounter;
@@ -169,6 +203,10 @@ signals:
     void loggingChanged(bool enabled);
     /** @brief Emitted if multiplexing is started / stopped */
     void multiplexingChanged(bool enabled);
+    /** @brief Emitted if duplicate filtering is enabled / disabled */
+    void duplicateFilterChanged(bool enabled);
+    /** @brief Emitted periodically with the percentage of packets on this link which arrived before their copies on other links */
+    void linkFirstArrivalChanged(LinkInterface* link, float percent);
     /** @brief Emitted if version check is enabled / disabled */
     void versionCheckChanged(bool enabled);
     /** @brief Emitted if a message from the protocol should reach the user */
@@ -89,7 +89,7 @@ public slots:
     virtual void mainloop();
     bool connectLink(bool connect);
     void connectLink();
-    void sendMAVLinkMessage(const mavlink_message_t* msg);
+    virtual void sendMAVLinkMessage(const mavlink_message_t* msg);
 
 
 protected:
@@ -1,12 +1,149 @@
 #include "MAVLinkSwarmSimulationLink.h"
+#include "MAVLinkSimulationMAV.h"
+#include "QGC.h"
 
 MAVLinkSwarmSimulationLink::MAVLinkSwarmSimulationLink(QString readFile, QString writeFile, int rate, QObject *parent) :
-    MAVLinkSimulationLink(readFile, writeFile, rate, parent)
+    MAVLinkSimulationLink(readFile, writeFile, rate, parent),
+    systemCount(1),
+    latencyTracking(false),
+    messagesSent(0)
 {
 }
 
+MAVLinkSwarmSimulationLink::~MAVLinkSwarmSimulationLink()
+{
+    if (isRunning()) disconnect();
+}
 
-void MAVLinkSwarmSimulationLink::mainloop()
+void MAVLinkSwarmSimulationLink::run()
+{
+    while (_isConnected)
+    {
+        readBytes();
+        QGC::SLEEP::msleep(rate);
+    }
+}
+
+bool MAVLinkSwarmSimulationLink::connect()
 {
+    if (isRunning()) return true;
+
+    _isConnected = true;
+    emit connected();
+    emit connected(true);
+
+    // Spread the systems on a grid of about 70 m spacing
+    for (int i = 0; i < systemCount; i++)
+    {
+        double lat = 47.376 + (i / 16) * 0.0006;
+        double lon = 8.548 + (i % 16) * 0.0009;
+        mavs.append(new MAVLinkSimulationMAV(this, i + 1, lat, lon));
+    }
+
+    start(LowPriority);
+    return true;
+}
+
+bool MAVLinkSwarmSimulationLink::disconnect()
+{
+    MAVLinkSimulationLink::disconnect();
+    wait();
+
+    qDeleteAll(mavs);
+    mavs.clear();
+
+    // Chunks already emitted keep their send times until they are taken
+    readyBufferMutex.lock();
+    pending.clear();
+    pendingLengths.clear();
+    pendingSendTimes.clear();
+    readyBufferMutex.unlock();
+    return true;
+}
+
+qint64 MAVLinkSwarmSimulationLink::bytesAvailable()
+{
+    readyBufferMutex.lock();
+    qint64 size = pending.size();
+    readyBufferMutex.unlock();
+    return size;
+}
+
+void MAVLinkSwarmSimulationLink::setSystemCount(int systems)
+{
+    systemCount = qBound(1, systems, maxSystems);
+}
 
+void MAVLinkSwarmSimulationLink::setLatencyTracking(bool enabled)
+{
+    readyBufferMutex.lock();
+    latencyTracking = enabled;
+    if (!enabled) chunkSendTimes.clear();
+    readyBufferMutex.unlock();
+}
+
+QVector<quint64> MAVLinkSwarmSimulationLink::takeChunkSendTimes()
+{
+    QVector<quint64> times;
+    readyBufferMutex.lock();
+    if (!chunkSendTimes.isEmpty()) times = chunkSendTimes.dequeue();
+    readyBufferMutex.unlock();
+    return times;
+}
+
+int MAVLinkSwarmSimulationLink::getPendingChunks()
+{
+    readyBufferMutex.lock();
+    int chunks = chunkSendTimes.size();
+    readyBufferMutex.unlock();
+    return chunks;
+}
+
+void MAVLinkSwarmSimulationLink::sendMAVLinkMessage(const mavlink_message_t* msg)
+{
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    unsigned int length = mavlink_msg_to_send_buffer(buf, msg);
+    quint64 now = QGC::groundTimeUsecs();
+
+    readyBufferMutex.lock();
+    pending.append((const char*)buf, length);
+    pendingLengths.enqueue(length);
+    pendingSendTimes.enqueue(now);
+    messagesSent++;
+    readyBufferMutex.unlock();
+}
+
+void MAVLinkSwarmSimulationLink::readBytes()
+{
+    readyBufferMutex.lock();
+    int length = 0;
+    int count = 0;
+    while (count < pendingLengths.size() && length + pendingLengths.at(count) <= maxChunk)
+    {
+        length += pendingLengths.at(count);
+        count++;
+    }
+    if (count == 0)
+    {
+        readyBufferMutex.unlock();
+        return;
+    }
+
+    QByteArray chunk = pending.left(length);
+    pending.remove(0, length);
+    QVector<quint64> times(count);
+    for (int i = 0; i < count; i++)
+    {
+        pendingLengths.dequeue();
+        times[i] = pendingSendTimes.dequeue();
+    }
+    if (latencyTracking) chunkSendTimes.enqueue(times);
+    readyBufferMutex.unlock();
+
+    emit bytesReceived(this, chunk);
+}
+
+void MAVLinkSwarmSimulationLink::mainloop()
+{
+    // The simulated MAVs run their own mainloops
 }
@@ -1,19 +1,68 @@
 #ifndef MAVLINKSWARMSIMULATIONLINK_H
 #define MAVLINKSWARMSIMULATIONLINK_H
 
+#include <QList>
+#include <QQueue>
+#include <QVector>
+#include <QByteArray>
 #include "MAVLinkSimulationLink.h"
 
+class MAVLinkSimulationMAV;
+
+/**
+ * @brief Simulation link with one simulated MAV per system ID
+ *
+ * Connecting spawns the configured number of MAVLinkSimulationMAV instances
+ * on a grid around the default position. Their packets are emitted in chunks
+ * of whole messages every rate milliseconds.
+ *
+ * With latency tracking enabled the link remembers when every message was
+ * sent. The single receiver of bytesReceived() has to call
+ * takeChunkSendTimes() once per received chunk, in order.
+ */
 class MAVLinkSwarmSimulationLink : public MAVLinkSimulationLink
 {
     Q_OBJECT
 public:
     MAVLinkSwarmSimulationLink(QString readFile="", QString writeFile="", int rate=5, QObject *parent = 0);
+    ~MAVLinkSwarmSimulationLink();
+
+    void run();
+    bool connect();
+    bool disconnect();
+    qint64 bytesAvailable();
+
+    int getSystemCount() const { return systemCount; }
+    /** @brief Messages sent by all simulated MAVs since connect */
+    quint64 getMessagesSent() const { return messagesSent; }
+    /** @brief Send times in microseconds of the messages of the oldest chunk not yet taken */
+    QVector<quint64> takeChunkSendTimes();
+    /** @brief Chunks emitted whose send times were not yet taken */
+    int getPendingChunks();
+
+    static const int maxSystems = 250;
 
 signals:
 
 public slots:
     void mainloop();
+    void readBytes();
+    void sendMAVLinkMessage(const mavlink_message_t* msg);
+    /** @brief Number of MAVs spawned on the next connect */
+    void setSystemCount(int systems);
+    void setLatencyTracking(bool enabled);
+
+protected:
+    int systemCount;
+    bool latencyTracking;
+    quint64 messagesSent;
+    QList<MAVLinkSimulationMAV*> mavs;
+    QByteArray pending;               ///< Packets not yet emitted, whole messages only
+    QQueue<int> pendingLengths;       ///< Length of each message in pending
+    QQueue<quint64> pendingSendTimes; ///< Send time of each message in pending, if tracked
+    QQueue<QVector<quint64> > chunkSendTimes; ///< Send times per emitted chunk, if tracked
 
+    static const int maxChunk = 16384; ///< Maximum bytes emitted in one bytesReceived() call
 };
 
 #endif // MAVLINKSWARMSIMULATIONLINK_H
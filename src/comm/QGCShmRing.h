@@ -0,0 +1,295 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Shared memory ring pair for co-located simulators
+ *
+ *   This header is plain C and has no dependencies on Qt or QGroundControl,
+ *   a simulator or companion process can copy it and attach to the segment
+ *   QGroundControl creates:
+ *
+ *   @code
+ *   qgc_shm_region_t* shm = qgc_shm_attach("/qgroundcontrol", 0, NULL);
+ *   qgc_shm_ring_write(&shm->to_gcs, buf, len);
+ *   uint32_t seq = qgc_shm_ring_sequence(&shm->from_gcs);
+ *   len = qgc_shm_ring_read(&shm->from_gcs, buf, sizeof(buf));
+ *   if (len == 0) qgc_shm_ring_wait(&shm->from_gcs, seq, 100);
+ *   @endcode
+ *
+ *   Each ring has exactly one producer and one consumer. The data is an
+ *   unframed byte stream, MAVLink framing is done by the protocol on top.
+ *   Wakeups use a futex on Linux, other platforms fall back to polling.
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#ifndef QGC_SHM_RING_H
+#define QGC_SHM_RING_H
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define QGC_SHM_RING_MAGIC    0x51474352u /* "QGCR" */
+#define QGC_SHM_RING_VERSION  1u
+#define QGC_SHM_RING_SIZE     (1u << 16)  /* Must be a power of two */
+#define QGC_SHM_CACHELINE     64
+
+/** @brief Single producer / single consumer byte ring */
+typedef struct qgc_shm_ring
+{
+    volatile uint32_t head;     /* Total bytes written, only the producer writes it */
+    uint8_t pad0[QGC_SHM_CACHELINE - sizeof(uint32_t)];
+    volatile uint32_t tail;     /* Total bytes read, only the consumer writes it */
+    uint8_t pad1[QGC_SHM_CACHELINE - sizeof(uint32_t)];
+    volatile uint32_t sequence; /* Incremented by the producer after each write, futex word */
+    volatile uint32_t waiting;  /* Non-zero while the consumer sleeps on sequence */
+    uint8_t pad2[QGC_SHM_CACHELINE - 2 * sizeof(uint32_t)];
+    uint8_t data[QGC_SHM_RING_SIZE];
+} qgc_shm_ring_t;
+
+/** @brief Layout of the shared memory segment */
+typedef struct qgc_shm_region
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t ring_size;
+    uint8_t pad[QGC_SHM_CACHELINE - 3 * sizeof(uint32_t)];
+    qgc_shm_ring_t to_gcs;      /* Simulator -> QGroundControl */
+    qgc_shm_ring_t from_gcs;    /* QGroundControl -> Simulator */
+} qgc_shm_region_t;
+
+static inline void qgc_shm_barrier(void)
+{
+    __sync_synchronize();
+}
+
+/** @return Number of bytes ready to be read */
+static inline uint32_t qgc_shm_ring_available(const qgc_shm_ring_t* ring)
+{
+    return ring->head - ring->tail;
+}
+
+/** @return Current wakeup sequence, read it before an empty read and pass it to qgc_shm_ring_wait() */
+static inline uint32_t qgc_shm_ring_sequence(const qgc_shm_ring_t* ring)
+{
+    uint32_t seq = ring->sequence;
+    qgc_shm_barrier();
+    return seq;
+}
+
+/**
+ * @brief Wake up the consumer if it is sleeping
+ */
+static inline void qgc_shm_ring_wake(qgc_shm_ring_t* ring)
+{
+    __sync_fetch_and_add(&ring->sequence, 1);
+#ifdef __linux__
+    if (ring->waiting)
+    {
+        syscall(SYS_futex, &ring->sequence, FUTEX_WAKE, 1, NULL, NULL, 0);
+    }
+#endif
+}
+
+/**
+ * @brief Block until the producer signals new data or the timeout expires
+ *
+ * @param seq Sequence value read before the ring was found empty
+ * @param timeout_ms Maximum time to block
+ */
+static inline void qgc_shm_ring_wait(qgc_shm_ring_t* ring, uint32_t seq, int timeout_ms)
+{
+#ifdef __linux__
+    struct timespec timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = (timeout_ms % 1000) * 1000000L;
+    ring->waiting = 1;
+    qgc_shm_barrier();
+    if (ring->head == ring->tail)
+    {
+        syscall(SYS_futex, &ring->sequence, FUTEX_WAIT, seq, &timeout, NULL, 0);
+    }
+    ring->waiting = 0;
+#else
+    (void)ring;
+    (void)seq;
+    usleep(timeout_ms > 1 ? 1000 : timeout_ms * 1000);
+#endif
+}
+
+/**
+ * @brief Append bytes to the ring and wake the consumer
+ *
+ * @return Number of bytes written, less than len if the ring is full
+ */
+static inline uint32_t qgc_shm_ring_write(qgc_shm_ring_t* ring, const uint8_t* buf, uint32_t len)
+{
+    const uint32_t head = ring->head;
+    uint32_t space;
+    uint32_t offset;
+    uint32_t first;
+
+    qgc_shm_barrier();
+    space = QGC_SHM_RING_SIZE - (head - ring->tail);
+    if (len > space) len = space;
+    if (len == 0) return 0;
+
+    offset = head & (QGC_SHM_RING_SIZE - 1);
+    first = QGC_SHM_RING_SIZE - offset;
+    if (first > len) first = len;
+    memcpy(ring->data + offset, buf, first);
+    memcpy(ring->data, buf + first, len - first);
+
+    /* Publish the data before the new head */
+    qgc_shm_barrier();
+    ring->head = head + len;
+    qgc_shm_ring_wake(ring);
+    return len;
+}
+
+/**
+ * @brief Take up to maxlen bytes out of the ring, never blocks
+ *
+ * @return Number of bytes read
+ */
+static inline uint32_t qgc_shm_ring_read(qgc_shm_ring_t* ring, uint8_t* buf, uint32_t maxlen)
+{
+    const uint32_t tail = ring->tail;
+    uint32_t len;
+    uint32_t offset;
+    uint32_t first;
+
+    len = ring->head - tail;
+    qgc_shm_barrier();
+    if (len > maxlen) len = maxlen;
+    if (len == 0) return 0;
+
+    offset = tail & (QGC_SHM_RING_SIZE - 1);
+    first = QGC_SHM_RING_SIZE - offset;
+    if (first > len) first = len;
+    memcpy(buf, ring->data + offset, first);
+    memcpy(buf + first, ring->data, len - first);
+
+    /* Release the space only after the copy is complete */
+    qgc_shm_barrier();
+    ring->tail = tail + len;
+    return len;
+}
+
+/**
+ * @brief Map the shared memory segment
+ *
+ * An existing segment is attached as it is, it is never cleared.
+ *
+ * @param name POSIX shared memory name, e.g. "/qgroundcontrol"
+ * @param create 1 to create and initialize the segment if it does not exist yet (done by QGroundControl), 0 to only attach to it
+ * @param created If not NULL, set to 1 if this call created the segment and 0 otherwise
+ * @return Pointer to the mapped region or NULL on failure
+ */
+static inline qgc_shm_region_t* qgc_shm_attach(const char* name, int create, int* created)
+{
+    qgc_shm_region_t* region;
+    struct stat st;
+    int initialize = 0;
+    int fd = -1;
+    if (created) *created = 0;
+    if (create)
+    {
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0)
+        {
+            initialize = 1;
+            if (ftruncate(fd, sizeof(qgc_shm_region_t)) != 0)
+            {
+                close(fd);
+                shm_unlink(name);
+                return NULL;
+            }
+        }
+        else if (errno != EEXIST)
+        {
+            return NULL;
+        }
+    }
+    if (fd < 0) fd = shm_open(name, O_RDWR, 0600);
+    if (fd < 0) return NULL;
+    /* A segment left behind before it was sized would fault on access */
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(qgc_shm_region_t))
+    {
+        close(fd);
+        if (initialize) shm_unlink(name);
+        return NULL;
+    }
+    region = (qgc_shm_region_t*)mmap(NULL, sizeof(qgc_shm_region_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (region == MAP_FAILED)
+    {
+        if (initialize) shm_unlink(name);
+        return NULL;
+    }
+
+    if (initialize)
+    {
+        if (created) *created = 1;
+        memset(region, 0, sizeof(qgc_shm_region_t));
+        region->version = QGC_SHM_RING_VERSION;
+        region->ring_size = QGC_SHM_RING_SIZE;
+        qgc_shm_barrier();
+        region->magic = QGC_SHM_RING_MAGIC;
+    }
+    else if (region->magic != QGC_SHM_RING_MAGIC || region->version != QGC_SHM_RING_VERSION)
+    {
+        munmap(region, sizeof(qgc_shm_region_t));
+        return NULL;
+    }
+    return region;
+}
+
+/** @brief Unmap the region, the creator additionally removes the name */
+static inline void qgc_shm_detach(qgc_shm_region_t* region, const char* name, int created)
+{
+    if (region) munmap(region, sizeof(qgc_shm_region_t));
+    if (created) shm_unlink(name);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* QGC_SHM_RING_H */
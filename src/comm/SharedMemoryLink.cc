@@ -0,0 +1,291 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the shared memory link
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <QSettings>
+#include "SharedMemoryLink.h"
+#include "LinkManager.h"
+#include "QGC.h"
+
+const char* SharedMemoryLink::defaultSegmentName = "/qgroundcontrol";
+
+SharedMemoryLink::SharedMemoryLink(const QString& segmentName) :
+    segmentName(segmentName),
+    region(NULL),
+    segmentCreated(false),
+    connectState(false),
+    bitsSentTotal(0),
+    bitsReceivedTotal(0),
+    bytesDropped(0),
+    connectionStartTime(0)
+{
+    // Set unique ID and add link to the list of links
+    id = getNextLinkId();
+    if (this->segmentName.isEmpty()) loadSettings();
+    this->segmentName = unusedSegmentName(this->segmentName);
+    name = tr("Shared Memory Link (%1)").arg(this->segmentName);
+    LinkManager::instance()->add(this);
+}
+
+SharedMemoryLink::~SharedMemoryLink()
+{
+    disconnect();
+}
+
+void SharedMemoryLink::loadSettings()
+{
+    QSettings settings(QGC::COMPANYNAME, QGC::APPNAME);
+    settings.sync();
+    segmentName = settings.value("SHMLINK_SEGMENT_NAME", defaultSegmentName).toString();
+}
+
+void SharedMemoryLink::writeSettings()
+{
+    QSettings settings(QGC::COMPANYNAME, QGC::APPNAME);
+    settings.setValue("SHMLINK_SEGMENT_NAME", segmentName);
+    settings.sync();
+}
+
+bool SharedMemoryLink::isSegmentNameUsed(const QString& name) const
+{
+    foreach (LinkInterface* link, LinkManager::instance()->getLinks())
+    {
+        SharedMemoryLink* shm = dynamic_cast<SharedMemoryLink*>(link);
+        if (shm && shm != this && shm->getSegmentName() == name) return true;
+    }
+    return false;
+}
+
+QString SharedMemoryLink::unusedSegmentName(const QString& name) const
+{
+    QString candidate = name;
+    for (int i = 2; isSegmentNameUsed(candidate); i++)
+    {
+        candidate = QString("%1-%2").arg(name).arg(i);
+    }
+    return candidate;
+}
+
+/**
+ * @brief Runs the reader thread
+ *
+ * The thread sleeps on the futex of the incoming ring and forwards everything
+ * available in one chunk, so a burst of packets costs a single signal.
+ **/
+void SharedMemoryLink::run()
+{
+    while (connectState)
+    {
+        const uint32_t seq = qgc_shm_ring_sequence(&region->to_gcs);
+        if (qgc_shm_ring_available(&region->to_gcs) > 0)
+        {
+            readBytes();
+        }
+        else
+        {
+            qgc_shm_ring_wait(&region->to_gcs, seq, waitTimeout);
+        }
+    }
+}
+
+void SharedMemoryLink::readBytes()
+{
+    if (!connectState) return;
+
+    const uint32_t maxLength = 4096;
+    char data[maxLength];
+    uint32_t numBytes = qgc_shm_ring_read(&region->to_gcs, (uint8_t*)data, maxLength);
+    if (numBytes > 0)
+    {
+        QByteArray b(data, numBytes);
+        emit bytesReceived(this, b);
+        bitsReceivedTotal += numBytes * 8;
+    }
+}
+
+void SharedMemoryLink::writeBytes(const char* data, qint64 length)
+{
+    if (!connectState) return;
+
+    QMutexLocker locker(&regionMutex);
+    if (!region) return;
+    uint32_t written = qgc_shm_ring_write(&region->from_gcs, (const uint8_t*)data, length);
+    bitsSentTotal += written * 8;
+    // A full ring means the simulator is not reading, drop like a serial port would
+    if (written < length)
+    {
+        bytesDropped += length - written;
+    }
+}
+
+qint64 SharedMemoryLink::bytesAvailable()
+{
+    QMutexLocker locker(&regionMutex);
+    if (!region) return 0;
+    return qgc_shm_ring_available(&region->to_gcs);
+}
+
+void SharedMemoryLink::setSegmentName(const QString& name)
+{
+    // POSIX shared memory names start with a slash
+    QString segment = name.trimmed();
+    if (!segment.startsWith('/')) segment.prepend('/');
+    if (segment == segmentName) return;
+    if (segment.length() < 2 || segment.indexOf('/', 1) >= 0)
+    {
+        emit communicationError(getName(), tr("%1 is no valid shared memory segment name").arg(name));
+        return;
+    }
+    if (isSegmentNameUsed(segment))
+    {
+        emit communicationError(getName(), tr("Shared memory segment %1 is already used by another link").arg(segment));
+        return;
+    }
+
+    bool reconnect = connectState;
+    if (reconnect) disconnect();
+    segmentName = segment;
+    writeSettings();
+    this->name = tr("Shared Memory Link (%1)").arg(segmentName);
+    emit nameChanged(this->name);
+    if (reconnect) connect();
+}
+
+/**
+ * @brief Create or attach the segment and start the reader thread
+ *
+ * A segment which already exists, e.g. because the simulator was started
+ * first, is attached without clearing it.
+ *
+ * @return True if the segment could be mapped
+ **/
+bool SharedMemoryLink::connect()
+{
+    if (connectState) return true;
+
+    int created = 0;
+    qgc_shm_region_t* shm = qgc_shm_attach(segmentName.toLocal8Bit().constData(), 1, &created);
+    if (!shm)
+    {
+        emit communicationError(getName(), tr("Could not create or attach shared memory segment %1").arg(segmentName));
+        return false;
+    }
+    regionMutex.lock();
+    region = shm;
+    segmentCreated = (created != 0);
+    regionMutex.unlock();
+
+    connectState = true;
+    connectionStartTime = QGC::groundTimeUsecs()/1000;
+    emit connected(true);
+    emit connected();
+
+    start(HighPriority);
+    return true;
+}
+
+bool SharedMemoryLink::disconnect()
+{
+    if (!connectState) return true;
+
+    // The reader wakes up at the latest after waitTimeout
+    connectState = false;
+    qgc_shm_ring_wake(&region->to_gcs);
+    wait();
+
+    regionMutex.lock();
+    qgc_shm_detach(region, segmentName.toLocal8Bit().constData(), segmentCreated);
+    region = NULL;
+    segmentCreated = false;
+    regionMutex.unlock();
+
+    emit disconnected();
+    emit connected(false);
+    return true;
+}
+
+bool SharedMemoryLink::isConnected()
+{
+    return connectState;
+}
+
+int SharedMemoryLink::getId()
+{
+    return id;
+}
+
+QString SharedMemoryLink::getName()
+{
+    return name;
+}
+
+qint64 SharedMemoryLink::getNominalDataRate()
+{
+    return 0; // Bound by memory bandwidth, unknown
+}
+
+qint64 SharedMemoryLink::getTotalUpstream()
+{
+    quint64 elapsed = QGC::groundTimeUsecs()/1000 - connectionStartTime;
+    if (elapsed < 1000) return 0;
+    return bitsSentTotal / (elapsed / 1000);
+}
+
+qint64 SharedMemoryLink::getCurrentUpstream()
+{
+    return 0; // TODO
+}
+
+qint64 SharedMemoryLink::getMaxUpstream()
+{
+    return 0; // TODO
+}
+
+qint64 SharedMemoryLink::getBitsSent()
+{
+    return bitsSentTotal;
+}
+
+qint64 SharedMemoryLink::getBitsReceived()
+{
+    return bitsReceivedTotal;
+}
+
+bool SharedMemoryLink::isFullDuplex()
+{
+    return true;
+}
+
+int SharedMemoryLink::getLinkQuality()
+{
+    /* This feature is not supported with this interface */
+    return -1;
+}
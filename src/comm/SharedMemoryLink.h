@@ -0,0 +1,118 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Shared memory link for simulators running on the same machine
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#ifndef SHAREDMEMORYLINK_H
+#define SHAREDMEMORYLINK_H
+
+#include <QString>
+#include <QMutex>
+#include <LinkInterface.h>
+#include "QGCShmRing.h"
+
+/**
+ * @brief Link to a co-located process over a POSIX shared memory ring pair
+ *
+ * QGroundControl creates the segment, the simulator attaches to it with the
+ * functions in QGCShmRing.h. Compared to UDPLink on loopback this avoids the
+ * kernel socket copies and one syscall per datagram, the reading thread
+ * sleeps on a futex and is woken directly by the writer.
+ *
+ * Every link uses its own segment, a name already taken by another link gets
+ * a number appended. The last name set by the user is stored in the settings
+ * and used for the next new link.
+ */
+class SharedMemoryLink : public LinkInterface
+{
+    Q_OBJECT
+
+public:
+    /** @param segmentName Segment to use, the stored name if empty */
+    SharedMemoryLink(const QString& segmentName = QString());
+    ~SharedMemoryLink();
+
+    bool isConnected();
+    qint64 bytesAvailable();
+    /** @brief Name of the POSIX shared memory segment */
+    QString getSegmentName() const { return segmentName; }
+
+    QString getName();
+    int getId();
+
+    /* Statistics */
+    qint64 getNominalDataRate();
+    qint64 getTotalUpstream();
+    qint64 getCurrentUpstream();
+    qint64 getMaxUpstream();
+    qint64 getBitsSent();
+    qint64 getBitsReceived();
+    /** @brief Number of bytes dropped because the simulator did not empty its ring */
+    qint64 getBytesDropped() const { return bytesDropped; }
+
+    void run();
+
+    int getLinkQuality();
+    bool isFullDuplex();
+
+public slots:
+    /** @brief Set and store the segment name, reconnects if connected */
+    void setSegmentName(const QString& name);
+
+    void writeBytes(const char* data, qint64 length);
+    bool connect();
+    bool disconnect();
+
+protected slots:
+    void readBytes();
+
+protected:
+    void loadSettings();
+    void writeSettings();
+    /** @brief True if another shared memory link uses this segment */
+    bool isSegmentNameUsed(const QString& name) const;
+    /** @brief The name itself if it is unused, else the name with the first free number appended */
+    QString unusedSegmentName(const QString& name) const;
+
+    QString segmentName;
+    QString name;
+    int id;
+    qgc_shm_region_t* region;
+    bool segmentCreated;        ///< This link created the segment and removes it on disconnect
+    volatile bool connectState;
+    quint64 bitsSentTotal;
+    quint64 bitsReceivedTotal;
+    qint64 bytesDropped;
+    quint64 connectionStartTime;
+    QMutex regionMutex;         ///< Serializes writers, the ring has a single producer, and guards region against disconnect()
+
+    static const int waitTimeout = 100; ///< Maximum time in ms the reader sleeps before checking for disconnect
+    static const char* defaultSegmentName;
+};
+
+#endif // SHAREDMEMORYLINK_H
@@ -0,0 +1,526 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of TCP connection (client or server) for unmanned vehicles
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#include <QMutexLocker>
+#include <QMetaObject>
+#include "TCPLink.h"
+#include "LinkManager.h"
+#include "QGC.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#endif
+
+TCPLink::TCPLink(const QString& host, quint16 port, TCPLinkMode mode) :
+    host(host),
+    port(port),
+    mode(mode),
+    noDelay(true),
+    connectState(false),
+    server(NULL),
+    reconnectDelay(reconnectDelayMin),
+    writeBufferSince(0),
+    bitsSentTotal(0),
+    bitsSentCurrent(0),
+    bitsSentMax(0),
+    bitsReceivedTotal(0),
+    bitsReceivedCurrent(0),
+    bitsReceivedMax(0),
+    bitsSentInterval(0),
+    bitsReceivedInterval(0),
+    writeLatencyTotal(0),
+    writeCount(0),
+    connectionStartTime(0)
+{
+    reconnectTimer.setSingleShot(true);
+    QObject::connect(&reconnectTimer, SIGNAL(timeout()), this, SLOT(reconnect()));
+    statisticsTimer.setInterval(statisticsInterval);
+    QObject::connect(&statisticsTimer, SIGNAL(timeout()), this, SLOT(updateStatistics()));
+
+    // Set unique ID and add link to the list of links
+    this->id = getNextLinkId();
+    updateName();
+    LinkManager::instance()->add(this);
+}
+
+TCPLink::~TCPLink()
+{
+    disconnect();
+}
+
+/**
+ * @brief Runs the thread
+ *
+ * The sockets are owned by the thread this object lives in,
+ * like UDPLink the thread itself only runs an event loop.
+ **/
+void TCPLink::run()
+{
+    exec();
+}
+
+void TCPLink::setHost(const QString& host)
+{
+    this->host = host;
+    updateName();
+    if (connectState && mode == TCP_CLIENT)
+    {
+        disconnect();
+        connect();
+    }
+}
+
+void TCPLink::setPort(int port)
+{
+    this->port = port;
+    updateName();
+    if (connectState)
+    {
+        disconnect();
+        connect();
+    }
+}
+
+void TCPLink::setMode(int mode)
+{
+    if (mode == this->mode) return;
+    bool reconnect = connectState;
+    if (reconnect) disconnect();
+    this->mode = static_cast<TCPLinkMode>(mode);
+    updateName();
+    if (reconnect) connect();
+}
+
+void TCPLink::setNoDelay(bool enabled)
+{
+    noDelay = enabled;
+    foreach (QTcpSocket* socket, sockets)
+    {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, noDelay ? 1 : 0);
+    }
+}
+
+void TCPLink::configureSocket(QTcpSocket* socket)
+{
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, noDelay ? 1 : 0);
+    socket->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
+
+    // Large kernel buffers absorb radio bursts without stalling the sender
+    int fd = socket->socketDescriptor();
+    if (fd != -1)
+    {
+        int size = socketBufferSize;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (const char*)&size, sizeof(size));
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, (const char*)&size, sizeof(size));
+    }
+}
+
+/**
+ * Bytes are only appended to the coalescing buffer here, the socket write
+ * happens once per event loop iteration in flushWriteBuffer(). This method
+ * can therefore be called from any thread.
+ */
+void TCPLink::writeBytes(const char* data, qint64 size)
+{
+    if (!connectState) return;
+
+    writeMutex.lock();
+    bool wasEmpty = writeBuffer.isEmpty();
+    if (wasEmpty) writeBufferSince = QGC::groundTimeUsecs();
+    writeBuffer.append(data, size);
+    bool full = writeBuffer.size() >= maxCoalescedBytes;
+    writeMutex.unlock();
+
+    if (full && QThread::currentThread() == thread())
+    {
+        flushWriteBuffer();
+    }
+    else if (wasEmpty)
+    {
+        QMetaObject::invokeMethod(this, "flushWriteBuffer", Qt::QueuedConnection);
+    }
+}
+
+void TCPLink::flushWriteBuffer()
+{
+    writeMutex.lock();
+    QByteArray data = writeBuffer;
+    quint64 since = writeBufferSince;
+    writeBuffer.clear();
+    writeMutex.unlock();
+
+    if (data.isEmpty()) return;
+
+    bool written = false;
+    foreach (QTcpSocket* socket, sockets)
+    {
+        if (socket->state() == QAbstractSocket::ConnectedState)
+        {
+            socket->write(data);
+            written = true;
+        }
+    }
+
+    if (written)
+    {
+        bitsSentTotal += data.size() * 8;
+        bitsSentInterval += data.size() * 8;
+        writeLatencyTotal += QGC::groundTimeUsecs() - since;
+        writeCount++;
+    }
+}
+
+/**
+ * @brief Read all pending bytes of all connected sockets
+ **/
+void TCPLink::readBytes()
+{
+    QTcpSocket* source = qobject_cast<QTcpSocket*>(sender());
+    QList<QTcpSocket*> readable;
+    if (source)
+    {
+        readable.append(source);
+    }
+    else
+    {
+        readable = sockets;
+    }
+
+    foreach (QTcpSocket* socket, readable)
+    {
+        qint64 available = socket->bytesAvailable();
+        if (available > 0)
+        {
+            QByteArray b = socket->readAll();
+            emit bytesReceived(this, b);
+            bitsReceivedTotal += b.size() * 8;
+            bitsReceivedInterval += b.size() * 8;
+        }
+    }
+}
+
+qint64 TCPLink::bytesAvailable()
+{
+    qint64 available = 0;
+    foreach (QTcpSocket* socket, sockets)
+    {
+        available += socket->bytesAvailable();
+    }
+    return available;
+}
+
+void TCPLink::acceptConnection()
+{
+    while (server && server->hasPendingConnections())
+    {
+        QTcpSocket* socket = server->nextPendingConnection();
+        configureSocket(socket);
+        QObject::connect(socket, SIGNAL(readyRead()), this, SLOT(readBytes()));
+        QObject::connect(socket, SIGNAL(disconnected()), this, SLOT(socketDisconnected()));
+        sockets.append(socket);
+    }
+    updateName();
+}
+
+void TCPLink::socketConnected()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    if (socket) configureSocket(socket);
+    // Connection is up again, restart the backoff sequence
+    reconnectDelay = reconnectDelayMin;
+    emit connected(true);
+    emit connected();
+}
+
+void TCPLink::socketDisconnected()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket) return;
+
+    if (mode == TCP_SERVER)
+    {
+        // Vehicle went away, keep listening for others
+        sockets.removeAll(socket);
+        socket->deleteLater();
+        updateName();
+    }
+    else if (connectState && !reconnectTimer.isActive())
+    {
+        emit connected(false);
+        reconnectTimer.start(reconnectDelay);
+    }
+}
+
+void TCPLink::socketError(QAbstractSocket::SocketError error)
+{
+    Q_UNUSED(error);
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket || mode != TCP_CLIENT) return;
+
+    // Only report the first failure of a reconnect sequence
+    if (reconnectDelay == reconnectDelayMin)
+    {
+        emit communicationError(getName(), tr("TCP connection to %1:%2 failed: %3").arg(host).arg(port).arg(socket->errorString()));
+    }
+    if (connectState && !reconnectTimer.isActive())
+    {
+        reconnectTimer.start(reconnectDelay);
+    }
+}
+
+/**
+ * The delay between attempts doubles up to reconnectDelayMax,
+ * so a bridge which is down does not get flooded.
+ */
+void TCPLink::reconnect()
+{
+    if (!connectState || sockets.isEmpty()) return;
+    reconnectDelay = qMin(reconnectDelay * 2, (int)reconnectDelayMax);
+    QTcpSocket* socket = sockets.first();
+    // Do not let the abort of a stale attempt schedule another retry
+    socket->blockSignals(true);
+    socket->abort();
+    socket->blockSignals(false);
+    socket->connectToHost(host, port);
+}
+
+void TCPLink::closeSockets()
+{
+    foreach (QTcpSocket* socket, sockets)
+    {
+        socket->blockSignals(true);
+        socket->abort();
+        socket->deleteLater();
+    }
+    sockets.clear();
+}
+
+/**
+ * @brief Disconnect the connection.
+ *
+ * @return True if connection has been disconnected, false if connection couldn't be disconnected.
+ **/
+bool TCPLink::disconnect()
+{
+    if (!connectState) return true;
+    connectState = false;
+
+    reconnectTimer.stop();
+    statisticsTimer.stop();
+    flushWriteBuffer();
+    closeSockets();
+    if (server)
+    {
+        server->close();
+        delete server;
+        server = NULL;
+    }
+
+    quit();
+    wait();
+
+    emit disconnected();
+    emit connected(false);
+    updateName();
+    return true;
+}
+
+/**
+ * @brief Connect the connection.
+ *
+ * In client mode the connection is established asynchronously, connected()
+ * is emitted once the handshake completed.
+ *
+ * @return True if the link could be started, false otherwise.
+ **/
+bool TCPLink::connect()
+{
+    if (connectState) return true;
+
+    reconnectDelay = reconnectDelayMin;
+    if (mode == TCP_SERVER)
+    {
+        server = new QTcpServer(this);
+        QObject::connect(server, SIGNAL(newConnection()), this, SLOT(acceptConnection()));
+        if (!server->listen(QHostAddress::Any, port))
+        {
+            emit communicationError(getName(), tr("Could not listen on TCP port %1: %2").arg(port).arg(server->errorString()));
+            delete server;
+            server = NULL;
+            return false;
+        }
+        emit connected(true);
+        emit connected();
+    }
+    else
+    {
+        QTcpSocket* socket = new QTcpSocket(this);
+        QObject::connect(socket, SIGNAL(connected()), this, SLOT(socketConnected()));
+        QObject::connect(socket, SIGNAL(disconnected()), this, SLOT(socketDisconnected()));
+        QObject::connect(socket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(socketError(QAbstractSocket::SocketError)));
+        QObject::connect(socket, SIGNAL(readyRead()), this, SLOT(readBytes()));
+        sockets.append(socket);
+        socket->connectToHost(host, port);
+    }
+
+    connectState = true;
+    connectionStartTime = QGC::groundTimeUsecs()/1000;
+    statisticsTimer.start();
+    updateName();
+
+    start(HighPriority);
+    return true;
+}
+
+/**
+ * @brief Check if connection is active.
+ *
+ * @return True if the client is connected or the server is listening
+ **/
+bool TCPLink::isConnected()
+{
+    if (!connectState) return false;
+    if (mode == TCP_SERVER) return (server != NULL);
+    return (!sockets.isEmpty() && sockets.first()->state() == QAbstractSocket::ConnectedState);
+}
+
+int TCPLink::getId()
+{
+    return id;
+}
+
+QString TCPLink::getName()
+{
+    return name;
+}
+
+void TCPLink::setName(const QString& name)
+{
+    if (name == this->name) return;
+    this->name = name;
+    emit nameChanged(this->name);
+}
+
+void TCPLink::updateName()
+{
+    if (mode == TCP_SERVER)
+    {
+        setName(tr("TCP Server (port:%1, %2 connected)").arg(port).arg(sockets.size()));
+    }
+    else
+    {
+        setName(tr("TCP Link (%1:%2)").arg(host).arg(port));
+    }
+}
+
+void TCPLink::updateStatistics()
+{
+    bitsSentCurrent = bitsSentInterval * 1000 / statisticsInterval;
+    bitsReceivedCurrent = bitsReceivedInterval * 1000 / statisticsInterval;
+    if (bitsSentCurrent > bitsSentMax) bitsSentMax = bitsSentCurrent;
+    if (bitsReceivedCurrent > bitsReceivedMax) bitsReceivedMax = bitsReceivedCurrent;
+    bitsSentInterval = 0;
+    bitsReceivedInterval = 0;
+}
+
+qint64 TCPLink::getNominalDataRate()
+{
+    return 54000000; // 54 Mbit
+}
+
+qint64 TCPLink::getTotalUpstream()
+{
+    quint64 elapsed = (QGC::groundTimeUsecs()/1000 - connectionStartTime) / 1000;
+    if (elapsed == 0) return 0;
+    return bitsSentTotal / elapsed;
+}
+
+qint64 TCPLink::getCurrentUpstream()
+{
+    return bitsSentCurrent;
+}
+
+qint64 TCPLink::getMaxUpstream()
+{
+    return bitsSentMax;
+}
+
+qint64 TCPLink::getTotalDownstream()
+{
+    quint64 elapsed = (QGC::groundTimeUsecs()/1000 - connectionStartTime) / 1000;
+    if (elapsed == 0) return 0;
+    return bitsReceivedTotal / elapsed;
+}
+
+qint64 TCPLink::getCurrentDownstream()
+{
+    return bitsReceivedCurrent;
+}
+
+qint64 TCPLink::getMaxDownstream()
+{
+    return bitsReceivedMax;
+}
+
+qint64 TCPLink::getBitsSent()
+{
+    return bitsSentTotal;
+}
+
+qint64 TCPLink::getBitsReceived()
+{
+    return bitsReceivedTotal;
+}
+
+qint64 TCPLink::getMeanWriteLatency()
+{
+    if (writeCount == 0) return 0;
+    return writeLatencyTotal / writeCount;
+}
+
+qint64 TCPLink::getMeanWriteSize()
+{
+    if (writeCount == 0) return 0;
+    return bitsSentTotal / 8 / writeCount;
+}
+
+bool TCPLink::isFullDuplex()
+{
+    return true;
+}
+
+int TCPLink::getLinkQuality()
+{
+    /* This feature is not supported with this interface */
+    return -1;
+}
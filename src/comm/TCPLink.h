@@ -0,0 +1,172 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TCP connection (client or server) for unmanned vehicles
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#ifndef TCPLINK_H
+#define TCPLINK_H
+
+#include <QString>
+#include <QList>
+#include <QMutex>
+#include <QTimer>
+#include <QByteArray>
+#include <QTcpSocket>
+#include <QTcpServer>
+#include <LinkInterface.h>
+#include <configuration.h>
+
+/**
+ * @brief MAVLink over TCP, e.g. through companion computers or ser2net bridges
+ *
+ * In client mode the link connects to host:port and reconnects with
+ * exponential backoff when the connection drops. In server mode it listens
+ * on port and accepts any number of vehicles, incoming data of all of them
+ * is forwarded and outgoing data is sent to all of them.
+ *
+ * Writes are coalesced: packets written in the same event loop iteration
+ * are sent with a single socket write.
+ */
+class TCPLink : public LinkInterface
+{
+    Q_OBJECT
+
+public:
+    enum TCPLinkMode
+    {
+        TCP_CLIENT,
+        TCP_SERVER
+    };
+
+    TCPLink(const QString& host = "localhost", quint16 port = 5760, TCPLinkMode mode = TCP_CLIENT);
+    ~TCPLink();
+
+    bool isConnected();
+    qint64 bytesAvailable();
+    QString getHost() const { return host; }
+    int getPort() const { return port; }
+    TCPLinkMode getMode() const { return mode; }
+    bool getNoDelay() const { return noDelay; }
+    /** @brief Number of accepted vehicle connections in server mode */
+    int getClientCount() const { return sockets.size(); }
+
+    QString getName();
+    int getId();
+
+    /* Extensive statistics for scientific purposes */
+    qint64 getNominalDataRate();
+    qint64 getTotalUpstream();
+    qint64 getCurrentUpstream();
+    qint64 getMaxUpstream();
+    qint64 getTotalDownstream();
+    qint64 getCurrentDownstream();
+    qint64 getMaxDownstream();
+    qint64 getBitsSent();
+    qint64 getBitsReceived();
+    /** @brief Mean time in microseconds written bytes waited in the coalescing buffer */
+    qint64 getMeanWriteLatency();
+    /** @brief Mean number of bytes per socket write */
+    qint64 getMeanWriteSize();
+
+    void run();
+
+    int getLinkQuality();
+    bool isFullDuplex();
+
+    /** @brief Socket buffer size requested from the kernel */
+    static const int socketBufferSize = 256 * 1024;
+    /** @brief Flush the write buffer immediately once it holds this many bytes */
+    static const int maxCoalescedBytes = 8 * 1024;
+
+public slots:
+    void setHost(const QString& host);
+    void setPort(int port);
+    void setMode(int mode);
+    /** @brief Enable/disable TCP_NODELAY on all sockets */
+    void setNoDelay(bool enabled);
+
+    void writeBytes(const char* data, qint64 length);
+    bool connect();
+    bool disconnect();
+
+protected slots:
+    void readBytes();
+    /** @brief Write all coalesced bytes to the socket(s) */
+    void flushWriteBuffer();
+    /** @brief Accept pending vehicle connections in server mode */
+    void acceptConnection();
+    void socketConnected();
+    void socketDisconnected();
+    void socketError(QAbstractSocket::SocketError error);
+    /** @brief Attempt to reconnect the client socket */
+    void reconnect();
+    /** @brief Update current and maximum data rates */
+    void updateStatistics();
+
+protected:
+    QString host;
+    quint16 port;
+    TCPLinkMode mode;
+    bool noDelay;
+    QString name;
+    int id;
+    bool connectState;          ///< Link is logically connected, reconnects are attempted
+    QTcpServer* server;
+    QList<QTcpSocket*> sockets; ///< The client socket or all accepted connections
+    QTimer reconnectTimer;
+    int reconnectDelay;         ///< Current backoff in milliseconds
+    QTimer statisticsTimer;
+
+    QMutex writeMutex;          ///< Protects the coalescing buffer, writers may be on any thread
+    QByteArray writeBuffer;
+    quint64 writeBufferSince;   ///< Time in microseconds the oldest buffered byte was written
+
+    quint64 bitsSentTotal;
+    quint64 bitsSentCurrent;
+    quint64 bitsSentMax;
+    quint64 bitsReceivedTotal;
+    quint64 bitsReceivedCurrent;
+    quint64 bitsReceivedMax;
+    quint64 bitsSentInterval;      ///< Bits sent since last statistics update
+    quint64 bitsReceivedInterval;  ///< Bits received since last statistics update
+    quint64 writeLatencyTotal;     ///< Sum of coalescing delays in microseconds
+    quint64 writeCount;            ///< Number of socket writes
+    quint64 connectionStartTime;
+
+    /** @brief Apply buffer sizes and TCP_NODELAY to a connected socket */
+    void configureSocket(QTcpSocket* socket);
+    void setName(const QString& name);
+    void updateName();
+    void closeSockets();
+
+    static const int reconnectDelayMin = 250;
+    static const int reconnectDelayMax = 8000;
+    static const int statisticsInterval = 1000;
+};
+
+#endif // TCPLINK_H
@@ -0,0 +1,211 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+
+/**
+ * @file
+ *   @brief Implementation of the central heartbeat supervision
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#include "QGCHeartbeatSupervisor.h"
+#include "QGC.h"
+
+QGCHeartbeatSupervisor::QGCHeartbeatSupervisor(QObject* parent) :
+    QObject(parent),
+    inner(wheelSize),
+    outer(wheelSize),
+    currentTick(0),
+    startTime(0),
+    started(false),
+    timeout(2000),
+    lostTimeout(10000),
+    entriesProcessed(0),
+    timer(this)
+{
+    connect(&timer, SIGNAL(timeout()), this, SLOT(tick()));
+}
+
+void QGCHeartbeatSupervisor::heartbeat(int systemId)
+{
+    heartbeat(systemId, QGC::groundTimeMilliseconds());
+}
+
+void QGCHeartbeatSupervisor::heartbeat(int systemId, quint64 now)
+{
+    if (!started)
+    {
+        started = true;
+        startTime = now;
+        currentTick = 0;
+    }
+
+    QHash<int, System>::iterator it = systems.find(systemId);
+    if (it == systems.end())
+    {
+        it = systems.insert(systemId, System());
+        it->lastHeartbeat = now;
+        schedule(systemId, *it);
+    }
+    else
+    {
+        // The common case, only remember the time
+        it->lastHeartbeat = now;
+        if (it->state != HEARTBEAT_ALIVE)
+        {
+            it->state = HEARTBEAT_ALIVE;
+            it->generation++;
+            schedule(systemId, *it);
+            emit stateChanged(systemId, HEARTBEAT_ALIVE, 0);
+        }
+    }
+
+    if (!timer.isActive()) timer.start(tickInterval);
+}
+
+void QGCHeartbeatSupervisor::removeSystem(int systemId)
+{
+    // Its entries in the wheel are skipped once they come up
+    systems.remove(systemId);
+    if (systems.isEmpty()) timer.stop();
+}
+
+void QGCHeartbeatSupervisor::setTimeout(int milliseconds)
+{
+    timeout = qMax(milliseconds, tickInterval);
+    if (lostTimeout < timeout) lostTimeout = timeout;
+    // Deadlines may have moved closer, schedule everybody again
+    QHash<int, System>::iterator it;
+    for (it = systems.begin(); it != systems.end(); ++it)
+    {
+        it->generation++;
+        schedule(it.key(), *it);
+    }
+}
+
+void QGCHeartbeatSupervisor::setLostTimeout(int milliseconds)
+{
+    lostTimeout = qMax(milliseconds, timeout);
+    setTimeout(timeout);
+}
+
+void QGCHeartbeatSupervisor::tick()
+{
+    advance(QGC::groundTimeMilliseconds());
+}
+
+quint64 QGCHeartbeatSupervisor::deadline(const System& system) const
+{
+    switch (system.state)
+    {
+    case HEARTBEAT_ALIVE:
+        return system.lastHeartbeat + timeout;
+    case HEARTBEAT_TIMEOUT:
+        return system.lastHeartbeat + lostTimeout;
+    default:
+        return 0;
+    }
+}
+
+void QGCHeartbeatSupervisor::schedule(int systemId, const System& system, bool cascading)
+{
+    quint64 due = deadline(system);
+    if (due == 0) return;
+
+    // The slot at or after the deadline, never one that was processed already.
+    // While cascading, the slot of the current tick is still to be processed.
+    quint64 tick = (due > startTime) ? (due - startTime + tickInterval - 1) / tickInterval : 0;
+    quint64 first = cascading ? currentTick : currentTick + 1;
+    if (tick < first) tick = first;
+
+    Entry entry;
+    entry.systemId = systemId;
+    entry.generation = system.generation;
+    if (tick - currentTick < (quint64)wheelSize)
+    {
+        inner[tick % wheelSize].append(entry);
+    }
+    else
+    {
+        // Beyond the last turn of the outer wheel the entry is checked and
+        // moved on early, which is correct, just not free
+        quint64 turn = qMin(tick / wheelSize, currentTick / wheelSize + wheelSize - 1);
+        outer[turn % wheelSize].append(entry);
+    }
+}
+
+void QGCHeartbeatSupervisor::advance(quint64 now)
+{
+    if (!started) return;
+
+    while (startTime + (currentTick + 1) * tickInterval <= now)
+    {
+        currentTick++;
+
+        // A new turn of the inner wheel, spread the entries of this
+        // turn from the outer wheel over the inner one
+        if (currentTick % wheelSize == 0)
+        {
+            QVector<Entry> cascade = outer[(currentTick / wheelSize) % wheelSize];
+            outer[(currentTick / wheelSize) % wheelSize].clear();
+            foreach (const Entry& entry, cascade)
+            {
+                QHash<int, System>::const_iterator it = systems.constFind(entry.systemId);
+                if (it != systems.constEnd() && it->generation == entry.generation)
+                {
+                    schedule(entry.systemId, *it, true);
+                }
+            }
+        }
+
+        QVector<Entry> due = inner[currentTick % wheelSize];
+        inner[currentTick % wheelSize].clear();
+        foreach (const Entry& entry, due)
+        {
+            check(entry, now);
+        }
+    }
+}
+
+void QGCHeartbeatSupervisor::check(const Entry& entry, quint64 now)
+{
+    QHash<int, System>::iterator it = systems.find(entry.systemId);
+    if (it == systems.end() || it->generation != entry.generation) return;
+    entriesProcessed++;
+
+    quint64 elapsed = now - it->lastHeartbeat;
+    bool timedOut = (it->state == HEARTBEAT_ALIVE && elapsed >= (quint64)timeout);
+    if (timedOut) it->state = HEARTBEAT_TIMEOUT;
+    bool lost = (it->state == HEARTBEAT_TIMEOUT && elapsed >= (quint64)lostTimeout);
+    if (lost) it->state = HEARTBEAT_LOST;
+
+    // A lost system is not checked again until its next heartbeat,
+    // all others move on to their next deadline
+    schedule(entry.systemId, *it);
+
+    // Emit last, a receiver might remove the system
+    if (timedOut) emit stateChanged(entry.systemId, HEARTBEAT_TIMEOUT, elapsed);
+    if (lost) emit stateChanged(entry.systemId, HEARTBEAT_LOST, elapsed);
+}
@@ -0,0 +1,147 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+
+/**
+ * @file
+ *   @brief Definition of the central heartbeat supervision
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#ifndef QGCHEARTBEATSUPERVISOR_H
+#define QGCHEARTBEATSUPERVISOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QTimer>
+
+/**
+ * @brief Detects heartbeat timeouts of all systems with one timer
+ *
+ * Every system is in one of three states: alive, timed out (no heartbeat
+ * for getTimeout() milliseconds) and lost (no heartbeat for getLostTimeout()
+ * milliseconds). Only the transitions are signalled.
+ *
+ * The deadlines live in a hierarchical timer wheel with two levels of
+ * wheelSize slots. The inner wheel has a resolution of one tick, each slot
+ * of the outer wheel covers a whole turn of the inner one and is cascaded
+ * into it when the inner wheel reaches it. A heartbeat only stores its time,
+ * it does not touch the wheel. When the deadline slot of a system comes up,
+ * the real deadline is computed from the last heartbeat and the system is
+ * either moved on to it or changes its state. This makes the cost per
+ * heartbeat and per timeout period constant, independent of the number of
+ * systems and the heartbeat rate.
+ */
+class QGCHeartbeatSupervisor : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum HeartbeatState
+    {
+        HEARTBEAT_ALIVE,
+        HEARTBEAT_TIMEOUT,
+        HEARTBEAT_LOST
+    };
+
+    QGCHeartbeatSupervisor(QObject* parent = 0);
+
+    /** @brief A heartbeat of a system arrived, starts supervising it */
+    void heartbeat(int systemId, quint64 now);
+    /** @brief Stop supervising a system */
+    void removeSystem(int systemId);
+    /** @brief Process all deadlines up to now, called by the internal timer */
+    void advance(quint64 now);
+
+    HeartbeatState getState(int systemId) const { return systems.value(systemId).state; }
+    int getSystemCount() const { return systems.size(); }
+    int getTimeout() const { return timeout; }
+    int getLostTimeout() const { return lostTimeout; }
+    /** @brief Wheel entries processed so far, a measure of the supervision cost */
+    quint64 getEntriesProcessed() const { return entriesProcessed; }
+
+    static const int tickInterval = 100;   ///< Resolution of the wheel in milliseconds
+    static const int wheelSize = 64;       ///< Slots per wheel level
+
+public slots:
+    /** @brief A heartbeat of a system arrived now */
+    void heartbeat(int systemId);
+    /** @brief Milliseconds without heartbeat until a system times out */
+    void setTimeout(int milliseconds);
+    /** @brief Milliseconds without heartbeat until a system is lost */
+    void setLostTimeout(int milliseconds);
+
+signals:
+    /**
+     * @brief A system changed its heartbeat state
+     *
+     * @param elapsed Milliseconds since the last heartbeat
+     */
+    void stateChanged(int systemId, int state, quint64 elapsed);
+
+protected slots:
+    void tick();
+
+protected:
+    struct System
+    {
+        System() : lastHeartbeat(0), state(HEARTBEAT_ALIVE), generation(0) {}
+        quint64 lastHeartbeat;
+        HeartbeatState state;
+        quint32 generation;    ///< Entries of older generations are stale
+    };
+
+    /** @brief A scheduled check of one system */
+    struct Entry
+    {
+        int systemId;
+        quint32 generation;
+    };
+
+    QHash<int, System> systems;
+    QVector<QVector<Entry> > inner;     ///< One tick per slot
+    QVector<QVector<Entry> > outer;     ///< One turn of the inner wheel per slot
+    quint64 currentTick;                ///< Ticks processed since the first heartbeat
+    quint64 startTime;                  ///< Time of tick zero in milliseconds
+    bool started;
+    int timeout;
+    int lostTimeout;
+    quint64 entriesProcessed;
+    QTimer timer;
+
+    /** @brief Deadline of the next state change of a system in milliseconds, 0 if none */
+    quint64 deadline(const System& system) const;
+    /**
+     * @brief Put a check of a system into the slot of its deadline
+     *
+     * @param cascading True while moving entries from the outer to the inner wheel
+     */
+    void schedule(int systemId, const System& system, bool cascading = false);
+    /** @brief Check a system whose slot came up */
+    void check(const Entry& entry, quint64 now);
+};
+
+#endif // QGCHEARTBEATSUPERVISOR_H
@@ -0,0 +1,199 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+
+/**
+ * @file
+ *   @brief Implementation of the encapsulated image transfer reassembly
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#include <cstring>
+#include <QtConcurrentRun>
+
+#include "QGCUASImageTransfer.h"
+#include "QGC.h"
+
+QGCUASImageTransfer::QGCUASImageTransfer(QObject* parent) :
+    QObject(parent),
+    nextFrame(0),
+    lastDelivery(0),
+    frameInterval(0),
+    framesDecoded(0),
+    framesLost(0),
+    packetsExpected(0),
+    packetsMissed(0),
+    imagesRequested(0),
+    timer(this)
+{
+    connect(&timer, SIGNAL(timeout()), this, SLOT(tick()));
+}
+
+void QGCUASImageTransfer::startTransfer(int component, int size, int packets, int payload)
+{
+    if (size <= 0 || packets <= 0 || payload <= 0 || (qint64)packets * payload < size) return;
+
+    // A new capture, packets of an incomplete older image must not be mixed in
+    QMap<int, Transfer>::iterator it = transfers.find(component);
+    if (it != transfers.end())
+    {
+        framesLost++;
+        packetsMissed += it->missing;
+        transfers.erase(it);
+    }
+    pendingRequests.remove(component);
+
+    Transfer transfer;
+    transfer.buffer = QByteArray(size, 0);
+    transfer.received = QBitArray(packets);
+    transfer.payload = payload;
+    transfer.missing = packets;
+    transfer.lastProgress = QGC::groundTimeMilliseconds();
+    transfers.insert(component, transfer);
+    packetsExpected += packets;
+
+    if (!timer.isActive()) timer.start(tickInterval);
+}
+
+bool QGCUASImageTransfer::receivePacket(int component, int seq, const char* data, int length)
+{
+    QMap<int, Transfer>::iterator it = transfers.find(component);
+    if (it == transfers.end() || seq < 0 || seq >= it->received.size()) return false;
+    // Duplicates of a retransmission are expected
+    if (it->received.testBit(seq)) return true;
+
+    int pos = seq * it->payload;
+    int bytes = qMin(qMin(length, it->payload), it->buffer.size() - pos);
+    if (bytes > 0) memcpy(it->buffer.data() + pos, data, bytes);
+
+    it->received.setBit(seq);
+    it->missing--;
+    it->lastProgress = QGC::groundTimeMilliseconds();
+    if (it->missing == 0) decode(component);
+    return true;
+}
+
+QList<int> QGCUASImageTransfer::getMissingPackets(int component) const
+{
+    QList<int> missing;
+    QMap<int, Transfer>::const_iterator it = transfers.constFind(component);
+    if (it == transfers.constEnd()) return missing;
+    for (int i = 0; i < it->received.size(); ++i)
+    {
+        if (!it->received.testBit(i)) missing.append(i);
+    }
+    return missing;
+}
+
+void QGCUASImageTransfer::tick()
+{
+    quint64 now = QGC::groundTimeMilliseconds();
+
+    // Stalled images can not be completed, drop them and ask for a new one
+    QList<int> stalled;
+    QMap<int, Transfer>::iterator it = transfers.begin();
+    while (it != transfers.end())
+    {
+        if (now - it->lastProgress < (quint64)gapTimeout)
+        {
+            ++it;
+            continue;
+        }
+        framesLost++;
+        packetsMissed += it->missing;
+        stalled.append(it.key());
+        it = transfers.erase(it);
+    }
+
+    // Requests the vehicle did not answer
+    QMap<int, quint64>::const_iterator p;
+    for (p = pendingRequests.constBegin(); p != pendingRequests.constEnd(); ++p)
+    {
+        if (now - p.value() >= (quint64)requestTimeout) stalled.append(p.key());
+    }
+
+    foreach (int component, stalled) request(component, now);
+    if (transfers.isEmpty() && pendingRequests.isEmpty()) timer.stop();
+}
+
+void QGCUASImageTransfer::request(int component, quint64 now)
+{
+    int sent = requests.value(component, 0);
+    if (sent >= maxRequests)
+    {
+        // Given up, the next image the vehicle sends on its own starts over
+        requests.remove(component);
+        pendingRequests.remove(component);
+        return;
+    }
+    requests.insert(component, sent + 1);
+    pendingRequests.insert(component, now);
+    imagesRequested++;
+    emit requestImage(component);
+}
+
+void QGCUASImageTransfer::decode(int component)
+{
+    Transfer transfer = transfers.take(component);
+    requests.remove(component);
+    if (transfers.isEmpty() && pendingRequests.isEmpty()) timer.stop();
+
+    QFutureWatcher<QImage>* watcher = new QFutureWatcher<QImage>(this);
+    decoding.insert(watcher, qMakePair(component, nextFrame++));
+    connect(watcher, SIGNAL(finished()), this, SLOT(imageDecoded()));
+    watcher->setFuture(QtConcurrent::run(decodeImage, transfer.buffer));
+}
+
+QImage QGCUASImageTransfer::decodeImage(QByteArray data)
+{
+    return QImage::fromData(data);
+}
+
+void QGCUASImageTransfer::imageDecoded()
+{
+    QFutureWatcher<QImage>* watcher = static_cast<QFutureWatcher<QImage>*>(sender());
+    QPair<int, int> frame = decoding.take(watcher);
+    QImage image = watcher->result();
+    watcher->deleteLater();
+
+    if (image.isNull())
+    {
+        framesLost++;
+        return;
+    }
+    // A newer image of this component was already shown
+    if (lastFrame.contains(frame.first) && lastFrame.value(frame.first) > frame.second) return;
+    lastFrame.insert(frame.first, frame.second);
+
+    quint64 now = QGC::groundTimeMilliseconds();
+    if (lastDelivery > 0)
+    {
+        float interval = now - lastDelivery;
+        frameInterval = (frameInterval > 0) ? 0.875f * frameInterval + 0.125f * interval : interval;
+    }
+    lastDelivery = now;
+    framesDecoded++;
+    emit imageReady(frame.first, image);
+}
@@ -0,0 +1,148 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+
+/**
+ * @file
+ *   @brief Definition of the encapsulated image transfer reassembly
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#ifndef QGCUASIMAGETRANSFER_H
+#define QGCUASIMAGETRANSFER_H
+
+#include <QObject>
+#include <QHash>
+#include <QPair>
+#include <QMap>
+#include <QList>
+#include <QBitArray>
+#include <QByteArray>
+#include <QImage>
+#include <QTimer>
+#include <QFutureWatcher>
+
+/**
+ * @brief Reassembles images sent as DATA_TRANSMISSION_HANDSHAKE and ENCAPSULATED_DATA
+ *
+ * Each component has its own transfer, so several cameras can send at the same
+ * time. Packets may arrive in any order, a bitmap per transfer tracks which
+ * ones are there. The handshake can not address single packets and every
+ * handshake the vehicle answers is a new capture, so an image that makes no
+ * progress for gapTimeout milliseconds is dropped and a new one is requested
+ * with requestImage(). After maxRequests requests without a complete image,
+ * or without any answer within requestTimeout, the component is given up
+ * until the next image. A complete image is decoded in the global thread
+ * pool (QtConcurrent) and emitted with imageReady() in the thread of this
+ * object. Frames that finish decoding after a newer frame of the same
+ * component are dropped.
+ *
+ * The class knows nothing about MAVLink, UAS feeds it the decoded messages.
+ */
+class QGCUASImageTransfer : public QObject
+{
+    Q_OBJECT
+
+public:
+    QGCUASImageTransfer(QObject* parent = 0);
+
+    /**
+     * @brief A handshake announced an image
+     *
+     * The handshake carries no image id, so it always starts a new image.
+     * An incomplete image of the same component is dropped.
+     */
+    void startTransfer(int component, int size, int packets, int payload);
+    /** @brief Store one data packet, returns false if no transfer of the component expects it */
+    bool receivePacket(int component, int seq, const char* data, int length);
+
+    /** @brief True if an image of the component is incomplete */
+    bool isActive(int component) const { return transfers.contains(component); }
+    /** @brief True if an image of any component is incomplete */
+    bool isActive() const { return !transfers.isEmpty(); }
+    /** @brief Missing packets of the image of a component */
+    QList<int> getMissingPackets(int component) const;
+
+    /** @brief Decoded images per second, smoothed over all components */
+    float getFrameRate() const { return (frameInterval > 0) ? 1000.0f / frameInterval : 0.0f; }
+    /** @brief Fraction of announced packets that never arrived */
+    float getLossRate() const { return (packetsExpected > 0) ? (float)packetsMissed / packetsExpected : 0.0f; }
+    quint64 getFramesDecoded() const { return framesDecoded; }
+    /** @brief Images given up, undecodable or superseded by a newer one while incomplete */
+    quint64 getFramesLost() const { return framesLost; }
+    /** @brief Images requested again after a stalled transfer */
+    quint64 getImagesRequested() const { return imagesRequested; }
+
+    static const int gapTimeout = 200;  ///< Milliseconds without a new packet before dropping the image
+    static const int requestTimeout = 1000; ///< Milliseconds to wait for the handshake of a requested image
+    static const int maxRequests = 3;   ///< Requests per component without a complete image before giving up
+
+signals:
+    /** @brief Ask the vehicle of a component for a new image */
+    void requestImage(int component);
+    /** @brief A complete image was decoded, QImage is implicitly shared */
+    void imageReady(int component, QImage image);
+
+protected slots:
+    void tick();
+    /** @brief A decoder of the pool finished */
+    void imageDecoded();
+
+protected:
+    struct Transfer
+    {
+        QByteArray buffer;
+        QBitArray received;
+        int payload;
+        int missing;
+        quint64 lastProgress;   ///< Time of the handshake or the last new packet in milliseconds
+    };
+
+    QMap<int, Transfer> transfers;      ///< Incomplete images by component
+    QMap<int, int> requests;            ///< Images requested by component since its last complete image
+    QMap<int, quint64> pendingRequests; ///< Time of the unanswered request by component in milliseconds
+    QHash<QFutureWatcher<QImage>*, QPair<int, int> > decoding; ///< Component and frame number of running decoders
+    QMap<int, int> lastFrame;           ///< Newest delivered frame by component
+    int nextFrame;
+    quint64 lastDelivery;
+    float frameInterval;                ///< Smoothed time between delivered images in milliseconds
+    quint64 framesDecoded;
+    quint64 framesLost;
+    quint64 packetsExpected;
+    quint64 packetsMissed;
+    quint64 imagesRequested;
+    QTimer timer;
+
+    /** @brief Request a new image of the component, unless it was given up */
+    void request(int component, quint64 now);
+    /** @brief Hand a complete image to the decoder pool */
+    void decode(int component);
+    /** @brief Runs in the pool, a null image if the data is no valid image */
+    static QImage decodeImage(QByteArray data);
+
+    static const int tickInterval = 50;
+};
+
+#endif // QGCUASIMAGETRANSFER_H
@@ -0,0 +1,126 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the on-disk onboard parameter cache
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#include <QDir>
+#include <QFile>
+#include <QDataStream>
+#include <QStringList>
+#include <QDesktopServices>
+#include <QDebug>
+
+#include "QGCUASParamCache.h"
+
+QGCUASParamCache::QGCUASParamCache(const QString& directory) :
+    directory(directory)
+{
+}
+
+QString QGCUASParamCache::defaultDirectory()
+{
+    return QDesktopServices::storageLocation(QDesktopServices::DataLocation) + "/parameters";
+}
+
+QString QGCUASParamCache::fileName(int uas, int component, int autopilot) const
+{
+    return QString("%1/mav%2_comp%3_ap%4.params").arg(directory).arg(uas).arg(component).arg(autopilot);
+}
+
+QList<int> QGCUASParamCache::getComponents(int uas, int autopilot) const
+{
+    QList<int> components;
+    QString prefix = QString("mav%1_comp").arg(uas);
+    QString suffix = QString("_ap%1.params").arg(autopilot);
+    QStringList files = QDir(directory).entryList(QStringList(prefix + "*" + suffix), QDir::Files);
+    foreach (QString file, files)
+    {
+        bool ok;
+        int component = file.mid(prefix.length(), file.length() - prefix.length() - suffix.length()).toInt(&ok);
+        if (ok) components.append(component);
+    }
+    return components;
+}
+
+bool QGCUASParamCache::load(int uas, int component, int autopilot, QVector<QString>* names, QVector<float>* values) const
+{
+    QFile file(fileName(uas, component, autopilot));
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_6);
+    quint32 magic;
+    quint16 version;
+    qint32 fileAutopilot;
+    in >> magic >> version >> fileAutopilot;
+    if (magic != fileMagic || version != fileVersion || fileAutopilot != autopilot) return false;
+
+    QVector<QString> fileNames;
+    QVector<float> fileValues;
+    in >> fileNames >> fileValues;
+    if (in.status() != QDataStream::Ok || fileNames.size() != fileValues.size() || fileNames.isEmpty())
+    {
+        qDebug() << "Ignoring corrupt parameter cache" << file.fileName();
+        return false;
+    }
+
+    *names = fileNames;
+    *values = fileValues;
+    return true;
+}
+
+bool QGCUASParamCache::store(int uas, int component, int autopilot, const QVector<QString>& names, const QVector<float>& values) const
+{
+    if (names.size() != values.size() || names.isEmpty()) return false;
+    if (!QDir().mkpath(directory)) return false;
+
+    // Write to a temporary file first, a crash while writing
+    // must not leave a truncated list behind
+    QString name = fileName(uas, component, autopilot);
+    QFile file(name + ".tmp");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_6);
+    out << fileMagic << fileVersion << (qint32)autopilot << names << values;
+    file.close();
+    if (out.status() != QDataStream::Ok || file.error() != QFile::NoError)
+    {
+        file.remove();
+        return false;
+    }
+
+    QFile::remove(name);
+    return file.rename(name);
+}
+
+void QGCUASParamCache::remove(int uas, int component, int autopilot) const
+{
+    QFile::remove(fileName(uas, component, autopilot));
+}
@@ -0,0 +1,87 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the on-disk onboard parameter cache
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#ifndef QGCUASPARAMCACHE_H
+#define QGCUASPARAMCACHE_H
+
+#include <QString>
+#include <QVector>
+#include <QList>
+
+/**
+ * @brief Stores the last known parameter list of every component on disk
+ *
+ * One file is kept per system, component and autopilot type. It holds the
+ * parameter names in onboard index order and their values. MAVLink reports
+ * neither a vehicle id nor a firmware version, so the key does not tell
+ * two vehicles with the same system id apart. A loaded list is only a
+ * preview until it has been compared against the complete onboard list.
+ *
+ * The cache has no dependency on widgets or the link layer so it can be
+ * tested headless.
+ */
+class QGCUASParamCache
+{
+public:
+    /** @param directory Directory holding the cache files, created on first store */
+    QGCUASParamCache(const QString& directory = defaultDirectory());
+
+    /** @brief Per-user data directory of the application */
+    static QString defaultDirectory();
+
+    QString getDirectory() const { return directory; }
+
+    /** @brief Components of this system with a cached list for this autopilot type */
+    QList<int> getComponents(int uas, int autopilot) const;
+
+    /**
+     * @brief Load the cached list of one component
+     *
+     * @param names Parameter names by onboard index
+     * @param values Parameter values by onboard index
+     * @return True if a valid cache file exists, false if it is missing or corrupt
+     */
+    bool load(int uas, int component, int autopilot, QVector<QString>* names, QVector<float>* values) const;
+    /** @brief Replace the cached list of one component, names and values by onboard index */
+    bool store(int uas, int component, int autopilot, const QVector<QString>& names, const QVector<float>& values) const;
+    /** @brief Drop the cached list of one component */
+    void remove(int uas, int component, int autopilot) const;
+
+protected:
+    QString directory;
+
+    QString fileName(int uas, int component, int autopilot) const;
+
+    static const quint32 fileMagic = 0x51504331; ///< "QPC1"
+    static const quint16 fileVersion = 1;
+};
+
+#endif // QGCUASPARAMCACHE_H
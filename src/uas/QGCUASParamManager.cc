@@ -4,14 +4,16 @@
 QGCUASParamManager::QGCUASParamManager(UASInterface* uas, QWidget *parent) :
     QWidget(parent),
     mav(uas),
-    transmissionListMode(false),
-    transmissionActive(false),
-    transmissionTimeout(0),
     retransmissionTimeout(350),
-    rewriteTimeout(500),
-    retransmissionBurstRequestSize(2)
+    rewriteTimeout(500)
 {
     uas->setParamManager(this);
+
+    // The transfer engine sends all requests and writes
+    connect(&transfer, SIGNAL(requestParameter(int,int)), uas, SLOT(requestParameter(int,int)));
+    connect(&transfer, SIGNAL(writeParameter(int,QString,float)), uas, SLOT(setParameter(int,QString,float)));
+    transfer.setRetransmissionTimeout(retransmissionTimeout);
+    transfer.setRewriteTimeout(rewriteTimeout);
 }
 
 
@@ -4,6 +4,7 @@
 #include <QWidget>
 #include <QMap>
 #include <QTimer>
+#include "QGCUASParamTransfer.h"
 
 class UASInterface;
 
@@ -21,6 +22,8 @@ public:
     void requestParameterListUpdate(int component = 0);
     /** @brief Request an update for this specific parameter */
     virtual void requestParameterUpdate(int component, const QString& parameter) = 0;
+    /** @brief The engine tracking list reads and writes of this system */
+    const QGCUASParamTransfer* getTransfer() const { return &transfer; }
 
 signals:
     void parameterChanged(int component, QString parameter, float value);
@@ -38,16 +41,9 @@ protected:
     QMap<int, QMap<QString, float>* > changedValues; ///< Changed values
     QMap<int, QMap<QString, float>* > parameters; ///< All parameters
     QVector<bool> received; ///< Successfully received parameters
-    QMap<int, QList<int>* > transmissionMissingPackets; ///< Missing packets
-    QMap<int, QMap<QString, float>* > transmissionMissingWriteAckPackets; ///< Missing write ACK packets
-    bool transmissionListMode;       ///< Currently requesting list
-    QMap<int, bool> transmissionListSizeKnown;  ///< List size initialized?
-    bool transmissionActive;         ///< Missing packets, working on list?
-    quint64 transmissionTimeout;     ///< Timeout
-    QTimer retransmissionTimer;      ///< Timer handling parameter retransmission
+    QGCUASParamTransfer transfer; ///< Reliable list reads and writes
     int retransmissionTimeout; ///< Retransmission request timeout, in milliseconds
     int rewriteTimeout; ///< Write request timeout, in milliseconds
-    int retransmissionBurstRequestSize; ///< Number of packets requested for retransmission per burst
 
 };
 
@@ -0,0 +1,514 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the onboard parameter transfer engine
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#include <cmath>
+#include "QGCUASParamTransfer.h"
+#include "QGC.h"
+
+QGCUASParamTransfer::QGCUASParamTransfer(QObject* parent) :
+    QObject(parent),
+    writeTotal(0),
+    writesDone(0),
+    writeBatchStart(0),
+    nextSend(0),
+    active(false),
+    listActive(false),
+    listUnanswered(false),
+    missingCount(0),
+    missingWriteCount(0),
+    failedCount(0),
+    failedWriteCount(0),
+    totalCount(0),
+    inFlightCount(0),
+    burst(initialBurst),
+    srtt(0),
+    rttvar(0),
+    arrivalInterval(0),
+    lossRate(0),
+    initialTimeout(350),
+    initialWriteTimeout(500),
+    retries(0),
+    transferStart(0),
+    lastArrival(0),
+    lastLoss(0),
+    lastTransferTime(0),
+    lastTransferRetries(0)
+{
+    connect(&timer, SIGNAL(timeout()), this, SLOT(tick()));
+}
+
+void QGCUASParamTransfer::setRetransmissionTimeout(int milliseconds)
+{
+    initialTimeout = qMax(milliseconds, minTimeout);
+}
+
+void QGCUASParamTransfer::setRewriteTimeout(int milliseconds)
+{
+    initialWriteTimeout = qMax(milliseconds, minTimeout);
+}
+
+int QGCUASParamTransfer::getRetransmissionTimeout() const
+{
+    if (srtt <= 0) return initialTimeout;
+    return qMax(minTimeout, (int)(srtt + 4 * rttvar));
+}
+
+int QGCUASParamTransfer::getBurstSize() const
+{
+    int size = (int)burst;
+    // More than one round trip worth of parameters in flight only fills queues
+    if (srtt > 0 && arrivalInterval > 0)
+    {
+        size = qMin(size, qMax(1, (int)(srtt / arrivalInterval)));
+    }
+    return qBound(1, size, (int)maxBurst);
+}
+
+float QGCUASParamTransfer::getSendInterval() const
+{
+    if (arrivalInterval > 0) return arrivalInterval;
+    if (srtt > 0) return srtt / getBurstSize();
+    return 0;
+}
+
+float QGCUASParamTransfer::getWriteProgress() const
+{
+    if (writeTotal == 0) return 100.0f;
+    return 100.0f * writesDone / writeTotal;
+}
+
+float QGCUASParamTransfer::getWriteThroughput() const
+{
+    quint64 elapsed = QGC::groundTimeMilliseconds() - writeBatchStart;
+    if (elapsed == 0) return 0;
+    return 1000.0f * (writesDone - failedWriteCount) / elapsed;
+}
+
+/**
+ * A running transfer is extended, its metrics then cover both.
+ */
+void QGCUASParamTransfer::start()
+{
+    if (active) return;
+    active = true;
+    transferStart = QGC::groundTimeMilliseconds();
+    retries = 0;
+    failedCount = 0;
+    failedWriteCount = 0;
+    timer.start(tickInterval);
+}
+
+void QGCUASParamTransfer::startList()
+{
+    // A new list request replaces all previous read state,
+    // only writes stay in flight
+    foreach (const ListState& list, lists)
+    {
+        inFlightCount -= list.inFlight.count(true);
+    }
+    lists.clear();
+    missingCount = 0;
+    totalCount = 0;
+    failedCount = 0;
+    listActive = true;
+    listUnanswered = false;
+    start();
+    transferStart = QGC::groundTimeMilliseconds();
+    lastArrival = transferStart;
+}
+
+void QGCUASParamTransfer::startWrite(int component, const QString& name, float value)
+{
+    if (missingWriteCount == 0)
+    {
+        // New batch
+        writeTotal = 0;
+        writesDone = 0;
+        writeBatchStart = QGC::groundTimeMilliseconds();
+    }
+
+    WriteKey key;
+    key.component = component;
+    key.name = name;
+    key.sentAt = 0;
+
+    QHash<QString, WriteState>& pending = writes[component];
+    QHash<QString, WriteState>::iterator i = pending.find(name);
+    if (i == pending.end())
+    {
+        WriteState write;
+        write.value = value;
+        write.sentAt = 0;
+        write.attempts = 0;
+        pending.insert(name, write);
+        sendQueue.append(key);
+        missingWriteCount++;
+        writeTotal++;
+    }
+    else
+    {
+        // Still pending, only the value changes. If the old value
+        // is in flight, the new one is sent again.
+        i.value().value = value;
+        if (i.value().sentAt != 0)
+        {
+            i.value().sentAt = 0;
+            inFlightCount--;
+            sendQueue.append(key);
+        }
+    }
+    start();
+}
+
+void QGCUASParamTransfer::abort()
+{
+    timer.stop();
+    lists.clear();
+    writes.clear();
+    sendQueue.clear();
+    writesInFlight.clear();
+    active = false;
+    listActive = false;
+    missingCount = 0;
+    missingWriteCount = 0;
+    totalCount = 0;
+    inFlightCount = 0;
+}
+
+QGCUASParamTransfer::ReceiveResult QGCUASParamTransfer::receiveParameter(int component, int paramCount, int paramId, const QString& name, float value, float* written)
+{
+    quint64 now = QGC::groundTimeMilliseconds();
+    ReceiveResult result = PARAM_UNEXPECTED;
+    bool answered = false;
+
+    // Echo of a write. Only a write already sent can be echoed, a queued
+    // write of the same parameter stays queued
+    QMap<int, QHash<QString, WriteState> >::iterator w = writes.find(component);
+    if (w != writes.end() && w.value().contains(name) && w.value().value(name).sentAt != 0)
+    {
+        WriteState write = w.value().take(name);
+        if (w.value().isEmpty()) writes.erase(w);
+        missingWriteCount--;
+        inFlightCount--;
+        answered = true;
+        if (write.attempts == 1) measureRoundTrip(write.sentAt, now);
+        // Echoes arriving back to back while more writes are in
+        // flight measure the link throughput
+        if (inFlightCount > 0 && lastArrival != 0)
+        {
+            float interval = now - lastArrival;
+            arrivalInterval = (arrivalInterval <= 0) ? interval : 0.875f * arrivalInterval + 0.125f * interval;
+        }
+        lastArrival = now;
+        if (written) *written = write.value;
+        writeDone();
+        result = (write.value == value) ? PARAM_WRITTEN : PARAM_WRITE_MISMATCH;
+    }
+
+    // Part of a list
+    if (listActive && paramId >= 0 && paramId < paramCount)
+    {
+        QMap<int, ListState>::iterator i = lists.find(component);
+        if (i == lists.end() || i.value().received.size() != paramCount)
+        {
+            if (i != lists.end())
+            {
+                // The list changed size, start over for this component
+                const ListState& old = i.value();
+                missingCount -= old.received.size() - old.received.count(true) - old.failed.count(true);
+                failedCount -= old.failed.count(true);
+                totalCount -= old.received.size();
+                inFlightCount -= old.inFlight.count(true);
+            }
+            ListState list;
+            list.received = QBitArray(paramCount);
+            list.inFlight = QBitArray(paramCount);
+            list.failed = QBitArray(paramCount);
+            list.sentAt = QVector<quint64>(paramCount, 0);
+            list.attempts = QVector<quint8>(paramCount, 0);
+            list.next = 0;
+            i = lists.insert(component, list);
+            missingCount += paramCount;
+            totalCount += paramCount;
+        }
+
+        ListState& list = i.value();
+        if (!list.received.testBit(paramId))
+        {
+            list.received.setBit(paramId);
+            if (list.failed.testBit(paramId))
+            {
+                // Arrived after it was given up
+                list.failed.clearBit(paramId);
+                failedCount--;
+            }
+            else
+            {
+                missingCount--;
+            }
+
+            if (list.inFlight.testBit(paramId))
+            {
+                list.inFlight.clearBit(paramId);
+                inFlightCount--;
+                answered = true;
+                if (list.attempts[paramId] == 1) measureRoundTrip(list.sentAt[paramId], now);
+            }
+            else if (list.attempts[paramId] == 0)
+            {
+                // Streamed by the vehicle, measures the link throughput
+                float interval = now - lastArrival;
+                arrivalInterval = (arrivalInterval <= 0) ? interval : 0.875f * arrivalInterval + 0.125f * interval;
+            }
+            if (result == PARAM_UNEXPECTED) result = PARAM_RECEIVED;
+        }
+        lastArrival = now;
+    }
+
+    if (answered)
+    {
+        requestAnswered();
+        fill(now);
+    }
+    finishIfDone(now);
+    return result;
+}
+
+void QGCUASParamTransfer::tick()
+{
+    quint64 now = QGC::groundTimeMilliseconds();
+    int timeout = getRetransmissionTimeout();
+    int writeTimeout = (srtt > 0) ? timeout : initialWriteTimeout;
+    bool lost = false;
+
+    if (listActive && lists.isEmpty() && now - transferStart > (quint64)listStartTimeout)
+    {
+        // The vehicle did not answer the list request at all
+        listActive = false;
+        listUnanswered = true;
+    }
+
+    // Requests that timed out
+    for (QMap<int, ListState>::iterator i = lists.begin(); i != lists.end() && inFlightCount > 0; ++i)
+    {
+        ListState& list = i.value();
+        for (int id = list.next; id < list.received.size(); ++id)
+        {
+            if (list.inFlight.testBit(id) && now - list.sentAt[id] > (quint64)timeout)
+            {
+                list.inFlight.clearBit(id);
+                inFlightCount--;
+                lossRate = 0.875f * lossRate + 0.125f;
+                lost = true;
+                if (list.attempts[id] >= maxAttempts)
+                {
+                    list.failed.setBit(id);
+                    failedCount++;
+                    missingCount--;
+                }
+            }
+        }
+    }
+
+    // Writes that timed out, the oldest are at the front
+    while (!writesInFlight.isEmpty())
+    {
+        const WriteKey& key = writesInFlight.first();
+        WriteState* write = findWrite(key);
+        if (write && write->sentAt == key.sentAt)
+        {
+            if (now - key.sentAt <= (quint64)writeTimeout) break;
+
+            write->sentAt = 0;
+            inFlightCount--;
+            lossRate = 0.875f * lossRate + 0.125f;
+            lost = true;
+            if (write->attempts >= maxAttempts)
+            {
+                QHash<QString, WriteState>& pending = writes[key.component];
+                pending.remove(key.name);
+                if (pending.isEmpty()) writes.remove(key.component);
+                failedWriteCount++;
+                missingWriteCount--;
+                writeDone();
+            }
+            else
+            {
+                // Repeat it before the writes not yet sent
+                WriteKey repeat = key;
+                repeat.sentAt = 0;
+                sendQueue.prepend(repeat);
+            }
+        }
+        writesInFlight.removeFirst();
+    }
+
+    if (lost) requestLost(now);
+    fill(now);
+    finishIfDone(now);
+}
+
+void QGCUASParamTransfer::fill(quint64 now)
+{
+    int budget = getBurstSize() - inFlightCount;
+
+    // Writes first, the user is waiting for them
+    while (budget > 0 && !sendQueue.isEmpty())
+    {
+        WriteState* write = findWrite(sendQueue.first());
+        if (!write || write->sentAt != 0)
+        {
+            // Echoed or sent in the meantime
+            sendQueue.removeFirst();
+            continue;
+        }
+        if (!pace(now)) return;
+
+        WriteKey key = sendQueue.takeFirst();
+        emit writeParameter(key.component, key.name, write->value);
+        write->sentAt = now;
+        if (write->attempts > 0) retries++;
+        write->attempts++;
+        inFlightCount++;
+        budget--;
+        key.sentAt = now;
+        writesInFlight.append(key);
+    }
+
+    // Do not request parameters the vehicle is still streaming
+    if (listActive && now - lastArrival < (quint64)getRetransmissionTimeout()) return;
+
+    for (QMap<int, ListState>::iterator i = lists.begin(); i != lists.end() && budget > 0; ++i)
+    {
+        ListState& list = i.value();
+        const int count = list.received.size();
+        while (list.next < count && (list.received.testBit(list.next) || list.failed.testBit(list.next)))
+        {
+            list.next++;
+        }
+
+        for (int id = list.next; id < count && budget > 0; ++id)
+        {
+            if (list.received.testBit(id) || list.failed.testBit(id) || list.inFlight.testBit(id)) continue;
+            if (!pace(now)) return;
+            emit requestParameter(i.key(), id);
+            list.inFlight.setBit(id);
+            list.sentAt[id] = now;
+            list.attempts[id]++;
+            retries++;
+            inFlightCount++;
+            budget--;
+        }
+    }
+}
+
+QGCUASParamTransfer::WriteState* QGCUASParamTransfer::findWrite(const WriteKey& key)
+{
+    QMap<int, QHash<QString, WriteState> >::iterator i = writes.find(key.component);
+    if (i == writes.end()) return NULL;
+    QHash<QString, WriteState>::iterator j = i.value().find(key.name);
+    if (j == i.value().end()) return NULL;
+    return &j.value();
+}
+
+void QGCUASParamTransfer::writeDone()
+{
+    writesDone++;
+    emit writeProgress(writesDone, writeTotal);
+}
+
+/**
+ * Unused send time of up to one tick is kept, so the rate is met although
+ * the engine only runs every tickInterval milliseconds.
+ */
+bool QGCUASParamTransfer::pace(quint64 now)
+{
+    float interval = getSendInterval();
+    if (interval <= 0) return true;
+    if (nextSend > now) return false;
+    nextSend = qMax(nextSend, (double)now - tickInterval) + interval;
+    return true;
+}
+
+/**
+ * List transfers end one retransmission timeout after the last parameter
+ * arrived, so components that start streaming late are still tracked.
+ */
+void QGCUASParamTransfer::finishIfDone(quint64 now)
+{
+    if (!active) return;
+    if (missingCount > 0 || missingWriteCount > 0) return;
+    if (listActive && (lists.isEmpty() || now - lastArrival < (quint64)getRetransmissionTimeout())) return;
+
+    timer.stop();
+    active = false;
+    listActive = false;
+    lastTransferTime = now - transferStart;
+    lastTransferRetries = retries;
+    emit transferFinished(listUnanswered ? -1 : failedCount, failedWriteCount);
+    listUnanswered = false;
+}
+
+/**
+ * Only requests answered on the first attempt are measured, the answer to a
+ * repeated request can not be attributed to one of them (Karn's algorithm).
+ */
+void QGCUASParamTransfer::measureRoundTrip(quint64 sentAt, quint64 now)
+{
+    float sample = qMax((quint64)1, now - sentAt);
+    if (srtt <= 0)
+    {
+        srtt = sample;
+        rttvar = sample / 2;
+    }
+    else
+    {
+        rttvar = 0.75f * rttvar + 0.25f * fabs(srtt - sample);
+        srtt = 0.875f * srtt + 0.125f * sample;
+    }
+}
+
+void QGCUASParamTransfer::requestAnswered()
+{
+    lossRate *= 0.875f;
+    // Additive increase, one more per burst answered
+    burst = qMin((float)maxBurst, burst + 1.0f / burst);
+}
+
+void QGCUASParamTransfer::requestLost(quint64 now)
+{
+    // Multiplicative decrease, at most once per round trip
+    if (now - lastLoss > (quint64)getRetransmissionTimeout())
+    {
+        burst = qMax(1.0f, burst / 2);
+        lastLoss = now;
+    }
+}
@@ -0,0 +1,238 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the onboard parameter transfer engine
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#ifndef QGCUASPARAMTRANSFER_H
+#define QGCUASPARAMTRANSFER_H
+
+#include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QVector>
+#include <QBitArray>
+#include <QString>
+#include <QTimer>
+
+/**
+ * @brief Reliable parameter list reads and parameter writes over a lossy link
+ *
+ * After a list request the vehicle streams all parameters on its own. The
+ * engine learns the list size of each component from the first PARAM_VALUE
+ * and marks received parameters in a bitset. Once the stream pauses, missing
+ * parameters are requested by index. Writes are repeated until the vehicle
+ * echoes the parameter.
+ *
+ * Writes are sent in the order they were started. A write of a parameter that
+ * is still pending replaces the value instead of queueing a second write. All
+ * bookkeeping per sent write and per echo is constant time, so writing a whole
+ * parameter file does not slow down with its size.
+ *
+ * Requests and writes in flight are limited to the burst size. The burst grows
+ * by one per round trip without loss and is halved on a timeout. It is capped
+ * at the number of parameters that arrive within one round trip. The timeout
+ * follows the measured round trip time (Jacobson/Karn). A parameter that is
+ * still missing after maxAttempts requests is given up. Sends are additionally
+ * paced to the measured link capacity, the interval at which the vehicle
+ * streams parameters or, before that is known, one round trip per burst.
+ *
+ * The engine does not send anything itself, it emits requestParameter() and
+ * writeParameter(). It is independent of widgets and the UAS class.
+ */
+class QGCUASParamTransfer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @brief What a received parameter meant to the current transfer */
+    enum ReceiveResult
+    {
+        PARAM_UNEXPECTED,    ///< No transfer was waiting for it
+        PARAM_RECEIVED,      ///< Part of a list transfer
+        PARAM_WRITTEN,       ///< Echo of a write with the written value
+        PARAM_WRITE_MISMATCH ///< Echo of a write with a different value
+    };
+
+    QGCUASParamTransfer(QObject* parent = 0);
+
+    /** @brief A parameter list request was sent, track the list of every component */
+    void startList();
+    /** @brief Write a parameter and wait for the echo */
+    void startWrite(int component, const QString& name, float value);
+    /**
+     * @brief Account for a received PARAM_VALUE
+     *
+     * @param written Set to the value that was written if the result is a write echo
+     */
+    ReceiveResult receiveParameter(int component, int paramCount, int paramId, const QString& name, float value, float* written = NULL);
+    /** @brief Forget all outstanding reads and writes */
+    void abort();
+
+    bool isActive() const { return active; }
+    bool isListActive() const { return listActive; }
+    /** @brief Parameters of the list not yet received */
+    int getMissingCount() const { return missingCount; }
+    /** @brief Writes not yet echoed */
+    int getMissingWriteCount() const { return missingWriteCount; }
+    /** @brief Size of all lists of the current transfer */
+    int getTotalCount() const { return totalCount; }
+    /** @brief Requests and writes currently allowed in flight */
+    int getBurstSize() const;
+    /** @brief Smoothed round trip time in milliseconds, 0 before the first measurement */
+    int getRoundTripTime() const { return (int)srtt; }
+    /** @brief Fraction of requests and writes that timed out, smoothed */
+    float getLossRate() const { return lossRate; }
+    /** @brief Current timeout for requests and writes in milliseconds */
+    int getRetransmissionTimeout() const;
+    /** @brief Requests and rewrites sent during the current transfer */
+    int getRetries() const { return retries; }
+    /** @brief Duration of the last finished transfer in milliseconds */
+    quint64 getLastTransferTime() const { return lastTransferTime; }
+    /** @brief Requests and rewrites the last finished transfer needed */
+    int getLastTransferRetries() const { return lastTransferRetries; }
+    /** @brief Writes started since no write was pending */
+    int getWriteTotal() const { return writeTotal; }
+    /** @brief Writes of the current batch echoed or given up */
+    int getWritesDone() const { return writesDone; }
+    /** @brief Progress of the current write batch in percent */
+    float getWriteProgress() const;
+    /** @brief Echoed writes per second of the current write batch */
+    float getWriteThroughput() const;
+    /** @brief Minimum time between two sends in milliseconds, 0 if not paced */
+    float getSendInterval() const;
+
+    static const int maxAttempts = 10;    ///< Requests per parameter before giving up
+    static const int initialBurst = 4;
+    static const int maxBurst = 32;
+    static const int minTimeout = 50;     ///< Lower bound of the retransmission timeout in milliseconds
+    static const int listStartTimeout = 5000; ///< Give up a list request without any answer after this many milliseconds
+
+public slots:
+    /** @brief Read timeout before the first round trip time measurement, in milliseconds */
+    void setRetransmissionTimeout(int milliseconds);
+    /** @brief Write timeout before the first round trip time measurement, in milliseconds */
+    void setRewriteTimeout(int milliseconds);
+
+signals:
+    /** @brief Request one parameter by onboard index */
+    void requestParameter(int component, int index);
+    /** @brief Send one parameter value */
+    void writeParameter(int component, QString name, float value);
+    /** @brief A write of the current batch was echoed or given up */
+    void writeProgress(int done, int total);
+    /**
+     * @brief All reads and writes are done
+     *
+     * @param missingRead Parameters given up, -1 if a list request was not answered at all
+     * @param missingWrite Writes given up
+     */
+    void transferFinished(int missingRead, int missingWrite);
+
+protected slots:
+    /** @brief Handle timeouts and fill the burst */
+    void tick();
+
+protected:
+    /** @brief Read state of the list of one component */
+    struct ListState
+    {
+        QBitArray received;      ///< Parameter is known
+        QBitArray inFlight;      ///< Request sent and not yet timed out
+        QBitArray failed;        ///< Given up after maxAttempts requests
+        QVector<quint64> sentAt; ///< Time of the last request in milliseconds
+        QVector<quint8> attempts; ///< Requests sent for this index
+        int next;                ///< Lowest index that may still be missing
+    };
+
+    /** @brief State of one outstanding write */
+    struct WriteState
+    {
+        float value;
+        quint64 sentAt;          ///< Time of the last send in milliseconds, 0 if not yet sent
+        int attempts;
+    };
+
+    /** @brief Identifies a write in the send and in-flight queues */
+    struct WriteKey
+    {
+        int component;
+        QString name;
+        quint64 sentAt;          ///< Send time this in-flight entry refers to
+    };
+
+    QMap<int, ListState> lists;             ///< By component
+    QMap<int, QHash<QString, WriteState> > writes; ///< By component and parameter name
+    QList<WriteKey> sendQueue;              ///< Writes waiting to be sent, oldest first
+    QList<WriteKey> writesInFlight;         ///< Sent writes, oldest first, entries of echoed or resent writes are skipped
+    int writeTotal;
+    int writesDone;
+    quint64 writeBatchStart;
+    double nextSend;          ///< Earliest time of the next send in milliseconds
+    bool active;
+    bool listActive;
+    bool listUnanswered;      ///< The last list request timed out without any answer
+    int missingCount;
+    int missingWriteCount;
+    int failedCount;          ///< Reads given up in this transfer
+    int failedWriteCount;     ///< Writes given up in this transfer
+    int totalCount;
+    int inFlightCount;        ///< Reads and writes in flight
+    float burst;              ///< Congestion window, fractional for additive increase
+    float srtt;               ///< Smoothed round trip time in milliseconds
+    float rttvar;             ///< Round trip time variation in milliseconds
+    float arrivalInterval;    ///< Smoothed time between streamed parameters in milliseconds
+    float lossRate;
+    int initialTimeout;
+    int initialWriteTimeout;
+    int retries;
+    quint64 transferStart;
+    quint64 lastArrival;
+    quint64 lastLoss;         ///< Time of the last burst reduction, one per round trip
+    quint64 lastTransferTime;
+    int lastTransferRetries;
+    QTimer timer;
+
+    void start();
+    /** @brief The pending write of a key, NULL if it was echoed or given up */
+    WriteState* findWrite(const WriteKey& key);
+    /** @brief A write of the batch is done, successfully or not */
+    void writeDone();
+    /** @brief True if pacing allows one more send now, accounts for it */
+    bool pace(quint64 now);
+    /** @brief Send requests and writes until the burst is full */
+    void fill(quint64 now);
+    void finishIfDone(quint64 now);
+    void measureRoundTrip(quint64 sentAt, quint64 now);
+    void requestAnswered();
+    void requestLost(quint64 now);
+
+    static const int tickInterval = 20;
+};
+
+#endif // QGCUASPARAMTRANSFER_H
@@ -45,9 +45,12 @@ warnLevelPercent(20.0f),
 currentVoltage(12.0f),
 lpVoltage(12.0f),
 batteryRemainingEstimateEnabled(false),
+chargeLevel(0),
+timeRemaining(0),
 mode(-1),
 status(-1),
 navMode(-1),
+thrust(0),
 onboardTimeOffset(0),
 controlRollManual(true),
 controlPitchManual(true),
@@ -70,7 +73,7 @@ altitude(0.0),
 roll(0.0),
 pitch(0.0),
 yaw(0.0),
-statusTimeout(new QTimer(this)),
+lastPositionLock(0),
 paramsOnceRequested(false),
 airframe(0),
 attitudeKnown(false),
@@ -78,9 +81,9 @@ paramManager(NULL)
 {
     color = UASInterface::getNextColor();
     setBattery(LIPOLY, 3);
-    connect(statusTimeout, SIGNAL(timeout()), this, SLOT(updateState()));
+    connect(&imageTransfer, SIGNAL(imageReady(int,QImage)), this, SLOT(receiveImage(int,QImage)));
+    connect(&imageTransfer, SIGNAL(requestImage(int)), this, SLOT(requestNewImage(int)));
     connect(this, SIGNAL(systemSpecsChanged(int)), this, SLOT(writeSettings()));
-    statusTimeout->start(500);
     readSettings();
 }
 
@@ -122,29 +125,23 @@ int UAS::getUASID() const
     return uasId;
 }
 
-void UAS::updateState()
+void UAS::setHeartbeatState(int state, quint64 elapsed)
 {
-    // Check if heartbeat timed out
-    quint64 heartbeatInterval = QGC::groundTimeUsecs() - lastHeartbeat;
-    if (heartbeatInterval > timeoutIntervalHeartbeat)
+    if (state != QGCHeartbeatSupervisor::HEARTBEAT_ALIVE)
     {
-        emit heartbeatTimeout(heartbeatInterval);
+        emit heartbeatTimeout(elapsed);
         emit heartbeatTimeout();
     }
+}
 
-    // Position lock is set by the MAVLink message handler
-    // if no position lock is available, indicate an error
-    if (positionLock)
-    {
-        positionLock = false;
-    }
-    else
-    {
-        if (mode > (uint8_t)MAV_MODE_LOCKED && positionLock)
-        {
-            GAudioOutput::instance()->notifyNegative();
-        }
-    }
+bool UAS::updatePositionLock()
+{
+    // The lock counts as lost if no position arrived for positionLockTimeout
+    quint64 now = QGC::groundTimeMilliseconds();
+    bool acquired = !positionLock || now - lastPositionLock > positionLockTimeout;
+    positionLock = true;
+    lastPositionLock = now;
+    return acquired;
 }
 
 void UAS::setSelected()
@@ -235,6 +232,8 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             break;
         case MAVLINK_MSG_ID_BOOT:
             getStatusForCode((int)MAV_STATE_BOOT, uasState, stateDescription);
+            shortStateText = uasState;
+            stateDescriptionText = stateDescription;
             emit statusChanged(this, uasState, stateDescription);
             onboardTimeOffset = 0; // Reset offset measurement
             break;
@@ -257,6 +256,8 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                     statechanged = true;
                     this->status = state.status;
                     getStatusForCode((int)state.status, uasState, stateDescription);
+                    shortStateText = uasState;
+                    stateDescriptionText = stateDescription;
                     emit statusChanged(this, uasState, stateDescription);
                     emit statusChanged(this->status);
                     stateAudio = " changed status to " + uasState;
@@ -264,7 +265,8 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
 
                 if (navMode != state.nav_mode)
                 {
-                    emit navModeChanged(uasId, state.nav_mode, getNavModeText(state.nav_mode));
+                    shortNavModeText = getNavModeText(state.nav_mode);
+                    emit navModeChanged(uasId, state.nav_mode, shortNavModeText);
                     navMode = state.nav_mode;
                 }
 
@@ -311,6 +313,7 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                         break;
                     }
 
+                    shortModeText = mode;
                     emit modeChanged(this->getUASID(), mode, "");
                     modeAudio = " is now in " + mode;
                 }
@@ -475,7 +478,8 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 emit valueChanged(uasId, "heading", "deg", hud.heading, time);
                 emit valueChanged(uasId, "climbrate", "m/s", hud.climb, time);
                 emit valueChanged(uasId, "throttle", "%", hud.throttle, time);
-                emit thrustChanged(this, hud.throttle/100.0);
+                thrust = hud.throttle/100.0;
+                emit thrustChanged(this, thrust);
 
                 if (!attitudeKnown)
                 {
@@ -529,12 +533,11 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
 
                 //emit attitudeChanged(this, pos.roll, pos.pitch, pos.yaw, time);
                 // Set internal state
-                if (!positionLock)
+                if (updatePositionLock())
                 {
                     // If position was not locked before, notify positive
                     GAudioOutput::instance()->notifyPositive();
                 }
-                positionLock = true;
             }
             break;
         case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
@@ -558,12 +561,11 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 emit globalPositionChanged(this, latitude, longitude, altitude, time);
                 emit speedChanged(this, speedX, speedY, speedZ, time);
                 // Set internal state
-                if (!positionLock)
+                if (updatePositionLock())
                 {
                     // If position was not locked before, notify positive
                     GAudioOutput::instance()->notifyPositive();
                 }
-                positionLock = true;
                 //TODO fix this hack for forwarding of global position for patch antenna tracking
                 forwardMessage(message);
             }
@@ -587,12 +589,11 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 emit globalPositionChanged(this, latitude, longitude, altitude, time);
                 emit speedChanged(this, speedX, speedY, speedZ, time);
                 // Set internal state
-                if (!positionLock)
+                if (updatePositionLock())
                 {
                     // If position was not locked before, notify positive
                     GAudioOutput::instance()->notifyPositive();
                 }
-                positionLock = true;
                 //TODO fix this hack for forwarding of global position for patch antenna tracking
                 forwardMessage(message);
             }
@@ -619,7 +620,7 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                     latitude = pos.lat;
                     longitude = pos.lon;
                     altitude = pos.alt;
-                    positionLock = true;
+                    updatePositionLock();
 
                     // Check for NaN
                     int alt = pos.alt;
@@ -663,7 +664,7 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                     latitude = pos.lat/(double)1E7;
                     longitude = pos.lon/(double)1E7;
                     altitude = pos.alt/1000.0;
-                    positionLock = true;
+                    updatePositionLock();
 
                     // Check for NaN
                     int alt = pos.alt;
@@ -908,14 +909,9 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
 #ifdef MAVLINK_ENABLED_PIXHAWK
         case MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE:
             {
-                qDebug() << "RECIEVED ACK TO GET IMAGE";
                 mavlink_data_transmission_handshake_t p;
                 mavlink_msg_data_transmission_handshake_decode(&message, &p);
-                imageSize = p.size;
-                imagePackets = p.packets;
-                imagePayload = p.payload;
-                imageQuality = p.jpg_quality;
-                imageStart = QGC::groundTimeMilliseconds();
+                imageTransfer.startTransfer(message.compid, p.size, p.packets, p.payload);
             }
             break;
 
@@ -923,31 +919,7 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             {
                 mavlink_encapsulated_data_t img;
                 mavlink_msg_encapsulated_data_decode(&message, &img);
-                int seq = img.seqnr;
-                int pos = seq * imagePayload;
-
-                for (int i = 0; i < imagePayload; ++i)
-                {
-                    if (pos <= imageSize)
-                    {
-                        imageRecBuffer[pos] = img.data[i];
-                    }
-                    ++pos;
-                }
-
-                ++imagePacketsArrived;
-
-                // emit signal if all packets arrived
-                if ((imagePacketsArrived == imagePackets))
-                {
-                    image.loadFromData(imageRecBuffer);
-                    emit imageReady(this);
-                    // Restart statemachine
-                    imagePacketsArrived = 0;
-
-                    //this->requestImage();
-                    //qDebug() << "SENDING REQUEST TO GET NEW IMAGE FROM SYSTEM" << uasId;
-                }
+                imageTransfer.receivePacket(message.compid, img.seqnr, (const char*)img.data, sizeof(img.data));
             }
             break;
 #endif
@@ -1387,26 +1359,34 @@ QImage UAS::getImage()
 
 void UAS::requestImage()
 {
-    #ifdef MAVLINK_ENABLED_PIXHAWK
-    qDebug() << "trying to get an image from the uas...";
-
-    if (imagePacketsArrived == 0)
+#ifdef MAVLINK_ENABLED_PIXHAWK
+    // Stalled images are requested again by the image transfer, do not restart it
+    if (!imageTransfer.isActive())
     {
+        qDebug() << "trying to get an image from the uas...";
         mavlink_message_t msg;
         mavlink_msg_data_transmission_handshake_pack(mavlink->getSystemId(), mavlink->getComponentId(), &msg, DATA_TYPE_JPEG_IMAGE, 0, 0, 0, 50);
         sendMessage(msg);
     }
-    else if (QGC::groundTimeMilliseconds() - imageStart >= 1000)
-    {
-        // handshake happened more than 1 second ago, packets should have arrived by now
-        // maybe we missed some packets (dropped along the way)
-        image.loadFromData(imageRecBuffer);
-        emit imageReady(this);
-        // Restart statemachine
-        imagePacketsArrived = 0;
-    }
 #endif
-    // default else, wait?
+}
+
+void UAS::requestNewImage(int component)
+{
+    Q_UNUSED(component);
+#ifdef MAVLINK_ENABLED_PIXHAWK
+    // The handshake can not address single packets, it starts a new capture
+    mavlink_message_t msg;
+    mavlink_msg_data_transmission_handshake_pack(mavlink->getSystemId(), mavlink->getComponentId(), &msg, DATA_TYPE_JPEG_IMAGE, 0, 0, 0, 50);
+    sendMessage(msg);
+#endif
+}
+
+void UAS::receiveImage(int component, QImage image)
+{
+    this->image = image;
+    emit imageReceived(component, image);
+    emit imageReady(this);
 }
 
 
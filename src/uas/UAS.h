@@ -36,6 +36,7 @@ This file is part of the QGROUNDCONTROL project
 #include "MG.h"
 #include <MAVLinkProtocol.h>
 #include "QGCMAVLink.h"
+#include "QGCUASImageTransfer.h"
 
 /**
  * @brief A generic MAVLINK-connected MAV/UAV
@@ -63,6 +64,7 @@ public:
 
     static const int lipoFull = 4.2f;  ///< 100% charged voltage
     static const int lipoEmpty = 3.5f; ///< Discharged voltage
+    static const unsigned int positionLockTimeout = 500; ///< Position lock is lost after this many milliseconds without position
 
     /* MANAGEMENT */
 
@@ -93,6 +95,13 @@ public:
     double getYaw() const { return yaw; }
     bool getSelected() const;
 
+    QString getShortState() const { return shortStateText; }
+    QString getStateDescription() const { return stateDescriptionText; }
+    QString getShortMode() const { return shortModeText; }
+    QString getShortNavMode() const { return shortNavModeText; }
+    int getTimeRemaining() const { return timeRemaining; }
+    double getThrust() const { return thrust; }
+
 friend class UASWaypointManager;
 
 protected: //COMMENTS FOR TEST UNIT
@@ -133,6 +142,11 @@ protected: //COMMENTS FOR TEST UNIT
     int mode;                   ///< The current mode of the MAV
     int status;                 ///< The current status of the MAV
     int navMode;                ///< The current navigation mode of the MAV
+    QString shortStateText;     ///< Text of the current status
+    QString stateDescriptionText; ///< Description of the current status
+    QString shortModeText;      ///< Text of the current mode
+    QString shortNavModeText;   ///< Text of the current navigation mode
+    double thrust;              ///< Current thrust: 0 - 1.0 for 100% thrust
     quint64 onboardTimeOffset;
 
     bool controlRollManual;     ///< status flag, true if roll is controlled manually
@@ -161,16 +175,10 @@ protected: //COMMENTS FOR TEST UNIT
     double pitch;
     double yaw;
     quint64 lastHeartbeat;      ///< Time of the last heartbeat message
-    QTimer* statusTimeout;      ///< Timer for various status timeouts
-
-    int imageSize;              ///< Image size being transmitted (bytes)
-    int imagePackets;           ///< Number of data packets being sent for this image
-    int imagePacketsArrived;    ///< Number of data packets recieved
-    int imagePayload;           ///< Payload size per transmitted packet (bytes). Standard is 254, and decreases when image resolution increases.
-    int imageQuality;           ///< JPEG-Quality of the transmitted image (percentage)
-    QByteArray imageRecBuffer;  ///< Buffer for the incoming bytestream
+    quint64 lastPositionLock;   ///< Time of the last position message in milliseconds
+
+    QGCUASImageTransfer imageTransfer; ///< Reassembly and decoding of encapsulated images
     QImage image;               ///< Image data of last completely transmitted image
-    quint64 imageStart;
 
     QMap<int, QMap<QString, float>* > parameters; ///< All parameters
     bool paramsOnceRequested;   ///< If the parameter list has been read at least once
@@ -200,7 +208,9 @@ public:
     void setParamManager(QGCUASParamManager* manager) { paramManager = manager; }
     int getSystemType();
     QImage getImage();
-    void requestImage(); // ?
+    /** @brief Request an image if none is being transmitted */
+    void requestImage();
+    QGCUASImageTransfer* getImageTransfer() { return &imageTransfer; }
     int getAutopilotType() {return autopilot;}
 
 public slots:
@@ -314,8 +324,8 @@ public slots:
     void enableExtra2Transmission(int rate);
     void enableExtra3Transmission(int rate);
 
-    /** @brief Update the system state */
-    void updateState();
+    /** @brief Heartbeat state transition detected by the UASManager, see QGCHeartbeatSupervisor */
+    void setHeartbeatState(int state, quint64 elapsed);
 
     /** @brief Set world frame origin at current GPS position */
     void setLocalOriginAtCurrentGPSPosition();
@@ -351,6 +361,8 @@ signals:
     void imageStarted(quint64 timestamp);
     /** @brief A new camera image has arrived */
     void imageReady(UASInterface* uas);
+    /** @brief A new camera image of a component has arrived, QImage is implicitly shared */
+    void imageReceived(int component, QImage image);
 
     protected:
     /** @brief Get the UNIX timestamp in milliseconds */
@@ -365,6 +377,12 @@ protected slots:
     // MESSAGE RECEPTION
     /** @brief Receive a named value message */
     void receiveMessageNamedValue(const mavlink_message_t& message);
+    /** @brief Mark the position as locked, returns true if it was not locked before */
+    bool updatePositionLock();
+    /** @brief Store and propagate a decoded image */
+    void receiveImage(int component, QImage image);
+    /** @brief Ask for a new image after the transfer of the last one stalled */
+    void requestNewImage(int component);
 };
 
 
@@ -81,6 +81,21 @@ public:
 
     virtual bool getSelected() const = 0;
 
+    /** @brief Short text of the current state, empty before the first status **/
+    virtual QString getShortState() const = 0;
+    /** @brief Description of the current state **/
+    virtual QString getStateDescription() const = 0;
+    /** @brief Short text of the current mode, empty before the first status **/
+    virtual QString getShortMode() const = 0;
+    /** @brief Text of the current navigation mode, empty before the first status **/
+    virtual QString getShortNavMode() const = 0;
+    /** @brief Get the current charge level in percent **/
+    virtual float getChargeLevel() = 0;
+    /** @brief Estimated remaining flight time in seconds **/
+    virtual int getTimeRemaining() const = 0;
+    /** @brief Current thrust: 0 - 1.0 for 100% thrust **/
+    virtual double getThrust() const = 0;
+
     /** @brief Set the airframe of this MAV */
     virtual int getAirframe() const = 0;
 
@@ -102,6 +102,7 @@ UASManager::UASManager() :
         homeLon(8.549444),
         homeAlt(470.0)
 {
+    connect(&heartbeatSupervisor, SIGNAL(stateChanged(int,int,quint64)), this, SLOT(heartbeatStateChanged(int,int,quint64)));
     start(QThread::LowPriority);
     loadSettings();
 }
@@ -146,6 +147,7 @@ void UASManager::addUAS(UASInterface* uas)
         systems.append(uas);
         connect(uas, SIGNAL(destroyed(QObject*)), this, SLOT(removeUAS(QObject*)));
         connect(this, SIGNAL(homePositionChanged(double,double,double)), uas, SLOT(setHomePosition(double,double,double)));
+        connect(uas, SIGNAL(heartbeat(UASInterface*)), this, SLOT(receiveHeartbeat(UASInterface*)));
         emit UASCreated(uas);
     }
 
@@ -156,12 +158,30 @@ void UASManager::addUAS(UASInterface* uas)
     }
 }
 
+void UASManager::receiveHeartbeat(UASInterface* uas)
+{
+    heartbeatSupervisor.heartbeat(uas->getUASID());
+}
+
+void UASManager::heartbeatStateChanged(int systemId, int state, quint64 elapsed)
+{
+    UASInterface* uas = getUASForId(systemId);
+    if (!uas) return;
+
+    UAS* mav = qobject_cast<UAS*>(uas);
+    if (mav) mav->setHeartbeatState(state, elapsed);
+    emit heartbeatStateChanged(uas, state);
+}
+
 void UASManager::removeUAS(QObject* uas)
 {
     UASInterface* mav = qobject_cast<UASInterface*>(uas);
 
     if (mav)
     {
+        // Stop supervising its heartbeat, the id may come back as a new system
+        heartbeatSupervisor.removeSystem(mav->getUASID());
+
         int listindex = systems.indexOf(mav);
 
         if (mav == activeUAS)
@@ -35,12 +35,15 @@ This file is part of the QGROUNDCONTROL project
 #include <QList>
 #include <QMutex>
 #include <UASInterface.h>
+#include "QGCHeartbeatSupervisor.h"
 
 /**
  * @brief Central manager for all connected aerial vehicles
  *
  * This class keeps a list of all connected / configured UASs. It also stores which
  * UAS is currently select with respect to user input or manual controls.
+ * The heartbeats of all systems are supervised centrally with one timer,
+ * see QGCHeartbeatSupervisor.
  **/
 class UASManager : public QThread
 {
@@ -76,6 +79,8 @@ public:
     double getHomeLongitude() const { return homeLon; }
     /** @brief Get home position altitude */
     double getHomeAltitude() const { return homeAlt; }
+    /** @brief Heartbeat timeout detection of all systems */
+    QGCHeartbeatSupervisor* getHeartbeatSupervisor() { return &heartbeatSupervisor; }
 
 
 public slots:
@@ -176,6 +181,12 @@ public slots:
     /** @brief Store settings */
     void storeSettings();
 
+protected slots:
+    /** @brief Hand a heartbeat to the supervisor */
+    void receiveHeartbeat(UASInterface* uas);
+    /** @brief Propagate a heartbeat state transition to the system */
+    void heartbeatStateChanged(int systemId, int state, quint64 elapsed);
+
 
 protected:
     UASManager();
@@ -185,6 +196,7 @@ protected:
     double homeLat;
     double homeLon;
     double homeAlt;
+    QGCHeartbeatSupervisor heartbeatSupervisor;
 
 signals:
     void UASCreated(UASInterface* UAS);
@@ -200,6 +212,8 @@ signals:
     void activeUASStatusChanged(int systemId, bool active);
     /** @brief Current home position changed */
     void homePositionChanged(double lat, double lon, double alt);
+    /** @brief A system timed out, was lost or came back, state is a QGCHeartbeatSupervisor::HeartbeatState */
+    void heartbeatStateChanged(UASInterface* uas, int state);
 
 };
 
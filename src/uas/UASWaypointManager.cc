@@ -29,14 +29,24 @@ This file is part of the QGROUNDCONTROL project
  *
  */
 
+#include <QDataStream>
+#include <QSettings>
+#include <QtAlgorithms>
+
 #include "UASWaypointManager.h"
+#include "WaypointFileLoader.h"
 #include "UAS.h"
 #include "mavlink_types.h"
+#include "QGC.h"
 //#include "MainWindow.h"
 
 #define PROTOCOL_TIMEOUT_MS 2000    ///< maximum time to wait for pending messages until timeout
 #define PROTOCOL_DELAY_MS 40        ///< minimum delay between sent messages
 #define PROTOCOL_MAX_RETRIES 3      ///< maximum number of send retries (after timeout)
+#define PROTOCOL_WINDOW_INITIAL 4   ///< number of waypoint requests in flight at the start of a download
+#define PROTOCOL_WINDOW_MAX 16      ///< maximum number of waypoint requests in flight
+#define PROTOCOL_WINDOW_TICK_MS 20  ///< interval of the lost request check
+#define PROTOCOL_MIN_RTO_MS 50      ///< lower bound of the retransmission timeout
 
 UASWaypointManager::UASWaypointManager(UAS &_uas)
         : uas(_uas),
@@ -46,9 +56,43 @@ UASWaypointManager::UASWaypointManager(UAS &_uas)
         current_state(WP_IDLE),
         current_partner_systemid(0),
         current_partner_compid(0),
-        protocol_timer(this)
+        current_waypoint(-1),
+        protocol_timer(this),
+        window_enabled(true),
+        window_ignored(false),
+        window_active(false),
+        window_size(PROTOCOL_WINDOW_INITIAL),
+        window_acked(0),
+        window_next_request(0),
+        window_next_add(0),
+        window_srtt(0),
+        window_rttvar(0),
+        window_interval(0),
+        window_last_arrival(0),
+        request_list_time(0),
+        window_timer(this),
+        transfer_start(0),
+        transfer_time(0),
+        transfer_retransmissions(0),
+        delta_enabled(false),
+        upload_index(0),
+        upload_size(0),
+        file_loader(NULL)
 {
     connect(&protocol_timer, SIGNAL(timeout()), this, SLOT(timeout()));
+    connect(&window_timer, SIGNAL(timeout()), this, SLOT(windowTimeout()));
+
+    QSettings settings;
+    settings.beginGroup(QString("MAV%1").arg(uas.getUASID()));
+    window_enabled = settings.value("WP_TRANSFER_WINDOW", window_enabled).toBool();
+    delta_enabled = settings.value("WP_DELTA_UPLOAD", delta_enabled).toBool();
+    settings.endGroup();
+}
+
+UASWaypointManager::~UASWaypointManager()
+{
+    // Waits for a running load
+    delete file_loader;
 }
 
 void UASWaypointManager::timeout()
@@ -65,7 +109,15 @@ void UASWaypointManager::timeout()
         }
         else if (current_state == WP_GETLIST_GETWPS)
         {
-            sendWaypointRequest(current_wp_id);
+            if (window_active)
+            {
+                // Nothing arrived for a whole timeout
+                restartStopAndWait();
+            }
+            else
+            {
+                sendWaypointRequest(current_wp_id);
+            }
         }
         else if (current_state == WP_SENDLIST)
         {
@@ -75,6 +127,11 @@ void UASWaypointManager::timeout()
         {
             sendWaypoint(current_wp_id);
         }
+        else if (current_state == WP_SENDLIST_PARTIAL)
+        {
+            // Vehicles which do not take single waypoints may not answer at all
+            restartFullUpload();
+        }
         else if (current_state == WP_CLEARLIST)
         {
             sendWaypointClearAll();
@@ -92,6 +149,12 @@ void UASWaypointManager::timeout()
 
         emit updateStatusString("Operation timed out.");
 
+        // An interrupted upload leaves the vehicle with an unknown mission
+        if (current_state == WP_SENDLIST || current_state == WP_SENDLIST_SENDWPS || current_state == WP_SENDLIST_PARTIAL)
+        {
+            vehicle_hashes.clear();
+        }
+        stopTransferWindow();
         current_state = WP_IDLE;
         current_count = 0;
         current_wp_id = 0;
@@ -104,6 +167,13 @@ void UASWaypointManager::handleWaypointCount(quint8 systemId, quint8 compId, qui
 {
     if (current_state == WP_GETLIST && systemId == current_partner_systemid && compId == current_partner_compid)
     {
+        // The list request gives the first round trip sample, unless it was sent again
+        if (current_retries == PROTOCOL_MAX_RETRIES && request_list_time != 0)
+        {
+            window_srtt = QGC::groundTimeUsecs() - request_list_time;
+            window_rttvar = window_srtt / 2;
+        }
+
         protocol_timer.start(PROTOCOL_TIMEOUT_MS);
         current_retries = PROTOCOL_MAX_RETRIES;
 
@@ -115,7 +185,15 @@ void UASWaypointManager::handleWaypointCount(quint8 systemId, quint8 compId, qui
             current_wp_id = 0;
             current_state = WP_GETLIST_GETWPS;
 
-            sendWaypointRequest(current_wp_id);
+            if (window_active)
+            {
+                startTransferWindow();
+                fillTransferWindow();
+            }
+            else
+            {
+                sendWaypointRequest(current_wp_id);
+            }
         }
         else
         {
@@ -131,7 +209,11 @@ void UASWaypointManager::handleWaypointCount(quint8 systemId, quint8 compId, qui
 
 void UASWaypointManager::handleWaypoint(quint8 systemId, quint8 compId, mavlink_waypoint_t *wp)
 {
-    if (systemId == current_partner_systemid && compId == current_partner_compid && current_state == WP_GETLIST_GETWPS && wp->seq == current_wp_id)
+    if (window_active && systemId == current_partner_systemid && compId == current_partner_compid && current_state == WP_GETLIST_GETWPS)
+    {
+        handleWindowedWaypoint(wp);
+    }
+    else if (systemId == current_partner_systemid && compId == current_partner_compid && current_state == WP_GETLIST_GETWPS && wp->seq == current_wp_id)
     {
         protocol_timer.start(PROTOCOL_TIMEOUT_MS);
         current_retries = PROTOCOL_MAX_RETRIES;
@@ -161,6 +243,8 @@ void UASWaypointManager::handleWaypoint(quint8 systemId, quint8 compId, mavlink_
                 current_partner_compid = 0;
 
                 protocol_timer.stop();
+                transfer_time = QGC::groundTimeMilliseconds() - transfer_start;
+                setVehicleMission(waypoints);
                 emit readGlobalWPFromUAS(false);
                 emit updateStatusString("done.");
 
@@ -178,6 +262,259 @@ void UASWaypointManager::handleWaypoint(quint8 systemId, quint8 compId, mavlink_
     }
 }
 
+void UASWaypointManager::startTransferWindow()
+{
+    window_size = PROTOCOL_WINDOW_INITIAL;
+    window_acked = 0;
+    window_received.fill(false, current_count);
+    window_requested.fill(false, current_count);
+    window_resent.fill(false, current_count);
+    window_in_flight.clear();
+    window_buffer.fill(NULL, current_count);
+    window_next_request = 0;
+    window_next_add = 0;
+    window_interval = 0;
+    window_last_arrival = 0;
+    window_timer.start(PROTOCOL_WINDOW_TICK_MS);
+}
+
+void UASWaypointManager::fillTransferWindow()
+{
+    while (window_in_flight.size() < window_size && window_next_request < current_count)
+    {
+        quint16 seq = window_next_request++;
+        if (window_received.testBit(seq) || window_in_flight.contains(seq)) continue;
+
+        if (window_requested.testBit(seq))
+        {
+            window_resent.setBit(seq);
+            transfer_retransmissions++;
+        }
+        window_requested.setBit(seq);
+        window_in_flight.insert(seq, QGC::groundTimeUsecs());
+        // The window limits the rate, no additional pacing
+        sendWaypointRequest(seq, false);
+    }
+}
+
+void UASWaypointManager::handleWindowedWaypoint(mavlink_waypoint_t *wp)
+{
+    // Late answer to a request that was sent twice
+    if (wp->seq >= current_count || window_received.testBit(wp->seq)) return;
+
+    protocol_timer.start(PROTOCOL_TIMEOUT_MS);
+    current_retries = PROTOCOL_MAX_RETRIES;
+
+    quint64 now = QGC::groundTimeUsecs();
+    if (window_in_flight.contains(wp->seq))
+    {
+        // Only requests sent once give unambiguous round trip samples
+        if (!window_resent.testBit(wp->seq))
+        {
+            quint64 sample = now - window_in_flight.value(wp->seq);
+            if (window_srtt == 0)
+            {
+                window_srtt = sample;
+                window_rttvar = sample / 2;
+            }
+            else
+            {
+                quint64 error = (sample > window_srtt) ? sample - window_srtt : window_srtt - sample;
+                window_rttvar = (3 * window_rttvar + error) / 4;
+                window_srtt = (7 * window_srtt + sample) / 8;
+            }
+        }
+        window_in_flight.remove(wp->seq);
+    }
+    if (window_last_arrival != 0)
+    {
+        quint64 gap = now - window_last_arrival;
+        window_interval = (window_interval == 0) ? gap : (7 * window_interval + gap) / 8;
+    }
+    window_last_arrival = now;
+
+    window_received.setBit(wp->seq);
+    window_buffer[wp->seq] = new Waypoint(wp->seq, wp->x, wp->y, wp->z, wp->param1, wp->param2, wp->param3, wp->param4, wp->autocontinue, wp->current, (MAV_FRAME) wp->frame, (MAV_CMD) wp->command);
+
+    // Grow by one per window without loss, but not beyond what
+    // the vehicle can answer within one round trip
+    if (++window_acked >= window_size)
+    {
+        window_acked = 0;
+        int pipe = PROTOCOL_WINDOW_MAX;
+        if (window_interval > 0 && window_srtt > 0) pipe = window_srtt / window_interval + 2;
+        window_size = qBound(1, qMin(window_size + 1, pipe), PROTOCOL_WINDOW_MAX);
+    }
+
+    // Hand over all waypoints which have no gap before them
+    while (window_next_add < current_count && window_received.testBit(window_next_add))
+    {
+        addWaypoint(window_buffer[window_next_add], false);
+        window_buffer[window_next_add] = NULL;
+        window_next_add++;
+    }
+    current_wp_id = window_next_add;
+
+    if (window_next_add < current_count)
+    {
+        fillTransferWindow();
+    }
+    else
+    {
+        stopTransferWindow();
+        sendWaypointAck(0);
+
+        // all waypoints retrieved, change state to idle
+        current_state = WP_IDLE;
+        current_count = 0;
+        current_wp_id = 0;
+        current_partner_systemid = 0;
+        current_partner_compid = 0;
+
+        protocol_timer.stop();
+        transfer_time = QGC::groundTimeMilliseconds() - transfer_start;
+        setVehicleMission(waypoints);
+        emit readGlobalWPFromUAS(false);
+        emit updateStatusString("done.");
+    }
+}
+
+void UASWaypointManager::stopTransferWindow()
+{
+    window_timer.stop();
+    window_in_flight.clear();
+    qDeleteAll(window_buffer);
+    window_buffer.clear();
+}
+
+void UASWaypointManager::restartStopAndWait()
+{
+    // Vehicles only answer a request for the waypoint they sent last or the
+    // next one. Once an answer is lost the vehicle is ahead of the gap and
+    // ignores all requests for it, start over with one request at a time.
+    // The list request is answered as soon as the vehicle ended the stalled
+    // transaction, which it does after its own timeout.
+    stopTransferWindow();
+    window_ignored = true;
+    window_active = false;
+
+    while(waypoints.size()>0)
+    {
+        delete waypoints.back();
+        waypoints.pop_back();
+    }
+    rebuildFrameIndex();
+
+    protocol_timer.start(PROTOCOL_TIMEOUT_MS);
+    current_retries = PROTOCOL_MAX_RETRIES;
+    current_state = WP_GETLIST;
+    current_count = 0;
+    current_wp_id = 0;
+    sendWaypointRequestList();
+}
+
+quint64 UASWaypointManager::getRetransmissionTimeout()
+{
+    if (window_srtt == 0) return PROTOCOL_TIMEOUT_MS * 1000 / 2;
+    return qBound((quint64)PROTOCOL_MIN_RTO_MS * 1000, window_srtt + 4 * window_rttvar, (quint64)PROTOCOL_TIMEOUT_MS * 1000);
+}
+
+void UASWaypointManager::windowTimeout()
+{
+    if (current_state != WP_GETLIST_GETWPS)
+    {
+        window_timer.stop();
+        return;
+    }
+
+    quint64 now = QGC::groundTimeUsecs();
+    quint64 rto = getRetransmissionTimeout();
+    bool lost = false;
+
+    QMap<quint16, quint64>::iterator i;
+    for (i = window_in_flight.begin(); i != window_in_flight.end(); ++i)
+    {
+        if (now - i.value() > rto)
+        {
+            // A request sent again and still unanswered is ignored by the vehicle
+            if (window_resent.testBit(i.key()))
+            {
+                restartStopAndWait();
+                return;
+            }
+            lost = true;
+            i.value() = now;
+            window_resent.setBit(i.key());
+            transfer_retransmissions++;
+            sendWaypointRequest(i.key(), false);
+        }
+    }
+
+    if (lost)
+    {
+        // Halve the window once per loss event
+        window_size = qMax(1, window_size / 2);
+        window_acked = 0;
+    }
+}
+
+void UASWaypointManager::setDeltaUploadEnabled(bool enabled)
+{
+    if (enabled == delta_enabled) return;
+    delta_enabled = enabled;
+
+    QSettings settings;
+    settings.beginGroup(QString("MAV%1").arg(uas.getUASID()));
+    settings.setValue("WP_DELTA_UPLOAD", delta_enabled);
+    settings.endGroup();
+    settings.sync();
+    emit deltaUploadEnabledChanged(delta_enabled);
+}
+
+quint32 UASWaypointManager::hashWaypoint(const Waypoint* wp)
+{
+    // Hash the values as transmitted, the vehicle stores them in single precision
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << (quint8)wp->getFrame() << (quint16)wp->getAction() << (quint8)wp->getAutoContinue()
+           << (float)wp->getParam1() << (float)wp->getParam2() << (float)wp->getParam3() << (float)wp->getParam4()
+           << (float)wp->getX() << (float)wp->getY() << (float)wp->getZ();
+    return qHash(data);
+}
+
+void UASWaypointManager::restartFullUpload()
+{
+    // The vehicle does not take single waypoints, fall back to sending
+    // the whole list and do not try again with this system
+    protocol_timer.stop();
+    current_state = WP_IDLE;
+    setDeltaUploadEnabled(false);
+    vehicle_hashes.clear();
+    writeWaypoints();
+}
+
+void UASWaypointManager::setVehicleMission(const QVector<Waypoint *> &list)
+{
+    vehicle_hashes.resize(list.size());
+    for (int i = 0; i < list.size(); i++)
+    {
+        vehicle_hashes[i] = hashWaypoint(list.at(i));
+    }
+}
+
+void UASWaypointManager::setTransferWindowEnabled(bool enabled)
+{
+    // A running download keeps its mode
+    window_enabled = enabled;
+    window_ignored = false;
+
+    QSettings settings;
+    settings.beginGroup(QString("MAV%1").arg(uas.getUASID()));
+    settings.setValue("WP_TRANSFER_WINDOW", window_enabled);
+    settings.endGroup();
+    settings.sync();
+}
+
 void UASWaypointManager::handleWaypointAck(quint8 systemId, quint8 compId, mavlink_waypoint_ack_t *wpa)
 {
     if (systemId == current_partner_systemid && compId == current_partner_compid)
@@ -187,13 +524,40 @@ void UASWaypointManager::handleWaypointAck(quint8 systemId, quint8 compId, mavli
             //all waypoints sent and ack received
             protocol_timer.stop();
             current_state = WP_IDLE;
+            vehicle_hashes = upload_hashes;
             emit updateStatusString("done.");
             qDebug() << "sent all waypoints to ID " << systemId;
         }
+        else if (current_state == WP_SENDLIST_PARTIAL)
+        {
+            if (wpa->type == 0)
+            {
+                vehicle_hashes[current_wp_id] = upload_hashes[current_wp_id];
+                upload_index++;
+                if (upload_index < upload_changes.size())
+                {
+                    protocol_timer.start(PROTOCOL_TIMEOUT_MS);
+                    current_retries = PROTOCOL_MAX_RETRIES;
+                    current_wp_id = upload_changes[upload_index];
+                    sendWaypoint(current_wp_id);
+                }
+                else
+                {
+                    protocol_timer.stop();
+                    current_state = WP_IDLE;
+                    emit updateStatusString(tr("done, %1 of %2 waypoints changed.").arg(upload_changes.size()).arg(current_count));
+                }
+            }
+            else
+            {
+                restartFullUpload();
+            }
+        }
         else if(current_state == WP_CLEARLIST)
         {
             protocol_timer.stop();
             current_state = WP_IDLE;
+            vehicle_hashes.clear();
             emit updateStatusString("done.");
             qDebug() << "cleared waypoint list of ID " << systemId;
         }
@@ -260,6 +624,7 @@ void UASWaypointManager::handleWaypointCurrent(quint8 systemId, quint8 compId, m
 
             //qDebug() << "Updated waypoints list";
         }
+        current_waypoint = wpc->seq;
         emit updateStatusString(QString("New current waypoint %1").arg(wpc->seq));
         //emit update to UI widgets
         emit currentWaypointChanged(wpc->seq);
@@ -273,6 +638,8 @@ void UASWaypointManager::notifyOfChange(Waypoint* wp)
     // If only one waypoint was changed, emit only WP signal
     if (wp != NULL)
     {
+        // A new frame changes the frame indices of the waypoints after it
+        if (frame_indexed.value(wp, -1) != wp->getFrame()) rebuildFrameIndex();
         emit waypointChanged(uas.getUASID(), wp);
     }
     else
@@ -332,6 +699,7 @@ void UASWaypointManager::addWaypoint(Waypoint *wp, bool enforceFirstActive)
         wp->setId(waypoints.size());
         if (enforceFirstActive && waypoints.size() == 0) wp->setCurrent(true);
         waypoints.insert(waypoints.size(), wp);
+        indexWaypoint(wp);
         connect(wp, SIGNAL(changed(Waypoint*)), this, SLOT(notifyOfChange(Waypoint*)));
 
         emit waypointListChanged();
@@ -345,6 +713,7 @@ int UASWaypointManager::removeWaypoint(quint16 seq)
     {
         Waypoint *t = waypoints[seq];
         waypoints.remove(seq);
+        unindexWaypoint(t);
         delete t;
 
         for(int i = seq; i < waypoints.size(); i++)
@@ -382,6 +751,28 @@ void UASWaypointManager::moveWaypoint(quint16 cur_seq, quint16 new_seq)
         waypoints[new_seq] = t;
         //waypoints[new_seq]->setId(new_seq);
 
+        // Only the waypoints of the same frame that t passed change their frame index
+        int frame = frame_indexed.value(t);
+        int first = qMin(cur_seq, new_seq);
+        int last = qMax(cur_seq, new_seq);
+        int passed = 0;
+        for (int i = first; i <= last; i++)
+        {
+            if (waypoints[i] != t && frame_indexed.value(waypoints[i]) == frame) passed++;
+        }
+        if (passed > 0)
+        {
+            QVector<Waypoint *> &list = frame_lists[frame];
+            int from = frame_positions.value(t);
+            int to = (cur_seq < new_seq) ? from + passed : from - passed;
+            list.remove(from);
+            list.insert(to, t);
+            for (int i = qMin(from, to); i <= qMax(from, to); i++)
+            {
+                frame_positions[list[i]] = i;
+            }
+        }
+
         emit waypointListChanged();
         emit waypointListChanged(uas.getUASID());
     }
@@ -390,71 +781,105 @@ void UASWaypointManager::moveWaypoint(quint16 cur_seq, quint16 new_seq)
 void UASWaypointManager::saveWaypoints(const QString &saveFile)
 {
     QFile file(saveFile);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    bool binary = (WaypointFileLoader::formatForFileName(saveFile) == WaypointFileLoader::FORMAT_BINARY);
+    if (!file.open(binary ? QIODevice::WriteOnly : QIODevice::WriteOnly | QIODevice::Text))
         return;
 
-    QTextStream out(&file);
-
-    //write the waypoint list version to the first line for compatibility check
-    out << "QGC WPL 110\r\n";
-
+    // The file stores the list position as index, renumber only waypoints
+    // whose id differs, every setId() notifies the views
     for (int i = 0; i < waypoints.size(); i++)
     {
-        waypoints[i]->setId(i);
-        waypoints[i]->save(out);
+        if (waypoints[i]->getId() != i) waypoints[i]->setId(i);
+    }
+
+    if (binary)
+    {
+        QDataStream out(&file);
+        out.setVersion(QDataStream::Qt_4_6);
+        out << (quint32)WaypointFileLoader::binaryMagic << (quint16)WaypointFileLoader::binaryVersion << (quint32)waypoints.size();
+        for (int i = 0; i < waypoints.size(); i++)
+        {
+            waypoints[i]->save(out);
+        }
+    }
+    else
+    {
+        QTextStream out(&file);
+
+        //write the waypoint list version to the first line for compatibility check
+        out << "QGC WPL 110\r\n";
+
+        for (int i = 0; i < waypoints.size(); i++)
+        {
+            waypoints[i]->save(out);
+        }
     }
     file.close();
 }
 
-void UASWaypointManager::loadWaypoints(const QString &loadFile)
+/**
+ * The file is parsed in a separate thread and the loaded list replaces the current
+ * one in a single change notification once it is complete. A load started while
+ * another one is still running is ignored.
+ *
+ * @param blocking Parse the file in the calling thread and return when the list is replaced
+ */
+void UASWaypointManager::loadWaypoints(const QString &loadFile, bool blocking)
 {
-    QFile file(loadFile);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    if (file_loader)
+    {
+        emit updateStatusString(tr("Still loading %1").arg(file_loader->getFileName()));
         return;
+    }
 
-    while(waypoints.size()>0)
+    file_loader = new WaypointFileLoader(loadFile, thread(), this);
+    if (blocking)
     {
-        Waypoint *t = waypoints[0];
-        waypoints.remove(0);
-        delete t;
+        file_loader->load();
+        waypointFileLoaded();
     }
+    else
+    {
+        connect(file_loader, SIGNAL(finished()), this, SLOT(waypointFileLoaded()));
+        emit updateStatusString(tr("Loading %1").arg(loadFile));
+        file_loader->start(QThread::LowPriority);
+    }
+}
 
-    QTextStream in(&file);
-
-    const QStringList &version = in.readLine().split(" ");
+void UASWaypointManager::waypointFileLoaded()
+{
+    WaypointFileLoader* loader = file_loader;
+    file_loader = NULL;
+    if (!loader) return;
+    loader->wait();
 
-    if (!(version.size() == 3 && version[0] == "QGC" && version[1] == "WPL" && version[2] == "110"))
+    if (!loader->getErrorString().isEmpty())
     {
-        emit updateStatusString(tr("The waypoint file is not compatible with the current version of QGroundControl."));
-        //MainWindow::instance()->showCriticalMessage(tr("Error loading waypoint file"),tr("The waypoint file is not compatible with the current version of QGroundControl."));
+        emit updateStatusString(loader->getErrorString());
     }
-    else
+
+    // An unreadable file leaves the current list untouched
+    if (loader->isCompatible())
     {
-        while (!in.atEnd())
+        qDeleteAll(waypoints);
+        waypoints = loader->takeWaypoints();
+        foreach (Waypoint* wp, waypoints)
         {
-            Waypoint *t = new Waypoint();
-            if(t->load(in))
-            {
-                t->setId(waypoints.size());
-                waypoints.insert(waypoints.size(), t);
-            }
-            else
-            {
-                emit updateStatusString(tr("The waypoint file is corrupted. Load operation only partly succesful."));
-                //MainWindow::instance()->showCriticalMessage(tr("Error loading waypoint file"),);
-                break;
-            }
+            connect(wp, SIGNAL(changed(Waypoint*)), this, SLOT(notifyOfChange(Waypoint*)));
         }
-    }
+        rebuildFrameIndex();
 
-    file.close();
-
-    emit loadWPFile();
-    emit waypointListChanged();
-    emit waypointListChanged(uas.getUASID());
+        if (loader->getErrorString().isEmpty())
+        {
+            emit updateStatusString(tr("Loaded %1 waypoints").arg(waypoints.size()));
+        }
+        emit loadWPFile();
+        emit waypointListChanged();
+        emit waypointListChanged(uas.getUASID());
+    }
+    delete loader;
 }
 
-
 //void UASWaypointManager::globalAddWaypoint(Waypoint *wp)
 //{
 //    // FIXME Will be removed
@@ -492,18 +917,7 @@ void UASWaypointManager::clearWaypointList()
 
 const QVector<Waypoint *> UASWaypointManager::getGlobalFrameWaypointList()
 {
-    // TODO Keep this global frame list up to date
-    // with complete waypoint list
-    // instead of filtering on each request
-    QVector<Waypoint*> wps;
-    foreach (Waypoint* wp, waypoints)
-    {
-        if (wp->getFrame() == MAV_FRAME_GLOBAL)
-        {
-            wps.append(wp);
-        }
-    }
-    return wps;
+    return frame_lists.value(MAV_FRAME_GLOBAL);
 }
 
 int UASWaypointManager::getIndexOf(Waypoint* wp)
@@ -513,94 +927,83 @@ int UASWaypointManager::getIndexOf(Waypoint* wp)
 
 int UASWaypointManager::getGlobalFrameIndexOf(Waypoint* wp)
 {
-    // Search through all waypoints,
-    // counting only those in global frame
-    int i = 0;
-    foreach (Waypoint* p, waypoints)
-    {
-        if (p->getFrame() == MAV_FRAME_GLOBAL)
-        {
-            if (p == wp)
-            {
-                return i;
-            }
-            i++;
-        }
-    }
-
-    return -1;
+    return getFrameIndexOf(wp, MAV_FRAME_GLOBAL);
 }
 
 int UASWaypointManager::getGlobalFrameCount()
 {
-    // Search through all waypoints,
-    // counting only those in global frame
-    int i = 0;
-    foreach (Waypoint* p, waypoints)
-    {
-        if (p->getFrame() == MAV_FRAME_GLOBAL)
-        {
-            i++;
-        }
-    }
-
-    return i;
+    return frame_lists.value(MAV_FRAME_GLOBAL).size();
 }
 
 int UASWaypointManager::getLocalFrameCount()
 {
-    // Search through all waypoints,
-    // counting only those in global frame
-    int i = 0;
-    foreach (Waypoint* p, waypoints)
-    {
-        if (p->getFrame() == MAV_FRAME_GLOBAL)
-        {
-            i++;
-        }
-    }
+    return frame_lists.value(MAV_FRAME_LOCAL).size();
+}
 
-    return i;
+int UASWaypointManager::getMissionFrameCount()
+{
+    return frame_lists.value(MAV_FRAME_MISSION).size();
 }
 
 int UASWaypointManager::getLocalFrameIndexOf(Waypoint* wp)
 {
-    // Search through all waypoints,
-    // counting only those in local frame
-    int i = 0;
-    foreach (Waypoint* p, waypoints)
+    return getFrameIndexOf(wp, MAV_FRAME_LOCAL);
+}
+
+int UASWaypointManager::getMissionFrameIndexOf(Waypoint* wp)
+{
+    return getFrameIndexOf(wp, MAV_FRAME_MISSION);
+}
+
+int UASWaypointManager::getFrameIndexOf(Waypoint* wp, int frame)
+{
+    QHash<Waypoint*, int>::const_iterator it = frame_indexed.constFind(wp);
+    if (it == frame_indexed.constEnd()) return -1;
+    if (it.value() != wp->getFrame())
     {
-        if (p->getFrame() == MAV_FRAME_LOCAL)
-        {
-            if (p == wp)
-            {
-                return i;
-            }
-            i++;
-        }
+        // The frame was changed without a changed() signal reaching us yet
+        rebuildFrameIndex();
+        it = frame_indexed.constFind(wp);
     }
+    if (it.value() != frame) return -1;
+    return frame_positions.value(wp);
+}
 
-    return -1;
+void UASWaypointManager::indexWaypoint(Waypoint* wp)
+{
+    QVector<Waypoint*> &list = frame_lists[wp->getFrame()];
+    frame_positions.insert(wp, list.size());
+    frame_indexed.insert(wp, wp->getFrame());
+    list.append(wp);
 }
 
-int UASWaypointManager::getMissionFrameIndexOf(Waypoint* wp)
+void UASWaypointManager::unindexWaypoint(Waypoint* wp)
 {
-    // Search through all waypoints,
-    // counting only those in mission frame
-    int i = 0;
-    foreach (Waypoint* p, waypoints)
+    QHash<Waypoint*, int>::iterator it = frame_indexed.find(wp);
+    if (it == frame_indexed.end()) return;
+
+    QVector<Waypoint*> &list = frame_lists[it.value()];
+    int position = frame_positions.value(wp);
+    list.remove(position);
+    for (int i = position; i < list.size(); i++)
     {
-        if (p->getFrame() == MAV_FRAME_MISSION)
-        {
-            if (p == wp)
-            {
-                return i;
-            }
-            i++;
-        }
+        frame_positions[list[i]] = i;
     }
+    frame_positions.remove(wp);
+    frame_indexed.erase(it);
+}
 
-    return -1;
+void UASWaypointManager::rebuildFrameIndex()
+{
+    frame_lists.clear();
+    frame_positions.clear();
+    frame_indexed.clear();
+    frame_positions.reserve(waypoints.size());
+    frame_indexed.reserve(waypoints.size());
+    foreach (Waypoint* wp, waypoints)
+    {
+        indexWaypoint(wp);
+    }
 }
 
 void UASWaypointManager::readWaypoints()
@@ -614,6 +1017,7 @@ void UASWaypointManager::readWaypoints()
             waypoints.pop_back();
 
         }
+        rebuildFrameIndex();
 
         protocol_timer.start(PROTOCOL_TIMEOUT_MS);
         current_retries = PROTOCOL_MAX_RETRIES;
@@ -622,6 +1026,9 @@ void UASWaypointManager::readWaypoints()
         current_wp_id = 0;
         current_partner_systemid = uas.getUASID();
         current_partner_compid = MAV_COMP_ID_WAYPOINTPLANNER;
+        transfer_start = QGC::groundTimeMilliseconds();
+        transfer_retransmissions = 0;
+        window_active = window_enabled && !window_ignored;
 
         sendWaypointRequestList();
 
@@ -681,8 +1088,53 @@ void UASWaypointManager::writeWaypoints()
                     noCurrent = false;
             }
 
-            //send the waypoint count to UAS (this starts the send transaction)
-            sendWaypointCount();
+            // Compare against the mission on the vehicle
+            upload_hashes.resize(current_count);
+            for (int i = 0; i < current_count; i++)
+            {
+                upload_hashes[i] = hashWaypoint(waypoints.at(i));
+            }
+            upload_changes.clear();
+            bool incremental = delta_enabled && vehicle_hashes.size() == current_count;
+            if (incremental)
+            {
+                for (int i = 0; i < current_count; i++)
+                {
+                    if (upload_hashes[i] != vehicle_hashes[i]) upload_changes.append(i);
+                }
+                // The same waypoints in a different order are sent as a new list
+                if (upload_changes.size() > 1)
+                {
+                    QVector<quint32> sortedUpload = upload_hashes;
+                    QVector<quint32> sortedVehicle = vehicle_hashes;
+                    qSort(sortedUpload);
+                    qSort(sortedVehicle);
+                    incremental = (sortedUpload != sortedVehicle);
+                }
+            }
+
+            if (incremental && upload_changes.isEmpty())
+            {
+                protocol_timer.stop();
+                current_state = WP_IDLE;
+                upload_size = 0;
+                emit updateStatusString(tr("Mission unchanged, nothing to send."));
+            }
+            else if (incremental)
+            {
+                // Send the changed waypoints one by one, each one is acknowledged
+                current_state = WP_SENDLIST_PARTIAL;
+                upload_index = 0;
+                upload_size = upload_changes.size();
+                current_wp_id = upload_changes.first();
+                sendWaypoint(current_wp_id);
+            }
+            else
+            {
+                upload_size = current_count;
+                //send the waypoint count to UAS (this starts the send transaction)
+                sendWaypointCount();
+            }
         }
     }
     else if (waypoints.count() == 0)
@@ -761,6 +1213,7 @@ void UASWaypointManager::sendWaypointRequestList()
     emit updateStatusString(QString("Requesting waypoint list..."));
 
     mavlink_msg_waypoint_request_list_encode(uas.mavlink->getSystemId(), uas.mavlink->getComponentId(), &message, &wprl);
+    request_list_time = QGC::groundTimeUsecs();
     uas.sendMessage(message);
     MG::SLEEP::usleep(PROTOCOL_DELAY_MS * 1000);
 
@@ -769,7 +1222,7 @@ void UASWaypointManager::sendWaypointRequestList()
 
 }
 
-void UASWaypointManager::sendWaypointRequest(quint16 seq)
+void UASWaypointManager::sendWaypointRequest(quint16 seq, bool paced)
 {
     mavlink_message_t message;
     mavlink_waypoint_request_t wpr;
@@ -782,7 +1235,7 @@ void UASWaypointManager::sendWaypointRequest(quint16 seq)
 
     mavlink_msg_waypoint_request_encode(uas.mavlink->getSystemId(), uas.mavlink->getComponentId(), &message, &wpr);
     uas.sendMessage(message);
-    MG::SLEEP::usleep(PROTOCOL_DELAY_MS * 1000);
+    if (paced) MG::SLEEP::usleep(PROTOCOL_DELAY_MS * 1000);
 
     qDebug() << "sent waypoint request (" << wpr.seq << ") to ID " << wpr.target_system;
 }
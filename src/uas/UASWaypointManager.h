@@ -34,10 +34,14 @@ This file is part of the QGROUNDCONTROL project
 
 #include <QObject>
 #include <QVector>
+#include <QMap>
+#include <QHash>
+#include <QBitArray>
 #include <QTimer>
 #include "Waypoint.h"
 #include "QGCMAVLink.h"
 class UAS;
+class WaypointFileLoader;
 
 /**
  * @brief Implementation of the MAVLINK waypoint protocol
@@ -47,6 +51,8 @@ class UAS;
  * Notice that currently the access to the internal waypoint storage is not guarded nor thread-safe. This works as long as no other widget alters the data.
  *
  * See http://qgroundcontrol.org/waypoint_protocol for more information about the protocol and the states.
+ * Downloads can keep several requests in flight, see setTransferWindowEnabled().
+ * Uploads can send only the changed waypoints, see setDeltaUploadEnabled().
  */
 class UASWaypointManager : public QObject
 {
@@ -56,6 +62,7 @@ private:
         WP_IDLE = 0,        ///< Waiting for commands
         WP_SENDLIST,        ///< Initial state for sending waypoints to the MAV
         WP_SENDLIST_SENDWPS,///< Sending waypoints
+        WP_SENDLIST_PARTIAL,///< Sending only changed waypoints, each one acknowledged
         WP_GETLIST,         ///< Initial state for retrieving wayppoints from the MAV
         WP_GETLIST_GETWPS,  ///< Receiving waypoints
         WP_CLEARLIST,       ///< Clearing waypoint list on the MAV
@@ -64,6 +71,7 @@ private:
 
 public:
     UASWaypointManager(UAS&);   ///< Standard constructor.
+    ~UASWaypointManager();
 
     /** @name Received message handlers */
     /*@{*/
@@ -90,13 +98,27 @@ public:
     int getIndexOf(Waypoint* wp);                   ///< Get the index of a waypoint in the list
     int getGlobalFrameIndexOf(Waypoint* wp);    ///< Get the index of a waypoint in the list, counting only global waypoints
     int getLocalFrameIndexOf(Waypoint* wp);     ///< Get the index of a waypoint in the list, counting only local waypoints
+    int getCurrentWaypoint() const { return current_waypoint; }  ///< Returns the sequence number the MAV last reported as current, -1 if unknown
     int getMissionFrameIndexOf(Waypoint* wp);   ///< Get the index of a waypoint in the list, counting only mission waypoints
     int getGlobalFrameCount(); ///< Get the count of global waypoints in the list
     int getLocalFrameCount();   ///< Get the count of local waypoints in the list
+    int getMissionFrameCount(); ///< Get the count of mission waypoints in the list
     /*@}*/
 
     UAS& getUAS() { return this->uas; }                         ///< Returns the owning UAS
 
+    /** @name Transfer statistics */
+    /*@{*/
+    bool getTransferWindowEnabled() const { return window_enabled; }    ///< Returns true if downloads are pipelined
+    bool getTransferWindowIgnored() const { return window_ignored; }    ///< Returns true if the vehicle ignored a pipelined request
+    int getTransferWindow() const { return window_size; }               ///< Returns the current number of requests kept in flight
+    quint64 getRoundTripTime() const { return window_srtt / 1000; }     ///< Returns the smoothed request round trip time in milliseconds
+    quint64 getLastTransferTime() const { return transfer_time; }       ///< Returns the duration of the last completed download in milliseconds
+    quint32 getLastTransferRetransmissions() const { return transfer_retransmissions; } ///< Returns the number of requests sent again during the last download
+    bool getDeltaUploadEnabled() const { return delta_enabled; }        ///< Returns true if only changed waypoints are uploaded
+    int getLastUploadSize() const { return upload_size; }               ///< Returns the number of waypoints sent by the last upload
+    /*@}*/
+
 //    /** @name Global waypoint list operations */
 //    /*@{*/
 //    const QVector<Waypoint *> &getGlobalWaypointList(void) { return waypoints; }  ///< Returns a const reference to the global waypoint list.
@@ -111,29 +133,77 @@ private:
     void sendWaypointSetCurrent(quint16 seq);
     void sendWaypointCount();
     void sendWaypointRequestList();
-    void sendWaypointRequest(quint16 seq);          ///< Requests a waypoint with sequence number seq
+    void sendWaypointRequest(quint16 seq, bool paced=true);  ///< Requests a waypoint with sequence number seq, paced requests wait PROTOCOL_DELAY_MS
     void sendWaypoint(quint16 seq);                 ///< Sends a waypoint with sequence number seq
     void sendWaypointAck(quint8 type);              ///< Sends a waypoint ack
     /*@}*/
 
+    /** @name Pipelined download */
+    /*@{*/
+    void startTransferWindow();                     ///< Resets the window state for a download of current_count waypoints
+    void fillTransferWindow();                      ///< Sends requests until window_size requests are in flight
+    void handleWindowedWaypoint(mavlink_waypoint_t *wp);    ///< Stores a waypoint received in windowed mode
+    void stopTransferWindow();                      ///< Stops the window timer and frees unclaimed waypoints
+    void restartStopAndWait();                      ///< Requests the list again and downloads it without window
+    quint64 getRetransmissionTimeout();             ///< Current retransmission timeout in microseconds
+    /*@}*/
+
+    /** @name Incremental upload */
+    /*@{*/
+    quint32 hashWaypoint(const Waypoint* wp);       ///< Hash of everything the vehicle stores of a waypoint, except the current flag
+    void setVehicleMission(const QVector<Waypoint *> &list);    ///< Remembers list as the mission on the vehicle
+    void restartFullUpload();                       ///< Disables incremental uploads and sends the complete list
+    /*@}*/
+
+    /** @name Per-frame index */
+    /*@{*/
+    void indexWaypoint(Waypoint *wp);               ///< Appends a waypoint at the end of the list of its frame
+    void unindexWaypoint(Waypoint *wp);             ///< Removes a waypoint from the list of its frame
+    void rebuildFrameIndex();                       ///< Rebuilds all frame lists from the main storage
+    int getFrameIndexOf(Waypoint *wp, int frame);   ///< Index of a waypoint in the list of frame, -1 if it has a different frame
+    /*@}*/
+
 public slots:
     void timeout();                                 ///< Called by the timer if a response times out. Handles send retries.
+    void windowTimeout();                           ///< Periodically requests waypoints again whose requests were lost
+    /**
+     * @brief Enables pipelined downloads, takes effect with the next download
+     *
+     * Vehicles which only answer requests in order ignore a gap once its
+     * answer was lost. If a request sent again is not answered either, the
+     * download starts over without window and the window stays off for the
+     * rest of the session. The setting is stored per system.
+     */
+    void setTransferWindowEnabled(bool enabled);
+    /**
+     * @brief Enables uploading only changed waypoints
+     *
+     * The changed waypoints are sent outside of a list transaction, which
+     * only some vehicles accept. Enable it for those. If the vehicle rejects
+     * or ignores a single waypoint the complete list is sent instead and the
+     * setting is turned off. The setting is stored per system.
+     */
+    void setDeltaUploadEnabled(bool enabled);
     /** @name Waypoint list operations */
     /*@{*/
     void addWaypoint(Waypoint *wp, bool enforceFirstActive=true);                 ///< adds a new waypoint to the end of the list and changes its sequence number accordingly
     int removeWaypoint(quint16 seq);                       ///< locally remove the specified waypoint from the storage
     void moveWaypoint(quint16 cur_seq, quint16 new_seq);   ///< locally move a waypoint from its current position cur_seq to a new position new_seq
-    void saveWaypoints(const QString &saveFile);           ///< saves the local waypoint list to saveFile
-    void loadWaypoints(const QString &loadFile);           ///< loads a waypoint list from loadFile
+    void saveWaypoints(const QString &saveFile);           ///< saves the local waypoint list to saveFile, in the binary format if it ends with .wpb
+    void loadWaypoints(const QString &loadFile, bool blocking=false);  ///< loads a waypoint list from loadFile, text or binary
     void notifyOfChange(Waypoint* wp);                     ///< Notifies manager to changes to a waypoint
     /*@}*/
 
+protected slots:
+    void waypointFileLoaded();                      ///< Replaces the waypoint list with the one of the finished file loader
+
 signals:
     void waypointListChanged(void);                 ///< emits signal that the waypoint list has been changed
     void waypointListChanged(int uasid);            ///< Emits signal that list has been changed
     void waypointChanged(int uasid, Waypoint* wp);  ///< emits signal that waypoint has been changed
     void currentWaypointChanged(quint16);           ///< emits the new current waypoint sequence number
     void updateStatusString(const QString &);       ///< emits the current status string
+    void deltaUploadEnabledChanged(bool enabled);   ///< emits the new incremental upload setting
 
     void loadWPFile();                              ///< emits signal that a file wp has been load
     void readGlobalWPFromUAS(bool value);           ///< emits signal when finish to read Global WP from UAS
@@ -146,10 +216,45 @@ private:
     WaypointState current_state;                    ///< The current protocol state
     quint8 current_partner_systemid;                ///< The current protocol communication target system
     quint8 current_partner_compid;                  ///< The current protocol communication target component
+    int current_waypoint;                           ///< The waypoint the MAV last reported as current, -1 if unknown
 
     QVector<Waypoint *> waypoints;                  ///< local waypoint list (main storage)
+    QHash<int, QVector<Waypoint *> > frame_lists;   ///< Waypoints of each frame in list order
+    QHash<Waypoint *, int> frame_positions;         ///< Index of each waypoint in the list of its frame
+    QHash<Waypoint *, int> frame_indexed;           ///< Frame each waypoint is indexed under
     QVector<mavlink_waypoint_t *> waypoint_buffer;  ///< buffer for waypoints during communication
     QTimer protocol_timer;                          ///< Timer to catch timeouts
+
+    bool window_enabled;                            ///< Pipelined download enabled
+    bool window_ignored;                            ///< The vehicle ignored a pipelined request, download without window
+    bool window_active;                             ///< The current download is pipelined
+    int window_size;                                ///< Number of requests kept in flight
+    int window_acked;                               ///< Waypoints received since the window last grew
+    QBitArray window_received;                      ///< Received flag per sequence number
+    QBitArray window_requested;                     ///< Requested flag per sequence number
+    QBitArray window_resent;                        ///< Requests sent more than once, these give no RTT samples
+    QMap<quint16, quint64> window_in_flight;        ///< Outstanding requests and the time they were sent in microseconds
+    QVector<Waypoint *> window_buffer;              ///< Waypoints received ahead of their predecessors
+    quint16 window_next_request;                    ///< Position of the request scan, restarts at the first gap after a timeout
+    quint16 window_next_add;                        ///< Lowest sequence number not added to the list yet
+    quint64 window_srtt;                            ///< Smoothed round trip time in microseconds
+    quint64 window_rttvar;                          ///< Round trip time variation in microseconds
+    quint64 window_interval;                        ///< Smoothed time between two received waypoints in microseconds
+    quint64 window_last_arrival;                    ///< Time the last waypoint was received in microseconds
+    quint64 request_list_time;                      ///< Time the waypoint list was requested in microseconds
+    QTimer window_timer;                            ///< Timer to detect lost requests
+
+    quint64 transfer_start;                         ///< Start of the current download in milliseconds
+    quint64 transfer_time;                          ///< Duration of the last download in milliseconds
+    quint32 transfer_retransmissions;               ///< Requests sent again during the current download
+
+    bool delta_enabled;                             ///< Upload only changed waypoints if possible
+    QVector<quint32> vehicle_hashes;                ///< Waypoint hashes of the mission on the vehicle, empty if unknown
+    QVector<quint32> upload_hashes;                 ///< Waypoint hashes of the mission being uploaded
+    QVector<quint16> upload_changes;                ///< Sequence numbers sent by the current incremental upload
+    int upload_index;                               ///< Position in upload_changes
+    int upload_size;                                ///< Number of waypoints sent by the last upload
+    WaypointFileLoader* file_loader;                ///< Load in progress, NULL if none
 };
 
 #endif // UASWAYPOINTMANAGER_H
@@ -0,0 +1,154 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+
+/**
+ * @file
+ *   @brief Implementation of the waypoint file loader
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QtEndian>
+#include <QDebug>
+
+#include "WaypointFileLoader.h"
+
+WaypointFileLoader::WaypointFileLoader(const QString& fileName, QThread* target, QObject* parent) :
+    QThread(parent),
+    fileName(fileName),
+    target(target),
+    compatible(false)
+{
+}
+
+WaypointFileLoader::~WaypointFileLoader()
+{
+    wait();
+    qDeleteAll(waypoints);
+}
+
+void WaypointFileLoader::run()
+{
+    load();
+}
+
+void WaypointFileLoader::load()
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        errorString = tr("Could not open waypoint file %1.").arg(fileName);
+        return;
+    }
+
+    QByteArray magic = file.peek(4);
+    if (magic.size() == 4 && qFromBigEndian<quint32>((const uchar*)magic.constData()) == binaryMagic)
+    {
+        loadBinary(&file);
+    }
+    else
+    {
+        loadText(&file);
+    }
+    file.close();
+
+    // The waypoints were created in this thread, hand them over
+    // before anyone else gets to see them
+    if (target && target != QThread::currentThread())
+    {
+        foreach (Waypoint* wp, waypoints) wp->moveToThread(target);
+    }
+}
+
+void WaypointFileLoader::loadText(QIODevice* device)
+{
+    QTextStream in(device);
+
+    const QStringList &version = in.readLine().split(" ");
+    if (!(version.size() == 3 && version[0] == "QGC" && version[1] == "WPL" && version[2] == "110"))
+    {
+        errorString = tr("The waypoint file is not compatible with the current version of QGroundControl.");
+        return;
+    }
+
+    compatible = true;
+    while (!in.atEnd())
+    {
+        Waypoint *t = new Waypoint();
+        if (!t->load(in))
+        {
+            delete t;
+            errorString = tr("The waypoint file is corrupted. Load operation only partly succesful.");
+            break;
+        }
+        t->setId(waypoints.size());
+        waypoints.append(t);
+    }
+}
+
+void WaypointFileLoader::loadBinary(QIODevice* device)
+{
+    QDataStream in(device);
+    in.setVersion(QDataStream::Qt_4_6);
+    quint32 magic;
+    quint16 version;
+    quint32 count;
+    in >> magic >> version >> count;
+    if (in.status() != QDataStream::Ok || version != binaryVersion)
+    {
+        errorString = tr("The waypoint file is not compatible with the current version of QGroundControl.");
+        return;
+    }
+
+    compatible = true;
+    // Do not trust the count for the allocation, a corrupt file could claim anything
+    waypoints.reserve(qMin(count, (quint32)65536));
+    for (quint32 i = 0; i < count; ++i)
+    {
+        Waypoint *t = new Waypoint(waypoints.size());
+        if (!t->load(in))
+        {
+            delete t;
+            errorString = tr("The waypoint file is corrupted. Load operation only partly succesful.");
+            break;
+        }
+        waypoints.append(t);
+    }
+}
+
+QVector<Waypoint*> WaypointFileLoader::takeWaypoints()
+{
+    QVector<Waypoint*> list = waypoints;
+    waypoints.clear();
+    return list;
+}
+
+WaypointFileLoader::Format WaypointFileLoader::formatForFileName(const QString& fileName)
+{
+    return (QFileInfo(fileName).suffix().toLower() == "wpb") ? FORMAT_BINARY : FORMAT_TEXT;
+}
@@ -0,0 +1,98 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+
+/**
+ * @file
+ *   @brief Definition of the waypoint file loader
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#ifndef WAYPOINTFILELOADER_H
+#define WAYPOINTFILELOADER_H
+
+#include <QThread>
+#include <QVector>
+#include <QString>
+#include "Waypoint.h"
+
+/**
+ * @brief Parses a waypoint file into a new waypoint list
+ *
+ * Two formats are understood, the "QGC WPL 110" text format and a compact
+ * binary format of the same fields, starting with binaryMagic. The format
+ * is detected from the file content. The loader only builds the list, it
+ * does not touch any waypoint manager, so it can run as its own thread
+ * while the UI stays responsive. The waypoints are handed to the thread
+ * given on construction.
+ */
+class WaypointFileLoader : public QThread
+{
+    Q_OBJECT
+
+public:
+    enum Format
+    {
+        FORMAT_TEXT,     ///< "QGC WPL 110", one tab separated line per waypoint
+        FORMAT_BINARY    ///< QDataStream records, see Waypoint::save(QDataStream&)
+    };
+
+    /**
+     * @param fileName File to load
+     * @param target Thread the loaded waypoints will live in
+     */
+    WaypointFileLoader(const QString& fileName, QThread* target, QObject* parent = 0);
+    ~WaypointFileLoader();
+
+    /** @brief Parse the file in the calling thread, run() does the same in the loader thread */
+    void load();
+
+    const QString& getFileName() const { return fileName; }
+    /** @brief False if the file could not be opened or has an unknown format, the list is empty then */
+    bool isCompatible() const { return compatible; }
+    /** @brief Empty if the whole file was loaded, otherwise the reason for a partial or failed load */
+    const QString& getErrorString() const { return errorString; }
+    /** @brief Take over the loaded waypoints, afterwards the loader holds none */
+    QVector<Waypoint*> takeWaypoints();
+
+    /** @brief Format a file should be saved in, binary for the .wpb suffix */
+    static Format formatForFileName(const QString& fileName);
+
+    static const quint32 binaryMagic = 0x51575042; ///< "QWPB"
+    static const quint16 binaryVersion = 1;
+
+protected:
+    QString fileName;
+    QThread* target;
+    QVector<Waypoint*> waypoints;
+    bool compatible;
+    QString errorString;
+
+    void run();
+    void loadText(QIODevice* device);
+    void loadBinary(QIODevice* device);
+};
+
+#endif // WAYPOINTFILELOADER_H
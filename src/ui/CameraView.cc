@@ -29,15 +29,14 @@ This file is part of the QGROUNDCONTROL project
  */
 
 #include "CameraView.h"
+#include "UAS.h"
 #include <QDebug>
 
 CameraView::CameraView(int width, int height, int depth, int channels, QWidget* parent) : QGLWidget(parent)
 {
-    rawImage = NULL;
-    rawBuffer1 = NULL;
-    rawBuffer2 = NULL;
+    rawVideo = false;
+    imageTransfer = NULL;
     rawLastIndex = 0;
-    image = NULL;
     imageStarted = false;
     // Init to black image
     //setImageSize(width, height, depth, channels);
@@ -66,8 +65,6 @@ CameraView::CameraView(int width, int height, int depth, int channels, QWidget*
 
 CameraView::~CameraView()
 {
-    delete rawImage;
-    delete image;
 }
 
 void CameraView::addUAS(UASInterface* uas)
@@ -75,55 +72,33 @@ void CameraView::addUAS(UASInterface* uas)
     // TODO Enable multi-uas support
     connect(uas, SIGNAL(imageStarted(int,int,int,int,int)), this, SLOT(startImage(int,int,int,int,int)));
     connect(uas, SIGNAL(imageDataReceived(int,const unsigned char*,int,int)), this, SLOT(setPixels(int,const unsigned char*,int,int)));
+
+    // Reassembled encapsulated images
+    UAS* u = dynamic_cast<UAS*>(uas);
+    if (u)
+    {
+        connect(u, SIGNAL(imageReceived(int,QImage)), this, SLOT(setImage(int,QImage)));
+        imageTransfer = u->getImageTransfer();
+    }
 }
 
 void CameraView::setImageSize(int width, int height, int depth, int channels)
 {
     // Allocate raw image in correct size
-    if (width != receivedWidth || height != receivedHeight || depth != receivedDepth || channels != receivedChannels || image == NULL)
+    if (width != receivedWidth || height != receivedHeight || depth != receivedDepth || channels != receivedChannels || videoBuffer.getRawSize() == 0)
     {
         // Set new size
         if (width > 0) receivedWidth  = width;
         if (height > 0) receivedHeight = height;
         if (depth > 1) receivedDepth = depth;
-        if (channels > 1) receivedChannels = channels;
-
-        rawExpectedBytes = (receivedWidth * receivedHeight * receivedDepth * receivedChannels) / 8;
-        bytesPerLine = rawExpectedBytes / receivedHeight;
-        // Delete old buffers if necessary
-        rawImage = NULL;
-        if (rawBuffer1 != NULL) delete rawBuffer1;
-        if (rawBuffer2 != NULL) delete rawBuffer2;
-
-        rawBuffer1 = (unsigned char*)malloc(rawExpectedBytes);
-        rawBuffer2 = (unsigned char*)malloc(rawExpectedBytes);
-        rawImage = rawBuffer1;
-        // TODO check if old image should be deleted
-
-        // Set image format
-        // 8 BIT GREYSCALE IMAGE
-        if (depth <= 8 && channels == 1)
-        {
-            image = new QImage(receivedWidth, receivedHeight, QImage::Format_Indexed8);
-            // Create matching color table
-            image->setNumColors(256);
-            for (int i = 0; i < 256; i++)
-            {
-                image->setColor(i, qRgb(i, i, i));
-                //qDebug() << __FILE__ << __LINE__ << std::hex << i;
-            }
+        if (channels > 0) receivedChannels = channels;
 
-        }
-        // 32 BIT COLOR IMAGE WITH ALPHA VALUES (#ARGB)
-        else
+        // The buffers are only reallocated here, not per frame
+        if (!videoBuffer.setFormat(receivedWidth, receivedHeight, receivedDepth, receivedChannels))
         {
-            image = new QImage(receivedWidth, receivedHeight, QImage::Format_ARGB32);
+            qDebug() << "CAMERAVIEW: Unsupported raw image format," << receivedDepth << "bit with" << receivedChannels << "channels";
         }
 
-        // Fill image with black pixels
-        image->fill(CameraView::initialColor);
-        glImage = QGLWidget::convertToGLFormat(*image);
-
         qDebug() << __FILE__ << __LINE__ << "Setting up image";
 
         // Set size once
@@ -161,43 +136,24 @@ void CameraView::finishImage()
 
 void CameraView::commitRawDataToGL()
 {
-    //qDebug() << __FILE__ << __LINE__ << "Copying raw data to GL buffer:" << rawImage << receivedWidth << receivedHeight << image->format();
-    if (image != NULL)
-    {
-        QImage::Format format = image->format();
-        QImage* newImage = new QImage(rawImage, receivedWidth, receivedHeight, format);
-        if (format == QImage::Format_Indexed8)
-        {
-            // Create matching color table
-            newImage->setNumColors(256);
-            for (int i = 0; i < 256; i++)
-            {
-                newImage->setColor(i, qRgb(i, i, i));
-                //qDebug() << __FILE__ << __LINE__ << std::hex << i;
-            }
-        }
-
-        glImage = QGLWidget::convertToGLFormat(*newImage);
-        delete image;
-        image = newImage;
-        // Switch buffers
-        if (rawImage == rawBuffer1)
-        {
-            rawImage = rawBuffer2;
-            //qDebug() << "Now buffer 2";
-        }
-        else
-        {
-            rawImage = rawBuffer1;
-            //qDebug() << "Now buffer 1";
-        }
-    }
-    paintGL();
+    // Convert into the back frame, the next paint picks it up
+    videoBuffer.commit();
+    rawVideo = true;
+    update();
 }
 
 void CameraView::saveImage(QString fileName)
 {
-    image->save(fileName);
+    if (videoBuffer.hasFrame()) videoBuffer.toImage().save(fileName);
+}
+
+void CameraView::setImage(int component, QImage image)
+{
+    Q_UNUSED(component);
+    if (image.isNull()) return;
+    glImage = QGLWidget::convertToGLFormat(image.scaled(width(), height()));
+    rawVideo = false;
+    update();
 }
 
 void CameraView::saveImage()
@@ -218,6 +174,7 @@ void CameraView::setPixels(int imgid, const unsigned char* imageData, int length
     if (imageStarted)
     {
         //if (rawLastIndex != startIndex) qDebug() << "PACKET LOSS!";
+        unsigned int rawExpectedBytes = videoBuffer.getRawSize();
 
         if (startIndex+length > rawExpectedBytes)
         {
@@ -225,7 +182,7 @@ void CameraView::setPixels(int imgid, const unsigned char* imageData, int length
         }
         else
         {
-            memcpy(rawImage+startIndex, imageData, length);
+            memcpy(videoBuffer.getRawBuffer()+startIndex, imageData, length);
 
             rawLastIndex = startIndex+length;
 
@@ -252,7 +209,21 @@ void CameraView::setPixels(int imgid, const unsigned char* imageData, int length
 
 void CameraView::paintGL()
 {
-    glDrawPixels(glImage.width(), glImage.height(), GL_RGBA, GL_UNSIGNED_BYTE, glImage.bits());
+    if (rawVideo)
+    {
+        // Take the latest converted frame, if none arrived keep the last one
+        videoBuffer.acquire();
+        glDrawPixels(videoBuffer.getWidth(), videoBuffer.getHeight(), GL_RGBA, GL_UNSIGNED_BYTE, videoBuffer.getFrontPixels());
+        renderText(5, 15, tr("%1 fps %2 us").arg(videoBuffer.getFrameRate(), 0, 'f', 1).arg(videoBuffer.getConversionTime(), 0, 'f', 0));
+    }
+    else
+    {
+        glDrawPixels(glImage.width(), glImage.height(), GL_RGBA, GL_UNSIGNED_BYTE, glImage.bits());
+        if (imageTransfer && imageTransfer->getFramesDecoded() > 0)
+        {
+            renderText(5, 15, tr("%1 fps %2 % loss %3 lost").arg(imageTransfer->getFrameRate(), 0, 'f', 1).arg(imageTransfer->getLossRate() * 100.0f, 0, 'f', 0).arg(imageTransfer->getFramesLost()));
+        }
+    }
 }
 
 void CameraView::resizeGL(int w, int h)
@@ -35,6 +35,9 @@ This file is part of the PIXHAWK project
 #include <QImage>
 #include <QGLWidget>
 #include "UASInterface.h"
+#include "QGCRawVideoBuffer.h"
+
+class QGCUASImageTransfer;
 
 class CameraView : public QGLWidget
 {
@@ -54,19 +57,18 @@ public slots:
     void finishImage();
     void saveImage();
     void saveImage(QString fileName);
+    /** @brief Show a decoded camera image */
+    void setImage(int component, QImage image);
 
 protected:
     // Image buffers
-    unsigned char* rawBuffer1;
-    unsigned char* rawBuffer2;
-    unsigned char* rawImage;
+    QGCRawVideoBuffer videoBuffer; ///< Raw camera frames, converted for glDrawPixels without allocations
+    bool rawVideo; ///< Display videoBuffer instead of glImage
+    QGCUASImageTransfer* imageTransfer; ///< Source of the decoded images, NULL if none
     unsigned int rawLastIndex;
-    unsigned int rawExpectedBytes;
-    unsigned int bytesPerLine;
     bool imageStarted;
     static const unsigned char initialColor = 0;
-    QImage* image; ///< Double buffer image
-    QImage glImage; ///< Displayed image
+    QImage glImage; ///< Displayed decoded image
     int receivedDepth;
     int receivedChannels;
     int receivedWidth;
@@ -40,17 +40,26 @@ This file is part of the QGROUNDCONTROL project
 #include "SerialConfigurationWindow.h"
 #include "SerialLink.h"
 #include "UDPLink.h"
+#include "TCPLink.h"
 #include "MAVLinkSimulationLink.h"
+#include "MAVLinkLoadGeneratorLink.h"
 #ifdef OPAL_RT
 #include "OpalLink.h"
 #include "OpalLinkConfigurationWindow.h"
 #endif
+#ifdef QGC_SHM_LINK
+#include "SharedMemoryLink.h"
+#include "QGCSharedMemoryLinkConfiguration.h"
+#endif
 #include "MAVLinkProtocol.h"
 #include "MAVLinkSettingsWidget.h"
 #include "QGCUDPLinkConfiguration.h"
+#include "QGCTCPLinkConfiguration.h"
+#include "QGCLoadGeneratorLinkConfiguration.h"
 #include "LinkManager.h"
 
-CommConfigurationWindow::CommConfigurationWindow(LinkInterface* link, ProtocolInterface* protocol, QWidget *parent, Qt::WindowFlags flags) : QWidget(parent, flags)
+CommConfigurationWindow::CommConfigurationWindow(LinkInterface* link, ProtocolInterface* protocol, QWidget *parent, Qt::WindowFlags flags) : QWidget(parent, flags),
+    mavlink(NULL)
 {
     this->link = link;
 
@@ -60,8 +69,13 @@ CommConfigurationWindow::CommConfigurationWindow(LinkInterface* link, ProtocolIn
     // add link types
     ui.linkType->addItem(tr("Serial"), QGC_LINK_SERIAL);
     ui.linkType->addItem(tr("UDP"), QGC_LINK_UDP);
+    ui.linkType->addItem(tr("TCP"), QGC_LINK_TCP);
     ui.linkType->addItem(tr("Simulation"), QGC_LINK_SIMULATION);
+    ui.linkType->addItem(tr("Load Generator"), QGC_LINK_LOAD_GENERATOR);
     ui.linkType->addItem(tr("Opal-RT Link"), QGC_LINK_OPAL);
+#ifdef QGC_SHM_LINK
+    ui.linkType->addItem(tr("Shared Memory"), QGC_LINK_SHARED_MEMORY);
+#endif
     ui.linkType->setEditable(false);
     //ui.linkType->setEnabled(false);
 
@@ -127,14 +141,34 @@ CommConfigurationWindow::CommConfigurationWindow(LinkInterface* link, ProtocolIn
         layout->addWidget(conf);
         ui.linkGroupBox->setLayout(layout);
         ui.linkGroupBox->setTitle(tr("UDP Link"));
-        ui.linkType->setCurrentIndex(1);
+        ui.linkType->setCurrentIndex(ui.linkType->findData(QGC_LINK_UDP));
+    }
+    TCPLink* tcp = dynamic_cast<TCPLink*>(link);
+    if (tcp != 0)
+    {
+        QWidget* conf = new QGCTCPLinkConfiguration(tcp, this);
+        QBoxLayout* layout = new QBoxLayout(QBoxLayout::LeftToRight, ui.linkGroupBox);
+        layout->addWidget(conf);
+        ui.linkGroupBox->setLayout(layout);
+        ui.linkGroupBox->setTitle(tr("TCP Link"));
+        ui.linkType->setCurrentIndex(ui.linkType->findData(QGC_LINK_TCP));
     }
     MAVLinkSimulationLink* sim = dynamic_cast<MAVLinkSimulationLink*>(link);
     if (sim != 0)
     {
-        ui.linkType->setCurrentIndex(2);
+        ui.linkType->setCurrentIndex(ui.linkType->findData(QGC_LINK_SIMULATION));
         ui.linkGroupBox->setTitle(tr("MAVLink Simulation Link"));
     }
+    MAVLinkLoadGeneratorLink* load = dynamic_cast<MAVLinkLoadGeneratorLink*>(link);
+    if (load != 0)
+    {
+        QWidget* conf = new QGCLoadGeneratorLinkConfiguration(load, this);
+        QBoxLayout* layout = new QBoxLayout(QBoxLayout::LeftToRight, ui.linkGroupBox);
+        layout->addWidget(conf);
+        ui.linkGroupBox->setLayout(layout);
+        ui.linkGroupBox->setTitle(tr("MAVLink Load Generator"));
+        ui.linkType->setCurrentIndex(ui.linkType->findData(QGC_LINK_LOAD_GENERATOR));
+    }
 #ifdef OPAL_RT
     OpalLink* opal = dynamic_cast<OpalLink*>(link);
     if (opal != 0)
@@ -143,13 +177,28 @@ CommConfigurationWindow::CommConfigurationWindow(LinkInterface* link, ProtocolIn
         QBoxLayout* layout = new QBoxLayout(QBoxLayout::LeftToRight, ui.linkGroupBox);
         layout->addWidget(conf);
         ui.linkGroupBox->setLayout(layout);
-        ui.linkType->setCurrentIndex(3);
+        ui.linkType->setCurrentIndex(ui.linkType->findData(QGC_LINK_OPAL));
         ui.linkGroupBox->setTitle(tr("Opal-RT Link"));
     }
 #endif
-    if (serial == 0 && udp == 0 && sim == 0
+#ifdef QGC_SHM_LINK
+    SharedMemoryLink* shm = dynamic_cast<SharedMemoryLink*>(link);
+    if (shm != 0)
+    {
+        QWidget* conf = new QGCSharedMemoryLinkConfiguration(shm, this);
+        QBoxLayout* layout = new QBoxLayout(QBoxLayout::LeftToRight, ui.linkGroupBox);
+        layout->addWidget(conf);
+        ui.linkGroupBox->setLayout(layout);
+        ui.linkType->setCurrentIndex(ui.linkType->findData(QGC_LINK_SHARED_MEMORY));
+        ui.linkGroupBox->setTitle(tr("Shared Memory Link"));
+    }
+#endif
+    if (serial == 0 && udp == 0 && tcp == 0 && sim == 0 && load == 0
 #ifdef OPAL_RT
         && opal == 0
+#endif
+#ifdef QGC_SHM_LINK
+        && shm == 0
 #endif
         )
     {
@@ -158,7 +207,7 @@ CommConfigurationWindow::CommConfigurationWindow(LinkInterface* link, ProtocolIn
 
 
     // Open details pane for MAVLink if necessary
-    MAVLinkProtocol* mavlink = dynamic_cast<MAVLinkProtocol*>(protocol);
+    mavlink = dynamic_cast<MAVLinkProtocol*>(protocol);
     if (mavlink != 0)
     {
         QWidget* conf = new MAVLinkSettingsWidget(mavlink, this);
@@ -166,10 +215,15 @@ CommConfigurationWindow::CommConfigurationWindow(LinkInterface* link, ProtocolIn
         layout->addWidget(conf);
         ui.protocolGroupBox->setLayout(layout);
         ui.protocolGroupBox->setTitle(protocol->getName()+" (Global Settings)");
+
+        // Duplicate statistics of this link
+        connect(&statisticsTimer, SIGNAL(timeout()), this, SLOT(updateRedundancy()));
+        statisticsTimer.start(1000);
     }
     else
     {
         qDebug() << "Protocol is NOT MAVLink, can't open configuration window";
+        ui.redundancyLabel->hide();
     }
 
     // Open details for UDP link if necessary
@@ -238,6 +292,24 @@ void CommConfigurationWindow::remove()
     this->deleteLater();
 }
 
+void CommConfigurationWindow::updateRedundancy()
+{
+    if (!isVisible() || !link || !mavlink) return;
+    quint64 first = mavlink->getFirstArrivals(link);
+    quint64 copies = mavlink->getDuplicateArrivals(link);
+    if (copies == 0)
+    {
+        ui.redundancyLabel->setText(tr("No packets received over redundant links"));
+    }
+    else
+    {
+        ui.redundancyLabel->setText(tr("Arrived first: %1 % (%2 packets), duplicates dropped: %3")
+                                    .arg(100.0 * first / (first + copies), 0, 'f', 1)
+                                    .arg(first)
+                                    .arg(copies));
+    }
+}
+
 void CommConfigurationWindow::connectionState(bool connect)
 {
     ui.connectButton->setChecked(connect);
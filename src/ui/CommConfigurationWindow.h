@@ -35,17 +35,23 @@ This file is part of the QGROUNDCONTROL project
 #include <QObject>
 #include <QWidget>
 #include <QAction>
+#include <QTimer>
 #include "LinkInterface.h"
 #include "ProtocolInterface.h"
 #include "ui_CommSettings.h"
 
+class MAVLinkProtocol;
+
 enum qgc_link_t
 {
     QGC_LINK_SERIAL,
     QGC_LINK_UDP,
     QGC_LINK_SIMULATION,
     QGC_LINK_FORWARDING,
-    QGC_LINK_OPAL
+    QGC_LINK_OPAL,
+    QGC_LINK_SHARED_MEMORY,
+    QGC_LINK_TCP,
+    QGC_LINK_LOAD_GENERATOR
 };
 
 enum qgc_protocol_t
@@ -81,12 +87,16 @@ public slots:
     void setLinkName(QString name);
     /** @brief Disconnects the associated link, removes it from all menus and closes the window. */
     void remove();
+    /** @brief Show how many packets of this link arrived first on redundant links */
+    void updateRedundancy();
 
 private:
 
     Ui::commSettings ui;
     LinkInterface* link;
     QAction* action;
+    MAVLinkProtocol* mavlink; ///< Protocol which counts the duplicates, NULL for other protocols
+    QTimer statisticsTimer;
 };
 
 
@@ -20,6 +20,9 @@
 #include <QSettings>
 #include <qmath.h>
 #include "UASManager.h"
+#include "QGCFrameScheduler.h"
+#include "QGCLabelCache.h"
+#include "QGCGeometry.h"
 #include "HDDisplay.h"
 #include "ui_HDDisplay.h"
 #include "MG.h"
@@ -41,7 +44,6 @@ HDDisplay::HDDisplay(QStringList* plotList, QString title, QWidget *parent) :
         infoColor(QColor(20, 200, 20)),
         fuelColor(criticalColor),
         warningBlinkRate(5),
-        refreshTimer(new QTimer(this)),
         hardwareAcceleration(true),
         strongStrokeWidth(1.5f),
         normalStrokeWidth(1.0f),
@@ -114,9 +116,8 @@ HDDisplay::HDDisplay(QStringList* plotList, QString title, QWidget *parent) :
     this->setMinimumHeight(125);
     this->setMinimumWidth(100);
 
-    // Refresh timer
-    refreshTimer->setInterval(180); //
-    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(triggerUpdate()));
+    // Repaint with the other instruments when new data arrived
+    QGCFrameScheduler::instance()->registerClient(this, NULL, updateInterval);
     //connect(refreshTimer, SIGNAL(timeout()), this, SLOT(paintGL()));
 
     fontDatabase = QFontDatabase();
@@ -218,7 +219,8 @@ void HDDisplay::saveState()
     for (int i = 0; i < acceptList->count(); i++)
     {
         QString key = acceptList->at(i);
-        instruments += "|" + QString::number(minValues.value(key, -1.0))+","+key+","+acceptUnitList->at(i)+","+QString::number(maxValues.value(key, +1.0))+","+((symmetric.value(key, false)) ? "s" : "");
+        const GaugeSlot& gauge = gauges.at(i);
+        instruments += "|" + QString::number(gauge.min)+","+key+","+acceptUnitList->at(i)+","+QString::number(gauge.max)+","+((gauge.symmetric) ? "s" : "");
     }
 
    // qDebug() << "Saving" << instruments;
@@ -261,10 +263,17 @@ void HDDisplay::removeItemByAction()
     {
         QString item = trigger->data().toString();
         int index = acceptList->indexOf(item);
+        if (index < 0) return;
         acceptList->removeAt(index);
-        minValues.remove(item);
-        maxValues.remove(item);
-        symmetric.remove(item);
+        acceptUnitList->removeAt(index);
+        gauges.remove(index);
+        // Further values of this variable are dropped, the
+        // following gauges moved one slot up
+        channels.insert(item, -1);
+        for (int i = index; i < acceptList->size(); ++i)
+        {
+            channels.insert(acceptList->at(i), i);
+        }
         adjustGaugeAspectRatio();
     }
 }
@@ -272,10 +281,12 @@ void HDDisplay::removeItemByAction()
 void HDDisplay::addGauge()
 {
     QStringList items;
-    for (int i = 0; i < values.count(); ++i)
+    QMapIterator<QString, QString> i(units);
+    while (i.hasNext())
     {
-        QString key = values.keys().at(i);
-        QString unit = units.value(key);
+        i.next();
+        QString key = i.key();
+        QString unit = i.value();
         if (unit.contains("deg") || unit.contains("rad"))
         {
             items.append(QString("%1,%2,%3,%4,s").arg("-180").arg(key).arg(unit).arg("+180"));
@@ -310,35 +321,40 @@ void HDDisplay::addGauge(const QString& gauge)
 
             if (!acceptList->contains(key))
             {
+                GaugeSlot gauge;
                 // Convert min to double number
                 val = parts.first().toDouble(&ok);
                 success &= ok;
-                if (ok) minValues.insert(key, val);
+                if (ok)
+                {
+                    gauge.min = val;
+                    gauge.value = val;
+                }
                 // Convert max to double number
-                val = parts.at(3).toDouble(&ok);
+                val = parts.value(3).toDouble(&ok);
                 success &= ok;
-                if (ok) maxValues.insert(key, val);
+                if (ok) gauge.max = val;
                 // Convert symmetric flag
                 if (parts.length() >= 5)
                 {
                     if (parts.at(4).contains("s"))
                     {
-                        symmetric.insert(key, true);
+                        gauge.symmetric = true;
                     }
                 }
                 if (success)
                 {
                     // Add value to acceptlist
-                    acceptList->append(key);
+                    addSlot(key) = gauge;
                     acceptUnitList->append(unit);
                 }
             }
         }
         else if (parts.count() > 1)
         {
-            if (!acceptList->contains(gauge))
+            if (!acceptList->contains(parts.at(0)))
             {
-                acceptList->append(parts.at(0));
+                addSlot(parts.at(0));
                 acceptUnitList->append(parts.at(1));
             }
         }
@@ -386,6 +402,7 @@ void HDDisplay::adjustGaugeAspectRatio()
     int vRows = ceil(acceptList->length()/(float)columns);
     // Assuming square instruments, vheight is column width*row count
     vheight = vColWidth * vRows;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HDDisplay::setTitle()
@@ -404,6 +421,17 @@ void HDDisplay::setTitle()
 }
 
 void HDDisplay::renderOverlay()
+{
+    paintOverlay(viewport());
+}
+
+void HDDisplay::renderOffscreen(QImage* image)
+{
+    if (size() != image->size()) resize(image->size());
+    paintOverlay(image);
+}
+
+void HDDisplay::paintOverlay(QPaintDevice* device)
 {
 #if (QGC_EVENTLOOP_DEBUG)
     qDebug() << "EVENTLOOP:" << __FILE__ << __LINE__;
@@ -425,7 +453,7 @@ void HDDisplay::renderOverlay()
     double scalingFactorH = this->height()/vheight;
     if (scalingFactorH < scalingFactor) scalingFactor = scalingFactorH;
 
-    QPainter painter(viewport());
+    QPainter painter(device);
     painter.setRenderHint(QPainter::Antialiasing, true);
     painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
     //painter.fillRect(QRect(0, 0, width(), height()), backgroundColor);
@@ -446,7 +474,8 @@ void HDDisplay::renderOverlay()
     for (int i = 0; i < acceptList->size(); ++i)
     {
         QString value = acceptList->at(i);
-        drawGauge(xCoord, yCoord, gaugeWidth/2.0f, minValues.value(value, -1.0f), maxValues.value(value, 1.0f), value, values.value(value, minValues.value(value, 0.0f)), gaugeColor, &painter, symmetric.value(value, false), goodRanges.value(value, qMakePair(0.0f, 0.5f)), critRanges.value(value, qMakePair(0.7f, 1.0f)), true);
+        const GaugeSlot& gauge = gauges.at(i);
+        drawGauge(xCoord, yCoord, gaugeWidth/2.0f, gauge.min, gauge.max, value, gauge.value, gaugeColor, &painter, gauge.symmetric, goodRanges.value(value, qMakePair(0.0f, 0.5f)), critRanges.value(value, qMakePair(0.7f, 1.0f)), true, gauge.integer);
         xCoord += gaugeWidth + leftSpacing;
         // Move one row down if necessary
         if (xCoord + gaugeWidth*0.9f > vwidth)
@@ -487,36 +516,14 @@ void HDDisplay::setActiveUAS(UASInterface* uas)
  */
 void HDDisplay::rotatePolygonClockWiseRad(QPolygonF& p, float angle, QPointF origin)
 {
-    // Standard 2x2 rotation matrix, counter-clockwise
-    //
-    //   |  cos(phi)   sin(phi) |
-    //   | -sin(phi)   cos(phi) |
-    //
-    for (int i = 0; i < p.size(); i++)
-    {
-        QPointF curr = p.at(i);
-
-        const float x = curr.x();
-        const float y = curr.y();
-
-        curr.setX(((cos(angle) * (x-origin.x())) + (-sin(angle) * (y-origin.y()))) + origin.x());
-        curr.setY(((sin(angle) * (x-origin.x())) + (cos(angle) * (y-origin.y()))) + origin.y());
-        p.replace(i, curr);
-    }
+    QGCGeometry::rotate(p, angle, origin);
 }
 
 void HDDisplay::drawPolygon(QPolygonF refPolygon, QPainter* painter)
 {
-    // Scale coordinates
-    QPolygonF draw(refPolygon.size());
-    for (int i = 0; i < refPolygon.size(); i++)
-    {
-        QPointF curr;
-        curr.setX(refToScreenX(refPolygon.at(i).x()));
-        curr.setY(refToScreenY(refPolygon.at(i).y()));
-        draw.replace(i, curr);
-    }
-    painter->drawPolygon(draw);
+    // Scale coordinates into the reused screen buffer
+    QGCGeometry::scale(refPolygon, scalingFactor, screenPolygon);
+    painter->drawPolygon(screenPolygon);
 }
 
 void HDDisplay::drawChangeRateStrip(float xRef, float yRef, float height, float minRate, float maxRate, float value, QPainter* painter)
@@ -564,7 +571,7 @@ void HDDisplay::drawChangeRateStrip(float xRef, float yRef, float height, float
     paintText(label, defaultColor, 3.0f, xRef+width/2.0f, yRef+height-((scaledValue - minRate)/(maxRate-minRate))*height - 1.6f, painter);
 }
 
-void HDDisplay::drawGauge(float xRef, float yRef, float radius, float min, float max, QString name, float value, const QColor& color, QPainter* painter, bool symmetric, QPair<float, float> goodRange, QPair<float, float> criticalRange, bool solid)
+void HDDisplay::drawGauge(float xRef, float yRef, float radius, float min, float max, QString name, float value, const QColor& color, QPainter* painter, bool symmetric, QPair<float, float> goodRange, QPair<float, float> criticalRange, bool solid, bool integer)
 {
     // Draw the circle
     QPen circlePen(Qt::SolidLine);
@@ -619,7 +626,7 @@ void HDDisplay::drawGauge(float xRef, float yRef, float radius, float min, float
     QString label;
 
     // Show integer values without decimal places
-    if (intValues.contains(name))
+    if (integer)
     {
         label.sprintf("% 05d", (int)value);
     }
@@ -701,15 +708,14 @@ void HDDisplay::drawGauge(float xRef, float yRef, float radius, float min, float
 
 void HDDisplay::drawSystemIndicator(float xRef, float yRef, int maxNum, float maxWidth, float maxHeight, QPainter* painter)
 {
-    if (values.size() > 0)
+    if (gauges.size() > 0)
     {
-        QString selectedKey = values.begin().key();
+        const int selected = 0;
         //   | | | | | |
         //   | | | | | |
         //   x speed: 2.54
 
         // One column per value
-        QMapIterator<QString, float> value(values);
 
         float x = xRef;
         float y = yRef;
@@ -720,17 +726,17 @@ void HDDisplay::drawSystemIndicator(float xRef, float yRef, int maxNum, float ma
         const float hspacing = 0.6f;
 
         int i = 0;
-        while (value.hasNext() && i < maxNum && x < maxWidth && y < maxHeight)
+        while (i < gauges.size() && i < maxNum && x < maxWidth && y < maxHeight)
         {
-            value.next();
+            const float value = gauges.at(i).value;
             QBrush brush(Qt::SolidPattern);
 
 
-            if (value.value() < 0.01f && value.value() > -0.01f)
+            if (value < 0.01f && value > -0.01f)
             {
                 brush.setColor(Qt::gray);
             }
-            else if (value.value() > 0.01f)
+            else if (value > 0.01f)
             {
                 brush.setColor(Qt::blue);
             }
@@ -761,11 +767,11 @@ void HDDisplay::drawSystemIndicator(float xRef, float yRef, int maxNum, float ma
         // Draw detail label
         QString detail = "NO DATA AVAILABLE";
 
-        if (values.contains(selectedKey))
+        if (gauges.at(selected).count > 0)
         {
-            detail = values.find(selectedKey).key();
+            detail = acceptList->at(selected);
             detail.append(": ");
-            detail.append(QString::number(values.find(selectedKey).value()));
+            detail.append(QString::number(gauges.at(selected).value));
         }
         paintText(detail, QColor(255, 255, 255), 3.0f, xRef, yRef+3.0f*(height+hspacing)+1.0f, painter);
     }
@@ -827,26 +833,15 @@ void HDDisplay::drawChangeIndicatorGauge(float xRef, float yRef, float radius, f
  */
 void HDDisplay::paintText(QString text, QColor color, float fontSize, float refX, float refY, QPainter* painter)
 {
-    QPen prevPen = painter->pen();
     float pPositionX = refToScreenX(refX) - (fontSize*scalingFactor*0.072f);
     float pPositionY = refToScreenY(refY) - (fontSize*scalingFactor*0.212f);
 
-    QFont font("Bitstream Vera Sans");
     // Enforce minimum font size of 5 pixels
     int fSize = qMax(5, (int)(fontSize*scalingFactor*1.26f));
-    font.setPixelSize(fSize);
-
-    QFontMetrics metrics = QFontMetrics(font);
-    int border = qMax(4, metrics.leading());
-    QRect rect = metrics.boundingRect(0, 0, width() - 2*border, int(height()*0.125),
-                                      Qt::AlignLeft | Qt::TextWordWrap, text);
-    painter->setPen(color);
-    painter->setFont(font);
-    painter->setRenderHint(QPainter::TextAntialiasing);
-    painter->drawText(pPositionX, pPositionY,
-                      rect.width(), rect.height(),
-                      Qt::AlignCenter | Qt::TextWordWrap, text);
-    painter->setPen(prevPen);
+
+    // The same labels are drawn every frame, blit them from the cache
+    QGCLabelCache::instance()->drawLabel(painter, QPoint((int)pPositionX, (int)pPositionY), text, color,
+                                         fSize, QSize(width(), int(height()*0.125)));
 }
 
 float HDDisplay::refLineWidthToPen(float line)
@@ -856,23 +851,52 @@ float HDDisplay::refLineWidthToPen(float line)
 
 void HDDisplay::updateValue(const int uasId, const QString& name, const QString& unit, const int value, const quint64 msec)
 {
-    if (!intValues.contains(name)) intValues.insert(name, true);
-    updateValue(uasId, name, unit, (double)value, msec);
+    Q_UNUSED(uasId);
+    storeValue(name, unit, value, msec, true);
 }
 
 void HDDisplay::updateValue(const int uasId, const QString& name, const QString& unit, const double value, const quint64 msec)
 {
     Q_UNUSED(uasId);
-    Q_UNUSED(unit);
+    storeValue(name, unit, value, msec, false);
+}
+
+HDDisplay::GaugeSlot& HDDisplay::addSlot(const QString& name)
+{
+    acceptList->append(name);
+    gauges.append(GaugeSlot());
+    channels.insert(name, gauges.size() - 1);
+    return gauges.last();
+}
+
+void HDDisplay::storeValue(const QString& name, const QString& unit, double value, quint64 msec, bool integer)
+{
+    // The UAS sends all its values, most of them are not displayed.
+    // Resolve the name once and drop them before any other work.
+    QHash<QString, int>::const_iterator channel = channels.constFind(name);
+    if (channel == channels.constEnd())
+    {
+        // First value of this variable, offer it in the gauge menu
+        channels.insert(name, -1);
+        units.insert(name, unit);
+        return;
+    }
+    if (channel.value() < 0) return;
+
+    GaugeSlot& gauge = gauges[channel.value()];
+    if (gauge.count == 0)
+    {
+        // Configured gauge, first value
+        units.insert(name, unit);
+    }
     // Update mean
-    const float oldMean = valuesMean.value(name, 0.0f);
-    const int meanCount = valuesCount.value(name, 0);
-    valuesMean.insert(name, (oldMean * meanCount +  value) / (meanCount + 1));
-    valuesCount.insert(name, meanCount + 1);
-    valuesDot.insert(name, (value - values.value(name, 0.0f)) / ((msec - lastUpdate.value(name, 0))/1000.0f));
-    values.insert(name, value);
-    units.insert(name, unit);
-    lastUpdate.insert(name, msec);
+    gauge.mean = (gauge.mean * gauge.count + value) / (gauge.count + 1);
+    gauge.count++;
+    gauge.dot = (value - gauge.value) / ((msec - gauge.lastUpdate)/1000.0f);
+    gauge.value = value;
+    gauge.lastUpdate = msec;
+    gauge.integer = integer;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 /**
@@ -943,8 +967,8 @@ void HDDisplay::showEvent(QShowEvent* event)
 {
     // React only to internal (pre-display)
     // events
+    // The frame scheduler repaints as soon as the widget is visible
     Q_UNUSED(event);
-    refreshTimer->start(updateInterval);
 }
 
 void HDDisplay::hideEvent(QHideEvent* event)
@@ -952,7 +976,6 @@ void HDDisplay::hideEvent(QHideEvent* event)
     // React only to internal (pre-display)
     // events
     Q_UNUSED(event);
-    refreshTimer->stop();
     saveState();
 }
 
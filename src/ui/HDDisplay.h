@@ -37,8 +37,11 @@ This file is part of the QGROUNDCONTROL project
 #include <QTimer>
 #include <QFontDatabase>
 #include <QMap>
+#include <QHash>
+#include <QVector>
 #include <QContextMenuEvent>
 #include <QPair>
+#include <QPolygonF>
 #include <cmath>
 
 #include "UASInterface.h"
@@ -62,6 +65,9 @@ public:
     HDDisplay(QStringList* plotList, QString title="", QWidget *parent = 0);
     ~HDDisplay();
 
+    /** @brief Render the current state into an image, the widget is resized to the image */
+    void renderOffscreen(QImage* image);
+
 public slots:
     /** @brief Update a HDD double value */
     void updateValue(const int uasId, const QString& name, const QString& unit, const double value, const quint64 msec);
@@ -98,6 +104,8 @@ protected:
     QSize sizeHint() const;
     void changeEvent(QEvent* e);
     void paintEvent(QPaintEvent* event);
+    /** @brief Paint all instruments onto a device of the size of this widget */
+    virtual void paintOverlay(QPaintDevice* device);
     void showEvent(QShowEvent* event);
     void hideEvent(QHideEvent* event);
     void contextMenuEvent(QContextMenuEvent* event);
@@ -116,7 +124,7 @@ protected:
 
     void drawChangeRateStrip(float xRef, float yRef, float height, float minRate, float maxRate, float value, QPainter* painter);
     void drawChangeIndicatorGauge(float xRef, float yRef, float radius, float expectedMaxChange, float value, const QColor& color, QPainter* painter, bool solid=true);
-    void drawGauge(float xRef, float yRef, float radius, float min, float max, const QString name, float value, const QColor& color, QPainter* painter, bool symmetric, QPair<float, float> goodRange, QPair<float, float> criticalRange, bool solid=true);
+    void drawGauge(float xRef, float yRef, float radius, float min, float max, const QString name, float value, const QColor& color, QPainter* painter, bool symmetric, QPair<float, float> goodRange, QPair<float, float> criticalRange, bool solid=true, bool integer=false);
     void drawSystemIndicator(float xRef, float yRef, int maxNum, float maxWidth, float maxHeight, QPainter* painter);
     void paintText(QString text, QColor color, float fontSize, float refX, float refY, QPainter* painter);
 
@@ -138,19 +146,34 @@ protected:
 //     virtual void resizeEvent(QResizeEvent* event);
 
     UASInterface* uas;                 ///< The uas currently monitored
-    QMap<QString, float> values;       ///< The variables this HUD displays
-    QMap<QString, QString> units;      ///< The units
-    QMap<QString, float> valuesDot;    ///< First derivative of the variable
-    QMap<QString, float> valuesMean;   ///< Mean since system startup for this variable
-    QMap<QString, int> valuesCount;    ///< Number of values received so far
-    QMap<QString, quint64> lastUpdate; ///< The last update time for this variable
-    QMap<QString, float> minValues;    ///< The minimum value this variable is assumed to have
-    QMap<QString, float> maxValues;    ///< The maximum value this variable is assumed to have
-    QMap<QString, bool> symmetric;     ///< Draw the gauge / dial symmetric bool = yes
-    QMap<QString, bool> intValues;     ///< Is the gauge value an integer?
+    /** @brief Value and settings of one gauge */
+    struct GaugeSlot
+    {
+        GaugeSlot() : value(0.0f), dot(0.0f), mean(0.0f), count(0), lastUpdate(0),
+            min(-1.0f), max(1.0f), symmetric(false), integer(false) {}
+        float value;           ///< The last received value
+        float dot;             ///< First derivative of the value
+        float mean;            ///< Mean since the first received value
+        int count;             ///< Number of values received so far
+        quint64 lastUpdate;    ///< The last update time
+        float min;             ///< The minimum value this variable is assumed to have
+        float max;             ///< The maximum value this variable is assumed to have
+        bool symmetric;        ///< Draw the gauge / dial symmetric
+        bool integer;          ///< Is the gauge value an integer?
+    };
+
+    /** @brief Store a received value in its gauge slot, drop it if no gauge displays it */
+    void storeValue(const QString& name, const QString& unit, double value, quint64 msec, bool integer);
+    /** @brief Append a gauge slot for this variable */
+    GaugeSlot& addSlot(const QString& name);
+
+    QVector<GaugeSlot> gauges;         ///< The variables this HUD displays, in the order of acceptList
+    QHash<QString, int> channels;      ///< Slot in gauges of every known variable, -1 if no gauge displays it
+    QMap<QString, QString> units;      ///< The units of all variables received so far
     QMap<QString, QPair<float, float> > goodRanges; ///< The range of good values
     QMap<QString, QPair<float, float> > critRanges; ///< The range of critical values
     double scalingFactor;      ///< Factor used to scale all absolute values to screen coordinates
+    QPolygonF screenPolygon;   ///< Screen coordinates of the polygon drawn last, reused to avoid allocations
     float xCenterOffset, yCenterOffset; ///< Offset from center of window in mm coordinates
     float vwidth;              ///< Virtual width of this window, 200 mm per default. This allows to hardcode positions and aspect ratios. This virtual image plane is then scaled to the window size.
     float vheight;             ///< Virtual height of this window, 150 mm per default
@@ -170,8 +193,7 @@ protected:
     // Blink rates
     int warningBlinkRate;      ///< Blink rate of warning messages, will be rounded to the refresh rate
 
-    QTimer* refreshTimer;      ///< The main timer, controls the update rate
-    static const int updateInterval = 120; ///< Update interval in milliseconds
+    static const int updateInterval = 120; ///< Minimum repaint interval in milliseconds
     QPainter* hudPainter;
     QFont font;                ///< The HUD font, per default the free Bitstream Vera SANS, which is very close to actual HUD fonts
     QFontDatabase fontDatabase;///< Font database, only used to load the TrueType font file (the HUD font is directly loaded from file rather than from the system)
@@ -35,9 +35,11 @@ This file is part of the QGROUNDCONTROL project
 #include <QGraphicsScene>
 #include <QHBoxLayout>
 #include <QDoubleSpinBox>
+#include <limits>
 #include "UASManager.h"
 #include "HSIDisplay.h"
 #include "QGC.h"
+#include "QGCFrameScheduler.h"
 #include "Waypoint.h"
 #include "UASWaypointManager.h"
 #include "Waypoint2DIcon.h"
@@ -49,6 +51,12 @@ HSIDisplay::HSIDisplay(QWidget *parent) :
         HDDisplay(NULL, "HSI", parent),
         gpsSatellites(),
         satellitesUsed(0),
+        gpsDirty(true),
+        gpsScalingFactor(0.0f),
+        gpsExpiry(0),
+        missionCurrent(-1),
+        missionDirty(true),
+        glyphScalingFactor(0.0f),
         attXSet(0.0f),
         attYSet(0.0f),
         attYawSet(0.0f),
@@ -100,8 +108,6 @@ HSIDisplay::HSIDisplay(QWidget *parent) :
         topMargin(12.0f),
         userSetPointSet(false)
 {
-    refreshTimer->setInterval(updateInterval);
-
     columns = 1;
     this->setAutoFillBackground(true);
     QPalette pal = palette();
@@ -169,6 +175,7 @@ void HSIDisplay::resetMAVState()
     // Setpoints
     positionSetPointKnown = false;
     setPointKnown = false;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HSIDisplay::paintEvent(QPaintEvent * event)
@@ -181,7 +188,7 @@ void HSIDisplay::paintEvent(QPaintEvent * event)
     renderOverlay();
 }
 
-void HSIDisplay::renderOverlay()
+void HSIDisplay::paintOverlay(QPaintDevice* device)
 {
 #if (QGC_EVENTLOOP_DEBUG)
     qDebug() << "EVENTLOOP:" << __FILE__ << __LINE__;
@@ -202,7 +209,7 @@ void HSIDisplay::renderOverlay()
     double scalingFactorH = this->height()/vheight;
     if (scalingFactorH < scalingFactor) scalingFactor = scalingFactorH;
 
-    QPainter painter(viewport());
+    QPainter painter(device);
     painter.setRenderHint(QPainter::Antialiasing, true);
     painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
 
@@ -448,24 +455,28 @@ void HSIDisplay::updatePositionLock(UASInterface* uas, bool lock)
 {
     Q_UNUSED(uas);
     positionLock = lock;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HSIDisplay::updateAttitudeControllerEnabled(bool enabled)
 {
     attControlEnabled = enabled;
     attControlKnown = true;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HSIDisplay::updatePositionXYControllerEnabled(bool enabled)
 {
     xyControlEnabled = enabled;
     xyControlKnown = true;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HSIDisplay::updatePositionZControllerEnabled(bool enabled)
 {
     zControlEnabled = enabled;
     zControlKnown = true;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 QPointF HSIDisplay::metricWorldToBody(QPointF world)
@@ -545,6 +556,7 @@ void HSIDisplay::mouseDoubleClickEvent(QMouseEvent * event)
     {
         if (dragStarted) uiYawSet += (startX - event->globalX()) / this->frameSize().width();
     }
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HSIDisplay::setMetricWidth(double width)
@@ -554,6 +566,7 @@ void HSIDisplay::setMetricWidth(double width)
         metricWidth = width;
         emit metricWidthChanged(metricWidth);
     }
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 /**
@@ -581,6 +594,11 @@ void HSIDisplay::setActiveUAS(UASInterface* uas)
             disconnect(this->uas, SIGNAL(visionLocalizationChanged(UASInterface*,int)), this, SLOT(updateVisionLocalization(UASInterface*,int)));
             disconnect(this->uas, SIGNAL(gpsLocalizationChanged(UASInterface*,int)), this, SLOT(updateGpsLocalization(UASInterface*,int)));
             disconnect(this->uas, SIGNAL(irUltraSoundLocalizationChanged(UASInterface*,int)), this, SLOT(updateInfraredUltrasoundLocalization(UASInterface*,int)));
+
+            UASWaypointManager* wpManager = this->uas->getWaypointManager();
+            disconnect(wpManager, SIGNAL(waypointListChanged()), this, SLOT(invalidateMission()));
+            disconnect(wpManager, SIGNAL(waypointChanged(int,Waypoint*)), this, SLOT(invalidateMission()));
+            disconnect(wpManager, SIGNAL(currentWaypointChanged(quint16)), this, SLOT(invalidateMission()));
         }
 
         connect(uas, SIGNAL(gpsSatelliteStatusChanged(int,int,float,float,float,bool)), this, SLOT(updateSatellite(int,int,float,float,float,bool)));
@@ -601,7 +619,14 @@ void HSIDisplay::setActiveUAS(UASInterface* uas)
         connect(uas, SIGNAL(gpsLocalizationChanged(UASInterface*,int)), this, SLOT(updateGpsLocalization(UASInterface*,int)));
         connect(uas, SIGNAL(irUltraSoundLocalizationChanged(UASInterface*,int)), this, SLOT(updateInfraredUltrasoundLocalization(UASInterface*,int)));
 
+        // The mission is only collected again when it changed
+        UASWaypointManager* wpManager = uas->getWaypointManager();
+        connect(wpManager, SIGNAL(waypointListChanged()), this, SLOT(invalidateMission()));
+        connect(wpManager, SIGNAL(waypointChanged(int,Waypoint*)), this, SLOT(invalidateMission()));
+        connect(wpManager, SIGNAL(currentWaypointChanged(quint16)), this, SLOT(invalidateMission()));
+
         this->uas = uas;
+        missionDirty = true;
 
         resetMAVState();
 }
@@ -614,6 +639,7 @@ void HSIDisplay::updateSpeed(UASInterface* uas, double vx, double vy, double vz,
     this->vy = vy;
     this->vz = vz;
     this->speed = sqrt(pow(vx, 2.0) + pow(vy, 2.0) + pow(vz, 2.0));
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HSIDisplay::setBodySetpointCoordinateXY(double x, double y)
@@ -632,12 +658,14 @@ void HSIDisplay::setBodySetpointCoordinateXY(double x, double y)
         uas->setLocalPositionSetpoint(uiXSetCoordinate, uiYSetCoordinate, uiZSetCoordinate, uiYawSet);
         qDebug() << "Setting new setpoint at x: " << x << "metric y:" << y;
     }
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HSIDisplay::setBodySetpointCoordinateZ(double z)
 {
     // Set coordinates and send them out to MAV
     uiZSetCoordinate = z;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HSIDisplay::sendBodySetPointCoordinates()
@@ -653,6 +681,7 @@ void HSIDisplay::updateAttitudeSetpoints(UASInterface* uas, double rollDesired,
     attYSet = rollDesired;
     attYawSet = yawDesired;
     altitudeSet = thrustDesired;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HSIDisplay::updateAttitude(UASInterface* uas, double roll, double pitch, double yaw, quint64 time)
@@ -662,6 +691,7 @@ void HSIDisplay::updateAttitude(UASInterface* uas, double roll, double pitch, do
     this->roll = roll;
     this->pitch = pitch;
     this->yaw = yaw;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HSIDisplay::updatePositionSetpoints(int uasid, float xDesired, float yDesired, float zDesired, float yawDesired, quint64 usec)
@@ -681,6 +711,7 @@ void HSIDisplay::updatePositionSetpoints(int uasid, float xDesired, float yDesir
     //    posYSet = yDesired;
     //    posZSet = zDesired;
     //    posYawSet = yawDesired;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HSIDisplay::updateLocalPosition(UASInterface*, double x, double y, double z, quint64 usec)
@@ -689,6 +720,7 @@ void HSIDisplay::updateLocalPosition(UASInterface*, double x, double y, double z
     this->y = y;
     this->z = z;
     localAvailable = usec;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HSIDisplay::updateGlobalPosition(UASInterface*, double lat, double lon, double alt, quint64 usec)
@@ -697,6 +729,7 @@ void HSIDisplay::updateGlobalPosition(UASInterface*, double lat, double lon, dou
     this->lon = lon;
     this->alt = alt;
     globalAvailable = usec;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HSIDisplay::updateSatellite(int uasid, int satid, float elevation, float azimuth, float snr, bool used)
@@ -712,12 +745,15 @@ void HSIDisplay::updateSatellite(int uasid, int satid, float elevation, float az
     {
         gpsSatellites.insert(satid, new GPSSatellite(satid, elevation, azimuth, snr, used));
     }
+    gpsDirty = true;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HSIDisplay::updatePositionYawControllerEnabled(bool enabled)
 {
     yawControlEnabled = enabled;
     yawControlKnown = true;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 /**
@@ -729,6 +765,7 @@ void HSIDisplay::updateLocalization(UASInterface* uas, int fix)
     positionFix = fix;
     positionFixKnown = true;
     //qDebug() << "LOCALIZATION FIX CALLED";
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 /**
  * @param fix 0: lost, 1: at least one satellite, but no GPS fix, 2: 2D localization, 3: 3D localization
@@ -738,6 +775,7 @@ void HSIDisplay::updateGpsLocalization(UASInterface* uas, int fix)
     Q_UNUSED(uas);
     gpsFix = fix;
     gpsFixKnown = true;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 /**
  * @param fix 0: lost, 1: 2D local position hold, 2: 2D localization, 3: 3D localization
@@ -748,6 +786,7 @@ void HSIDisplay::updateVisionLocalization(UASInterface* uas, int fix)
     visionFix = fix;
     visionFixKnown = true;
     //qDebug() << "VISION FIX GOT CALLED";
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 /**
@@ -758,6 +797,7 @@ void HSIDisplay::updateInfraredUltrasoundLocalization(UASInterface* uas, int fix
     Q_UNUSED(uas);
     iruFix = fix;
     iruFixKnown = true;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 QColor HSIDisplay::getColorForSNR(float snr)
@@ -809,94 +849,127 @@ void HSIDisplay::drawSetpointXY(float x, float y, float yaw, const QColor &color
     }
 }
 
-void HSIDisplay::drawWaypoints(QPainter& painter)
+void HSIDisplay::invalidateMission()
 {
-    if (uas)
+    missionDirty = true;
+    QGCFrameScheduler::instance()->markDirty(this);
+}
+
+QTransform HSIDisplay::metricWorldToScreen() const
+{
+    // metricWorldToBody(), metricBodyToRef() and refToScreenX/Y()
+    // combined into one affine transformation
+    const double angle = yaw + M_PI;
+    const double c = cos(angle);
+    const double s = sin(angle);
+    const double k = scalingFactor * vwidth / metricWidth;
+    return QTransform(-k * s, k * c,
+                      -k * c, -k * s,
+                      scalingFactor * xCenterPos + k * (s * x + c * y),
+                      scalingFactor * yCenterPos - k * (c * x - s * y));
+}
+
+void HSIDisplay::updateMission()
+{
+    missionPoints.clear();
+    missionYaws.clear();
+    missionCurrent = -1;
+    missionDirty = false;
+    if (!uas) return;
+
+    // Global waypoints are shown with their coordinates
+    // taken as local coordinates, like local waypoints
+    const QVector<Waypoint*>& list = uas->getWaypointManager()->getWaypointList();
+    for (int i = 0; i < list.size(); i++)
+    {
+        missionPoints.append(QPointF(list.at(i)->getX(), list.at(i)->getY()));
+        missionYaws.append(list.at(i)->getYaw());
+        if (list.at(i)->getCurrent()) missionCurrent = i;
+    }
+    missionColor = uas->getColor();
+}
+
+void HSIDisplay::updateWaypointGlyphs()
+{
+    if (glyphScalingFactor == scalingFactor && !waypointGlyph.isNull()) return;
+
+    // Diamond with the corners on the axes
+    const float waypointSize = vwidth / 20.0f * 2.0f;
+    const float half = refToScreenX(waypointSize / 2.0f);
+    const int size = (int)(2.0f * half) + 4;
+    QPolygonF poly(4);
+    poly.replace(0, QPointF(size / 2.0f, size / 2.0f - half));
+    poly.replace(1, QPointF(size / 2.0f + half, size / 2.0f));
+    poly.replace(2, QPointF(size / 2.0f, size / 2.0f + half));
+    poly.replace(3, QPointF(size / 2.0f - half, size / 2.0f));
+
+    for (int i = 0; i < 2; i++)
     {
-		const QVector<Waypoint*>& list = uas->getWaypointManager()->getWaypointList();
-        //        for (int i = 0; i < list.size(); i++)
-        //        {
-        //            QPointF in(list.at(i)->getX(), list.at(i)->getY());
-        //            // Transform from world to body coordinates
-        //            in = metricWorldToBody(in);
-        //            // Scale from metric to screen reference coordinates
-        //            QPointF p = metricBodyToRef(in);
-        //            Waypoint2DIcon* wp = new Waypoint2DIcon();
-        //            wp->setLocalPosition(list.at(i)->getX(), list.at(i)->getY());
-        //            wp->setPos(0, 0);
-        //            scene()->addItem(wp);
-        //        }
-
-        QColor color;
+        const bool current = (i == 1);
+        QPixmap& glyph = current ? currentWaypointGlyph : waypointGlyph;
+        glyph = QPixmap(size, size);
+        glyph.fill(Qt::transparent);
+        QPainter painter(&glyph);
+        painter.setRenderHint(QPainter::Antialiasing, true);
+        painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
+        QPen pen(current ? QGC::colorCyan : missionColor);
+        pen.setWidthF(refLineWidthToPen(current ? 0.8f : 0.4f));
+        painter.setPen(pen);
         painter.setBrush(Qt::NoBrush);
+        painter.drawPolygon(poly);
+    }
+    glyphScalingFactor = scalingFactor;
+}
+
+void HSIDisplay::drawWaypoints(QPainter& painter)
+{
+    if (!uas) return;
 
-        QPointF lastWaypoint;
+    if (missionDirty)
+    {
+        QColor oldColor = missionColor;
+        updateMission();
+        // Repaint the symbols in the new color
+        if (missionColor != oldColor) waypointGlyph = QPixmap();
+    }
+    if (missionPoints.isEmpty()) return;
+    updateWaypointGlyphs();
 
-        for (int i = 0; i < list.size(); i++)
-        {
-            QPointF in;
-            if (list.at(i)->getFrame() == MAV_FRAME_LOCAL)
-            {
-                // Do not transform
-                in = QPointF(list.at(i)->getX(), list.at(i)->getY());
-            }
-            else
-            {
-                // Transform to local coordinates first
-                double x = list.at(i)->getX();
-                double y = list.at(i)->getY();
-                in = QPointF(x, y);
-            }
-            // Transform from world to body coordinates
-            in = metricWorldToBody(in);
-            // Scale from metric to screen reference coordinates
-            QPointF p = metricBodyToRef(in);
-
-            // Setup pen
-            QPen pen(color);
-            painter.setBrush(Qt::NoBrush);
-
-            // DRAW WAYPOINT
-            //drawCircle(p.x(), p.y(), radius, 0.4f, color, &painter);
-            float waypointSize = vwidth / 20.0f * 2.0f;
-            QPolygonF poly(4);
-            // Top point
-            poly.replace(0, QPointF(p.x(), p.y()-waypointSize/2.0f));
-            // Right point
-            poly.replace(1, QPointF(p.x()+waypointSize/2.0f, p.y()));
-            // Bottom point
-            poly.replace(2, QPointF(p.x(), p.y() + waypointSize/2.0f));
-            poly.replace(3, QPointF(p.x() - waypointSize/2.0f, p.y()));
-
-            // Select color based on if this is the current waypoint
-            if (list.at(i)->getCurrent())
-            {
-                color = QGC::colorCyan;//uas->getColor();
-                pen.setWidthF(refLineWidthToPen(0.8f));
-            }
-            else
-            {
-                color = uas->getColor();
-                pen.setWidthF(refLineWidthToPen(0.4f));
-            }
-
-            pen.setColor(color);
-            painter.setPen(pen);
-            float radius = (waypointSize/2.0f) * 0.8 * (1/sqrt(2.0f));
-            drawLine(p.x(), p.y(), p.x()+sin(list.at(i)->getYaw()+yaw) * radius, p.y()-cos(list.at(i)->getYaw()+yaw) * radius, refLineWidthToPen(0.4f), color, &painter);
-            drawPolygon(poly, &painter);
-
-            // DRAW CONNECTING LINE
-            // Draw line from last waypoint to this one
-            if (!lastWaypoint.isNull())
-            {
-                pen.setWidthF(refLineWidthToPen(0.4f));
-                painter.setPen(pen);
-                color = uas->getColor();
-                drawLine(lastWaypoint.x(), lastWaypoint.y(), p.x(), p.y(), refLineWidthToPen(0.4f), color, &painter);
-            }
-            lastWaypoint = p;
-        }
+    // Only the vehicle moved since the last frame, map
+    // the whole mission with one transformation
+    const QPolygonF points = metricWorldToScreen().map(missionPoints);
+
+    // Connecting lines
+    QPen pen(missionColor);
+    pen.setWidthF(refLineWidthToPen(0.4f));
+    painter.setPen(pen);
+    painter.setBrush(Qt::NoBrush);
+    painter.drawPolyline(points);
+
+    // Heading of every waypoint
+    const float waypointSize = vwidth / 20.0f * 2.0f;
+    const float radius = refToScreenX((waypointSize/2.0f) * 0.8 * (1/sqrt(2.0f)));
+    QVector<QLineF> headings(points.size());
+    for (int i = 0; i < points.size(); i++)
+    {
+        const QPointF& p = points.at(i);
+        headings[i] = QLineF(p, QPointF(p.x() + sin(missionYaws.at(i) + yaw) * radius, p.y() - cos(missionYaws.at(i) + yaw) * radius));
+    }
+    painter.drawLines(headings);
+
+    // Symbols, the current waypoint is highlighted
+    const QPointF offset(waypointGlyph.width() / 2.0f, waypointGlyph.height() / 2.0f);
+    for (int i = 0; i < points.size(); i++)
+    {
+        if (i == missionCurrent) continue;
+        painter.drawPixmap(points.at(i) - offset, waypointGlyph);
+    }
+    if (missionCurrent >= 0)
+    {
+        pen.setColor(QGC::colorCyan);
+        painter.setPen(pen);
+        painter.drawLine(headings.at(missionCurrent));
+        painter.drawPixmap(points.at(missionCurrent) - offset, currentWaypointGlyph);
     }
 }
 
@@ -911,68 +984,77 @@ void HSIDisplay::drawSafetyArea(const QPointF &topLeft, const QPointF &bottomRig
 
 void HSIDisplay::drawGPS(QPainter &painter)
 {
+    updateGPSLayer();
+    painter.drawPixmap(0, 0, gpsLayer);
+}
+
+void HSIDisplay::updateGPSLayer()
+{
+    quint64 currTime = MG::TIME::getGroundTimeNowUsecs();
+    if (!gpsDirty && currTime <= gpsExpiry && gpsScalingFactor == scalingFactor && gpsLayer.size() == size()) return;
+
     float xCenter = xCenterPos;
     float yCenter = xCenterPos;
     // Max satellite circle radius
 
     const float margin = 0.15f;  // 20% margin of total width on each side
     float radius = (vwidth - vwidth * 2.0f * margin) / 2.0f;
-    quint64 currTime = MG::TIME::getGroundTimeNowUsecs();
+
+    if (gpsLayer.size() != size()) gpsLayer = QPixmap(size());
+    gpsLayer.fill(Qt::transparent);
+    QPainter painter(&gpsLayer);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
 
     // Draw satellite labels
     //    QString label;
     //    label.sprintf("%05.1f", value);
     //    paintText(label, color, 4.5f, xRef-7.5f, yRef-2.0f, painter);
 
-    QMapIterator<int, GPSSatellite*> i(gpsSatellites);
-    while (i.hasNext())
+    gpsExpiry = std::numeric_limits<quint64>::max();
+    QMap<int, GPSSatellite*>::iterator i = gpsSatellites.begin();
+    while (i != gpsSatellites.end())
     {
-        i.next();
         GPSSatellite* sat = i.value();
 
-        // Check if update is not older than 5 seconds, else delete satellite
+        // Check if update is not older than one second, else delete satellite
         if (sat->lastUpdate + 1000000 < currTime)
         {
-            // Delete and go to next satellite
-            gpsSatellites.remove(i.key());
-            if (i.hasNext())
-            {
-                i.next();
-                sat = i.value();
-            }
-            else
-            {
-                continue;
-            }
+            delete sat;
+            i = gpsSatellites.erase(i);
+            continue;
         }
-
-        if (sat)
+        // Repaint the layer when this satellite times out
+        gpsExpiry = qMin(gpsExpiry, sat->lastUpdate + 1000000);
+
+        // Draw satellite
+        QBrush brush;
+        QColor color = getColorForSNR(sat->snr);
+        brush.setColor(color);
+        if (sat->used)
+        {
+            brush.setStyle(Qt::SolidPattern);
+        }
+        else
         {
-            // Draw satellite
-            QBrush brush;
-            QColor color = getColorForSNR(sat->snr);
-            brush.setColor(color);
-            if (sat->used)
-            {
-                brush.setStyle(Qt::SolidPattern);
-            }
-            else
-            {
-                brush.setStyle(Qt::NoBrush);
-            }
-            painter.setPen(Qt::SolidLine);
-            painter.setPen(color);
-            painter.setBrush(brush);
-
-            float xPos = xCenter + (sin(((sat->azimuth/255.0f)*360.0f)/180.0f * M_PI) * cos(sat->elevation/180.0f * M_PI)) * radius;
-            float yPos = yCenter - (cos(((sat->azimuth/255.0f)*360.0f)/180.0f * M_PI) * cos(sat->elevation/180.0f * M_PI)) * radius;
-
-            // Draw circle for satellite, filled for used satellites
-            drawCircle(xPos, yPos, vwidth*0.02f, 1.0f, color, &painter);
-            // Draw satellite PRN
-            paintText(QString::number(sat->id), QColor(255, 255, 255), 2.9f, xPos+1.7f, yPos+2.0f, &painter);
+            brush.setStyle(Qt::NoBrush);
         }
+        painter.setPen(Qt::SolidLine);
+        painter.setPen(color);
+        painter.setBrush(brush);
+
+        float xPos = xCenter + (sin(((sat->azimuth/255.0f)*360.0f)/180.0f * M_PI) * cos(sat->elevation/180.0f * M_PI)) * radius;
+        float yPos = yCenter - (cos(((sat->azimuth/255.0f)*360.0f)/180.0f * M_PI) * cos(sat->elevation/180.0f * M_PI)) * radius;
+
+        // Draw circle for satellite, filled for used satellites
+        drawCircle(xPos, yPos, vwidth*0.02f, 1.0f, color, &painter);
+        // Draw satellite PRN
+        paintText(QString::number(sat->id), QColor(255, 255, 255), 2.9f, xPos+1.7f, yPos+2.0f, &painter);
+        ++i;
     }
+
+    gpsDirty = false;
+    gpsScalingFactor = scalingFactor;
 }
 
 void HSIDisplay::drawObjects(QPainter &painter)
@@ -1091,16 +1173,15 @@ void HSIDisplay::wheelEvent(QWheelEvent* event)
     }
     metricWidth = qBound(0.1, metricWidth, 9999.0);
     emit metricWidthChanged(metricWidth);
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HSIDisplay::showEvent(QShowEvent* event)
 {
     // React only to internal (pre-display)
     // events
+    // The frame scheduler repaints as soon as the widget is visible
     Q_UNUSED(event)
-    {
-        refreshTimer->start(updateInterval);
-    }
 }
 
 void HSIDisplay::hideEvent(QHideEvent* event)
@@ -1108,9 +1189,6 @@ void HSIDisplay::hideEvent(QHideEvent* event)
     // React only to internal (post-display)
     // events
     Q_UNUSED(event)
-    {
-        refreshTimer->stop();
-    }
 }
 
 void HSIDisplay::updateJoystick(double roll, double pitch, double yaw, double thrust, int xHat, int yHat)
@@ -38,6 +38,9 @@ This file is part of the QGROUNDCONTROL project
 #include <QMap>
 #include <QPair>
 #include <QMouseEvent>
+#include <QPixmap>
+#include <QPolygonF>
+#include <QTransform>
 #include <cmath>
 
 #include "HDDisplay.h"
@@ -88,7 +91,6 @@ signals:
     void metricWidthChanged(double width);
 
 protected slots:
-    void renderOverlay();
     void drawGPS(QPainter &painter);
     void drawObjects(QPainter &painter);
     void drawPositionDirection(float xRef, float yRef, float radius, const QColor& color, QPainter* painter);
@@ -106,6 +108,8 @@ protected slots:
     void drawSetpointXY(float x, float y, float yaw, const QColor &color, QPainter &painter);
     /** @brief Draw waypoints of this system */
     void drawWaypoints(QPainter& painter);
+    /** @brief The mission changed, rebuild its geometry with the next frame */
+    void invalidateMission();
     /** @brief Draw the limiting safety area */
     void drawSafetyArea(const QPointF &topLeft, const QPointF &bottomRight,  const QColor &color, QPainter &painter);
     /** @brief Receive mouse clicks */
@@ -115,6 +119,7 @@ protected slots:
 
 protected:
 
+    void paintOverlay(QPaintDevice* device);
     void showEvent(QShowEvent* event);
     void hideEvent(QHideEvent* event);
     /** @brief Get color from GPS signal-to-noise colormap */
@@ -131,6 +136,14 @@ protected:
     QPointF metricBodyToRef(QPointF &metric);
     /** @brief Metric body coordinates to screen coordinates */
     QPointF metricBodyToScreen(QPointF metric);
+    /** @brief Metric world coordinates to screen coordinates at the current position, heading and zoom */
+    QTransform metricWorldToScreen() const;
+    /** @brief Collect the waypoints of the mission if it changed */
+    void updateMission();
+    /** @brief Repaint the waypoint symbols if the size changed */
+    void updateWaypointGlyphs();
+    /** @brief Repaint the satellites if any was updated, expired or the size changed */
+    void updateGPSLayer();
 
     /**
      * @brief Private data container class to be used within the HSI widget
@@ -171,6 +184,21 @@ protected:
 
     QMap<int, GPSSatellite*> gpsSatellites;
     unsigned int satellitesUsed;
+    QPixmap gpsLayer;          ///< Satellites as painted by updateGPSLayer()
+    bool gpsDirty;             ///< A satellite was updated since the layer was painted
+    float gpsScalingFactor;    ///< Scaling factor the layer was painted at
+    quint64 gpsExpiry;         ///< Time the first satellite of the layer times out in microseconds
+
+    // Mission in metric world coordinates, it only
+    // changes with the mission and not with the vehicle
+    QPolygonF missionPoints;
+    QVector<float> missionYaws;
+    int missionCurrent;        ///< Index of the current waypoint, -1 if none
+    QColor missionColor;
+    bool missionDirty;
+    QPixmap waypointGlyph;     ///< Symbol of a waypoint
+    QPixmap currentWaypointGlyph; ///< Symbol of the current waypoint
+    float glyphScalingFactor;  ///< Scaling factor the symbols were painted at
 
     // Current controller values
     float attXSet;
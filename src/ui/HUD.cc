@@ -45,6 +45,9 @@ This file is part of the QGROUNDCONTROL project
 #include "HUD.h"
 #include "MG.h"
 #include "QGC.h"
+#include "QGCFrameScheduler.h"
+#include "QGCLabelCache.h"
+#include "QGCGeometry.h"
 
 // Fix for some platforms, e.g. windows
 #ifndef GL_MULTISAMPLE
@@ -86,17 +89,16 @@ HUD::HUD(int width, int height, QWidget* parent)
     vheight(150.0f),
     vGaugeSpacing(50.0f),
     vPitchPerDeg(6.0f), ///< 4 mm y translation per degree)
-    rawBuffer1(NULL),
-    rawBuffer2(NULL),
-    rawImage(NULL),
+    rawVideo(false),
+    imageTransfer(NULL),
     rawLastIndex(0),
-    rawExpectedBytes(0),
-    bytesPerLine(1),
     imageStarted(false),
     receivedDepth(8),
     receivedChannels(1),
     receivedWidth(640),
     receivedHeight(480),
+    staticScalingFactor(0.0),
+    ladderScalingFactor(0.0),
     defaultColor(QColor(70, 200, 70)),
     setPointColor(QColor(200, 20, 200)),
     warningColor(Qt::yellow),
@@ -104,7 +106,6 @@ HUD::HUD(int width, int height, QWidget* parent)
     infoColor(QColor(20, 200, 20)),
     fuelColor(criticalColor),
     warningBlinkRate(5),
-    refreshTimer(new QTimer(this)),
     noCamera(true),
     hardwareAcceleration(true),
     strongStrokeWidth(1.5f),
@@ -160,10 +161,8 @@ HUD::HUD(int width, int height, QWidget* parent)
 
     //glImage = QGLWidget::convertToGLFormat(fill);
 
-    // Refresh timer
-    refreshTimer->setInterval(updateInterval);
-    //connect(refreshTimer, SIGNAL(timeout()), this, SLOT(update()));
-    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(paintHUD()));
+    // Repaint with the other instruments when new data arrived
+    QGCFrameScheduler::instance()->registerClient(this, "paintHUD", updateInterval);
 
     // Resize to correct size and fill with image
     //glDrawPixels(glImage.width(), glImage.height(), GL_RGBA, GL_UNSIGNED_BYTE, glImage.bits());
@@ -204,7 +203,6 @@ HUD::HUD(int width, int height, QWidget* parent)
 
 HUD::~HUD()
 {
-    refreshTimer->stop();
 }
 
 QSize HUD::sizeHint() const
@@ -216,8 +214,8 @@ void HUD::showEvent(QShowEvent* event)
 {
     // React only to internal (pre-display)
     // events
+    // The frame scheduler repaints as soon as the widget is visible
     Q_UNUSED(event)
-    refreshTimer->start(updateInterval);
 }
 
 void HUD::hideEvent(QHideEvent* event)
@@ -225,7 +223,6 @@ void HUD::hideEvent(QHideEvent* event)
     // React only to internal (pre-display)
     // events
     Q_UNUSED(event);
-    refreshTimer->stop();
 }
 
 void HUD::contextMenuEvent (QContextMenuEvent* event)
@@ -287,7 +284,9 @@ void HUD::setActiveUAS(UASInterface* uas)
         if (u)
         {
             disconnect(u, SIGNAL(imageStarted(quint64)), this, SLOT(startImage(quint64)));
+            disconnect(u, SIGNAL(imageReceived(int,QImage)), this, SLOT(setImage(int,QImage)));
         }
+        imageTransfer = NULL;
     }
 
     if (uas)
@@ -310,11 +309,14 @@ void HUD::setActiveUAS(UASInterface* uas)
         if (u)
         {
             connect(u, SIGNAL(imageStarted(quint64)), this, SLOT(startImage(quint64)));
+            connect(u, SIGNAL(imageReceived(int,QImage)), this, SLOT(setImage(int,QImage)));
+            imageTransfer = u->getImageTransfer();
         }
 
         // Set new UAS
         this->uas = uas;
     }
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 //void HUD::updateAttitudeThrustSetPoint(UASInterface* uas, double rollDesired, double pitchDesired, double yawDesired, double thrustDesired, quint64 msec)
@@ -332,6 +334,7 @@ void HUD::updateAttitude(UASInterface* uas, double roll, double pitch, double ya
     this->roll = roll;
     this->pitch = pitch;
     this->yaw = yaw;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::updateBattery(UASInterface* uas, double voltage, double percent, int seconds)
@@ -350,6 +353,7 @@ void HUD::updateBattery(UASInterface* uas, double voltage, double percent, int s
     {
         fuelColor = infoColor;
     }
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::receiveHeartbeat(UASInterface*)
@@ -370,6 +374,7 @@ void HUD::updateLocalPosition(UASInterface* uas,double x,double y,double z,quint
     this->xPos = x;
     this->yPos = y;
     this->zPos = z;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::updateGlobalPosition(UASInterface* uas,double lat, double lon, double altitude, quint64 timestamp)
@@ -379,6 +384,7 @@ void HUD::updateGlobalPosition(UASInterface* uas,double lat, double lon, double
     this->lat = lat;
     this->lon = lon;
     this->alt = altitude;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::updateSpeed(UASInterface* uas,double x,double y,double z,quint64 timestamp)
@@ -391,6 +397,7 @@ void HUD::updateSpeed(UASInterface* uas,double x,double y,double z,quint64 times
     double newTotalSpeed = sqrt(xSpeed*xSpeed + ySpeed*ySpeed + zSpeed*zSpeed);
     totalAcc = (newTotalSpeed - totalSpeed) / ((double)(lastSpeedUpdate - timestamp)/1000.0);
     totalSpeed = newTotalSpeed;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 /**
@@ -404,6 +411,7 @@ void HUD::updateState(UASInterface* uas,QString state)
     // Only one UAS is connected at a time
     Q_UNUSED(uas);
     this->state = state;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 /**
@@ -418,6 +426,7 @@ void HUD::updateMode(int id,QString mode, QString description)
     Q_UNUSED(id);
     Q_UNUSED(description);
     this->mode = mode;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::updateLoad(UASInterface* uas, double load)
@@ -425,6 +434,7 @@ void HUD::updateLoad(UASInterface* uas, double load)
     Q_UNUSED(uas);
     this->load = load;
     //updateValue(uas, "load", load, MG::TIME::getGroundTimeNow());
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 /**
@@ -511,6 +521,27 @@ void HUD::paintCenterBackground(float roll, float pitch, float yaw)
     glEnd();
 }
 
+void HUD::paintCenterBackground(float roll, float pitch, float yaw, QPainter* painter)
+{
+    // Same area and motion as the OpenGL version,
+    // but with the y axis pointing down
+    const float referenceWidth = 70.0f;
+    const float referenceHeight = 70.0f;
+
+    painter->save();
+    painter->translate((vwidth/2.0f+xCenterOffset)*scalingFactor, (vheight/2.0f+yCenterOffset)*scalingFactor);
+    painter->setClipRect(QRectF(refToScreenX(-referenceWidth/2.0f), refToScreenY(-referenceHeight/2.0f), refToScreenX(referenceWidth), refToScreenY(referenceHeight)));
+    painter->translate(refToScreenX(yaw), 0);
+    painter->rotate((roll/M_PI)* -180.0f);
+    painter->translate(0, refToScreenY(pitch * vPitchPerDeg * 16.5f));
+
+    // Ground
+    painter->fillRect(QRectF(refToScreenX(-300.0f), 0, refToScreenX(600.0f), refToScreenY(300.0f)), QColor(179, 102, 0));
+    // Sky
+    painter->fillRect(QRectF(refToScreenX(-300.0f), refToScreenY(-300.0f), refToScreenX(600.0f), refToScreenY(300.0f)), QColor(0, 153, 204));
+    painter->restore();
+}
+
 /**
  * Paint text on top of the image and OpenGL drawings
  *
@@ -522,26 +553,15 @@ void HUD::paintCenterBackground(float roll, float pitch, float yaw)
  */
 void HUD::paintText(QString text, QColor color, float fontSize, float refX, float refY, QPainter* painter)
 {
-    QPen prevPen = painter->pen();
     float pPositionX = refToScreenX(refX) - (fontSize*scalingFactor*0.072f);
     float pPositionY = refToScreenY(refY) - (fontSize*scalingFactor*0.212f);
 
-    QFont font("Bitstream Vera Sans");
     // Enforce minimum font size of 5 pixels
     int fSize = qMax(5, (int)(fontSize*scalingFactor*1.26f));
-    font.setPixelSize(fSize);
 
-    QFontMetrics metrics = QFontMetrics(font);
-    int border = qMax(4, metrics.leading());
-    QRect rect = metrics.boundingRect(0, 0, width() - 2*border, int(height()*0.125),
-                                      Qt::AlignLeft | Qt::TextWordWrap, text);
-    painter->setPen(color);
-    painter->setFont(font);
-    painter->setRenderHint(QPainter::TextAntialiasing);
-    painter->drawText(pPositionX, pPositionY,
-                      rect.width(), rect.height(),
-                      Qt::AlignCenter | Qt::TextWordWrap, text);
-    painter->setPen(prevPen);
+    // The same labels are drawn every frame, blit them from the cache
+    QGCLabelCache::instance()->drawLabel(painter, QPoint((int)pPositionX, (int)pPositionY), text, color,
+                                         fSize, QSize(width(), int(height()*0.125)));
 }
 
 void HUD::initializeGL()
@@ -627,47 +647,7 @@ void HUD::paintHUD()
         qDebug() << "EVENTLOOP:" << __FILE__ << __LINE__;
 #endif
 
-        // Read out most important values to limit hash table lookups
-        // Low-pass roll, pitch and yaw
-        rollLP = rollLP * 0.2f + 0.8f * roll;
-        pitchLP = pitchLP * 0.2f + 0.8f * pitch;
-        yawLP = yawLP * 0.2f + 0.8f * yaw;
-
-        // Translate for yaw
-        const float maxYawTrans = 60.0f;
-
-        float newYawDiff = yawDiff;
-        if (isinf(newYawDiff)) newYawDiff = yawDiff;
-        if (newYawDiff > M_PI) newYawDiff = newYawDiff - M_PI;
-
-        if (newYawDiff < -M_PI) newYawDiff = newYawDiff + M_PI;
-
-        newYawDiff = yawDiff * 0.8 + newYawDiff * 0.2;
-
-        yawDiff = newYawDiff;
-
-        yawInt += newYawDiff;
-
-        if (yawInt > M_PI) yawInt = (float)M_PI;
-        if (yawInt < -M_PI) yawInt = (float)-M_PI;
-
-        float yawTrans = yawInt * (float)maxYawTrans;
-        yawInt *= 0.6f;
-
-        if ((yawTrans < 5.0) && (yawTrans > -5.0)) yawTrans = 0;
-
-        // Negate to correct direction
-        yawTrans = -yawTrans;
-
-        //qDebug() << "yaw translation" << yawTrans << "integral" << yawInt << "difference" << yawDiff << "yaw" << yaw;
-
-        // Update scaling factor
-        // adjust scaling to fit both horizontally and vertically
-        scalingFactor = this->width()/vwidth;
-        double scalingFactorH = this->height()/vheight;
-        if (scalingFactorH < scalingFactor) scalingFactor = scalingFactorH;
-
-
+        const float yawTrans = prepareFrame();
 
         // OPEN GL PAINTING
         // Store model view matrix to be able to reset it to the previous state
@@ -688,6 +668,7 @@ void HUD::paintHUD()
                 yImageFactor = height() / (float)fill.height();
 
                 glImage = QGLWidget::convertToGLFormat(fill);
+                rawVideo = false;
 
                 // Reset to save load efforts
                 nextOfflineImage = "";
@@ -697,7 +678,16 @@ void HUD::paintHUD()
 
             glPixelZoom(xImageFactor, yImageFactor);
             // Resize to correct size and fill with image
-            glDrawPixels(glImage.width(), glImage.height(), GL_RGBA, GL_UNSIGNED_BYTE, glImage.bits());
+            if (rawVideo)
+            {
+                // Take the latest converted frame, if none arrived keep the last one
+                videoBuffer.acquire();
+                glDrawPixels(videoBuffer.getWidth(), videoBuffer.getHeight(), GL_RGBA, GL_UNSIGNED_BYTE, videoBuffer.getFrontPixels());
+            }
+            else
+            {
+                glDrawPixels(glImage.width(), glImage.height(), GL_RGBA, GL_UNSIGNED_BYTE, glImage.bits());
+            }
         }
         else
         {
@@ -719,156 +709,177 @@ void HUD::paintHUD()
             //makeCurrent();
             QPainter painter;
             painter.begin(this);
-            painter.setRenderHint(QPainter::Antialiasing, true);
-            painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
-            painter.translate((this->vwidth/2.0+xCenterOffset)*scalingFactor, (this->vheight/2.0+yCenterOffset)*scalingFactor);
-
-
-
-            // COORDINATE FRAME IS NOW (0,0) at CENTER OF WIDGET
-
-
-            // Draw all fixed indicators
-            // MODE
-            paintText(mode, infoColor, 2.0f, (-vwidth/2.0) + 10, -vheight/2.0 + 10, &painter);
-            // STATE
-            paintText(state, infoColor, 2.0f, (-vwidth/2.0) + 10, -vheight/2.0 + 15, &painter);
-            // BATTERY
-            paintText(fuelStatus, fuelColor, 2.0f, (-vwidth/2.0) + 10, -vheight/2.0 + 20, &painter);
-            // Waypoint
-            paintText(waypointName, defaultColor, 2.0f, (-vwidth/3.0) + 10, +vheight/3.0 + 15, &painter);
-
-            // YAW INDICATOR
-            //
-            //      .
-            //    .   .
-            //   .......
-            //
-            const float yawIndicatorWidth = 4.0f;
-            const float yawIndicatorY = vheight/2.0f - 10.0f;
-            QPolygon yawIndicator(4);
-            yawIndicator.setPoint(0, QPoint(refToScreenX(0.0f), refToScreenY(yawIndicatorY)));
-            yawIndicator.setPoint(1, QPoint(refToScreenX(yawIndicatorWidth/2.0f), refToScreenY(yawIndicatorY+yawIndicatorWidth)));
-            yawIndicator.setPoint(2, QPoint(refToScreenX(-yawIndicatorWidth/2.0f), refToScreenY(yawIndicatorY+yawIndicatorWidth)));
-            yawIndicator.setPoint(3, QPoint(refToScreenX(0.0f), refToScreenY(yawIndicatorY)));
-            painter.setPen(defaultColor);
-            painter.drawPolyline(yawIndicator);
-
-            // CENTER
-
-            // HEADING INDICATOR
-            //
-            //    __      __
-            //       \/\/
-            //
-            const float hIndicatorWidth = 7.0f;
-            const float hIndicatorY = -25.0f;
-            const float hIndicatorYLow = hIndicatorY + hIndicatorWidth / 6.0f;
-            const float hIndicatorSegmentWidth = hIndicatorWidth / 7.0f;
-            QPolygon hIndicator(7);
-            hIndicator.setPoint(0, QPoint(refToScreenX(0.0f-hIndicatorWidth/2.0f), refToScreenY(hIndicatorY)));
-            hIndicator.setPoint(1, QPoint(refToScreenX(0.0f-hIndicatorWidth/2.0f+hIndicatorSegmentWidth*1.75f), refToScreenY(hIndicatorY)));
-            hIndicator.setPoint(2, QPoint(refToScreenX(0.0f-hIndicatorSegmentWidth*1.0f), refToScreenY(hIndicatorYLow)));
-            hIndicator.setPoint(3, QPoint(refToScreenX(0.0f), refToScreenY(hIndicatorY)));
-            hIndicator.setPoint(4, QPoint(refToScreenX(0.0f+hIndicatorSegmentWidth*1.0f), refToScreenY(hIndicatorYLow)));
-            hIndicator.setPoint(5, QPoint(refToScreenX(0.0f+hIndicatorWidth/2.0f-hIndicatorSegmentWidth*1.75f), refToScreenY(hIndicatorY)));
-            hIndicator.setPoint(6, QPoint(refToScreenX(0.0f+hIndicatorWidth/2.0f), refToScreenY(hIndicatorY)));
-            painter.setPen(defaultColor);
-            painter.drawPolyline(hIndicator);
-
-
-            // SETPOINT
-            const float centerWidth = 4.0f;
-            painter.setPen(defaultColor);
-            painter.setBrush(Qt::NoBrush);
-            // TODO
-            //painter.drawEllipse(QPointF(refToScreenX(qMin(10.0f, values.value("roll desired", 0.0f) * 10.0f)), refToScreenY(qMin(10.0f, values.value("pitch desired", 0.0f) * 10.0f))), refToScreenX(centerWidth/2.0f), refToScreenX(centerWidth/2.0f));
-
-            const float centerCrossWidth = 10.0f;
-            // left
-            painter.drawLine(QPointF(refToScreenX(-centerWidth / 2.0f), refToScreenY(0.0f)), QPointF(refToScreenX(-centerCrossWidth / 2.0f), refToScreenY(0.0f)));
-            // right
-            painter.drawLine(QPointF(refToScreenX(centerWidth / 2.0f), refToScreenY(0.0f)), QPointF(refToScreenX(centerCrossWidth / 2.0f), refToScreenY(0.0f)));
-            // top
-            painter.drawLine(QPointF(refToScreenX(0.0f), refToScreenY(-centerWidth / 2.0f)), QPointF(refToScreenX(0.0f), refToScreenY(-centerCrossWidth / 2.0f)));
-
-
-
-            // COMPASS
-            const float compassY = -vheight/2.0f + 10.0f;
-            QRectF compassRect(QPointF(refToScreenX(-5.0f), refToScreenY(compassY)), QSizeF(refToScreenX(10.0f), refToScreenY(5.0f)));
-            painter.setBrush(Qt::NoBrush);
-            painter.setPen(Qt::SolidLine);
-            painter.setPen(defaultColor);
-            painter.drawRoundedRect(compassRect, 2, 2);
-            QString yawAngle;
-
-            //    const float yawDeg = ((values.value("yaw", 0.0f)/M_PI)*180.0f)+180.f;
-
-            // YAW is in compass-human readable format, so 0 - 360deg. This is normal in aviation, not -180 - +180.
-            const float yawDeg = ((yawLP/M_PI)*180.0f)+180.0f+180.0f;
-            int yawCompass = static_cast<int>(yawDeg) % 360;
-            yawAngle.sprintf("%03d", yawCompass);
-            paintText(yawAngle, defaultColor, 3.5f, -4.3f, compassY+ 0.97f, &painter);
-
-            // CHANGE RATE STRIPS
-            drawChangeRateStrip(-51.0f, -50.0f, 15.0f, -1.0f, 1.0f, -zSpeed, &painter);
-
-            // CHANGE RATE STRIPS
-            drawChangeRateStrip(49.0f, -50.0f, 15.0f, -1.0f, 1.0f, totalAcc, &painter);
-
-            // GAUGES
-
-            // Left altitude gauge
-            float gaugeAltitude;
-
-            if (this->alt != 0)
-            {
-                gaugeAltitude = alt;
-            }
-            else
-            {
-                gaugeAltitude = -zPos;
-            }
+            paintInstruments(&painter, yawTrans);
+            painter.end();
+        }
+        else
+        {
+            QPainter painter;
+            painter.begin(this);
+            painter.end();
+        }
+        //glDisable(GL_MULTISAMPLE);
 
-            drawChangeIndicatorGauge(-vGaugeSpacing, -15.0f, 10.0f, 2.0f, gaugeAltitude, defaultColor, &painter, false);
 
-            // Right speed gauge
-            drawChangeIndicatorGauge(vGaugeSpacing, -15.0f, 10.0f, 5.0f, totalSpeed, defaultColor, &painter, false);
 
+        //glFlush();
 
-            // Waypoint name
-            if (waypointName != "") paintText(waypointName, defaultColor, 2.0f, (-vwidth/3.0) + 10, +vheight/3.0 + 15, &painter);
+        // Keep repainting until the low-pass filtered attitude has settled
+        if (fabs(rollLP - roll) > 0.001f || fabs(pitchLP - pitch) > 0.001f || fabs(yawLP - yaw) > 0.001f || yawTrans != 0.0f)
+        {
+            QGCFrameScheduler::instance()->markDirty(this);
+        }
+    }
+}
 
-            // MOVING PARTS
+float HUD::prepareFrame()
+{
+    // Low-pass roll, pitch and yaw
+    rollLP = rollLP * 0.2f + 0.8f * roll;
+    pitchLP = pitchLP * 0.2f + 0.8f * pitch;
+    yawLP = yawLP * 0.2f + 0.8f * yaw;
 
+    // Translate for yaw
+    const float maxYawTrans = 60.0f;
 
-            painter.translate(refToScreenX(yawTrans), 0);
+    float newYawDiff = yawDiff;
+    if (isinf(newYawDiff)) newYawDiff = yawDiff;
+    if (newYawDiff > M_PI) newYawDiff = newYawDiff - M_PI;
 
-            // Rotate view and draw all roll-dependent indicators
-            painter.rotate((rollLP/M_PI)* -180.0f);
+    if (newYawDiff < -M_PI) newYawDiff = newYawDiff + M_PI;
 
-            painter.translate(0, (-pitchLP/(float)M_PI)* -180.0f * refToScreenY(1.8f));
+    newYawDiff = yawDiff * 0.8 + newYawDiff * 0.2;
 
-            //qDebug() << "ROLL" << roll << "PITCH" << pitch << "YAW DIFF" << valuesDot.value("roll", 0.0f);
+    yawDiff = newYawDiff;
 
-            // PITCH
+    yawInt += newYawDiff;
 
-            paintPitchLines(pitchLP, &painter);
-            painter.end();
-        }
-        else
-        {
-            QPainter painter;
-            painter.begin(this);
-            painter.end();
-        }
-        //glDisable(GL_MULTISAMPLE);
+    if (yawInt > M_PI) yawInt = (float)M_PI;
+    if (yawInt < -M_PI) yawInt = (float)-M_PI;
+
+    float yawTrans = yawInt * (float)maxYawTrans;
+    yawInt *= 0.6f;
 
+    if ((yawTrans < 5.0) && (yawTrans > -5.0)) yawTrans = 0;
 
+    // Negate to correct direction
+    yawTrans = -yawTrans;
 
-        //glFlush();
+    //qDebug() << "yaw translation" << yawTrans << "integral" << yawInt << "difference" << yawDiff << "yaw" << yaw;
+
+    // Update scaling factor
+    // adjust scaling to fit both horizontally and vertically
+    scalingFactor = this->width()/vwidth;
+    double scalingFactorH = this->height()/vheight;
+    if (scalingFactorH < scalingFactor) scalingFactor = scalingFactorH;
+
+    return yawTrans;
+}
+
+void HUD::paintInstruments(QPainter* painter, float yawTrans)
+{
+    painter->setRenderHint(QPainter::Antialiasing, true);
+    painter->setRenderHint(QPainter::HighQualityAntialiasing, true);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+
+    // Scales and fixed symbols, only repainted on resize
+    updateStaticLayer();
+    painter->drawPixmap(0, 0, staticLayer);
+
+    // Texts, only repainted if one of them changed
+    QList<LayerText> texts;
+    // MODE
+    texts.append(LayerText(mode, infoColor, 2.0f, (-vwidth/2.0) + 10, -vheight/2.0 + 10));
+    // STATE
+    texts.append(LayerText(state, infoColor, 2.0f, (-vwidth/2.0) + 10, -vheight/2.0 + 15));
+    // BATTERY
+    texts.append(LayerText(fuelStatus, fuelColor, 2.0f, (-vwidth/2.0) + 10, -vheight/2.0 + 20));
+    // Waypoint
+    texts.append(LayerText(waypointName, defaultColor, 2.0f, (-vwidth/3.0) + 10, +vheight/3.0 + 15));
+    // Raw video frame rate and conversion time
+    if (videoEnabled && rawVideo)
+    {
+        texts.append(LayerText(tr("%1 fps %2 us").arg(videoBuffer.getFrameRate(), 0, 'f', 1).arg(videoBuffer.getConversionTime(), 0, 'f', 0), infoColor, 2.0f, (-vwidth/2.0) + 10, -vheight/2.0 + 25));
     }
+    // Encapsulated image rate and losses
+    else if (videoEnabled && imageTransfer && imageTransfer->getFramesDecoded() > 0)
+    {
+        texts.append(LayerText(tr("%1 fps %2 % loss %3 lost").arg(imageTransfer->getFrameRate(), 0, 'f', 1).arg(imageTransfer->getLossRate() * 100.0f, 0, 'f', 0).arg(imageTransfer->getFramesLost()), infoColor, 2.0f, (-vwidth/2.0) + 10, -vheight/2.0 + 25));
+    }
+
+    // COMPASS
+    const float compassY = -vheight/2.0f + 10.0f;
+    QString yawAngle;
+
+    //    const float yawDeg = ((values.value("yaw", 0.0f)/M_PI)*180.0f)+180.f;
+
+    // YAW is in compass-human readable format, so 0 - 360deg. This is normal in aviation, not -180 - +180.
+    const float yawDeg = ((yawLP/M_PI)*180.0f)+180.0f+180.0f;
+    int yawCompass = static_cast<int>(yawDeg) % 360;
+    yawAngle.sprintf("%03d", yawCompass);
+    texts.append(LayerText(yawAngle, defaultColor, 3.5f, -4.3f, compassY+ 0.97f));
+
+    // CHANGE RATE STRIPS
+    texts.append(changeRateStripLabel(-51.0f, -50.0f, 15.0f, -1.0f, 1.0f, -zSpeed));
+
+    // CHANGE RATE STRIPS
+    texts.append(changeRateStripLabel(49.0f, -50.0f, 15.0f, -1.0f, 1.0f, totalAcc));
+
+    // GAUGES
+
+    // Left altitude gauge
+    float gaugeAltitude;
+
+    if (this->alt != 0)
+    {
+        gaugeAltitude = alt;
+    }
+    else
+    {
+        gaugeAltitude = -zPos;
+    }
+
+    texts.append(changeIndicatorGaugeLabel(-vGaugeSpacing, -15.0f, gaugeAltitude, defaultColor));
+
+    // Right speed gauge
+    texts.append(changeIndicatorGaugeLabel(vGaugeSpacing, -15.0f, totalSpeed, defaultColor));
+
+    updateTextLayer(texts);
+    painter->drawPixmap(0, 0, textLayer);
+
+    painter->translate((this->vwidth/2.0+xCenterOffset)*scalingFactor, (this->vheight/2.0+yCenterOffset)*scalingFactor);
+
+    // COORDINATE FRAME IS NOW (0,0) at CENTER OF WIDGET
+
+    // Gauge needles follow their values continuously
+    drawChangeIndicatorNeedle(-vGaugeSpacing, -15.0f, 10.0f, 2.0f, gaugeAltitude, painter);
+    drawChangeIndicatorNeedle(vGaugeSpacing, -15.0f, 10.0f, 5.0f, totalSpeed, painter);
+
+    // MOVING PARTS
+
+    painter->translate(refToScreenX(yawTrans), 0);
+
+    // Rotate view and draw all roll-dependent indicators
+    painter->rotate((rollLP/M_PI)* -180.0f);
+
+    painter->translate(0, (-pitchLP/(float)M_PI)* -180.0f * refToScreenY(1.8f));
+
+    //qDebug() << "ROLL" << roll << "PITCH" << pitch << "YAW DIFF" << valuesDot.value("roll", 0.0f);
+
+    // PITCH
+
+    paintPitchLines(pitchLP, painter);
+}
+
+void HUD::renderOffscreen(QImage* image)
+{
+    if (size() != image->size()) resize(image->size());
+
+    const float yawTrans = prepareFrame();
+
+    QPainter painter(image);
+    paintCenterBackground(roll, pitch, yawTrans, &painter);
+    if (hudInstrumentsEnabled) paintInstruments(&painter, yawTrans);
 }
 
 /*
@@ -1072,72 +1083,176 @@ void HUD::paintGL()
  */
 void HUD::paintPitchLines(float pitch, QPainter* painter)
 {
+    const float yDeg = vPitchPerDeg;
+    const float offsetAbs = pitch * yDeg;
+
+    // The pitch lines only move with the horizon, blit them from the
+    // cached ladder instead of painting every line and label
+    updatePitchLadder();
+    painter->drawPixmap(QPointF(-pitchLadder.width()/2.0f, -pitchLadder.height()/2.0f + refToScreenY(offsetAbs)), pitchLadder);
+
+    // HORIZON
+    //
+    //    ------------    ------------
+    //
+    const float pitchWidth = 30.0f;
+    const float pitchGap = pitchWidth / 2.5f;
+    const QColor horizonColor = defaultColor;
+    const float diagonal = sqrt(pow(vwidth, 2.0f) + pow(vheight, 2.0f));
+    const float lineWidth = refLineWidthToPen(0.5f);
+
+    // Left horizon
+    drawLine(0.0f-diagonal, offsetAbs, 0.0f-pitchGap/2.0f, offsetAbs, lineWidth, horizonColor, painter);
+    // Right horizon
+    drawLine(0.0f+pitchGap/2.0f, offsetAbs, 0.0f+diagonal, offsetAbs, lineWidth, horizonColor, painter);
+}
+
+void HUD::updatePitchLadder()
+{
+    if (!pitchLadder.isNull() && ladderScalingFactor == scalingFactor) return;
+
     QString label;
 
     const float yDeg = vPitchPerDeg;
     const float lineDistance = 5.0f; ///< One pitch line every 10 degrees
     const float posIncrement = yDeg * lineDistance;
-    float posY = posIncrement;
-    const float posLimit = sqrt(pow(vwidth, 2.0f) + pow(vheight, 2.0f));
-
-    const float offsetAbs = pitch * yDeg;
+    // One line more than needed at zero offset, paintPitchLines() moves the
+    // ladder by less than one line distance for pitch angles given in radians
+    const float posLimit = sqrt(pow(vwidth, 2.0f) + pow(vheight, 2.0f)) + posIncrement;
+    const float pitchWidth = 30.0f;
 
-    float offset = pitch;
-    if (offset < 0) offset = -offset;
-    int offsetCount = 0;
-    while (offset > lineDistance)
-    {
-        offset -= lineDistance;
-        offsetCount++;
-    }
+    // Lines and labels are centered, leave some room for the labels
+    pitchLadder = QPixmap((int)(refToScreenX(pitchWidth + 10.0f)), (int)(2.0f * refToScreenY(posLimit + posIncrement)));
+    pitchLadder.fill(Qt::transparent);
+    QPainter painter(&pitchLadder);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
+    painter.translate(pitchLadder.width()/2.0f, pitchLadder.height()/2.0f);
+    painter.setPen(defaultColor);
 
     int iPos = (int)(0.5f + lineDistance); ///< The first line
     int iNeg = (int)(-0.5f - lineDistance); ///< The first line
+    for (float posY = posIncrement; posY < posLimit; posY += posIncrement)
+    {
+        paintPitchLinePos(label.sprintf("%3d", iPos), 0.0f, -posY, &painter);
+        paintPitchLineNeg(label.sprintf("%3d", iNeg), 0.0f, posY, &painter);
+        iPos += (int)lineDistance;
+        iNeg -= (int)lineDistance;
+    }
 
-    offset *= yDeg;
+    ladderScalingFactor = scalingFactor;
+}
 
+void HUD::beginLayer(QPixmap& layer, QPainter& painter)
+{
+    if (layer.size() != size()) layer = QPixmap(size());
+    layer.fill(Qt::transparent);
+    painter.begin(&layer);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
+    painter.translate((this->vwidth/2.0+xCenterOffset)*scalingFactor, (this->vheight/2.0+yCenterOffset)*scalingFactor);
+}
 
-    painter->setPen(defaultColor);
+void HUD::updateStaticLayer()
+{
+    if (staticLayer.size() == size() && staticScalingFactor == scalingFactor) return;
 
-    posY = -offsetAbs + posIncrement; //+ 100;// + lineDistance;
+    // The texts are placed in the same coordinates, repaint them as well
+    layerTexts.clear();
 
-    while (posY < posLimit)
-    {
-        paintPitchLinePos(label.sprintf("%3d", iPos), 0.0f, -posY, painter);
-        posY += posIncrement;
-        iPos += (int)lineDistance;
-    }
+    QPainter painter;
+    beginLayer(staticLayer, painter);
 
+    // YAW INDICATOR
+    //
+    //      .
+    //    .   .
+    //   .......
+    //
+    const float yawIndicatorWidth = 4.0f;
+    const float yawIndicatorY = vheight/2.0f - 10.0f;
+    QPolygon yawIndicator(4);
+    yawIndicator.setPoint(0, QPoint(refToScreenX(0.0f), refToScreenY(yawIndicatorY)));
+    yawIndicator.setPoint(1, QPoint(refToScreenX(yawIndicatorWidth/2.0f), refToScreenY(yawIndicatorY+yawIndicatorWidth)));
+    yawIndicator.setPoint(2, QPoint(refToScreenX(-yawIndicatorWidth/2.0f), refToScreenY(yawIndicatorY+yawIndicatorWidth)));
+    yawIndicator.setPoint(3, QPoint(refToScreenX(0.0f), refToScreenY(yawIndicatorY)));
+    painter.setPen(defaultColor);
+    painter.drawPolyline(yawIndicator);
 
+    // CENTER
 
-    // HORIZON
+    // HEADING INDICATOR
     //
-    //    ------------    ------------
+    //    __      __
+    //       \/\/
     //
-    const float pitchWidth = 30.0f;
-    const float pitchGap = pitchWidth / 2.5f;
-    const QColor horizonColor = defaultColor;
-    const float diagonal = sqrt(pow(vwidth, 2.0f) + pow(vheight, 2.0f));
-    const float lineWidth = refLineWidthToPen(0.5f);
+    const float hIndicatorWidth = 7.0f;
+    const float hIndicatorY = -25.0f;
+    const float hIndicatorYLow = hIndicatorY + hIndicatorWidth / 6.0f;
+    const float hIndicatorSegmentWidth = hIndicatorWidth / 7.0f;
+    QPolygon hIndicator(7);
+    hIndicator.setPoint(0, QPoint(refToScreenX(0.0f-hIndicatorWidth/2.0f), refToScreenY(hIndicatorY)));
+    hIndicator.setPoint(1, QPoint(refToScreenX(0.0f-hIndicatorWidth/2.0f+hIndicatorSegmentWidth*1.75f), refToScreenY(hIndicatorY)));
+    hIndicator.setPoint(2, QPoint(refToScreenX(0.0f-hIndicatorSegmentWidth*1.0f), refToScreenY(hIndicatorYLow)));
+    hIndicator.setPoint(3, QPoint(refToScreenX(0.0f), refToScreenY(hIndicatorY)));
+    hIndicator.setPoint(4, QPoint(refToScreenX(0.0f+hIndicatorSegmentWidth*1.0f), refToScreenY(hIndicatorYLow)));
+    hIndicator.setPoint(5, QPoint(refToScreenX(0.0f+hIndicatorWidth/2.0f-hIndicatorSegmentWidth*1.75f), refToScreenY(hIndicatorY)));
+    hIndicator.setPoint(6, QPoint(refToScreenX(0.0f+hIndicatorWidth/2.0f), refToScreenY(hIndicatorY)));
+    painter.setPen(defaultColor);
+    painter.drawPolyline(hIndicator);
 
-    // Left horizon
-    drawLine(0.0f-diagonal, offsetAbs, 0.0f-pitchGap/2.0f, offsetAbs, lineWidth, horizonColor, painter);
-    // Right horizon
-    drawLine(0.0f+pitchGap/2.0f, offsetAbs, 0.0f+diagonal, offsetAbs, lineWidth, horizonColor, painter);
 
+    // SETPOINT
+    const float centerWidth = 4.0f;
+    painter.setPen(defaultColor);
+    painter.setBrush(Qt::NoBrush);
+    // TODO
+    //painter.drawEllipse(QPointF(refToScreenX(qMin(10.0f, values.value("roll desired", 0.0f) * 10.0f)), refToScreenY(qMin(10.0f, values.value("pitch desired", 0.0f) * 10.0f))), refToScreenX(centerWidth/2.0f), refToScreenX(centerWidth/2.0f));
 
+    const float centerCrossWidth = 10.0f;
+    // left
+    painter.drawLine(QPointF(refToScreenX(-centerWidth / 2.0f), refToScreenY(0.0f)), QPointF(refToScreenX(-centerCrossWidth / 2.0f), refToScreenY(0.0f)));
+    // right
+    painter.drawLine(QPointF(refToScreenX(centerWidth / 2.0f), refToScreenY(0.0f)), QPointF(refToScreenX(centerCrossWidth / 2.0f), refToScreenY(0.0f)));
+    // top
+    painter.drawLine(QPointF(refToScreenX(0.0f), refToScreenY(-centerWidth / 2.0f)), QPointF(refToScreenX(0.0f), refToScreenY(-centerCrossWidth / 2.0f)));
 
-    label.clear();
 
-    posY = offsetAbs  + posIncrement;
 
+    // COMPASS
+    const float compassY = -vheight/2.0f + 10.0f;
+    QRectF compassRect(QPointF(refToScreenX(-5.0f), refToScreenY(compassY)), QSizeF(refToScreenX(10.0f), refToScreenY(5.0f)));
+    painter.setBrush(Qt::NoBrush);
+    painter.setPen(Qt::SolidLine);
+    painter.setPen(defaultColor);
+    painter.drawRoundedRect(compassRect, 2, 2);
 
-    while (posY < posLimit)
+    // CHANGE RATE STRIPS
+    drawChangeRateStripFrame(-51.0f, -50.0f, 15.0f, &painter);
+
+    // CHANGE RATE STRIPS
+    drawChangeRateStripFrame(49.0f, -50.0f, 15.0f, &painter);
+
+    // GAUGES
+    drawChangeIndicatorGaugeFrame(-vGaugeSpacing, -15.0f, 10.0f, defaultColor, &painter, false);
+    drawChangeIndicatorGaugeFrame(vGaugeSpacing, -15.0f, 10.0f, defaultColor, &painter, false);
+
+    painter.end();
+    staticScalingFactor = scalingFactor;
+}
+
+void HUD::updateTextLayer(const QList<LayerText>& texts)
+{
+    if (texts == layerTexts && textLayer.size() == size()) return;
+
+    QPainter painter;
+    beginLayer(textLayer, painter);
+    foreach (const LayerText& text, texts)
     {
-        paintPitchLineNeg(label.sprintf("%3d", iNeg), 0.0f, posY, painter);
-        posY += posIncrement;
-        iNeg -= (int)lineDistance;
+        paintText(text.text, text.color, text.fontSize, text.refX, text.refY, &painter);
     }
+    painter.end();
+    layerTexts = texts;
 }
 
 void HUD::paintPitchLinePos(QString text, float refPosX, float refPosY, QPainter* painter)
@@ -1212,13 +1327,7 @@ void rotatePointClockWise(QPointF& p, float angle)
     //   |  cos(phi)   sin(phi) |
     //   | -sin(phi)   cos(phi) |
     //
-
-    //p.setX(cos(angle) * p.x() + sin(angle) * p.y());
-    //p.setY(-sin(angle) * p.x() + cos(angle) * p.y());
-
-
-    p.setX(cos(angle) * p.x() + sin(angle)* p.y());
-    p.setY((-1.0f * sin(angle) * p.x()) + cos(angle) * p.y());
+    QGCGeometry::rotate(p, -angle);
 }
 
 float HUD::refLineWidthToPen(float line)
@@ -1236,39 +1345,26 @@ float HUD::refLineWidthToPen(float line)
  */
 void HUD::rotatePolygonClockWiseRad(QPolygonF& p, float angle, QPointF origin)
 {
-    // Standard 2x2 rotation matrix, counter-clockwise
-    //
-    //   |  cos(phi)   sin(phi) |
-    //   | -sin(phi)   cos(phi) |
-    //
-    for (int i = 0; i < p.size(); i++)
-    {
-        QPointF curr = p.at(i);
-
-        const float x = curr.x();
-        const float y = curr.y();
-
-        curr.setX(((cos(angle) * (x-origin.x())) + (-sin(angle) * (y-origin.y()))) + origin.x());
-        curr.setY(((sin(angle) * (x-origin.x())) + (cos(angle) * (y-origin.y()))) + origin.y());
-        p.replace(i, curr);
-    }
+    QGCGeometry::rotate(p, angle, origin);
 }
 
 void HUD::drawPolygon(QPolygonF refPolygon, QPainter* painter)
 {
-    // Scale coordinates
-    QPolygonF draw(refPolygon.size());
-    for (int i = 0; i < refPolygon.size(); i++)
-    {
-        QPointF curr;
-        curr.setX(refToScreenX(refPolygon.at(i).x()));
-        curr.setY(refToScreenY(refPolygon.at(i).y()));
-        draw.replace(i, curr);
-    }
-    painter->drawPolygon(draw);
+    // Scale coordinates into the reused screen buffer
+    QGCGeometry::scale(refPolygon, scalingFactor, screenPolygon);
+    painter->drawPolygon(screenPolygon);
 }
 
 void HUD::drawChangeRateStrip(float xRef, float yRef, float height, float minRate, float maxRate, float value, QPainter* painter)
+{
+    drawChangeRateStripFrame(xRef, yRef, height, painter);
+
+    // Text
+    LayerText label = changeRateStripLabel(xRef, yRef, height, minRate, maxRate, value);
+    paintText(label.text, label.color, label.fontSize, label.refX, label.refY, painter);
+}
+
+void HUD::drawChangeRateStripFrame(float xRef, float yRef, float height, QPainter* painter)
 {
     QBrush brush(defaultColor, Qt::NoBrush);
     painter->setBrush(brush);
@@ -1277,12 +1373,6 @@ void HUD::drawChangeRateStrip(float xRef, float yRef, float height, float minRat
     rectPen.setColor(defaultColor);
     painter->setPen(rectPen);
 
-    float scaledValue = value;
-
-    // Saturate value
-    if (value > maxRate) scaledValue = maxRate;
-    if (value < minRate) scaledValue = minRate;
-
     //           x (Origin: xRef, yRef)
     //           -
     //           |
@@ -1306,11 +1396,23 @@ void HUD::drawChangeRateStrip(float xRef, float yRef, float height, float minRat
     drawLine(xRef, yRef+height/2.0f, xRef+width, yRef+height/2.0f, lineWidth, defaultColor, painter);
     // Horizontal bottom line
     drawLine(xRef, yRef+height, xRef+width, yRef+height, lineWidth, defaultColor, painter);
+}
+
+HUD::LayerText HUD::changeRateStripLabel(float xRef, float yRef, float height, float minRate, float maxRate, float value)
+{
+    // Place the label by the displayed value, so it only
+    // moves when the text changes
+    float scaledValue = qRound(value * 100.0f) / 100.0f;
+
+    // Saturate value
+    if (scaledValue > maxRate) scaledValue = maxRate;
+    if (scaledValue < minRate) scaledValue = minRate;
+
+    const float width = height / 8.0f;
 
-    // Text
     QString label;
     label.sprintf("< %+06.2f", value);
-    paintText(label, defaultColor, 3.0f, xRef+width/2.0f, yRef+height-((scaledValue - minRate)/(maxRate-minRate))*height - 1.6f, painter);
+    return LayerText(label, defaultColor, 3.0f, xRef+width/2.0f, yRef+height-((scaledValue - minRate)/(maxRate-minRate))*height - 1.6f);
 }
 
 //void HUD::drawSystemIndicator(float xRef, float yRef, int maxNum, float maxWidth, float maxHeight, QPainter* painter)
@@ -1391,6 +1493,17 @@ void HUD::drawChangeRateStrip(float xRef, float yRef, float height, float minRat
 //}
 
 void HUD::drawChangeIndicatorGauge(float xRef, float yRef, float radius, float expectedMaxChange, float value, const QColor& color, QPainter* painter, bool solid)
+{
+    drawChangeIndicatorGaugeFrame(xRef, yRef, radius, color, painter, solid);
+
+    // Draw the value
+    LayerText label = changeIndicatorGaugeLabel(xRef, yRef, value, color);
+    paintText(label.text, label.color, label.fontSize, label.refX, label.refY, painter);
+
+    drawChangeIndicatorNeedle(xRef, yRef, radius, expectedMaxChange, value, painter);
+}
+
+void HUD::drawChangeIndicatorGaugeFrame(float xRef, float yRef, float radius, const QColor& color, QPainter* painter, bool solid)
 {
     // Draw the circle
     QPen circlePen(Qt::SolidLine);
@@ -1400,13 +1513,17 @@ void HUD::drawChangeIndicatorGauge(float xRef, float yRef, float radius, float e
     painter->setBrush(Qt::NoBrush);
     painter->setPen(circlePen);
     drawCircle(xRef, yRef, radius, 200.0f, 170.0f, 1.0f, color, painter);
+}
 
+HUD::LayerText HUD::changeIndicatorGaugeLabel(float xRef, float yRef, float value, const QColor& color)
+{
     QString label;
     label.sprintf("%05.1f", value);
+    return LayerText(label, color, 4.5f, xRef-7.5f, yRef-2.0f);
+}
 
-    // Draw the value
-    paintText(label, color, 4.5f, xRef-7.5f, yRef-2.0f, painter);
-
+void HUD::drawChangeIndicatorNeedle(float xRef, float yRef, float radius, float expectedMaxChange, float value, QPainter* painter)
+{
     // Draw the needle
     // Scale the rotation so that the gauge does one revolution
     // per max. change
@@ -1467,63 +1584,33 @@ void HUD::resizeGL(int w, int h)
     glOrtho(0, w, 0, h, -1, 1);
     glMatrixMode(GL_MODELVIEW);
     glPolygonMode(GL_FRONT, GL_FILL);
-    //FIXME
-    paintHUD();
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::selectWaypoint(int uasId, int id)
 {
     Q_UNUSED(uasId);
     waypointName = tr("WP") + QString::number(id);
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::setImageSize(int width, int height, int depth, int channels)
 {
     // Allocate raw image in correct size
-    if (width != receivedWidth || height != receivedHeight || depth != receivedDepth || channels != receivedChannels || image == NULL)
+    if (width != receivedWidth || height != receivedHeight || depth != receivedDepth || channels != receivedChannels || videoBuffer.getRawSize() == 0)
     {
         // Set new size
         if (width > 0) receivedWidth  = width;
         if (height > 0) receivedHeight = height;
         if (depth > 1) receivedDepth = depth;
-        if (channels > 1) receivedChannels = channels;
-
-        rawExpectedBytes = (receivedWidth * receivedHeight * receivedDepth * receivedChannels) / 8;
-        bytesPerLine = rawExpectedBytes / receivedHeight;
-        // Delete old buffers if necessary
-        rawImage = NULL;
-        if (rawBuffer1 != NULL) delete rawBuffer1;
-        if (rawBuffer2 != NULL) delete rawBuffer2;
-
-        rawBuffer1 = (unsigned char*)malloc(rawExpectedBytes);
-        rawBuffer2 = (unsigned char*)malloc(rawExpectedBytes);
-        rawImage = rawBuffer1;
-        // TODO check if old image should be deleted
-
-        // Set image format
-        // 8 BIT GREYSCALE IMAGE
-        if (depth <= 8 && channels == 1)
-        {
-            image = new QImage(receivedWidth, receivedHeight, QImage::Format_Indexed8);
-            // Create matching color table
-            image->setNumColors(256);
-            for (int i = 0; i < 256; i++)
-            {
-                image->setColor(i, qRgb(i, i, i));
-                //qDebug() << __FILE__ << __LINE__ << std::hex << i;
-            }
+        if (channels > 0) receivedChannels = channels;
 
-        }
-        // 32 BIT COLOR IMAGE WITH ALPHA VALUES (#ARGB)
-        else
+        // The buffers are only reallocated here, not per frame
+        if (!videoBuffer.setFormat(receivedWidth, receivedHeight, receivedDepth, receivedChannels))
         {
-            image = new QImage(receivedWidth, receivedHeight, QImage::Format_ARGB32);
+            qDebug() << "HUD: Unsupported raw image format," << receivedDepth << "bit with" << receivedChannels << "channels";
         }
 
-        // Fill first channel of image with black pixels
-        image->fill(0);
-        glImage = QGLWidget::convertToGLFormat(*image);
-
         qDebug() << __FILE__ << __LINE__ << "Setting up image";
 
         // Set size once
@@ -1561,43 +1648,28 @@ void HUD::finishImage()
 
 void HUD::commitRawDataToGL()
 {
-    qDebug() << __FILE__ << __LINE__ << "Copying raw data to GL buffer:" << rawImage << receivedWidth << receivedHeight << image->format();
-    if (image != NULL)
-    {
-        QImage::Format format = image->format();
-        QImage* newImage = new QImage(rawImage, receivedWidth, receivedHeight, format);
-        if (format == QImage::Format_Indexed8)
-        {
-            // Create matching color table
-            newImage->setNumColors(256);
-            for (int i = 0; i < 256; i++)
-            {
-                newImage->setColor(i, qRgb(i, i, i));
-                //qDebug() << __FILE__ << __LINE__ << std::hex << i;
-            }
-        }
-
-        glImage = QGLWidget::convertToGLFormat(*newImage);
-        delete image;
-        image = newImage;
-        // Switch buffers
-        if (rawImage == rawBuffer1)
-        {
-            rawImage = rawBuffer2;
-            //qDebug() << "Now buffer 2";
-        }
-        else
-        {
-            rawImage = rawBuffer1;
-            //qDebug() << "Now buffer 1";
-        }
-    }
-    update();
+    // Convert into the back frame, the next paint picks it up
+    videoBuffer.commit();
+    rawVideo = true;
+    xImageFactor = width() / (float)videoBuffer.getWidth();
+    yImageFactor = height() / (float)videoBuffer.getHeight();
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::saveImage(QString fileName)
 {
-    image->save(fileName);
+    if (videoBuffer.hasFrame()) videoBuffer.toImage().save(fileName);
+}
+
+void HUD::setImage(int component, QImage image)
+{
+    Q_UNUSED(component);
+    if (image.isNull()) return;
+    xImageFactor = width() / (float)image.width();
+    yImageFactor = height() / (float)image.height();
+    glImage = QGLWidget::convertToGLFormat(image);
+    rawVideo = false;
+    if (videoEnabled) QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::saveImage()
@@ -1628,11 +1700,13 @@ void HUD::selectOfflineDirectory()
 void HUD::enableHUDInstruments(bool enabled)
 {
     hudInstrumentsEnabled = enabled;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::enableVideo(bool enabled)
 {
     videoEnabled = enabled;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::setPixels(int imgid, const unsigned char* imageData, int length, int startIndex)
@@ -1643,6 +1717,7 @@ void HUD::setPixels(int imgid, const unsigned char* imageData, int length, int s
     if (imageStarted)
     {
         //if (rawLastIndex != startIndex) qDebug() << "PACKET LOSS!";
+        int rawExpectedBytes = videoBuffer.getRawSize();
 
         if (startIndex+length > rawExpectedBytes)
         {
@@ -1650,7 +1725,7 @@ void HUD::setPixels(int imgid, const unsigned char* imageData, int length, int s
         }
         else
         {
-            memcpy(rawImage+startIndex, imageData, length);
+            memcpy(videoBuffer.getRawBuffer()+startIndex, imageData, length);
 
             rawLastIndex = startIndex+length;
 
@@ -33,11 +33,15 @@ This file is part of the QGROUNDCONTROL project
 #define HUD_H
 
 #include <QImage>
+#include <QPixmap>
+#include <QList>
 #include <QGLWidget>
 #include <QPainter>
 #include <QFontDatabase>
-#include <QTimer>
 #include "UASInterface.h"
+#include "QGCRawVideoBuffer.h"
+
+class QGCUASImageTransfer;
 
 /**
  * @brief Displays a Head Up Display (HUD)
@@ -55,6 +59,14 @@ public:
 
     void setImageSize(int width, int height, int depth, int channels);
     void resizeGL(int w, int h);
+    /**
+     * @brief Render the next frame into an image with the raster engine
+     *
+     * The OpenGL background is replaced by its QPainter equivalent, the
+     * widget is resized to the image. Used to benchmark the instruments
+     * without a GPU.
+     */
+    void renderOffscreen(QImage* image);
 
 public slots:
     void initializeGL();
@@ -82,6 +94,8 @@ public slots:
     void finishImage();
     void saveImage();
     void saveImage(QString fileName);
+    /** @brief Show a decoded camera image as background */
+    void setImage(int component, QImage image);
     /** @brief Select directory where to load the offline files from */
     void selectOfflineDirectory();
     /** @brief Enable the HUD instruments */
@@ -92,6 +106,8 @@ public slots:
 
 protected slots:
     void paintCenterBackground(float roll, float pitch, float yaw);
+    /** @brief Paint the blue / brown background with QPainter instead of OpenGL */
+    void paintCenterBackground(float roll, float pitch, float yaw, QPainter* painter);
     void paintRollPitchStrips();
     void paintPitchLines(float pitch, QPainter* painter);
     /** @brief Paint text on top of the image and OpenGL drawings */
@@ -108,11 +124,45 @@ protected slots:
 
     void drawChangeRateStrip(float xRef, float yRef, float height, float minRate, float maxRate, float value, QPainter* painter);
     void drawChangeIndicatorGauge(float xRef, float yRef, float radius, float expectedMaxChange, float value, const QColor& color, QPainter* painter, bool solid=true);
+    void drawChangeRateStripFrame(float xRef, float yRef, float height, QPainter* painter);
+    void drawChangeIndicatorGaugeFrame(float xRef, float yRef, float radius, const QColor& color, QPainter* painter, bool solid=true);
+    void drawChangeIndicatorNeedle(float xRef, float yRef, float radius, float expectedMaxChange, float value, QPainter* painter);
 
     void drawPolygon(QPolygonF refPolygon, QPainter* painter);
 
 protected:
+    /** @brief A text of the text layer, in reference coordinates */
+    struct LayerText
+    {
+        LayerText(const QString& text, const QColor& color, float fontSize, float refX, float refY) :
+            text(text), color(color), fontSize(fontSize), refX(refX), refY(refY) {}
+        bool operator==(const LayerText& other) const
+        {
+            return text == other.text && color == other.color && fontSize == other.fontSize &&
+                   refX == other.refX && refY == other.refY;
+        }
+        QString text;
+        QColor color;
+        float fontSize;
+        float refX;
+        float refY;
+    };
+
     void commitRawDataToGL();
+    /** @brief Advance the attitude low-pass and the scaling, returns the yaw translation */
+    float prepareFrame();
+    /** @brief Paint all instruments on top of the background */
+    void paintInstruments(QPainter* painter, float yawTrans);
+    /** @brief Start painting a full-widget layer, cleared and centered like paintHUD() */
+    void beginLayer(QPixmap& layer, QPainter& painter);
+    /** @brief Repaint the scales and fixed symbols if the size changed */
+    void updateStaticLayer();
+    /** @brief Repaint the texts if any of them changed */
+    void updateTextLayer(const QList<LayerText>& texts);
+    /** @brief Repaint the pitch lines and their labels if the size changed */
+    void updatePitchLadder();
+    LayerText changeRateStripLabel(float xRef, float yRef, float height, float minRate, float maxRate, float value);
+    LayerText changeIndicatorGaugeLabel(float xRef, float yRef, float value, const QColor& color);
     /** @brief Convert reference coordinates to screen coordinates */
     float refToScreenX(float x);
     /** @brief Convert reference coordinates to screen coordinates */
@@ -130,16 +180,16 @@ protected:
     void contextMenuEvent (QContextMenuEvent* event);
     void createActions();
 
-    static const int updateInterval = 40;
+    static const int updateInterval = 40; ///< Minimum repaint interval in milliseconds
 
-    QImage* image; ///< Double buffer image
-    QImage glImage; ///< The background / camera image
+    QImage glImage; ///< Decoded or offline background image in GL format
     UASInterface* uas; ///< The uas currently monitored
     float yawInt; ///< The yaw integral. Used to damp the yaw indication.
     QString mode; ///< The current vehicle mode
     QString state; ///< The current vehicle state
     QString fuelStatus; ///< Current fuel level / battery voltage
     double scalingFactor; ///< Factor used to scale all absolute values to screen coordinates
+    QPolygonF screenPolygon; ///< Screen coordinates of the polygon drawn last, reused to avoid allocations
     float xCenterOffset, yCenterOffset; ///< Offset from center of window in mm coordinates
     float vwidth; ///< Virtual width of this window, 200 mm per default. This allows to hardcode positions and aspect ratios. This virtual image plane is then scaled to the window size.
     float vheight; ///< Virtual height of this window, 150 mm per default
@@ -150,18 +200,24 @@ protected:
     int yCenter; ///< Center of the HUD instrument in pixel coordinates. Allows to off-center the whole instrument in its OpenGL window, e.g. to fit another instrument
 
     // Image buffers
-    unsigned char* rawBuffer1; ///< Double buffer 1 for the image
-    unsigned char* rawBuffer2; ///< Double buffer 2 for the image
-    unsigned char* rawImage;   ///< Pointer to current complete image
+    QGCRawVideoBuffer videoBuffer; ///< Raw camera frames, converted for glDrawPixels without allocations
+    bool rawVideo;             ///< The background is taken from videoBuffer instead of glImage
+    QGCUASImageTransfer* imageTransfer; ///< Decoded images of the monitored UAS, NULL if it has none
     int rawLastIndex;          ///< The last byte index received of the image
-    int rawExpectedBytes;      ///< Number of raw image bytes expected. Calculated by: image depth * channels * widht * height / 8
-    int bytesPerLine;          ///< Bytes per image line. Is calculated as: image depth * channels * width / 8
     bool imageStarted;         ///< If an image is currently in transmission
     int receivedDepth;         ///< Image depth in bit for the current image
     int receivedChannels;      ///< Number of color channels
     int receivedWidth;         ///< Width in pixels of the current image
     int receivedHeight;        ///< Height in pixels of the current image
 
+    // Cached instrument layers
+    QPixmap staticLayer;       ///< Scales and fixed symbols, depend only on the widget size
+    QPixmap textLayer;         ///< Texts, repainted when one of layerTexts changes
+    QPixmap pitchLadder;       ///< Pitch lines and labels centered at zero pitch, moved and rotated per frame
+    QList<LayerText> layerTexts; ///< Texts currently painted into textLayer
+    double staticScalingFactor; ///< Scaling factor staticLayer was painted with
+    double ladderScalingFactor; ///< Scaling factor pitchLadder was painted with
+
     // HUD colors
     QColor defaultColor;       ///< Color for most HUD elements, e.g. pitch lines, center cross, change rate gauges
     QColor setPointColor;      ///< Color for the current control set point, e.g. yaw desired
@@ -173,7 +229,6 @@ protected:
     // Blink rates
     int warningBlinkRate;      ///< Blink rate of warning messages, will be rounded to the refresh rate
 
-    QTimer* refreshTimer;      ///< The main timer, controls the update rate
     QPainter* hudPainter;
     QFont font;                ///< The HUD font, per default the free Bitstream Vera SANS, which is very close to actual HUD fonts
     QFontDatabase fontDatabase;///< Font database, only used to load the TrueType font file (the HUD font is directly loaded from file rather than from the system)
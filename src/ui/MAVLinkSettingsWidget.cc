@@ -49,6 +49,7 @@ MAVLinkSettingsWidget::MAVLinkSettingsWidget(MAVLinkProtocol* protocol, QWidget
     m_ui->loggingCheckBox->setChecked(protocol->loggingEnabled());
     m_ui->versionCheckBox->setChecked(protocol->versionCheckEnabled());
     m_ui->multiplexingCheckBox->setChecked(protocol->multiplexingEnabled());
+    m_ui->duplicateFilterCheckBox->setChecked(protocol->duplicateFilterEnabled());
     m_ui->systemIdSpinBox->setValue(protocol->getSystemId());
 
     m_ui->paramGuardCheckBox->setChecked(protocol->paramGuardEnabled());
@@ -76,6 +77,9 @@ MAVLinkSettingsWidget::MAVLinkSettingsWidget(MAVLinkProtocol* protocol, QWidget
     // Multiplexing
     connect(protocol, SIGNAL(multiplexingChanged(bool)), m_ui->multiplexingCheckBox, SLOT(setChecked(bool)));
     connect(m_ui->multiplexingCheckBox, SIGNAL(toggled(bool)), protocol, SLOT(enableMultiplexing(bool)));
+    // Duplicate filter
+    connect(protocol, SIGNAL(duplicateFilterChanged(bool)), m_ui->duplicateFilterCheckBox, SLOT(setChecked(bool)));
+    connect(m_ui->duplicateFilterCheckBox, SIGNAL(toggled(bool)), protocol, SLOT(enableDuplicateFilter(bool)));
     // Parameter guard
     connect(protocol, SIGNAL(paramGuardChanged(bool)), m_ui->paramGuardCheckBox, SLOT(setChecked(bool)));
     connect(m_ui->paramGuardCheckBox, SIGNAL(toggled(bool)), protocol, SLOT(enableParamGuard(bool)));
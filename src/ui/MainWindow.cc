@@ -20,6 +20,11 @@
 #include "MAVLinkSimulationLink.h"
 #include "SerialLink.h"
 #include "UDPLink.h"
+#include "TCPLink.h"
+#include "MAVLinkLoadGeneratorLink.h"
+#ifdef QGC_SHM_LINK
+#include "SharedMemoryLink.h"
+#endif
 #include "MAVLinkProtocol.h"
 #include "CommConfigurationWindow.h"
 #include "QGCWaypointListMulti.h"
@@ -1397,6 +1402,20 @@ void MainWindow::connectCommonActions()
 
     // Connect actions from ui
     connect(ui.actionAdd_Link, SIGNAL(triggered()), this, SLOT(addLink()));
+    QAction* addTcpLink = new QAction(QIcon(":/images/actions/list-add.svg"), tr("Add TCP Link"), this);
+    addTcpLink->setStatusTip(tr("Connect to a vehicle over TCP"));
+    ui.menuNetwork->insertAction(ui.actionAdd_Link, addTcpLink);
+    connect(addTcpLink, SIGNAL(triggered()), this, SLOT(addTCPLink()));
+    QAction* addLoadLink = new QAction(QIcon(":/images/actions/list-add.svg"), tr("Add Load Generator Link"), this);
+    addLoadLink->setStatusTip(tr("Generate synthetic high-rate MAVLink traffic for performance testing"));
+    ui.menuNetwork->insertAction(ui.actionAdd_Link, addLoadLink);
+    connect(addLoadLink, SIGNAL(triggered()), this, SLOT(addLoadGeneratorLink()));
+#ifdef QGC_SHM_LINK
+    QAction* addShmLink = new QAction(QIcon(":/images/actions/list-add.svg"), tr("Add Shared Memory Link"), this);
+    addShmLink->setStatusTip(tr("Connect to a simulator on this machine over shared memory"));
+    ui.menuNetwork->insertAction(ui.actionAdd_Link, addShmLink);
+    connect(addShmLink, SIGNAL(triggered()), this, SLOT(addSharedMemoryLink()));
+#endif
 
     // Connect internal actions
     connect(UASManager::instance(), SIGNAL(UASCreated(UASInterface*)), this, SLOT(UASCreated(UASInterface*)));
@@ -1540,6 +1559,62 @@ void MainWindow::addLink()
     }
 }
 
+void MainWindow::addTCPLink()
+{
+    // The link registers itself, the configuration window
+    // is created through the newLink() notification
+    TCPLink* link = new TCPLink();
+
+    // Open the configuration window so host and port can be set
+    QList<QAction*> actions = ui.menuNetwork->actions();
+    foreach (QAction* act, actions)
+    {
+        if (act->data().toInt() == LinkManager::instance()->getLinks().indexOf(link))
+        {
+            act->trigger();
+            break;
+        }
+    }
+}
+
+void MainWindow::addLoadGeneratorLink()
+{
+    // The link registers itself, the configuration window
+    // is created through the newLink() notification
+    MAVLinkLoadGeneratorLink* link = new MAVLinkLoadGeneratorLink();
+
+    // Open the configuration window so rate and systems can be set
+    QList<QAction*> actions = ui.menuNetwork->actions();
+    foreach (QAction* act, actions)
+    {
+        if (act->data().toInt() == LinkManager::instance()->getLinks().indexOf(link))
+        {
+            act->trigger();
+            break;
+        }
+    }
+}
+
+void MainWindow::addSharedMemoryLink()
+{
+#ifdef QGC_SHM_LINK
+    // The link registers itself, the configuration window
+    // is created through the newLink() notification
+    SharedMemoryLink* link = new SharedMemoryLink();
+
+    // Open the configuration window so the segment can be set
+    QList<QAction*> actions = ui.menuNetwork->actions();
+    foreach (QAction* act, actions)
+    {
+        if (act->data().toInt() == LinkManager::instance()->getLinks().indexOf(link))
+        {
+            act->trigger();
+            break;
+        }
+    }
+#endif
+}
+
 void MainWindow::addLink(LinkInterface *link)
 {
     // IMPORTANT! KEEP THESE TWO LINES
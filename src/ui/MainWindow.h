@@ -117,6 +117,12 @@ public slots:
     void showSettings();
     /** @brief Add a communication link */
     void addLink();
+    /** @brief Add a TCP link to a companion computer or serial bridge */
+    void addTCPLink();
+    /** @brief Add a synthetic MAVLink traffic source for performance testing */
+    void addLoadGeneratorLink();
+    /** @brief Add a link to a simulator running on this machine */
+    void addSharedMemoryLink();
     void addLink(LinkInterface* link);
     void configure();
     /** @brief Set the currently controlled UAS */
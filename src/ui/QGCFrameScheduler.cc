@@ -0,0 +1,210 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+
+/**
+ * @file
+ *   @brief Implementation of the shared repaint scheduler of all instruments
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#include <QApplication>
+#include <QWidget>
+#include <QThread>
+#include <QEvent>
+
+#include "QGCFrameScheduler.h"
+#include "QGC.h"
+
+QGCFrameScheduler::QGCFrameScheduler(QObject* parent) :
+    QObject(parent),
+    interval(minFrameInterval),
+    frameCost(0.0f),
+    repaints(0)
+{
+    timer.setInterval(interval);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(frame()));
+}
+
+QGCFrameScheduler* QGCFrameScheduler::instance()
+{
+    static QGCFrameScheduler* _instance = 0;
+    if (_instance == 0)
+    {
+        _instance = new QGCFrameScheduler();
+
+        // Set the application as parent to ensure that this object
+        // will be destroyed when the main application exits
+        _instance->setParent(qApp);
+    }
+    return _instance;
+}
+
+void QGCFrameScheduler::registerClient(QObject* client, const char* method, int minInterval)
+{
+    if (!client || index.contains(client)) return;
+
+    Client c;
+    c.object = client;
+    c.method = method;
+    c.minInterval = minInterval;
+    c.lastPaint = 0;
+    c.dirty = true;
+    index.insert(client, clients.size());
+    clients.append(c);
+
+    connect(client, SIGNAL(destroyed(QObject*)), this, SLOT(clientDestroyed(QObject*)));
+    client->installEventFilter(this);
+    if (!timer.isActive()) timer.start(interval);
+}
+
+void QGCFrameScheduler::unregisterClient(QObject* client)
+{
+    QHash<QObject*, int>::iterator i = index.find(client);
+    if (i == index.end()) return;
+
+    clients.removeAt(i.value());
+    updateIndex();
+    disconnect(client, SIGNAL(destroyed(QObject*)), this, SLOT(clientDestroyed(QObject*)));
+    client->removeEventFilter(this);
+}
+
+void QGCFrameScheduler::clientDestroyed(QObject* client)
+{
+    // Only the QObject part is left, do not call into it
+    QHash<QObject*, int>::iterator i = index.find(client);
+    if (i == index.end()) return;
+    clients.removeAt(i.value());
+    updateIndex();
+}
+
+void QGCFrameScheduler::updateIndex()
+{
+    index.clear();
+    for (int i = 0; i < clients.size(); ++i)
+    {
+        index.insert(clients.at(i).object, i);
+    }
+}
+
+void QGCFrameScheduler::setMinInterval(QObject* client, int minInterval)
+{
+    QHash<QObject*, int>::const_iterator i = index.constFind(client);
+    if (i != index.constEnd()) clients[i.value()].minInterval = minInterval;
+}
+
+bool QGCFrameScheduler::isDirty(QObject* client) const
+{
+    QHash<QObject*, int>::const_iterator i = index.constFind(client);
+    return i != index.constEnd() && clients.at(i.value()).dirty;
+}
+
+void QGCFrameScheduler::markDirty(QObject* client)
+{
+    // Called for every received value, keep it cheap
+    if (QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, "markDirty", Qt::QueuedConnection, Q_ARG(QObject*, client));
+        return;
+    }
+
+    QHash<QObject*, int>::const_iterator i = index.constFind(client);
+    if (i == index.constEnd()) return;
+    clients[i.value()].dirty = true;
+    if (!timer.isActive()) timer.start(interval);
+}
+
+bool QGCFrameScheduler::eventFilter(QObject* watched, QEvent* event)
+{
+    if (event->type() == QEvent::Show) markDirty(watched);
+    return false;
+}
+
+void QGCFrameScheduler::frame()
+{
+    paintFrame(QGC::groundTimeUsecs());
+}
+
+void QGCFrameScheduler::paintFrame(quint64 now)
+{
+    const quint64 start = QGC::groundTimeUsecs();
+    int painted = 0;
+
+    // Clients may register or unregister others while repainting, walk a
+    // copy and do not keep references into the list across the calls
+    QList<QObject*> frameClients;
+    foreach (const Client& c, clients) frameClients.append(c.object);
+
+    foreach (QObject* client, frameClients)
+    {
+        QHash<QObject*, int>::const_iterator i = index.constFind(client);
+        if (i == index.constEnd()) continue;
+        Client& c = clients[i.value()];
+        if (!c.dirty) continue;
+        QWidget* widget = qobject_cast<QWidget*>(c.object);
+        if (widget && !widget->isVisible()) continue;
+        if (now < c.lastPaint + (quint64)c.minInterval * 1000) continue;
+
+        // Clear before repainting, the client may mark itself
+        // dirty again, e.g. to continue an animation
+        QObject* object = c.object;
+        QByteArray method = c.method;
+        c.dirty = false;
+        c.lastPaint = now;
+
+        if (method.isEmpty())
+        {
+            if (widget) widget->repaint();
+        }
+        else
+        {
+            QMetaObject::invokeMethod(object, method.constData(), Qt::DirectConnection);
+        }
+        painted++;
+    }
+    repaints += painted;
+
+    if (painted > 0)
+    {
+        const float cost = (QGC::groundTimeUsecs() - start) / 1000.0f;
+        frameCost = frameCost * 0.8f + cost * 0.2f;
+        // Keep repainting within the budget of the GUI thread
+        interval = qBound(minFrameInterval, (int)(frameCost * 100.0f / budgetPercent), maxFrameInterval);
+        timer.setInterval(interval);
+    }
+
+    // Keep running while a visible client waits for its next repaint
+    bool pending = false;
+    foreach (const Client& c, clients)
+    {
+        QWidget* widget = qobject_cast<QWidget*>(c.object);
+        if (c.dirty && (!widget || widget->isVisible()))
+        {
+            pending = true;
+            break;
+        }
+    }
+    if (!pending) timer.stop();
+}
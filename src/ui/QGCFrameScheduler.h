@@ -0,0 +1,131 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+
+/**
+ * @file
+ *   @brief Definition of the shared repaint scheduler of all instruments
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#ifndef QGCFRAMESCHEDULER_H
+#define QGCFRAMESCHEDULER_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QByteArray>
+#include <QTimer>
+
+/**
+ * @brief Repaints all instruments on one shared cadence
+ *
+ * Instruments register once and mark themselves dirty when new data arrives,
+ * instead of running their own refresh timers. On every frame the scheduler
+ * repaints the dirty clients which are visible and whose minimum interval has
+ * passed. Hidden clients stay dirty and are repainted as soon as they are
+ * shown. The timer only runs while there is something to repaint.
+ *
+ * The cost of every frame is measured. The frame interval is stretched so
+ * that repainting takes at most budgetPercent of the GUI thread, the rest
+ * stays free to process incoming telemetry.
+ *
+ * Clients are QObjects, a widget is only repainted while it is visible.
+ */
+class QGCFrameScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    QGCFrameScheduler(QObject* parent = 0);
+
+    /** @brief The scheduler of the application */
+    static QGCFrameScheduler* instance();
+
+    /**
+     * @brief Repaint this client on the shared cadence
+     *
+     * @param client The instrument, unregistered automatically when destroyed
+     * @param method Name of a slot without arguments which repaints the client, e.g. "paintHUD". If NULL the client widget is repainted.
+     * @param minInterval Do not repaint more often than every minInterval milliseconds
+     */
+    void registerClient(QObject* client, const char* method = NULL, int minInterval = 0);
+    void unregisterClient(QObject* client);
+    /** @brief Change the minimum interval of a registered client in milliseconds */
+    void setMinInterval(QObject* client, int minInterval);
+    bool isDirty(QObject* client) const;
+
+    /** @brief Current interval between frames in milliseconds */
+    int getInterval() const { return interval; }
+    /** @brief Smoothed time spent repainting per frame in milliseconds */
+    float getFrameCost() const { return frameCost; }
+    /** @brief Number of client repaints so far */
+    quint64 getRepaints() const { return repaints; }
+    int getClientCount() const { return clients.size(); }
+
+    /**
+     * @brief Repaint all clients which are due
+     *
+     * Called by the timer, the time is passed in to allow headless tests.
+     *
+     * @param now Current time in microseconds
+     */
+    void paintFrame(quint64 now);
+
+    static const int minFrameInterval = 20;  ///< Fastest cadence in milliseconds (50 Hz)
+    static const int maxFrameInterval = 500; ///< Slowest cadence in milliseconds
+    static const int budgetPercent = 30;     ///< Share of the GUI thread spent repainting at most
+
+public slots:
+    /** @brief New data for this client arrived, repaint it with the next frame */
+    void markDirty(QObject* client);
+
+protected slots:
+    void frame();
+    void clientDestroyed(QObject* client);
+
+protected:
+    /** @brief Repaint clients which become visible */
+    bool eventFilter(QObject* watched, QEvent* event);
+    void updateIndex();
+
+    struct Client
+    {
+        QObject* object;
+        QByteArray method;     ///< Repaint slot, empty to call QWidget::repaint()
+        int minInterval;       ///< In milliseconds
+        quint64 lastPaint;     ///< Time of the last repaint in microseconds
+        bool dirty;
+    };
+
+    QList<Client> clients;
+    QHash<QObject*, int> index; ///< Position in clients
+    int interval;
+    float frameCost;
+    quint64 repaints;
+    QTimer timer;
+};
+
+#endif // QGCFRAMESCHEDULER_H
@@ -0,0 +1,95 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the batch polygon transformations of the instruments
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#include <cmath>
+
+#include "QGCGeometry.h"
+
+namespace QGCGeometry
+{
+
+void rotate(QPointF& point, float angle, const QPointF& origin)
+{
+    const qreal c = cos(angle);
+    const qreal s = sin(angle);
+    const qreal x = point.x() - origin.x();
+    const qreal y = point.y() - origin.y();
+    point.setX(c * x - s * y + origin.x());
+    point.setY(s * x + c * y + origin.y());
+}
+
+void rotate(QPolygonF& polygon, float angle, const QPointF& origin)
+{
+    rotateScale(polygon, angle, origin, 1.0f, polygon);
+}
+
+void scale(const QPolygonF& polygon, float factor, QPolygonF& result)
+{
+    const int n = polygon.size();
+    result.resize(n);
+    const QPointF* in = polygon.constData();
+    QPointF* out = result.data();
+    for (int i = 0; i < n; i++)
+    {
+        out[i].rx() = in[i].x() * factor;
+        out[i].ry() = in[i].y() * factor;
+    }
+}
+
+void rotateScale(const QPolygonF& polygon, float angle, const QPointF& origin, float factor, QPolygonF& result)
+{
+    // Rotation and scale folded into one matrix:
+    //
+    //   | f*cos(phi)  -f*sin(phi) |
+    //   | f*sin(phi)   f*cos(phi) |
+    //
+    const qreal c = factor * cos(angle);
+    const qreal s = factor * sin(angle);
+    const qreal ox = origin.x();
+    const qreal oy = origin.y();
+    const qreal tx = factor * ox;
+    const qreal ty = factor * oy;
+
+    // In place works as well, every vertex is read before it is written
+    const int n = polygon.size();
+    result.resize(n);
+    const QPointF* in = polygon.constData();
+    QPointF* out = result.data();
+    for (int i = 0; i < n; i++)
+    {
+        const qreal x = in[i].x() - ox;
+        const qreal y = in[i].y() - oy;
+        out[i].rx() = c * x - s * y + tx;
+        out[i].ry() = s * x + c * y + ty;
+    }
+}
+
+}
@@ -0,0 +1,61 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the batch polygon transformations of the instruments
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#ifndef QGCGEOMETRY_H
+#define QGCGEOMETRY_H
+
+#include <QPointF>
+#include <QPolygonF>
+
+/**
+ * @brief Transformations of whole polygons for the instrument primitives
+ *
+ * Every function computes the sine and cosine of the angle once and then
+ * runs one tight loop over the vertices without any calls, which the
+ * compiler can unroll and vectorize. Results are written into an output
+ * polygon that is only resized, so a buffer kept by the caller is reused
+ * from frame to frame without allocating.
+ *
+ * The angle is positive clockwise on screen, where y points down.
+ */
+namespace QGCGeometry
+{
+    /** @brief Rotate a point around the origin by angle in radians */
+    void rotate(QPointF& point, float angle, const QPointF& origin = QPointF());
+    /** @brief Rotate all vertices of a polygon in place around the origin by angle in radians */
+    void rotate(QPolygonF& polygon, float angle, const QPointF& origin);
+    /** @brief Scale all vertices, e.g. from reference to screen coordinates */
+    void scale(const QPolygonF& polygon, float factor, QPolygonF& result);
+    /** @brief Rotate around the origin by angle in radians and scale all vertices in one pass */
+    void rotateScale(const QPolygonF& polygon, float angle, const QPointF& origin, float factor, QPolygonF& result);
+}
+
+#endif // QGCGEOMETRY_H
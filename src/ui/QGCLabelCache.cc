@@ -0,0 +1,147 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the shared cache of rendered instrument labels
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#include <QApplication>
+#include <QPainter>
+#include <QFont>
+#include <QFontMetrics>
+
+#include "QGCLabelCache.h"
+
+const char* QGCLabelCache::fontFamily = "Bitstream Vera Sans";
+
+uint qHash(const QGCLabelCache::Key& key)
+{
+    return qHash(key.text) ^ key.color ^ (key.pixelSize << 24) ^ (key.width << 12) ^ key.height;
+}
+
+QGCLabelCache::QGCLabelCache(int maxSize, QObject* parent) :
+    QObject(parent),
+    labels(maxSize),
+    hits(0),
+    misses(0)
+{
+}
+
+QGCLabelCache* QGCLabelCache::instance()
+{
+    static QGCLabelCache* _instance = 0;
+    if (_instance == 0)
+    {
+        _instance = new QGCLabelCache();
+
+        // Set the application as parent to ensure that this object
+        // and its pixmaps will be destroyed before the application
+        _instance->setParent(qApp);
+    }
+    return _instance;
+}
+
+void QGCLabelCache::drawLabel(QPainter* painter, const QPoint& pos, const QString& text, const QColor& color, int pixelSize, const QSize& bounds)
+{
+    const QPixmap& pixmap = label(text, color, pixelSize, bounds);
+    if (!pixmap.isNull()) painter->drawPixmap(pos, pixmap);
+}
+
+const QPixmap& QGCLabelCache::label(const QString& text, const QColor& color, int pixelSize, const QSize& bounds)
+{
+    Key key;
+    key.text = text;
+    key.color = color.rgba();
+    key.pixelSize = pixelSize;
+    key.width = bounds.width();
+    key.height = bounds.height();
+
+    QPixmap* pixmap = labels.object(key);
+    if (pixmap)
+    {
+        hits++;
+        return *pixmap;
+    }
+
+    misses++;
+    pixmap = render(key);
+    if (!pixmap) return empty;
+    // Cost in kilobytes, at least one so that many tiny labels are bounded as well
+    int cost = qMax(1, pixmap->width() * pixmap->height() * 4 / 1024);
+    if (cost > labels.maxCost())
+    {
+        // Larger than the whole cache, do not evict everything else for it
+        oversized = *pixmap;
+        delete pixmap;
+        return oversized;
+    }
+    labels.insert(key, pixmap, cost);
+    return *pixmap;
+}
+
+QPixmap* QGCLabelCache::render(const Key& key) const
+{
+    QFont font(fontFamily);
+    font.setPixelSize(key.pixelSize);
+
+    QFontMetrics metrics(font);
+    int border = qMax(4, metrics.leading());
+    QRect rect = metrics.boundingRect(0, 0, key.width - 2*border, key.height,
+                                      Qt::AlignLeft | Qt::TextWordWrap, key.text);
+    if (rect.width() <= 0 || rect.height() <= 0) return NULL;
+
+    QPixmap* pixmap = new QPixmap(rect.width(), rect.height());
+    pixmap->fill(Qt::transparent);
+    QPainter painter(pixmap);
+    painter.setPen(QColor::fromRgba(key.color));
+    painter.setFont(font);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.drawText(0, 0, rect.width(), rect.height(), Qt::AlignCenter | Qt::TextWordWrap, key.text);
+    return pixmap;
+}
+
+float QGCLabelCache::getHitRate() const
+{
+    if (hits + misses == 0) return 0.0f;
+    return (float)hits / (hits + misses);
+}
+
+void QGCLabelCache::setMaxSize(int maxSize)
+{
+    labels.setMaxCost(maxSize);
+}
+
+void QGCLabelCache::resetStatistics()
+{
+    hits = 0;
+    misses = 0;
+}
+
+void QGCLabelCache::clear()
+{
+    labels.clear();
+}
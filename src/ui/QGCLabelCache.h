@@ -0,0 +1,122 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the shared cache of rendered instrument labels
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#ifndef QGCLABELCACHE_H
+#define QGCLABELCACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QPixmap>
+#include <QString>
+#include <QColor>
+#include <QSize>
+#include <QPoint>
+
+class QPainter;
+
+/**
+ * @brief Pre-rendered text labels shared by all instruments
+ *
+ * The instruments draw a small set of distinct strings dozens of times per
+ * frame, the scale numbers of the pitch ladder and the gauges. Laying out and
+ * rasterizing the text every time is expensive, so every label is rendered
+ * once into a pixmap and then only blitted. Labels are identified by their
+ * text, color, pixel size and the bounds they are wrapped in. The least
+ * recently used labels are evicted once the pixmaps exceed the maximum size.
+ *
+ * Pixmaps can only be used in the GUI thread, so can this cache.
+ */
+class QGCLabelCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @param maxSize Memory of all pixmaps in kilobytes */
+    QGCLabelCache(int maxSize = defaultMaxSize, QObject* parent = 0);
+
+    /** @brief The label cache of the application */
+    static QGCLabelCache* instance();
+
+    /**
+     * @brief Draw a label with the top left corner at pos
+     *
+     * The text is laid out like QPainter::drawText() with Qt::AlignCenter and
+     * Qt::TextWordWrap in the rectangle it needs within bounds.
+     *
+     * @param bounds Size of the area the text may be wrapped in, e.g. the widget size
+     */
+    void drawLabel(QPainter* painter, const QPoint& pos, const QString& text, const QColor& color, int pixelSize, const QSize& bounds);
+    /** @brief The rendered label, rendered now if it is not cached yet. Valid until the next lookup. */
+    const QPixmap& label(const QString& text, const QColor& color, int pixelSize, const QSize& bounds);
+
+    /** @brief Lookups answered from the cache */
+    quint64 getHits() const { return hits; }
+    /** @brief Lookups which had to render the label */
+    quint64 getMisses() const { return misses; }
+    /** @brief Fraction of lookups answered from the cache, 0 before the first lookup */
+    float getHitRate() const;
+    /** @brief Number of cached labels */
+    int getCount() const { return labels.count(); }
+    int getMaxSize() const { return labels.maxCost(); }
+    void setMaxSize(int maxSize);
+    void resetStatistics();
+    void clear();
+
+    static const int defaultMaxSize = 2048; ///< 2 MB of pixmaps
+    static const char* fontFamily;
+
+protected:
+    struct Key
+    {
+        QString text;
+        QRgb color;
+        int pixelSize;
+        int width;
+        int height;
+
+        bool operator==(const Key& other) const
+        {
+            return color == other.color && pixelSize == other.pixelSize &&
+                   width == other.width && height == other.height && text == other.text;
+        }
+    };
+    friend uint qHash(const Key& key);
+
+    QCache<Key, QPixmap> labels;
+    QPixmap empty;       ///< Returned for labels without any text
+    QPixmap oversized;   ///< Last label too large for the cache
+    quint64 hits;
+    quint64 misses;
+
+    QPixmap* render(const Key& key) const;
+};
+
+#endif // QGCLABELCACHE_H
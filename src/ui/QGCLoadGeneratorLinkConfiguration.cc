@@ -0,0 +1,81 @@
+#include <QStringList>
+
+#include "QGCLoadGeneratorLinkConfiguration.h"
+#include "ui_QGCLoadGeneratorLinkConfiguration.h"
+
+QGCLoadGeneratorLinkConfiguration::QGCLoadGeneratorLinkConfiguration(MAVLinkLoadGeneratorLink* link, QWidget *parent) :
+    QWidget(parent),
+    link(link),
+    ui(new Ui::QGCLoadGeneratorLinkConfiguration)
+{
+    ui->setupUi(this);
+    ui->rateSpinBox->setRange(MAVLinkLoadGeneratorLink::minRate, MAVLinkLoadGeneratorLink::maxRate);
+    ui->rateSpinBox->setValue(link->getRate());
+    ui->systemsSpinBox->setRange(1, MAVLinkLoadGeneratorLink::maxSystems);
+    ui->systemsSpinBox->setValue(link->getSystemCount());
+    ui->seedSpinBox->setValue(link->getSeed());
+    updateMessageMix();
+
+    connect(ui->rateSpinBox, SIGNAL(valueChanged(int)), link, SLOT(setRate(int)));
+    connect(ui->systemsSpinBox, SIGNAL(valueChanged(int)), link, SLOT(setSystemCount(int)));
+    connect(ui->seedSpinBox, SIGNAL(valueChanged(int)), link, SLOT(setSeed(int)));
+    connect(ui->mixLineEdit, SIGNAL(editingFinished()), this, SLOT(setMessageMix()));
+
+    connect(&statisticsTimer, SIGNAL(timeout()), this, SLOT(updateStatistics()));
+    statisticsTimer.start(1000);
+    updateStatistics();
+}
+
+QGCLoadGeneratorLinkConfiguration::~QGCLoadGeneratorLinkConfiguration()
+{
+    delete ui;
+}
+
+void QGCLoadGeneratorLinkConfiguration::changeEvent(QEvent *e)
+{
+    QWidget::changeEvent(e);
+    switch (e->type()) {
+    case QEvent::LanguageChange:
+        ui->retranslateUi(this);
+        break;
+    default:
+        break;
+    }
+}
+
+void QGCLoadGeneratorLinkConfiguration::setMessageMix()
+{
+    QMap<int, int> mix;
+    QStringList entries = ui->mixLineEdit->text().split(" ", QString::SkipEmptyParts);
+    foreach (const QString& entry, entries)
+    {
+        QStringList pair = entry.split(":");
+        bool idOk = false;
+        bool weightOk = true;
+        int msgid = pair.at(0).toInt(&idOk);
+        int weight = (pair.size() > 1) ? pair.at(1).toInt(&weightOk) : 1;
+        if (idOk && weightOk && weight > 0) mix.insert(msgid, weight);
+    }
+    // Show the mix in use again if the link rejected the new one
+    if (mix != link->getMessageMix() && !link->setMessageMix(mix)) updateMessageMix();
+}
+
+void QGCLoadGeneratorLinkConfiguration::updateMessageMix()
+{
+    QStringList mix;
+    QMap<int, int> messageMix = link->getMessageMix();
+    QMap<int, int>::const_iterator i;
+    for (i = messageMix.constBegin(); i != messageMix.constEnd(); ++i)
+    {
+        mix << QString("%1:%2").arg(i.key()).arg(i.value());
+    }
+    ui->mixLineEdit->setText(mix.join(" "));
+}
+
+void QGCLoadGeneratorLinkConfiguration::updateStatistics()
+{
+    if (!isVisible()) return;
+    ui->statisticsLabel->setText(tr("Achieved: %1 msg/s  Total: %2 messages")
+                                 .arg(link->getAchievedRate())
+                                 .arg(link->getMessagesGenerated()));
+}
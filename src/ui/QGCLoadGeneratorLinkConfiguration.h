@@ -0,0 +1,39 @@
+#ifndef QGCLOADGENERATORLINKCONFIGURATION_H
+#define QGCLOADGENERATORLINKCONFIGURATION_H
+
+#include <QWidget>
+#include <QTimer>
+
+#include "MAVLinkLoadGeneratorLink.h"
+
+namespace Ui {
+    class QGCLoadGeneratorLinkConfiguration;
+}
+
+class QGCLoadGeneratorLinkConfiguration : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit QGCLoadGeneratorLinkConfiguration(MAVLinkLoadGeneratorLink* link, QWidget *parent = 0);
+    ~QGCLoadGeneratorLinkConfiguration();
+
+public slots:
+    /** @brief Apply the message mix entered as ID:weight pairs */
+    void setMessageMix();
+    /** @brief Refresh the achieved rate */
+    void updateStatistics();
+
+protected:
+    void changeEvent(QEvent *e);
+    /** @brief Show the message mix of the link */
+    void updateMessageMix();
+
+    MAVLinkLoadGeneratorLink* link;    ///< Load generator instance this widget configures
+    QTimer statisticsTimer;
+
+private:
+    Ui::QGCLoadGeneratorLinkConfiguration *ui;
+};
+
+#endif // QGCLOADGENERATORLINKCONFIGURATION_H
@@ -44,7 +44,9 @@ This file is part of the QGROUNDCONTROL project
  */
 QGCParamWidget::QGCParamWidget(UASInterface* uas, QWidget *parent) :
         QGCUASParamManager(uas, parent),
-        components(new QMap<int, QTreeWidgetItem*>())
+        components(new QMap<int, QTreeWidgetItem*>()),
+        cacheEnabled(true),
+        cacheMismatches(0)
 {
     // Load settings
     loadSettings();
@@ -120,15 +122,18 @@ QGCParamWidget::QGCParamWidget(UASInterface* uas, QWidget *parent) :
     tree->setExpandsOnDoubleClick(true);
 
     // Connect signals/slots
-    connect(this, SIGNAL(parameterChanged(int,QString,float)), mav, SLOT(setParameter(int,QString,float)));
     connect(tree, SIGNAL(itemChanged(QTreeWidgetItem*,int)), this, SLOT(parameterItemChanged(QTreeWidgetItem*,int)));
 
     // New parameters from UAS
     connect(uas, SIGNAL(parameterChanged(int,int,int,int,QString,float)), this, SLOT(addParameter(int,int,int,int,QString,float)));
 
-    // Connect retransmission guard
+    // Connect cache verification and transfer results
     connect(this, SIGNAL(requestParameter(int,int)), uas, SLOT(requestParameter(int,int)));
-    connect(&retransmissionTimer, SIGNAL(timeout()), this, SLOT(retransmissionGuardTick()));
+    connect(&transfer, SIGNAL(transferFinished(int,int)), this, SLOT(transferFinished(int,int)));
+    connect(&transfer, SIGNAL(writeProgress(int,int)), this, SLOT(writeProgress(int,int)));
+
+    // Show the last known parameters right away
+    loadCachedParameters();
 }
 
 void QGCParamWidget::loadSettings()
@@ -140,6 +145,9 @@ void QGCParamWidget::loadSettings()
     if (ok) retransmissionTimeout = temp;
     temp = settings.value("PARAMETER_REWRITE_TIMEOUT", rewriteTimeout).toInt(&ok);
     if (ok) rewriteTimeout = temp;
+    transfer.setRetransmissionTimeout(retransmissionTimeout);
+    transfer.setRewriteTimeout(rewriteTimeout);
+    cacheEnabled = settings.value("PARAMETER_CACHE", cacheEnabled).toBool();
     settings.endGroup();
 }
 
@@ -199,94 +207,44 @@ void QGCParamWidget::addComponent(int uas, int component, QString componentName)
  */
 void QGCParamWidget::addParameter(int uas, int component, int paramCount, int paramId, QString parameterName, float value)
 {
-    addParameter(uas, component, parameterName, value);
-
-    // Missing packets list has to be instantiated for all components
-    if (!transmissionMissingPackets.contains(component))
+    // Received values of the list confirm or replace the cached ones
+    if (cachedValues.contains(component))
     {
-        transmissionMissingPackets.insert(component, new QList<int>());
+        verifyCachedParameter(component, paramCount, paramId, parameterName, value);
     }
 
-    // List mode is different from single parameter transfers
-    if (transmissionListMode)
+    // Remember the onboard index of each parameter, the cache
+    // stores the list in this order
+    if (paramId >= 0 && paramId < paramCount)
     {
-        // Only accept the list size once on the first packet from
-        // each component
-        if (!transmissionListSizeKnown.contains(component))
+        if (parameterNames.value(component).size() != paramCount)
         {
-            // Mark list size as known
-            transmissionListSizeKnown.insert(component, true);
-
-            // Mark all parameters as missing
-            for (int i = 0; i < paramCount; ++i)
-            {
-                if (!transmissionMissingPackets.value(component)->contains(i))
-                {
-                    transmissionMissingPackets.value(component)->append(i);
-                }
-            }
-
-            // There is only one transmission timeout for all components
-            // since components do not manage their transmission,
-            // the longest timeout is safe for all components.
-            quint64 thisTransmissionTimeout = QGC::groundTimeMilliseconds() + ((paramCount/retransmissionBurstRequestSize+5)*retransmissionTimeout);
-            if (thisTransmissionTimeout > transmissionTimeout)
-            {
-                transmissionTimeout = thisTransmissionTimeout;
-            }
+            parameterNames.insert(component, QVector<QString>(paramCount));
         }
-
-        // Start retransmission guard
-        // or reset timer
-        setRetransmissionGuardEnabled(true);
+        parameterNames[component][paramId] = parameterName;
     }
+    onboardValues[component].insert(parameterName, value);
 
-    // Mark this parameter as received in read list
-    int index = transmissionMissingPackets.value(component)->indexOf(paramId);
-    // If the MAV sent the parameter without request, it wont be in missing list
-    if (index != -1) transmissionMissingPackets.value(component)->removeAt(index);
-
-    bool justWritten = false;
-    bool writeMismatch = false;
-    //bool lastWritten = false;
-    // Mark this parameter as received in write ACK list
-    QMap<QString, float>* map = transmissionMissingWriteAckPackets.value(component);
-    if (map && map->contains(parameterName))
-    {
-        justWritten = true;
-        if (map->value(parameterName) != value)
-        {
-            writeMismatch = true;
-        }
-        map->remove(parameterName);
-    }
-
-    int missCount = 0;
-    foreach (int key, transmissionMissingPackets.keys())
-    {
-        missCount +=  transmissionMissingPackets.value(key)->count();
-    }
+    addParameter(uas, component, parameterName, value);
 
-    int missWriteCount = 0;
-    foreach (int key, transmissionMissingWriteAckPackets.keys())
-    {
-        missWriteCount += transmissionMissingWriteAckPackets.value(key)->count();
-    }
+    float writtenValue = value;
+    QGCUASParamTransfer::ReceiveResult result = transfer.receiveParameter(component, paramCount, paramId, parameterName, value, &writtenValue);
+    bool justWritten = (result == QGCUASParamTransfer::PARAM_WRITTEN || result == QGCUASParamTransfer::PARAM_WRITE_MISMATCH);
+    bool writeMismatch = (result == QGCUASParamTransfer::PARAM_WRITE_MISMATCH);
+    int missCount = transfer.getMissingCount();
+    int missWriteCount = transfer.getMissingWriteCount();
 
     if (justWritten && !writeMismatch && missWriteCount == 0)
     {
         // Just wrote one and count went to 0 - this was the last missing write parameter
-        statusLabel->setText(tr("SUCCESS: WROTE ALL PARAMETERS"));
+        statusLabel->setText(tr("SUCCESS: WROTE ALL %1 PARAMETERS (%2 parameters/s)").arg(transfer.getWriteTotal()).arg(transfer.getWriteThroughput(), 0, 'f', 1));
         QPalette pal = statusLabel->palette();
         pal.setColor(backgroundRole(), QGC::colorGreen);
         statusLabel->setPalette(pal);
     }
     else if (justWritten && !writeMismatch)
     {
-        statusLabel->setText(tr("SUCCESS: Wrote %2 (#%1/%4): %3").arg(paramId+1).arg(parameterName).arg(value).arg(paramCount));
-        QPalette pal = statusLabel->palette();
-        pal.setColor(backgroundRole(), QGC::colorGreen);
-        statusLabel->setPalette(pal);
+        // Progress of the batch is shown by writeProgress()
     }
     else if (justWritten && writeMismatch)
     {
@@ -294,7 +252,7 @@ void QGCParamWidget::addParameter(int uas, int component, int paramCount, int pa
         QPalette pal = statusLabel->palette();
         pal.setColor(backgroundRole(), QGC::colorRed);
         statusLabel->setPalette(pal);
-        statusLabel->setText(tr("FAILURE: Wrote %1: sent %2 != onboard %3").arg(parameterName).arg(map->value(parameterName)).arg(value));
+        statusLabel->setText(tr("FAILURE: Wrote %1: sent %2 != onboard %3").arg(parameterName).arg(writtenValue).arg(value));
     }
     else
     {
@@ -312,18 +270,6 @@ void QGCParamWidget::addParameter(int uas, int component, int paramCount, int pa
         }
         statusLabel->setText(tr("Got %2 (#%1/%5): %3 (%4 missing)").arg(paramId+1).arg(parameterName).arg(value).arg(missCount).arg(paramCount));
     }
-
-    // Check if last parameter was received
-    if (missCount == 0 && missWriteCount == 0)
-    {
-        this->transmissionActive = false;
-        this->transmissionListMode = false;
-        transmissionListSizeKnown.clear();
-        foreach (int key, transmissionMissingPackets.keys())
-        {
-            transmissionMissingPackets.value(key)->clear();
-        }
-    }
 }
 
 /**
@@ -464,16 +410,13 @@ void QGCParamWidget::requestParameterList()
 
     // Clear view and request param list
     clear();
+    stopVerification();
     parameters.clear();
+    parameterNames.clear();
+    onboardValues.clear();
     received.clear();
-    // Clear transmission state
-    transmissionListMode = true;
-    transmissionListSizeKnown.clear();
-    foreach (int key, transmissionMissingPackets.keys())
-    {
-        transmissionMissingPackets.value(key)->clear();
-    }
-    transmissionActive = true;
+    // Track the list of every component
+    transfer.startList();
 
     // Set status text
     statusLabel->setText(tr("Requested param list.. waiting"));
@@ -591,13 +534,10 @@ void QGCParamWidget::loadParameters()
                 if (mav->getUASID() == wpParams.at(0).toInt())
                 {
 
-                    bool changed = false;
+                    // Only values differing from the onboard values are transmitted
                     int component = wpParams.at(1).toInt();
                     QString parameterName = wpParams.at(2);
-                    if (!parameters.contains(component) || parameters.value(component)->value(parameterName, 0.0f) != (float)wpParams.at(3).toDouble())
-                    {
-                        changed = true;
-                    }
+                    bool changed = !isOnboardValue(component, parameterName, (float)wpParams.at(3).toDouble());
 
                     // Set parameter value
                     addParameter(wpParams.at(0).toInt(), wpParams.at(1).toInt(), wpParams.at(2), wpParams.at(3).toDouble());
@@ -633,118 +573,191 @@ void QGCParamWidget::loadParameters()
 }
 
 /**
- * Enabling the retransmission guard enables the parameter widget to track
- * dropped parameters and to re-request them. This works for both individual
- * parameter reads as well for whole list requests.
- *
- * @param enabled True if retransmission checking should be enabled, false else
+ * @param missingRead Parameters of the list which could not be read, -1 if the list request was not answered
+ * @param missingWrite Parameters which could not be written
  */
-void QGCParamWidget::setRetransmissionGuardEnabled(bool enabled)
+void QGCParamWidget::transferFinished(int missingRead, int missingWrite)
 {
-    if (enabled)
+    if (missingRead == 0 && missingWrite == 0)
     {
-        retransmissionTimer.start(retransmissionTimeout);
+        // The list or the written values are now known to be onboard
+        storeParameterCache();
+        // Write results are reported by addParameter() right after this
+        if (!cachedValues.isEmpty() || cacheMismatches > 0)
+        {
+            // Cached components the vehicle did not report do not exist onboard
+            foreach (int component, cachedValues.keys())
+            {
+                if (onboardValues.contains(component)) continue;
+                cacheMismatches++;
+                rebuildComponent(component);
+            }
+            statusLabel->setText(tr("Verified the cache: got all %1 parameters in %2 s, %3 differed").arg(transfer.getTotalCount()).arg(transfer.getLastTransferTime()/1000.0f, 0, 'f', 1).arg(cacheMismatches));
+            stopVerification();
+        }
+        else
+        {
+            statusLabel->setText(tr("Got all %1 parameters in %2 s (%3 retransmissions)").arg(transfer.getTotalCount()).arg(transfer.getLastTransferTime()/1000.0f, 0, 'f', 1).arg(transfer.getLastTransferRetries()));
+        }
+        QPalette pal = statusLabel->palette();
+        pal.setColor(backgroundRole(), QGC::colorGreen);
+        statusLabel->setPalette(pal);
+        return;
+    }
+
+    QPalette pal = statusLabel->palette();
+    pal.setColor(backgroundRole(), QGC::colorRed);
+    statusLabel->setPalette(pal);
+    if (missingRead < 0)
+    {
+        statusLabel->setText(tr("TIMEOUT! No answer to param list request."));
     }
     else
     {
-        retransmissionTimer.stop();
+        statusLabel->setText(tr("TIMEOUT! MISSING: %1 read, %2 write.").arg(missingRead).arg(missingWrite));
     }
 }
 
-void QGCParamWidget::retransmissionGuardTick()
+/**
+ * @param done Writes of this batch echoed or given up
+ * @param total Writes of this batch
+ */
+void QGCParamWidget::writeProgress(int done, int total)
 {
-    if (transmissionActive)
+    if (done == total) return; // Reported by addParameter() and transferFinished()
+    statusLabel->setText(tr("Writing parameters: %1% (%2/%3), %4 parameters/s").arg(transfer.getWriteProgress(), 0, 'f', 1).arg(done).arg(total).arg(transfer.getWriteThroughput(), 0, 'f', 1));
+    QPalette pal = statusLabel->palette();
+    pal.setColor(backgroundRole(), QGC::colorOrange);
+    statusLabel->setPalette(pal);
+}
+
+/**
+ * The cached lists of all components of this system are shown immediately.
+ * Then the full list is read in the background. MAVLink reports no vehicle
+ * id or parameter hash, a cache of another vehicle with the same system id
+ * can only be told apart by reading every parameter. The cached values are
+ * therefore not treated as onboard until the vehicle reported them.
+ */
+void QGCParamWidget::loadCachedParameters()
+{
+    if (!cacheEnabled) return;
+
+    int uasId = mav->getUASID();
+    int autopilot = mav->getAutopilotType();
+    int count = 0;
+
+    foreach (int component, cache.getComponents(uasId, autopilot))
     {
-        qDebug() << __FILE__ << __LINE__ << "RETRANSMISSION GUARD ACTIVE, CHECKING FOR DROPS..";
+        QVector<QString> names;
+        QVector<float> values;
+        if (!cache.load(uasId, component, autopilot, &names, &values)) continue;
 
-        // Check for timeout
-        // stop retransmission attempts on timeout
-        if (QGC::groundTimeMilliseconds() > transmissionTimeout)
+        for (int i = 0; i < names.size(); ++i)
         {
-            setRetransmissionGuardEnabled(false);
-            transmissionActive = false;
-
-            // Empty read retransmission list
-            // Empty write retransmission list
-            int missingReadCount = 0;
-            QList<int> readKeys = transmissionMissingPackets.keys();
-            foreach (int component, readKeys)
-            {
-                missingReadCount += transmissionMissingPackets.value(component)->count();
-                transmissionMissingPackets.value(component)->clear();
-            }
-
-            // Empty write retransmission list
-            int missingWriteCount = 0;
-            QList<int> writeKeys = transmissionMissingWriteAckPackets.keys();
-            foreach (int component, writeKeys)
-            {
-                missingWriteCount += transmissionMissingWriteAckPackets.value(component)->count();
-                transmissionMissingWriteAckPackets.value(component)->clear();
-            }
-            statusLabel->setText(tr("TIMEOUT! MISSING: %1 read, %2 write.").arg(missingReadCount).arg(missingWriteCount));
+            addParameter(uasId, component, names.at(i), values.at(i));
         }
+        cachedNames.insert(component, names);
+        cachedValues.insert(component, values);
+        count += names.size();
+    }
+
+    if (cachedValues.isEmpty()) return;
+
+    statusLabel->setText(tr("Loaded %1 cached parameters, verifying..").arg(count));
+    QPalette pal = statusLabel->palette();
+    pal.setColor(backgroundRole(), QGC::colorOrange);
+    statusLabel->setPalette(pal);
+
+    // Read the list without clearing the view
+    cacheMismatches = 0;
+    transfer.startList();
+    mav->requestParameters();
+    QGC::SLEEP::msleep(10);
+    mav->requestParameters();
+}
+
+void QGCParamWidget::verifyCachedParameter(int component, int paramCount, int paramId, const QString& parameterName, float value)
+{
+    const QVector<QString> names = cachedNames.value(component);
+    if (paramCount != names.size() || names.value(paramId) != parameterName)
+    {
+        // Parameters were added or removed, e.g. by a firmware update,
+        // or the cache belongs to another vehicle with this system id
+        cacheMismatches++;
+        cachedNames.remove(component);
+        cachedValues.remove(component);
+        rebuildComponent(component);
+        return;
+    }
+
+    if (cachedValues.value(component).value(paramId) != value) cacheMismatches++;
+}
+
+void QGCParamWidget::rebuildComponent(int component)
+{
+    if (components->contains(component))
+    {
+        // Deleting the component item deletes its groups and parameters
+        delete components->take(component);
+        delete paramGroups.take(component);
+    }
+    if (parameters.contains(component)) parameters.value(component)->clear();
+
+    const QMap<QString, float> onboard = onboardValues.value(component);
+    QMap<QString, float>::const_iterator i;
+    for (i = onboard.constBegin(); i != onboard.constEnd(); ++i)
+    {
+        addParameter(mav->getUASID(), component, i.key(), i.value());
+    }
+}
+
+void QGCParamWidget::stopVerification()
+{
+    cachedNames.clear();
+    cachedValues.clear();
+    cacheMismatches = 0;
+}
+
+/**
+ * Only components of which every parameter has been received are stored.
+ * Edited but not yet transmitted values are not stored, the cache has to
+ * reflect the values onboard.
+ */
+void QGCParamWidget::storeParameterCache()
+{
+    if (!cacheEnabled) return;
 
-        // Re-request at maximum retransmissionBurstRequestSize parameters at once
-        // to prevent link flooding
-        QMap<int, QMap<QString, float>*>::iterator i;
-        for (i = parameters.begin(); i != parameters.end(); ++i)
+    QMap<int, QVector<QString> >::const_iterator i;
+    for (i = parameterNames.constBegin(); i != parameterNames.constEnd(); ++i)
+    {
+        int component = i.key();
+        const QVector<QString>& names = i.value();
+        const QMap<QString, float> onboard = onboardValues.value(component);
+        if (names.isEmpty()) continue;
+
+        QVector<float> values(names.size());
+        bool complete = true;
+        for (int j = 0; j < names.size() && complete; ++j)
         {
-            // Iterate through the parameters of the component
-            int component = i.key();
-            // Request n parameters from this component (at maximum)
-            QList<int> * paramList = transmissionMissingPackets.value(component, NULL);
-            if (paramList)
-            {
-                int count = 0;
-                foreach (int id, *paramList)
-                {
-                    if (count < retransmissionBurstRequestSize)
-                    {
-                        qDebug() << __FILE__ << __LINE__ << "RETRANSMISSION GUARD REQUESTS RETRANSMISSION OF PARAM #" << id << "FROM COMPONENT #" << component;
-                        emit requestParameter(component, id);
-                        statusLabel->setText(tr("Requested retransmission of #%1").arg(id+1));
-                        count++;
-                    }
-                    else
-                    {
-                        break;
-                    }
-                }
-            }
+            QMap<QString, float>::const_iterator value = onboard.find(names.at(j));
+            complete = !names.at(j).isEmpty() && value != onboard.end();
+            if (complete) values[j] = value.value();
         }
 
-        // Re-request at maximum retransmissionBurstRequestSize parameters at once
-        // to prevent write-request link flooding
-        // Empty write retransmission list
-        QList<int> writeKeys = transmissionMissingWriteAckPackets.keys();
-        foreach (int component, writeKeys)
+        if (complete)
         {
-            int count = 0;
-            QMap <QString, float>* missingParams = transmissionMissingWriteAckPackets.value(component);
-            foreach (QString key, missingParams->keys())
-            {
-                if (count < retransmissionBurstRequestSize)
-                {
-                    // Re-request write operation
-                    emit parameterChanged(component, key, missingParams->value(key));
-                    statusLabel->setText(tr("Requested rewrite of: %1: %2").arg(key).arg(missingParams->value(key)));
-                    count++;
-                }
-                else
-                {
-                    break;
-                }
-            }
+            cache.store(mav->getUASID(), component, mav->getAutopilotType(), names, values);
         }
     }
-    else
-    {
-        qDebug() << __FILE__ << __LINE__ << "STOPPING RETRANSMISSION GUARD GRACEFULLY";
-        setRetransmissionGuardEnabled(false);
-    }
 }
 
+bool QGCParamWidget::isOnboardValue(int component, const QString& parameterName, float value) const
+{
+    QMap<int, QMap<QString, float> >::const_iterator i = onboardValues.find(component);
+    if (i == onboardValues.end()) return false;
+    QMap<QString, float>::const_iterator j = i.value().find(parameterName);
+    return j != i.value().end() && j.value() == value;
+}
 
 /**
  * The .. signal is emitted
@@ -762,26 +775,8 @@ void QGCParamWidget::requestParameterUpdate(int component, const QString& parame
  */
 void QGCParamWidget::setParameter(int component, QString parameterName, float value)
 {
-    emit parameterChanged(component, parameterName, value);
-    // Wait for parameter to be written back
-    // mark it therefore as missing
-    if (!transmissionMissingWriteAckPackets.contains(component))
-    {
-        transmissionMissingWriteAckPackets.insert(component, new QMap<QString, float>());
-    }
-
-    // Insert it in missing write ACK list
-    transmissionMissingWriteAckPackets.value(component)->insert(parameterName, value);
-
-    // Set timeouts
-    transmissionActive = true;
-    quint64 newTransmissionTimeout = QGC::groundTimeMilliseconds() + 5*rewriteTimeout;
-    if (newTransmissionTimeout > transmissionTimeout)
-    {
-        transmissionTimeout = newTransmissionTimeout;
-    }
-    // Enable guard / reset timeouts
-    setRetransmissionGuardEnabled(true);
+    // The transfer engine sends it and repeats it until the MAV echoes it
+    transfer.startWrite(component, parameterName, value);
 }
 
 /**
@@ -791,6 +786,7 @@ void QGCParamWidget::setParameters()
 {
     // Iterate through all components, through all parameters and emit them
     int parametersSent = 0;
+    int parametersSkipped = 0;
     QMap<int, QMap<QString, float>*>::iterator i;
     for (i = changedValues.begin(); i != changedValues.end(); ++i)
     {
@@ -801,6 +797,12 @@ void QGCParamWidget::setParameters()
             QMap<QString, float>::iterator j;
             for (j = comp->begin(); j != comp->end(); ++j)
             {
+                // Edited back to the onboard value
+                if (isOnboardValue(compid, j.key(), j.value()))
+                {
+                    parametersSkipped++;
+                    continue;
+                }
                 setParameter(compid, j.key(), j.value());
                 parametersSent++;
             }
@@ -814,16 +816,7 @@ void QGCParamWidget::setParameters()
     }
     else
     {
-        statusLabel->setText(tr("Transmitting %1 parameters.").arg(parametersSent));
-        // Set timeouts
-        transmissionActive = true;
-        quint64 newTransmissionTimeout = QGC::groundTimeMilliseconds() + (parametersSent/retransmissionBurstRequestSize+5)*rewriteTimeout;
-        if (newTransmissionTimeout > transmissionTimeout)
-        {
-            transmissionTimeout = newTransmissionTimeout;
-        }
-        // Enable guard
-        setRetransmissionGuardEnabled(true);
+        statusLabel->setText(tr("Transmitting %1 parameters (%2 unchanged).").arg(parametersSent).arg(parametersSkipped));
     }
 
     changedValues.clear();
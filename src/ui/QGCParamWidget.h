@@ -38,10 +38,18 @@ This file is part of the QGROUNDCONTROL project
 #include <QTimer>
 
 #include "QGCUASParamManager.h"
+#include "QGCUASParamCache.h"
 #include "UASInterface.h"
 
 /**
  * @brief Widget to read/set onboard parameters
+ *
+ * Every complete parameter list is stored in a QGCUASParamCache. When the
+ * widget is created for a known system the cached lists are shown at once
+ * while the full list is read in the background. MAVLink identifies neither
+ * the vehicle nor its parameter set, so a cached value is only treated as
+ * onboard once the vehicle reported it. Components whose parameter count or
+ * names differ from the cache are rebuilt from the received list.
  */
 class QGCParamWidget : public QGCUASParamManager
 {
@@ -84,8 +92,13 @@ public slots:
     /** @brief Load parameters from a file */
     void loadParameters();
 
-    /** @brief Check for missing parameters */
-    void retransmissionGuardTick();
+    /** @brief Report a finished parameter transfer */
+    void transferFinished(int missingRead, int missingWrite);
+    /** @brief Show the progress of a batch of writes */
+    void writeProgress(int done, int total);
+
+    /** @brief Show the cached lists of this system and start verifying them */
+    void loadCachedParameters();
 
 protected:
     QTreeWidget* tree;   ///< The parameter tree
@@ -93,10 +106,26 @@ protected:
     QMap<int, QTreeWidgetItem*>* components; ///< The list of components
     QMap<int, QMap<QString, QTreeWidgetItem*>* > paramGroups; ///< Parameter groups
 
-    /** @brief Activate / deactivate parameter retransmission */
-    void setRetransmissionGuardEnabled(bool enabled);
+    QGCUASParamCache cache; ///< On-disk copy of the last complete lists
+    bool cacheEnabled;      ///< Use the cache on connect
+    QMap<int, QMap<QString, float> > onboardValues; ///< Values last read from or echoed by the MAV, per component
+    QMap<int, QVector<QString> > parameterNames; ///< Parameter names by onboard index, per component
+    QMap<int, QVector<QString> > cachedNames;    ///< Cached names by onboard index while verifying
+    QMap<int, QVector<float> > cachedValues;     ///< Cached values by onboard index while verifying
+    int cacheMismatches;      ///< Values and components which differed from the cache
+
     /** @brief Load  settings */
     void loadSettings();
+    /** @brief Compare a parameter of the list being read against the cache */
+    void verifyCachedParameter(int component, int paramCount, int paramId, const QString& parameterName, float value);
+    /** @brief Show only the received parameters of a component whose cached list is outdated */
+    void rebuildComponent(int component);
+    /** @brief True if the MAV is known to hold this value already */
+    bool isOnboardValue(int component, const QString& parameterName, float value) const;
+    /** @brief Store all completely known components in the cache */
+    void storeParameterCache();
+    /** @brief Stop verifying the cache, e.g. because the full list is requested */
+    void stopVerification();
 };
 
 #endif // QGCPARAMWIDGET_H
@@ -0,0 +1,247 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+
+/**
+ * @file
+ *   @brief Implementation of the raw video frame buffer
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "QGCRawVideoBuffer.h"
+#include "QGC.h"
+
+quint32 QGCRawVideoBuffer::greyTable[256];
+bool QGCRawVideoBuffer::greyTableValid = false;
+
+/** @brief One pixel with these bytes in memory order R, G, B, A */
+static inline quint32 packRGBA(uchar r, uchar g, uchar b, uchar a)
+{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    return r | (g << 8) | (b << 16) | ((quint32)a << 24);
+#else
+    return ((quint32)r << 24) | (g << 16) | (b << 8) | a;
+#endif
+}
+
+QGCRawVideoBuffer::QGCRawVideoBuffer() :
+    format(FORMAT_NONE),
+    width(0),
+    height(0),
+    back(0),
+    front(2),
+    latest(1),
+    framesCommitted(0),
+    framesDropped(0),
+    lastCommit(0),
+    frameInterval(0.0f),
+    conversionTime(0.0f)
+{
+    if (!greyTableValid)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            greyTable[i] = packRGBA(i, i, i, 255);
+        }
+        greyTableValid = true;
+    }
+}
+
+bool QGCRawVideoBuffer::setFormat(int width, int height, int depth, int channels)
+{
+    PixelFormat newFormat = FORMAT_NONE;
+    if (depth == 8 && channels == 1) newFormat = FORMAT_GREY8;
+    else if (depth == 8 && channels == 3) newFormat = FORMAT_BGR24;
+    else if (depth == 8 && channels == 4) newFormat = FORMAT_BGRA32;
+    if (width <= 0 || height <= 0) newFormat = FORMAT_NONE;
+
+    int rawSize = qMax(0, (width * height * depth * channels) / 8);
+    if (newFormat == format && width == this->width && height == this->height && rawSize == raw.size())
+    {
+        return format != FORMAT_NONE;
+    }
+
+    format = newFormat;
+    this->width = qMax(0, width);
+    this->height = qMax(0, height);
+    raw.fill(0, rawSize);
+    for (int i = 0; i < 3; i++)
+    {
+        frames[i].fill(packRGBA(0, 0, 0, 255), this->width * this->height);
+    }
+    back = 0;
+    latest = 1;
+    front = 2;
+    framesCommitted = 0;
+    framesDropped = 0;
+    lastCommit = 0;
+    frameInterval = 0.0f;
+    return format != FORMAT_NONE;
+}
+
+void QGCRawVideoBuffer::commit()
+{
+    if (format == FORMAT_NONE) return;
+
+    quint64 start = QGC::groundTimeUsecs();
+
+    // Convert line by line, glDrawPixels starts with the bottom line
+    int bytesPerPixel = (format == FORMAT_GREY8) ? 1 : ((format == FORMAT_BGR24) ? 3 : 4);
+    int bytesPerLine = width * bytesPerPixel;
+    const uchar* src = raw.constData();
+    quint32* dst = frames[back].data();
+    for (int y = 0; y < height; y++)
+    {
+        quint32* line = dst + (height - 1 - y) * width;
+        switch (format)
+        {
+        case FORMAT_GREY8:
+            convertGrey(src, line, width);
+            break;
+        case FORMAT_BGR24:
+            convertBGR(src, line, width);
+            break;
+        default:
+            convertBGRA(src, line, width);
+            break;
+        }
+        src += bytesPerLine;
+    }
+
+    // Publish the back frame and continue with the previous latest one
+    int previous = latest.fetchAndStoreOrdered(back | freshFlag);
+    if (previous & freshFlag) framesDropped++;
+    back = previous & ~freshFlag;
+
+    quint64 now = QGC::groundTimeUsecs();
+    float elapsed = now - start;
+    conversionTime = (framesCommitted == 0) ? elapsed : 0.9f * conversionTime + 0.1f * elapsed;
+    if (lastCommit != 0)
+    {
+        float interval = now - lastCommit;
+        frameInterval = (frameInterval == 0.0f) ? interval : 0.9f * frameInterval + 0.1f * interval;
+    }
+    lastCommit = now;
+    framesCommitted++;
+}
+
+bool QGCRawVideoBuffer::acquire()
+{
+    if (!((int)latest & freshFlag)) return false;
+    int previous = latest.fetchAndStoreOrdered(front);
+    front = previous & ~freshFlag;
+    return true;
+}
+
+float QGCRawVideoBuffer::getFrameRate() const
+{
+    if (frameInterval <= 0.0f) return 0.0f;
+    return 1000000.0f / frameInterval;
+}
+
+QImage QGCRawVideoBuffer::toImage() const
+{
+    if (format == FORMAT_NONE) return QImage();
+
+    QImage image(width, height, QImage::Format_ARGB32);
+    const uchar* src = getFrontPixels();
+    for (int y = 0; y < height; y++)
+    {
+        QRgb* line = (QRgb*)image.scanLine(height - 1 - y);
+        for (int x = 0; x < width; x++, src += 4)
+        {
+            line[x] = qRgba(src[0], src[1], src[2], src[3]);
+        }
+    }
+    return image;
+}
+
+void QGCRawVideoBuffer::convertGrey(const uchar* src, quint32* dst, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    // Sixteen pixels per step: duplicate every grey byte and pair it with 0xFF
+    const __m128i alpha = _mm_set1_epi8((char)0xFF);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i g = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i gg = _mm_unpacklo_epi8(g, g);
+        __m128i ga = _mm_unpacklo_epi8(g, alpha);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi16(gg, ga));
+        _mm_storeu_si128((__m128i*)(dst + i + 4), _mm_unpackhi_epi16(gg, ga));
+        gg = _mm_unpackhi_epi8(g, g);
+        ga = _mm_unpackhi_epi8(g, alpha);
+        _mm_storeu_si128((__m128i*)(dst + i + 8), _mm_unpacklo_epi16(gg, ga));
+        _mm_storeu_si128((__m128i*)(dst + i + 12), _mm_unpackhi_epi16(gg, ga));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[i] = greyTable[src[i]];
+    }
+}
+
+void QGCRawVideoBuffer::convertBGR(const uchar* src, quint32* dst, int count)
+{
+    for (int i = 0; i < count; i++, src += 3)
+    {
+        dst[i] = packRGBA(src[2], src[1], src[0], 255);
+    }
+}
+
+void QGCRawVideoBuffer::convertBGRA(const uchar* src, quint32* dst, int count)
+{
+    int i = 0;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+#ifdef __SSE2__
+    // Four pixels per step: swap the red and blue bytes of every word
+    const __m128i maskAG = _mm_set1_epi32((int)0xFF00FF00);
+    const __m128i maskRB = _mm_set1_epi32((int)0x00FF00FF);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + 4 * i));
+        __m128i rb = _mm_and_si128(v, maskRB);
+        rb = _mm_or_si128(_mm_srli_epi32(rb, 16), _mm_slli_epi32(rb, 16));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(v, maskAG), rb));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        quint32 v;
+        memcpy(&v, src + 4 * i, 4);
+        dst[i] = (v & 0xFF00FF00) | ((v >> 16) & 0xFF) | ((v & 0xFF) << 16);
+    }
+#else
+    for (; i < count; i++)
+    {
+        dst[i] = packRGBA(src[4 * i + 2], src[4 * i + 1], src[4 * i], src[4 * i + 3]);
+    }
+#endif
+}
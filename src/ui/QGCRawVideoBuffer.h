@@ -0,0 +1,130 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2011 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+
+/**
+ * @file
+ *   @brief Definition of the raw video frame buffer
+ *
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ */
+
+#ifndef QGCRAWVIDEOBUFFER_H
+#define QGCRAWVIDEOBUFFER_H
+
+#include <QVector>
+#include <QImage>
+#include <QAtomicInt>
+
+/**
+ * @brief Converts raw camera frames for glDrawPixels and hands them to the painter
+ *
+ * The raw bytes of a frame are received into one persistent buffer. On commit
+ * they are converted in a single pass into RGBA rows in bottom-up order,
+ * which is what glDrawPixels expects, so no QImage and no
+ * QGLWidget::convertToGLFormat() is needed. Greyscale uses a table built
+ * once, greyscale and BGRA use SSE2 where the compiler provides it.
+ *
+ * The converted frames are exchanged through a triple buffer: the receiver
+ * converts into the back frame, commit() makes it the latest frame and
+ * acquire() hands the latest frame to the painter. Neither side waits for the
+ * other, a frame committed twice before it was painted counts as dropped.
+ * All buffers are allocated by setFormat(), committing and painting a frame
+ * does not allocate.
+ */
+class QGCRawVideoBuffer
+{
+public:
+    enum PixelFormat
+    {
+        FORMAT_NONE,   ///< No or unsupported format, frames are not converted
+        FORMAT_GREY8,  ///< One 8 bit channel
+        FORMAT_BGR24,  ///< Three 8 bit channels, blue first
+        FORMAT_BGRA32  ///< Four 8 bit channels, blue first, as QImage::Format_ARGB32 on little endian
+    };
+
+    QGCRawVideoBuffer();
+
+    /**
+     * @brief Set the raw frame format, reallocates the buffers only if it changed
+     *
+     * @param depth Bits per channel
+     * @return False if the format is not supported
+     */
+    bool setFormat(int width, int height, int depth, int channels);
+    PixelFormat getFormat() const { return format; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    /** @brief Bytes of one raw frame */
+    int getRawSize() const { return raw.size(); }
+    /** @brief Buffer to receive the raw bytes of the next frame into */
+    unsigned char* getRawBuffer() { return raw.data(); }
+
+    /** @brief Convert the raw buffer and make it the latest frame */
+    void commit();
+    /** @brief Make the latest frame the front frame, false if there is no new frame */
+    bool acquire();
+    /** @brief True once a frame was committed in the current format */
+    bool hasFrame() const { return framesCommitted > 0; }
+    /** @brief RGBA pixels of the front frame, bottom row first */
+    const uchar* getFrontPixels() const { return (const uchar*)frames[front].constData(); }
+    /** @brief Copy of the front frame, e.g. for saving it */
+    QImage toImage() const;
+
+    /** @brief Committed frames per second, smoothed */
+    float getFrameRate() const;
+    /** @brief Time to convert one frame in microseconds, smoothed */
+    float getConversionTime() const { return conversionTime; }
+    quint64 getFramesCommitted() const { return framesCommitted; }
+    /** @brief Frames replaced by a newer one before they were acquired */
+    quint64 getFramesDropped() const { return framesDropped; }
+
+    /** @brief Convert greyscale pixels to RGBA */
+    static void convertGrey(const uchar* src, quint32* dst, int count);
+    /** @brief Convert BGR pixels to RGBA */
+    static void convertBGR(const uchar* src, quint32* dst, int count);
+    /** @brief Convert BGRA pixels to RGBA */
+    static void convertBGRA(const uchar* src, quint32* dst, int count);
+
+protected:
+    PixelFormat format;
+    int width;
+    int height;
+    QVector<uchar> raw;       ///< Raw bytes of the frame being received
+    QVector<quint32> frames[3]; ///< Converted frames, RGBA in memory order
+    int back;                 ///< Frame the receiver converts into
+    int front;                ///< Frame the painter draws
+    QAtomicInt latest;        ///< Index of the latest frame, plus freshFlag if it was not yet acquired
+    quint64 framesCommitted;
+    quint64 framesDropped;
+    quint64 lastCommit;       ///< Time of the last commit in microseconds
+    float frameInterval;      ///< Smoothed time between commits in microseconds
+    float conversionTime;
+
+    static const int freshFlag = 4;
+    static quint32 greyTable[256];
+    static bool greyTableValid;
+};
+
+#endif // QGCRAWVIDEOBUFFER_H
@@ -0,0 +1,55 @@
+#include "QGCSharedMemoryLinkConfiguration.h"
+#include "ui_QGCSharedMemoryLinkConfiguration.h"
+
+QGCSharedMemoryLinkConfiguration::QGCSharedMemoryLinkConfiguration(SharedMemoryLink* link, QWidget *parent) :
+    QWidget(parent),
+    link(link),
+    ui(new Ui::QGCSharedMemoryLinkConfiguration)
+{
+    ui->setupUi(this);
+    ui->segmentLineEdit->setText(link->getSegmentName());
+
+    // Every name change reconnects the link, do not do it for each typed character
+    connect(ui->segmentLineEdit, SIGNAL(editingFinished()), this, SLOT(setSegmentName()));
+
+    connect(&statisticsTimer, SIGNAL(timeout()), this, SLOT(updateStatistics()));
+    statisticsTimer.start(1000);
+    updateStatistics();
+}
+
+QGCSharedMemoryLinkConfiguration::~QGCSharedMemoryLinkConfiguration()
+{
+    delete ui;
+}
+
+void QGCSharedMemoryLinkConfiguration::changeEvent(QEvent *e)
+{
+    QWidget::changeEvent(e);
+    switch (e->type()) {
+    case QEvent::LanguageChange:
+        ui->retranslateUi(this);
+        break;
+    default:
+        break;
+    }
+}
+
+void QGCSharedMemoryLinkConfiguration::setSegmentName()
+{
+    if (ui->segmentLineEdit->text() != link->getSegmentName())
+    {
+        link->setSegmentName(ui->segmentLineEdit->text());
+        // Show the name in use, the link adds the slash or rejects a taken name
+        ui->segmentLineEdit->setText(link->getSegmentName());
+    }
+}
+
+void QGCSharedMemoryLinkConfiguration::updateStatistics()
+{
+    if (!isVisible()) return;
+    ui->statisticsLabel->setText(tr("Up: %1 kbit/s  Sent: %2 kB  Received: %3 kB  Dropped: %4 B")
+                                 .arg(link->getTotalUpstream() / 1000)
+                                 .arg(link->getBitsSent() / 8000)
+                                 .arg(link->getBitsReceived() / 8000)
+                                 .arg(link->getBytesDropped()));
+}
@@ -0,0 +1,37 @@
+#ifndef QGCSHAREDMEMORYLINKCONFIGURATION_H
+#define QGCSHAREDMEMORYLINKCONFIGURATION_H
+
+#include <QWidget>
+#include <QTimer>
+
+#include "SharedMemoryLink.h"
+
+namespace Ui {
+    class QGCSharedMemoryLinkConfiguration;
+}
+
+class QGCSharedMemoryLinkConfiguration : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit QGCSharedMemoryLinkConfiguration(SharedMemoryLink* link, QWidget *parent = 0);
+    ~QGCSharedMemoryLinkConfiguration();
+
+public slots:
+    /** @brief Apply the segment name once editing is finished */
+    void setSegmentName();
+    /** @brief Refresh the throughput and drop counters */
+    void updateStatistics();
+
+protected:
+    void changeEvent(QEvent *e);
+
+    SharedMemoryLink* link;    ///< Shared memory link instance this widget configures
+    QTimer statisticsTimer;
+
+private:
+    Ui::QGCSharedMemoryLinkConfiguration *ui;
+};
+
+#endif // QGCSHAREDMEMORYLINKCONFIGURATION_H
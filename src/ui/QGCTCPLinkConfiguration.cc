@@ -0,0 +1,76 @@
+#include "QGCTCPLinkConfiguration.h"
+#include "ui_QGCTCPLinkConfiguration.h"
+
+QGCTCPLinkConfiguration::QGCTCPLinkConfiguration(TCPLink* link, QWidget *parent) :
+    QWidget(parent),
+    link(link),
+    ui(new Ui::QGCTCPLinkConfiguration)
+{
+    ui->setupUi(this);
+    ui->modeComboBox->addItem(tr("Client (connect to vehicle)"), TCPLink::TCP_CLIENT);
+    ui->modeComboBox->addItem(tr("Server (accept vehicles)"), TCPLink::TCP_SERVER);
+    ui->modeComboBox->setCurrentIndex(ui->modeComboBox->findData(link->getMode()));
+    ui->hostLineEdit->setText(link->getHost());
+    ui->portSpinBox->setValue(link->getPort());
+    ui->noDelayCheckBox->setChecked(link->getNoDelay());
+    setMode(link->getMode());
+
+    connect(ui->modeComboBox, SIGNAL(currentIndexChanged(int)), link, SLOT(setMode(int)));
+    connect(ui->modeComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(setMode(int)));
+    connect(ui->hostLineEdit, SIGNAL(editingFinished()), this, SLOT(setHost()));
+    // Every port change reconnects the link, do not do it for each typed digit
+    connect(ui->portSpinBox, SIGNAL(editingFinished()), this, SLOT(setPort()));
+    connect(ui->noDelayCheckBox, SIGNAL(toggled(bool)), link, SLOT(setNoDelay(bool)));
+
+    connect(&statisticsTimer, SIGNAL(timeout()), this, SLOT(updateStatistics()));
+    statisticsTimer.start(1000);
+    updateStatistics();
+}
+
+QGCTCPLinkConfiguration::~QGCTCPLinkConfiguration()
+{
+    delete ui;
+}
+
+void QGCTCPLinkConfiguration::changeEvent(QEvent *e)
+{
+    QWidget::changeEvent(e);
+    switch (e->type()) {
+    case QEvent::LanguageChange:
+        ui->retranslateUi(this);
+        break;
+    default:
+        break;
+    }
+}
+
+void QGCTCPLinkConfiguration::setHost()
+{
+    if (ui->hostLineEdit->text() != link->getHost())
+    {
+        link->setHost(ui->hostLineEdit->text());
+    }
+}
+
+void QGCTCPLinkConfiguration::setPort()
+{
+    if (ui->portSpinBox->value() != link->getPort())
+    {
+        link->setPort(ui->portSpinBox->value());
+    }
+}
+
+void QGCTCPLinkConfiguration::setMode(int mode)
+{
+    ui->hostLineEdit->setEnabled(mode == TCPLink::TCP_CLIENT);
+}
+
+void QGCTCPLinkConfiguration::updateStatistics()
+{
+    if (!isVisible()) return;
+    ui->statisticsLabel->setText(tr("Up: %1 kbit/s  Down: %2 kbit/s  Write latency: %3 us  Write size: %4 B")
+                                 .arg(link->getCurrentUpstream() / 1000)
+                                 .arg(link->getCurrentDownstream() / 1000)
+                                 .arg(link->getMeanWriteLatency())
+                                 .arg(link->getMeanWriteSize()));
+}
@@ -0,0 +1,41 @@
+#ifndef QGCTCPLINKCONFIGURATION_H
+#define QGCTCPLINKCONFIGURATION_H
+
+#include <QWidget>
+#include <QTimer>
+
+#include "TCPLink.h"
+
+namespace Ui {
+    class QGCTCPLinkConfiguration;
+}
+
+class QGCTCPLinkConfiguration : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit QGCTCPLinkConfiguration(TCPLink* link, QWidget *parent = 0);
+    ~QGCTCPLinkConfiguration();
+
+public slots:
+    /** @brief Apply the host name once editing is finished */
+    void setHost();
+    /** @brief Apply the port once editing is finished */
+    void setPort();
+    /** @brief Enable the host field only in client mode */
+    void setMode(int mode);
+    /** @brief Refresh the throughput and latency counters */
+    void updateStatistics();
+
+protected:
+    void changeEvent(QEvent *e);
+
+    TCPLink* link;    ///< TCP link instance this widget configures
+    QTimer statisticsTimer;
+
+private:
+    Ui::QGCTCPLinkConfiguration *ui;
+};
+
+#endif // QGCTCPLINKCONFIGURATION_H
@@ -132,6 +132,12 @@ void WaypointList::setUAS(UASInterface* uas)
         //connect(uas->getWaypointManager(),SIGNAL(loadWPFile()),this,SLOT(setIsLoadFileWP()));
         //connect(uas->getWaypointManager(),SIGNAL(readGlobalWPFromUAS(bool)),this,SLOT(setIsReadGlobalWP(bool)));
 
+        m_ui->transferWindowCheckBox->setChecked(uas->getWaypointManager()->getTransferWindowEnabled());
+        connect(m_ui->transferWindowCheckBox, SIGNAL(toggled(bool)), uas->getWaypointManager(), SLOT(setTransferWindowEnabled(bool)));
+        m_ui->deltaUploadCheckBox->setChecked(uas->getWaypointManager()->getDeltaUploadEnabled());
+        connect(m_ui->deltaUploadCheckBox, SIGNAL(toggled(bool)), uas->getWaypointManager(), SLOT(setDeltaUploadEnabled(bool)));
+        connect(uas->getWaypointManager(), SIGNAL(deltaUploadEnabledChanged(bool)), m_ui->deltaUploadCheckBox, SLOT(setChecked(bool)));
+
     }
 }
 
@@ -139,8 +145,8 @@ void WaypointList::saveWaypoints()
 {
     if (uas)
     {
-        QString fileName = QFileDialog::getSaveFileName(this, tr("Save File"), "./waypoints.txt", tr("Waypoint File (*.txt)"));
-        uas->getWaypointManager()->saveWaypoints(fileName);
+        QString fileName = QFileDialog::getSaveFileName(this, tr("Save File"), "./waypoints.txt", tr("Waypoint File (*.txt);;Binary Waypoint File (*.wpb)"));
+        if (!fileName.isEmpty()) uas->getWaypointManager()->saveWaypoints(fileName);
     }
 }
 
@@ -148,8 +154,8 @@ void WaypointList::loadWaypoints()
 {
     if (uas)
     {
-        QString fileName = QFileDialog::getOpenFileName(this, tr("Load File"), ".", tr("Waypoint File (*.txt)"));
-        uas->getWaypointManager()->loadWaypoints(fileName);
+        QString fileName = QFileDialog::getOpenFileName(this, tr("Load File"), ".", tr("Waypoint File (*.txt *.wpb)"));
+        if (!fileName.isEmpty()) uas->getWaypointManager()->loadWaypoints(fileName);
     }
 }
 
@@ -24,6 +24,7 @@
 #include <QPaintEngine>
 
 #include "QGC.h"
+#include "QGCFrameScheduler.h"
 
 /**
  * @brief The default constructor
@@ -121,10 +122,8 @@ d_curve(NULL)
     zoomer->setRubberBandPen(QPen(Qt::blue, 1.2, Qt::DotLine));
     zoomer->setTrackerPen(QPen(Qt::blue));
 
-    // Start QTimer for plot update
-    updateTimer = new QTimer(this);
-    connect(updateTimer, SIGNAL(timeout()), this, SLOT(paintRealtime()));
-    //updateTimer->start(DEFAULT_REFRESH_RATE);
+    // Replot with the other instruments when new data arrived
+    QGCFrameScheduler::instance()->registerClient(this, "paintRealtime", DEFAULT_REFRESH_RATE);
 
     //    QwtPlot::setAutoReplot();
 
@@ -139,14 +138,13 @@ LinechartPlot::~LinechartPlot()
 
 void LinechartPlot::showEvent(QShowEvent* event)
 {
+    // The frame scheduler replots as soon as the widget is visible
     Q_UNUSED(event);
-    updateTimer->start(DEFAULT_REFRESH_RATE);
 }
 
 void LinechartPlot::hideEvent(QHideEvent* event)
 {
     Q_UNUSED(event);
-    updateTimer->stop();
 }
 
 int LinechartPlot::getPlotId()
@@ -198,12 +196,13 @@ int LinechartPlot::getAverageWindow()
  **/
 void LinechartPlot::setRefreshRate(int ms)
 {
-    updateTimer->setInterval(ms);
+    QGCFrameScheduler::instance()->setMinInterval(this, ms);
 }
 
 void LinechartPlot::setActive(bool active)
 {
     m_active = active;
+    if (active) QGCFrameScheduler::instance()->markDirty(this);
 }
 
 /**
@@ -270,6 +269,8 @@ void LinechartPlot::appendData(QString dataname, quint64 ms, double value)
     //    qDebug() << "mintime" << minTime << "maxtime" << maxTime << "last max time" << "window position" << getWindowPosition();
 
     datalock.unlock();
+
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 /**
@@ -620,32 +621,7 @@ void LinechartPlot::paintRealtime()
         qDebug() << "EVENTLOOP: (" << MG::TIME::getGroundTimeNow() - timestamp << ")" << __FILE__ << __LINE__;
         timestamp = MG::TIME::getGroundTimeNow();
 #endif
-        // Update plot window value to new max time if the last time was also the max time
-        windowLock.lock();
-        if (automaticScrollActive)
-        {
-
-            // FIXME Check, but commenting this out should have been
-            // beneficial (does only add complexity)
-            //            if (MG::TIME::getGroundTimeNow() > maxTime && abs(MG::TIME::getGroundTimeNow() - maxTime) < 5000000)
-            //            {
-            //                plotPosition = MG::TIME::getGroundTimeNow();
-            //            }
-            //            else
-            //            {
-            plotPosition = lastTime;// + lastMaxTimeAdded.msec();
-            //            }
-            setAxisScale(QwtPlot::xBottom, plotPosition - plotInterval, plotPosition, timeScaleStep);
-
-            // FIXME Last fix for scroll zoomer is here
-            //setAxisScale(QwtPlot::yLeft, minValue + minValue * 0.05, maxValue + maxValue * 0.05f, (maxValue - minValue) / 10.0);
-            /* Notify about change. Even if the window position was not changed
-         * itself, the relative position of the window to the interval must
-         * have changed, as the interval likely increased in length */
-            emit windowPositionChanged(getWindowPosition());
-        }
-
-        windowLock.unlock();
+        scrollWindow();
 
         // Defined both on windows 32- and 64 bit
 #ifndef _WIN32
@@ -696,6 +672,44 @@ void LinechartPlot::paintRealtime()
     }
 }
 
+void LinechartPlot::scrollWindow()
+{
+    // Update plot window value to new max time if the last time was also the max time
+    windowLock.lock();
+    if (automaticScrollActive)
+    {
+
+        // FIXME Check, but commenting this out should have been
+        // beneficial (does only add complexity)
+        //            if (MG::TIME::getGroundTimeNow() > maxTime && abs(MG::TIME::getGroundTimeNow() - maxTime) < 5000000)
+        //            {
+        //                plotPosition = MG::TIME::getGroundTimeNow();
+        //            }
+        //            else
+        //            {
+        plotPosition = lastTime;// + lastMaxTimeAdded.msec();
+        //            }
+        setAxisScale(QwtPlot::xBottom, plotPosition - plotInterval, plotPosition, timeScaleStep);
+
+        // FIXME Last fix for scroll zoomer is here
+        //setAxisScale(QwtPlot::yLeft, minValue + minValue * 0.05, maxValue + maxValue * 0.05f, (maxValue - minValue) / 10.0);
+        /* Notify about change. Even if the window position was not changed
+     * itself, the relative position of the window to the interval must
+     * have changed, as the interval likely increased in length */
+        emit windowPositionChanged(getWindowPosition());
+    }
+
+    windowLock.unlock();
+}
+
+void LinechartPlot::renderOffscreen(QImage* image)
+{
+    if (size() != image->size()) resize(image->size());
+    scrollWindow();
+    updateAxes();
+    print(*image);
+}
+
 /**
  * @brief Removes all data and curves from the plot
  **/
@@ -39,6 +39,7 @@ This file is part of the PIXHAWK project
 #include <QList>
 #include <QMutex>
 #include <QTime>
+#include <QImage>
 #include <qwt_plot_panner.h>
 #include <qwt_plot_curve.h>
 #include <qwt_scale_draw.h>
@@ -215,6 +216,8 @@ public:
     double getVariance(QString id);
     /** @brief Get the last inserted value */
     double getCurrentValue(QString id);
+    /** @brief Scroll to the latest data and print the plot into an image of any size */
+    void renderOffscreen(QImage* image);
 
     static const int SCALE_ABSOLUTE = 0;
     static const int SCALE_BEST_FIT = 1;
@@ -298,7 +301,6 @@ protected:
 
     quint64 plotInterval;
     quint64 plotPosition;
-    QTimer* updateTimer;
     QMutex datalock;
     QMutex windowLock;
     quint64 timeScaleStep;
@@ -311,6 +313,8 @@ protected:
     // Methods
     void addCurve(QString id);
     QColor getNextColor();
+    /** @brief Move the time window to the latest data if auto scrolling */
+    void scrollWindow();
     void showEvent(QShowEvent* event);
     void hideEvent(QHideEvent* event);
 
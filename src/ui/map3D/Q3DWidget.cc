@@ -31,6 +31,7 @@ This file is part of the QGROUNDCONTROL project
 
 #include "Q3DWidget.h"
 #include "QGC.h"
+#include "QGCFrameScheduler.h"
 
 #include <osg/Geometry>
 #include <osg/LineWidth>
@@ -105,8 +106,9 @@ Q3DWidget::init(float fps)
     cameraManipulator->setMinZoomRange(cameraParams.minZoomRange);
     cameraManipulator->setDistance(cameraParams.minZoomRange * 2.0);
 
-    connect(&timer, SIGNAL(timeout()), this, SLOT(redraw()));
-    // DO NOT START TIMER IN INITIALIZATION! IT IS STARTED IN THE SHOW EVENT
+    // The scene is animated, it is redrawn on every frame of the
+    // shared frame scheduler while visible, at most at the given fps
+    QGCFrameScheduler::instance()->registerClient(this, "redraw", static_cast<int>(floorf(1000.0f / fps)));
 }
 
 void Q3DWidget::showEvent(QShowEvent* event)
@@ -114,7 +116,6 @@ void Q3DWidget::showEvent(QShowEvent* event)
     // React only to internal (pre/post-display)
     // events
     Q_UNUSED(event)
-    timer.start(static_cast<int>(floorf(1000.0f / fps)));
 }
 
 void Q3DWidget::hideEvent(QHideEvent* event)
@@ -122,7 +123,6 @@ void Q3DWidget::hideEvent(QHideEvent* event)
     // React only to internal (pre/post-display)
     // events
     Q_UNUSED(event)
-    timer.stop();
 }
 
 osg::ref_ptr<osg::Geode>
@@ -267,6 +267,7 @@ Q3DWidget::redraw(void)
     qDebug() << "EVENTLOOP:" << __FILE__ << __LINE__;
 #endif
     updateGL();
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 int
@@ -248,8 +248,6 @@ protected:
 
     osg::ref_ptr<GCManipulator> cameraManipulator; /**< Camera manipulator. */
 
-    QTimer timer; /**< Timer which draws graphics based on specified fps. */
-
     struct CameraParams
     {
         float minZoomRange;
@@ -1,3 +1,4 @@
+#include <qnumeric.h>
 #include <QApplication>
 #include <QDir>
 #include <QShowEvent>
@@ -25,6 +26,7 @@
 #endif
 
 #include "QGC.h"
+#include "QGCFrameScheduler.h"
 #include "ui_QGCGoogleEarthView.h"
 #include "QGCGoogleEarthView.h"
 #include "UASWaypointManager.h"
@@ -33,7 +35,6 @@
 
 QGCGoogleEarthView::QGCGoogleEarthView(QWidget *parent) :
         QWidget(parent),
-        updateTimer(new QTimer(this)),
         refreshRateMs(100),
         mav(NULL),
         followCamera(true),
@@ -42,6 +43,11 @@ QGCGoogleEarthView::QGCGoogleEarthView(QWidget *parent) :
         jScriptInitialized(false),
         gEarthInitialized(false),
         currentViewMode(QGCGoogleEarthView::VIEW_MODE_SIDE),
+        batchCost(0.0f),
+        lastBatchSize(0),
+        batches(0),
+        batchedUpdates(0),
+        skippedUpdates(0),
 #if (defined Q_OS_MAC)
         webViewMac(new QWebView(this)),
 #endif
@@ -83,7 +89,8 @@ QGCGoogleEarthView::QGCGoogleEarthView(QWidget *parent) :
     ui->webViewLayout->addWidget(webViewWin);
 #endif
 
-    connect(updateTimer, SIGNAL(timeout()), this, SLOT(updateState()));
+    // Update the view with the other instruments when new data arrived
+    QGCFrameScheduler::instance()->registerClient(this, "updateState", refreshRateMs);
     connect(ui->resetButton, SIGNAL(clicked()), this, SLOT(reloadHTML()));
     connect(ui->changeViewButton, SIGNAL(clicked()), this, SLOT(toggleViewMode()));
     connect(ui->clearTrailsButton, SIGNAL(clicked()), this, SLOT(clearTrails()));
@@ -122,12 +129,15 @@ void QGCGoogleEarthView::reloadHTML()
     webViewInitialized = false;
     jScriptInitialized = false;
     gEarthInitialized = false;
+    clearUpdates();
     show();
 }
 
 void QGCGoogleEarthView::enableEditMode(bool mode)
 {
     javaScript(QString("setDraggingAllowed(%1);").arg(mode));
+    // Start polling for edits
+    if (mode) scheduleUpdate();
 }
 
 void QGCGoogleEarthView::enableDaylight(bool enable)
@@ -209,6 +219,7 @@ void QGCGoogleEarthView::addUAS(UASInterface* uas)
 
     // Automatically receive further position updates
     connect(uas, SIGNAL(globalPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateGlobalPosition(UASInterface*,double,double,double,quint64)));
+    connect(uas, SIGNAL(attitudeChanged(UASInterface*,double,double,double,quint64)), this, SLOT(scheduleUpdate()));
     // Receive waypoint updates
     // Connect the waypoint manager / data storage to the UI
     connect(uas->getWaypointManager(), SIGNAL(waypointListChanged(int)), this, SLOT(updateWaypointList(int)));
@@ -223,6 +234,9 @@ void QGCGoogleEarthView::setActiveUAS(UASInterface* uas)
     {
         mav = uas;
         javaScript(QString("setCurrAircraft(%1);").arg(uas->getUASID()));
+        // The page starts following from scratch, send the state again
+        vehicles.remove(uas->getUASID());
+        scheduleUpdate();
         updateWaypointList(uas->getUASID());
     }
 }
@@ -247,10 +261,24 @@ void QGCGoogleEarthView::updateWaypoint(int uas, Waypoint* wp)
         {
             return;
         }
-        else
+        else if (gEarthInitialized)
         {
-            javaScript(QString("updateWaypoint(%1,%2,%3,%4,%5,%6);").arg(uas).arg(wpindex).arg(wp->getLatitude(), 0, 'f', 18).arg(wp->getLongitude(), 0, 'f', 18).arg(wp->getAltitude(), 0, 'f', 18).arg(wp->getAction()));
-            //qDebug() << QString("updateWaypoint(%1,%2,%3,%4,%5,%6);").arg(uas).arg(wpindex).arg(wp->getLatitude(), 0, 'f', 18).arg(wp->getLongitude(), 0, 'f', 18).arg(wp->getAltitude(), 0, 'f', 18).arg(wp->getAction());
+            // Sent with the next batch, replaces an older update of this waypoint
+            WaypointUpdate update;
+            update.uas = uas;
+            update.index = wpindex;
+            update.json = QString("[%1,%2,%3,%4,%5,%6]").arg(uas).arg(wpindex).arg(wp->getLatitude(), 0, 'f', 18).arg(wp->getLongitude(), 0, 'f', 18).arg(wp->getAltitude(), 0, 'f', 18).arg(wp->getAction());
+            bool replaced = false;
+            for (int i = 0; i < waypointUpdates.size() && !replaced; i++)
+            {
+                if (waypointUpdates.at(i).uas == uas && waypointUpdates.at(i).index == wpindex)
+                {
+                    waypointUpdates[i] = update;
+                    replaced = true;
+                }
+            }
+            if (!replaced) waypointUpdates.append(update);
+            scheduleUpdate();
         }
     }
 }
@@ -270,9 +298,7 @@ void QGCGoogleEarthView::updateWaypointList(int uas)
         QVector<Waypoint*> wpList = uasInstance->getWaypointManager()->getGlobalFrameWaypointList();
 
         // Trim internal list to number of global waypoints in the waypoint manager list
-        javaScript(QString("updateWaypointListLength(%1,%2);").arg(uas).arg(wpList.count()));
-
-        qDebug() << QString("updateWaypointListLength(%1,%2);").arg(uas).arg(wpList.count());
+        queueWaypointListLength(uas, wpList.count());
 
         // Load all existing waypoints into map view
         foreach (Waypoint* wp, wpList)
@@ -285,13 +311,27 @@ void QGCGoogleEarthView::updateWaypointList(int uas)
 void QGCGoogleEarthView::updateGlobalPosition(UASInterface* uas, double lat, double lon, double alt, quint64 usec)
 {
     Q_UNUSED(usec);
-    javaScript(QString("addTrailPosition(%1, %2, %3, %4);").arg(uas->getUASID()).arg(lat, 0, 'f', 18).arg(lon, 0, 'f', 18).arg(alt, 0, 'f', 15));
+    if (!gEarthInitialized) return;
+    if (!qIsFinite(lat) || !qIsFinite(lon) || !qIsFinite(alt)) return;
+    // Every position extends the trail, they are sent together with the next batch.
+    // No batch is sent while the view is hidden, keep only the latest positions.
+    QStringList& trail = trailUpdates[uas->getUASID()];
+    trail.append(QString("[%1,%2,%3,%4]").arg(uas->getUASID()).arg(lat, 0, 'f', 18).arg(lon, 0, 'f', 18).arg(alt, 0, 'f', 15));
+    if (trail.size() > maxTrailUpdates) trail.removeFirst();
+    scheduleUpdate();
 
     //qDebug() << QString("addTrailPosition(%1, %2, %3, %4);").arg(uas->getUASID()).arg(lat, 0, 'f', 15).arg(lon, 0, 'f', 15).arg(alt, 0, 'f', 15);
 }
 
+void QGCGoogleEarthView::scheduleUpdate()
+{
+    QGCFrameScheduler::instance()->markDirty(this);
+}
+
 void QGCGoogleEarthView::clearTrails()
 {
+    // Positions not yet sent belong to the old trails
+    trailUpdates.clear();
     QList<UASInterface*> mavs = UASManager::instance()->getUASList();
     foreach (UASInterface* currMav, mavs)
     {
@@ -398,7 +438,6 @@ void QGCGoogleEarthView::moveToPosition()
 void QGCGoogleEarthView::hideEvent(QHideEvent* event)
 {
     Q_UNUSED(event);
-    updateTimer->stop();
 }
 
 void QGCGoogleEarthView::showEvent(QShowEvent* event)
@@ -429,7 +468,7 @@ void QGCGoogleEarthView::showEvent(QShowEvent* event)
         }
         else
         {
-            updateTimer->start(refreshRateMs);
+            scheduleUpdate();
         }
 }
 
@@ -620,8 +659,8 @@ void QGCGoogleEarthView::initializeGoogleEarth()
             // Update waypoint list
             if (mav) updateWaypointList(mav->getUASID());
 
-            // Start update timer
-            updateTimer->start(refreshRateMs);
+            // Start updating the view
+            scheduleUpdate();
 
             // Set current view mode
             setViewMode(currentViewMode);
@@ -644,47 +683,20 @@ void QGCGoogleEarthView::updateState()
 #endif
     if (gEarthInitialized)
     {
-        int uasId = 0;
-        double lat = 47.3769;
-        double lon = 8.549444;
-        double alt = 470.0;
-
-        float roll = 0.0f;
-        float pitch = 0.0f;
-        float yaw = 0.0f;
-
-        // Update all MAVs
-        QList<UASInterface*> mavs = UASManager::instance()->getUASList();
-        foreach (UASInterface* currMav, mavs)
-        {
-            uasId = currMav->getUASID();
-            lat = currMav->getLatitude();
-            lon = currMav->getLongitude();
-            alt = currMav->getAltitude();
-            roll = currMav->getRoll();
-            pitch = currMav->getPitch();
-            yaw = currMav->getYaw();
-
-            //qDebug() << "SETTING POSITION FOR" << uasId << lat << lon << alt << roll << pitch << yaw;
-
-            javaScript(QString("setAircraftPositionAttitude(%1, %2, %3, %4, %6, %7, %8);")
-                       .arg(uasId)
-                       .arg(lat, 0, 'f', 15)
-                       .arg(lon, 0, 'f', 15)
-                       .arg(alt, 0, 'f', 15)
-                       .arg(roll, 0, 'f', 9)
-                       .arg(pitch, 0, 'f', 9)
-                       .arg(yaw, 0, 'f', 9));
-        }
-
+        // All vehicle, trail and waypoint changes in one call
+        flushUpdates();
 
         // Read out new waypoint positions and waypoint create events
         // this is polling (bad) but forced because of the crappy
         // Microsoft API available in Qt - improvements wanted
 
+        // Waypoints can only be created or moved in edit mode,
+        // do not pay for the round trips otherwise
+        const bool editing = ui->editButton->isChecked();
+
         // First check if a new WP should be created
 //        bool newWaypointPending = .to
-        bool newWaypointPending = documentElement("newWaypointPending").toBool();
+        bool newWaypointPending = editing && documentElement("newWaypointPending").toBool();
         if (newWaypointPending)
         {
             bool coordsOk = true;
@@ -713,7 +725,7 @@ void QGCGoogleEarthView::updateState()
         }
 
         // Check if a waypoint should be moved
-        bool dragWaypointPending = documentElement("dragWaypointPending").toBool();
+        bool dragWaypointPending = editing && documentElement("dragWaypointPending").toBool();
 
         if (dragWaypointPending)
         {
@@ -765,7 +777,99 @@ void QGCGoogleEarthView::updateState()
             }
             javaScript("setDragWaypointPending(false);");
         }
+
+        // New and dragged waypoints are only known by polling,
+        // keep polling while they can be edited
+        if (editing) scheduleUpdate();
+    }
+}
+
+void QGCGoogleEarthView::queueWaypointListLength(int uas, int length)
+{
+    if (!gEarthInitialized) return;
+
+    // The whole list is sent again after its length
+    for (int i = waypointUpdates.size() - 1; i >= 0; i--)
+    {
+        if (waypointUpdates.at(i).uas == uas) waypointUpdates.removeAt(i);
+    }
+    WaypointUpdate update;
+    update.uas = uas;
+    update.index = -1;
+    update.json = QString("[%1,%2]").arg(uas).arg(length);
+    waypointUpdates.append(update);
+    scheduleUpdate();
+}
+
+void QGCGoogleEarthView::flushUpdates()
+{
+    QStringList aircraft;
+    QList<UASInterface*> mavs = UASManager::instance()->getUASList();
+    foreach (UASInterface* currMav, mavs)
+    {
+        VehicleState state;
+        state.lat = currMav->getLatitude();
+        state.lon = currMav->getLongitude();
+        state.alt = currMav->getAltitude();
+        state.roll = currMav->getRoll();
+        state.pitch = currMav->getPitch();
+        state.yaw = currMav->getYaw();
+        state.settle = settleFrames;
+
+        // Skip vehicles which did not move. The page smoothes the position of
+        // the followed aircraft, keep sending it until it arrived there.
+        QMap<int, VehicleState>::iterator last = vehicles.find(currMav->getUASID());
+        if (last != vehicles.end() && last->lat == state.lat && last->lon == state.lon && last->alt == state.alt &&
+            last->roll == state.roll && last->pitch == state.pitch && last->yaw == state.yaw)
+        {
+            if (currMav != mav || last->settle <= 0)
+            {
+                skippedUpdates++;
+                continue;
+            }
+            state.settle = last->settle - 1;
+        }
+        vehicles.insert(currMav->getUASID(), state);
+
+        aircraft.append(QString("[%1,%2,%3,%4,%5,%6,%7]")
+                        .arg(currMav->getUASID())
+                        .arg(state.lat, 0, 'f', 15)
+                        .arg(state.lon, 0, 'f', 15)
+                        .arg(state.alt, 0, 'f', 15)
+                        .arg(state.roll, 0, 'f', 9)
+                        .arg(state.pitch, 0, 'f', 9)
+                        .arg(state.yaw, 0, 'f', 9));
     }
+
+    QStringList trails;
+    foreach (const QStringList& trail, trailUpdates) trails.append(trail);
+    const int size = aircraft.size() + trails.size() + waypointUpdates.size();
+    if (size == 0) return;
+
+    // One JSON object, which is a valid JavaScript literal as well
+    QStringList waypoints;
+    for (int i = 0; i < waypointUpdates.size(); i++) waypoints.append(waypointUpdates.at(i).json);
+    QString batch = QString("applyUpdates({\"waypoints\":[%1],\"trails\":[%2],\"aircraft\":[%3]});")
+                    .arg(waypoints.join(","), trails.join(","), aircraft.join(","));
+    trailUpdates.clear();
+    waypointUpdates.clear();
+
+    const quint64 start = QGC::groundTimeUsecs();
+    javaScript(batch);
+    const float cost = (QGC::groundTimeUsecs() - start) / 1000.0f;
+
+    batchCost = (batches == 0) ? cost : 0.9f * batchCost + 0.1f * cost;
+    lastBatchSize = size;
+    batches++;
+    batchedUpdates += size;
+}
+
+void QGCGoogleEarthView::clearUpdates()
+{
+    // The new page knows nothing, send all vehicles again
+    vehicles.clear();
+    trailUpdates.clear();
+    waypointUpdates.clear();
 }
 
 
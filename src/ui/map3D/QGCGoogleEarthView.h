@@ -3,6 +3,10 @@
 
 #include <QWidget>
 #include <QTimer>
+#include <QMap>
+#include <QList>
+#include <QPair>
+#include <QStringList>
 #include <UASInterface.h>
 
 #if (defined Q_OS_MAC)
@@ -88,6 +92,8 @@ public slots:
     void setActiveUAS(UASInterface* uas);
     /** @brief Update the global position */
     void updateGlobalPosition(UASInterface* uas, double lat, double lon, double alt, quint64 usec);
+    /** @brief Update the view with the next frame */
+    void scheduleUpdate();
     /** @brief Update a single waypoint */
     void updateWaypoint(int uas, Waypoint* wp);
     /** @brief Update the waypoint list */
@@ -138,10 +144,47 @@ public:
     /** @brief Get a document element */
     QVariant documentElement(QString name);
 
+    /** @brief Smoothed duration of one batch call into the page in milliseconds */
+    float getBatchCost() const { return batchCost; }
+    /** @brief Vehicle, trail and waypoint updates in the last batch */
+    int getLastBatchSize() const { return lastBatchSize; }
+    /** @brief Number of batch calls so far */
+    quint64 getBatches() const { return batches; }
+    /** @brief Updates applied so far, one call each before batching */
+    quint64 getBatchedUpdates() const { return batchedUpdates; }
+    /** @brief Vehicle updates skipped so far because the vehicle did not move */
+    quint64 getSkippedUpdates() const { return skippedUpdates; }
+
 protected:
+    /** @brief Last position and attitude sent to the page */
+    struct VehicleState
+    {
+        double lat;
+        double lon;
+        double alt;
+        float roll;
+        float pitch;
+        float yaw;
+        int settle;             ///< Frames the page still interpolates towards this state
+    };
+
+    /** @brief A waypoint update waiting for the next batch */
+    struct WaypointUpdate
+    {
+        int uas;
+        int index;              ///< Waypoint index, -1 for a new list length
+        QString json;
+    };
+
     void changeEvent(QEvent *e);
-    QTimer* updateTimer;
-    int refreshRateMs;
+    /** @brief Queue a new waypoint list length, replaces all queued waypoint updates of this system */
+    void queueWaypointListLength(int uas, int length);
+    /** @brief Send all queued updates and all moved vehicles in one JavaScript call */
+    void flushUpdates();
+    /** @brief Drop all queued updates, e.g. after reloading the page */
+    void clearUpdates();
+
+    int refreshRateMs;          ///< Minimum update interval in milliseconds
     UASInterface* mav;
     bool followCamera;
     bool trailEnabled;
@@ -150,6 +193,16 @@ protected:
     bool jScriptInitialized;
     bool gEarthInitialized;
     VIEW_MODE currentViewMode;
+    QMap<int, VehicleState> vehicles;        ///< Last state sent per system ID
+    QMap<int, QStringList> trailUpdates;     ///< Trail positions not yet sent per system ID, oldest first
+    QList<WaypointUpdate> waypointUpdates;   ///< Waypoint changes, oldest first
+    float batchCost;
+    int lastBatchSize;
+    quint64 batches;
+    quint64 batchedUpdates;
+    quint64 skippedUpdates;
+    static const int settleFrames = 20; ///< The page moves the followed aircraft 20% closer per update
+    static const int maxTrailUpdates = 200; ///< Positions kept per system until the next batch, older ones are dropped while the view is hidden
 #ifdef _MSC_VER
     QGCWebAxWidget* webViewWin;
     QAxObject* jScriptWin;
@@ -34,6 +34,7 @@ This file is part of the PIXHAWK project
 #include <QFileDialog>
 #include <QDebug>
 #include <QApplication>
+#include <QScrollBar>
 
 #include "MG.h"
 #include "UASListWidget.h"
@@ -45,7 +46,9 @@ This file is part of the PIXHAWK project
 #include "MAVLinkSimulationLink.h"
 #include "LinkManager.h"
 
-UASListWidget::UASListWidget(QWidget *parent) : QWidget(parent), m_ui(new Ui::UASList)
+UASListWidget::UASListWidget(QWidget *parent) : QWidget(parent),
+    tileHeight(0),
+    m_ui(new Ui::UASList)
 {
     m_ui->setupUi(this);
 
@@ -60,6 +63,18 @@ UASListWidget::UASListWidget(QWidget *parent) : QWidget(parent), m_ui(new Ui::UA
     uWidget = new QGCUnconnectedInfoWidget(this);
     listLayout->addWidget(uWidget);
 
+    // Tiles are placed by hand in the scroll area
+    tileArea = new QWidget();
+    scrollArea = new QScrollArea(this);
+    scrollArea->setFrameShape(QFrame::NoFrame);
+    scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    scrollArea->setWidgetResizable(true);
+    scrollArea->setWidget(tileArea);
+    scrollArea->viewport()->installEventFilter(this);
+    connect(scrollArea->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(updateTiles()));
+    listLayout->addWidget(scrollArea);
+    scrollArea->hide();
+
     this->setMinimumWidth(262);
 
     uasViews = QMap<UASInterface*, UASView*>();
@@ -69,6 +84,8 @@ UASListWidget::UASListWidget(QWidget *parent) : QWidget(parent), m_ui(new Ui::UA
 
 UASListWidget::~UASListWidget()
 {
+    // The tiles are deleted with the widget, this is no removal by the user
+    foreach (UASView* tile, uasViews) disconnect(tile, SIGNAL(destroyed(QObject*)), this, SLOT(tileDestroyed(QObject*)));
     delete m_ui;
 }
 
@@ -84,22 +101,30 @@ void UASListWidget::changeEvent(QEvent *e)
     }
 }
 
-
+bool UASListWidget::eventFilter(QObject* watched, QEvent* event)
+{
+    if (watched == scrollArea->viewport() && event->type() == QEvent::Resize)
+    {
+        updateTiles();
+    }
+    return QWidget::eventFilter(watched, event);
+}
 
 void UASListWidget::addUAS(UASInterface* uas)
 {
-    if (uasViews.isEmpty())
+    if (systems.isEmpty() && uWidget)
     {
         listLayout->removeWidget(uWidget);
         delete uWidget;
         uWidget = NULL;
+        scrollArea->show();
     }
 
-    if (!uasViews.contains(uas))
+    if (!systems.contains(uas))
     {
-        uasViews.insert(uas, new UASView(uas, this));
-        listLayout->addWidget(uasViews.value(uas));
-        //connect(uas, SIGNAL(destroyed(QObject*)), this, SLOT(removeUAS(QObject*)));
+        systems.append(uas);
+        connect(uas, SIGNAL(systemRemoved(UASInterface*)), this, SLOT(removeUAS(UASInterface*)));
+        updateTiles();
     }
 }
 
@@ -114,7 +139,85 @@ void UASListWidget::activeUAS(UASInterface* uas)
 
 void UASListWidget::removeUAS(UASInterface* uas)
 {
-    listLayout->removeWidget(uasViews.value(uas));
-    uasViews.value(uas)->deleteLater();
+    dropTile(uas);
+    systems.removeAll(uas);
+    updateTiles();
+}
+
+UASView* UASListWidget::createTile(UASInterface* uas)
+{
+    UASView* tile = new UASView(uas, tileArea);
+    connect(tile, SIGNAL(destroyed(QObject*)), this, SLOT(tileDestroyed(QObject*)));
+    uasViews.insert(uas, tile);
+    return tile;
+}
+
+void UASListWidget::dropTile(UASInterface* uas)
+{
+    UASView* tile = uasViews.take(uas);
+    if (tile)
+    {
+        // Dropped by the list, its system stays
+        disconnect(tile, SIGNAL(destroyed(QObject*)), this, SLOT(tileDestroyed(QObject*)));
+        tile->hide();
+        tile->deleteLater();
+    }
+}
+
+void UASListWidget::tileDestroyed(QObject* tile)
+{
+    QMap<UASInterface*, UASView*>::iterator i = uasViews.begin();
+    while (i != uasViews.end())
+    {
+        if (i.value() == tile)
+        {
+            systems.removeAll(i.key());
+            uasViews.erase(i);
+            break;
+        }
+        ++i;
+    }
+    updateTiles();
 }
 
+void UASListWidget::updateTiles()
+{
+    if (systems.isEmpty())
+    {
+        foreach (UASInterface* uas, uasViews.keys()) dropTile(uas);
+        tileArea->setMinimumHeight(0);
+        return;
+    }
+
+    // Measure the tiles with the first one
+    if (tileHeight == 0)
+    {
+        UASView* tile = uasViews.value(systems.first(), NULL);
+        if (!tile) tile = createTile(systems.first());
+        tileHeight = qMax(1, tile->sizeHint().height());
+    }
+
+    const int stride = tileHeight + tileSpacing;
+    tileArea->setMinimumHeight(systems.size() * stride - tileSpacing);
+
+    // Rows intersecting the visible area
+    const int top = scrollArea->verticalScrollBar()->value();
+    const int first = qMax(0, top / stride - tileMargin);
+    const int last = qMin(systems.size() - 1, (top + scrollArea->viewport()->height()) / stride + tileMargin);
+
+    foreach (UASInterface* uas, uasViews.keys())
+    {
+        int row = systems.indexOf(uas);
+        if (row < first || row > last) dropTile(uas);
+    }
+
+    const int width = scrollArea->viewport()->width();
+    for (int row = first; row <= last; row++)
+    {
+        UASInterface* uas = systems.at(row);
+        UASView* tile = uasViews.value(uas, NULL);
+        if (!tile) tile = createTile(uas);
+        tile->setGeometry(0, row * stride, width, tileHeight);
+        if (!tile->isVisible()) tile->show();
+    }
+}
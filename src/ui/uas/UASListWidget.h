@@ -33,12 +33,23 @@ This file is part of the QGROUNDCONTROL project
 
 #include <QWidget>
 #include <QMap>
+#include <QList>
 #include <QVBoxLayout>
+#include <QScrollArea>
 #include "UASInterface.h"
 #include "UASView.h"
 #include "QGCUnconnectedInfoWidget.h"
 #include "ui_UASList.h"
 
+/**
+ * @brief Status tiles of all systems in a scrollable list
+ *
+ * The list is virtualized: tiles are only built for the systems on screen
+ * and dropped again when they are scrolled out of view, so dozens of
+ * systems do not each keep a tile updating in the background. A rebuilt
+ * tile starts from the current state of its system. All tiles have the
+ * height of the first one built.
+ */
 class UASListWidget : public QWidget
 {
     Q_OBJECT
@@ -47,16 +58,38 @@ public:
     UASListWidget(QWidget *parent = 0);
     ~UASListWidget();
 
+    /** @brief Number of systems in the list */
+    int getSystemCount() const { return systems.size(); }
+    /** @brief Number of tiles currently built */
+    int getTileCount() const { return uasViews.size(); }
+
 public slots:
     void addUAS(UASInterface* uas);
     void activeUAS(UASInterface* uas);
     void removeUAS(UASInterface* uas);
 
+protected slots:
+    /** @brief Build the tiles of the systems on screen and drop the others */
+    void updateTiles();
+    /** @brief A tile removed itself, remove its system from the list */
+    void tileDestroyed(QObject* tile);
+
 protected:
-    QMap<UASInterface*, UASView*> uasViews;
+    QList<UASInterface*> systems;           ///< All systems in list order
+    QMap<UASInterface*, UASView*> uasViews; ///< Tiles currently built
     QVBoxLayout* listLayout;
+    QScrollArea* scrollArea;
+    QWidget* tileArea;                      ///< Content of the scroll area, as high as all tiles together
     QGCUnconnectedInfoWidget* uWidget;
+    int tileHeight;                         ///< Height of every tile in pixels, 0 before the first tile was built
     void changeEvent(QEvent *e);
+    /** @brief Update the tiles when the visible area is resized */
+    bool eventFilter(QObject* watched, QEvent* event);
+    UASView* createTile(UASInterface* uas);
+    void dropTile(UASInterface* uas);
+
+    static const int tileSpacing = 3;       ///< Space between two tiles in pixels
+    static const int tileMargin = 1;        ///< Tiles built beyond the visible ones on each side
 
 private:
     Ui::UASList* m_ui;
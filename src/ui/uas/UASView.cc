@@ -37,6 +37,8 @@ This file is part of the PIXHAWK project
 #include "QGC.h"
 #include "MG.h"
 #include "UASManager.h"
+#include "QGCFrameScheduler.h"
+#include "QGCHeartbeatSupervisor.h"
 #include "UASView.h"
 #include "UASWaypointManager.h"
 #include "ui_UASView.h"
@@ -52,7 +54,7 @@ UASView::UASView(UASInterface* uas, QWidget *parent) :
         load(0),
         state("UNKNOWN"),
         stateDesc(tr("Unknown state")),
-        mode("MAV_MODE_UNKNOWN"),
+        mode(""),
         thrust(0),
         isActive(false),
         x(0),
@@ -64,6 +66,7 @@ UASView::UASView(UASInterface* uas, QWidget *parent) :
         alt(0),
         groundDistance(0),
         localFrame(false),
+        filteredTimeRemaining(0),
         removeAction(new QAction("Delete this system", this)),
         renameAction(new QAction("Rename..", this)),
         selectAction(new QAction("Control this system", this )),
@@ -127,12 +130,36 @@ UASView::UASView(UASInterface* uas, QWidget *parent) :
         m_ui->nameLabel->setText(uas->getUASName());
     }
     
+    // Tiles are built while the system is already connected and rebuilt
+    // when scrolled back into view, start from its current state instead
+    // of waiting for updates
+    x = uas->getLocalX();
+    y = uas->getLocalY();
+    z = uas->getLocalZ();
+    lat = uas->getLatitude();
+    lon = uas->getLongitude();
+    alt = uas->getAltitude();
+    isActive = (UASManager::instance()->getActiveUAS() == uas);
+    if (!uas->getShortState().isEmpty())
+    {
+        state = uas->getShortState();
+        stateDesc = uas->getStateDescription();
+    }
+    mode = uas->getShortMode();
+    navMode = uas->getShortNavMode();
+    chargeLevel = uas->getChargeLevel();
+    timeRemaining = uas->getTimeRemaining();
+    thrust = uas->getThrust();
+    if (uas->getWaypointManager()->getCurrentWaypoint() >= 0)
+    {
+        waypoint = tr("WP") + QString::number(uas->getWaypointManager()->getCurrentWaypoint());
+    }
+    timeout = (UASManager::instance()->getHeartbeatSupervisor()->getState(uas->getUASID()) != QGCHeartbeatSupervisor::HEARTBEAT_ALIVE);
+
     setBackgroundColor();
     
-    // Heartbeat fade
-    refreshTimer = new QTimer(this);
-    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
-    refreshTimer->start(updateInterval);
+    // Values are applied in one batch on the shared cadence
+    QGCFrameScheduler::instance()->registerClient(this, "refresh", updateInterval);
 
     // Hide kill and shutdown buttons per default
     m_ui->killButton->hide();
@@ -152,13 +179,15 @@ UASView::~UASView()
 void UASView::heartbeatTimeout()
 {
     timeout = true;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void UASView::updateNavMode(int uasid, int mode, const QString& text)
 {
     Q_UNUSED(uasid);
     Q_UNUSED(mode);
-    m_ui->navLabel->setText(text);
+    navMode = text;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void UASView::showStatusText(int uasid, int componentid, int severity, QString text)
@@ -168,6 +197,7 @@ void UASView::showStatusText(int uasid, int componentid, int severity, QString t
     Q_UNUSED(severity);
     //m_ui->statusTextLabel->setText(text);
     stateDesc = text;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 /**
@@ -191,7 +221,7 @@ void UASView::setBackgroundColor()
     }
     colorstyle = colorstyle.sprintf("QGroupBox { border-radius: 12px; padding: 0px; margin: 0px; background-color: #%02X%02X%02X; border: 2px solid %s; }",
                                     uasColor.red(), uasColor.green(), uasColor.blue(), borderColor.toStdString().c_str());
-    m_ui->uasViewFrame->setStyleSheet(colorstyle);
+    updateStyleSheet(m_ui->uasViewFrame, colorstyle);
 }
 
 void UASView::setUASasActive(bool active)
@@ -214,7 +244,11 @@ void UASView::updateActiveUAS(UASInterface* uas, bool active)
 void UASView::updateMode(int sysId, QString status, QString description)
 {
     Q_UNUSED(description);
-    if (sysId == this->uas->getUASID()) m_ui->modeLabel->setText(status);
+    if (sysId == this->uas->getUASID())
+    {
+        mode = status;
+        QGCFrameScheduler::instance()->markDirty(this);
+    }
 }
 
 void UASView::mouseDoubleClickEvent (QMouseEvent * event)
@@ -255,8 +289,8 @@ void UASView::showEvent(QShowEvent* event)
 {
     // React only to internal (pre-display)
     // events
+    // The frame scheduler refreshes as soon as the widget is visible
     Q_UNUSED(event);
-    refreshTimer->start(updateInterval);
 }
 
 void UASView::hideEvent(QHideEvent* event)
@@ -264,17 +298,18 @@ void UASView::hideEvent(QHideEvent* event)
     // React only to internal (pre-display)
     // events
     Q_UNUSED(event);
-    refreshTimer->stop();
 }
 
 void UASView::receiveHeartbeat(UASInterface* uas)
 {
     Q_UNUSED(uas);
     heartbeatColor = QColor(20, 200, 20);
-    QString colorstyle("QGroupBox { border-radius: 5px; padding: 2px; margin: 0px; border: 0px; background-color: %1; }");
-    m_ui->heartbeatIcon->setStyleSheet(colorstyle.arg(heartbeatColor.name()));
-    if (timeout) setBackgroundColor();
-    timeout = false;
+    if (timeout)
+    {
+        timeout = false;
+        setBackgroundColor();
+    }
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void UASView::updateName(const QString& name)
@@ -352,6 +387,7 @@ void UASView::updateLocalPosition(UASInterface* uas, double x, double y, double
     {
         localFrame = true;
     }
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void UASView::updateGlobalPosition(UASInterface* uas, double lon, double lat, double alt, quint64 usec)
@@ -361,17 +397,20 @@ void UASView::updateGlobalPosition(UASInterface* uas, double lon, double lat, do
     this->lon = lon;
     this->lat = lat;
     this->alt = alt;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void UASView::updateSpeed(UASInterface*, double x, double y, double z, quint64 usec)
 {
     Q_UNUSED(usec);
     totalSpeed = sqrt(x*x + y*y + z*z);
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void UASView::currentWaypointUpdated(quint16 waypoint)
 {
-    m_ui->waypointLabel->setText(tr("WP") + QString::number(waypoint));
+    this->waypoint = tr("WP") + QString::number(waypoint);
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void UASView::setWaypoint(int uasId, int id, double x, double y, double z, double yaw, bool autocontinue, bool current)
@@ -385,7 +424,8 @@ void UASView::setWaypoint(int uasId, int id, double x, double y, double z, doubl
     {
         if (current)
         {
-            m_ui->waypointLabel->setText(tr("WP") + QString::number(id));
+            waypoint = tr("WP") + QString::number(id);
+            QGCFrameScheduler::instance()->markDirty(this);
         }
     }
 }
@@ -394,7 +434,8 @@ void UASView::selectWaypoint(int uasId, int id)
 {
     if (uasId == this->uas->getUASID())
     {
-        m_ui->waypointLabel->setText(tr("WP") + QString::number(id));
+        waypoint = tr("WP") + QString::number(id);
+        QGCFrameScheduler::instance()->markDirty(this);
     }
 }
 
@@ -404,6 +445,7 @@ void UASView::updateThrust(UASInterface* uas, double thrust)
     {
         this->thrust = thrust;
     }
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void UASView::updateBattery(UASInterface* uas, double voltage, double percent, int seconds)
@@ -414,6 +456,7 @@ void UASView::updateBattery(UASInterface* uas, double voltage, double percent, i
         timeRemaining = seconds;
         chargeLevel = percent;
     }
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void UASView::updateState(UASInterface* uas, QString uasState, QString stateDescription)
@@ -423,6 +466,7 @@ void UASView::updateState(UASInterface* uas, QString uasState, QString stateDesc
         state = uasState;
         stateDesc = stateDescription;
     }
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void UASView::updateLoad(UASInterface* uas, double load)
@@ -431,6 +475,7 @@ void UASView::updateLoad(UASInterface* uas, double load)
     {
         this->load = load;
     }
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void UASView::contextMenuEvent (QContextMenuEvent* event)
@@ -502,108 +547,110 @@ void UASView::selectAirframe()
     }
 }
 
-void UASView::refresh()
+void UASView::updateText(QLabel* label, const QString& text)
 {
-    //setUpdatesEnabled(false);
-    //setUpdatesEnabled(true);
-    //repaint();
-
-    static quint64 lastupdate = 0;
-    //qDebug() << "UASVIEW update diff: " << MG::TIME::getGroundTimeNow() - lastupdate;
-    lastupdate = MG::TIME::getGroundTimeNow();
+    // Setting a text relayouts the list, even if it did not change
+    if (label->text() != text) label->setText(text);
+}
 
-    // FIXME
-    static int generalUpdateCount = 0;
+void UASView::updateStyleSheet(QWidget* widget, const QString& style)
+{
+    // Setting a style sheet polishes the widget again, which is expensive
+    if (widget->styleSheet() != style) widget->setStyleSheet(style);
+}
 
-    if (generalUpdateCount == 4)
-    {
+void UASView::refresh()
+{
+    // Apply everything received since the last refresh in one batch,
+    // only changed texts and styles touch the widgets
 #if (QGC_EVENTLOOP_DEBUG)
-        qDebug() << "EVENTLOOP:" << __FILE__ << __LINE__;
+    qDebug() << "EVENTLOOP:" << __FILE__ << __LINE__;
 #endif
-        generalUpdateCount = 0;
-        //qDebug() << "UPDATING EVERYTHING";
-        // State
-        m_ui->stateLabel->setText(state);
-        m_ui->statusTextLabel->setText(stateDesc);
-
-        // Battery
-        m_ui->batteryBar->setValue(static_cast<int>(this->chargeLevel));
-        //m_ui->loadBar->setValue(static_cast<int>(this->load));
-        m_ui->thrustBar->setValue(this->thrust);
-
-        // Position
-        QString position;
-        position = position.sprintf("%05.1f %05.1f %06.1f m", x, y, z);
-        m_ui->positionLabel->setText(position);
-        QString globalPosition;
-        QString latIndicator;
-        if (lat > 0)
-        {
-            latIndicator = "N";
-        }
-        else
-        {
-            latIndicator = "S";
-        }
-        QString lonIndicator;
-        if (lon > 0)
-        {
-            lonIndicator = "E";
-        }
-        else
-        {
-            lonIndicator = "W";
-        }
-        globalPosition = globalPosition.sprintf("%05.1f%s %05.1f%s %06.1f m", lon, lonIndicator.toStdString().c_str(), lat, latIndicator.toStdString().c_str(), alt);
-        m_ui->positionLabel->setText(globalPosition);
+    // State
+    updateText(m_ui->stateLabel, state);
+    updateText(m_ui->statusTextLabel, stateDesc);
+    if (!mode.isEmpty()) updateText(m_ui->modeLabel, mode);
+    if (!navMode.isEmpty()) updateText(m_ui->navLabel, navMode);
+    if (!waypoint.isEmpty() && uas->getSystemType() != 6) updateText(m_ui->waypointLabel, waypoint);
+
+    // Battery
+    m_ui->batteryBar->setValue(static_cast<int>(this->chargeLevel));
+    //m_ui->loadBar->setValue(static_cast<int>(this->load));
+
+    // Position
+    QString position;
+    position = position.sprintf("%05.1f %05.1f %06.1f m", x, y, z);
+    updateText(m_ui->positionLabel, position);
+    QString globalPosition;
+    QString latIndicator;
+    if (lat > 0)
+    {
+        latIndicator = "N";
+    }
+    else
+    {
+        latIndicator = "S";
+    }
+    QString lonIndicator;
+    if (lon > 0)
+    {
+        lonIndicator = "E";
+    }
+    else
+    {
+        lonIndicator = "W";
+    }
+    globalPosition = globalPosition.sprintf("%05.1f%s %05.1f%s %06.1f m", lon, lonIndicator.toStdString().c_str(), lat, latIndicator.toStdString().c_str(), alt);
+    updateText(m_ui->positionLabel, globalPosition);
 
-        // Altitude
-        if (groundDistance == 0 && alt != 0)
-        {
-            m_ui->groundDistanceLabel->setText(QString("%1 m").arg(alt, 6, 'f', 1, '0'));
-        }
-        else
-        {
-            m_ui->groundDistanceLabel->setText(QString("%1 m").arg(groundDistance, 6, 'f', 1, '0'));
-        }
+    // Altitude
+    if (groundDistance == 0 && alt != 0)
+    {
+        updateText(m_ui->groundDistanceLabel, QString("%1 m").arg(alt, 6, 'f', 1, '0'));
+    }
+    else
+    {
+        updateText(m_ui->groundDistanceLabel, QString("%1 m").arg(groundDistance, 6, 'f', 1, '0'));
+    }
 
-        // Speed
-        QString speed("%1 m/s");
-        m_ui->speedLabel->setText(speed.arg(totalSpeed, 4, 'f', 1, '0'));
+    // Speed
+    QString speed("%1 m/s");
+    updateText(m_ui->speedLabel, speed.arg(totalSpeed, 4, 'f', 1, '0'));
 
-        // Thrust
-        m_ui->thrustBar->setValue(thrust * 100);
+    // Thrust
+    m_ui->thrustBar->setValue(thrust * 100);
 
+    if (uas->getSystemType() != 6)
+    {
         if(this->timeRemaining > 1 && this->timeRemaining < QGC::MAX_FLIGHT_TIME)
         {
             // Filter output to get a higher stability
-            static double filterTime = static_cast<int>(this->timeRemaining);
-            filterTime = 0.8 * filterTime + 0.2 * static_cast<int>(this->timeRemaining);
-            int sec = static_cast<int>(filterTime - static_cast<int>(filterTime / 60.0f) * 60);
-            int min = static_cast<int>(filterTime / 60);
-            int hours = static_cast<int>(filterTime - min * 60 - sec);
+            if (filteredTimeRemaining == 0) filteredTimeRemaining = this->timeRemaining;
+            filteredTimeRemaining = 0.8 * filteredTimeRemaining + 0.2 * this->timeRemaining;
+            int sec = static_cast<int>(filteredTimeRemaining - static_cast<int>(filteredTimeRemaining / 60.0f) * 60);
+            int min = static_cast<int>(filteredTimeRemaining / 60);
+            int hours = static_cast<int>(filteredTimeRemaining - min * 60 - sec);
 
             QString timeText;
             timeText = timeText.sprintf("%02d:%02d:%02d", hours, min, sec);
-            m_ui->timeRemainingLabel->setText(timeText);
+            updateText(m_ui->timeRemainingLabel, timeText);
         }
         else
         {
-            m_ui->timeRemainingLabel->setText(tr("Calc.."));
+            updateText(m_ui->timeRemainingLabel, tr("Calc.."));
         }
+    }
 
-        // Time Elapsed
-        //QDateTime time = MG::TIME::msecToQDateTime(uas->getUptime());
+    // Time Elapsed
+    //QDateTime time = MG::TIME::msecToQDateTime(uas->getUptime());
 
-        quint64 filterTime = uas->getUptime() / 1000;
-        int sec = static_cast<int>(filterTime - static_cast<int>(filterTime / 60) * 60);
-        int min = static_cast<int>(filterTime / 60);
-        int hours = static_cast<int>(filterTime - min * 60 - sec);
-        QString timeText;
-        timeText = timeText.sprintf("%02d:%02d:%02d", hours, min, sec);
-        m_ui->timeElapsedLabel->setText(timeText);
-    }
-    generalUpdateCount++;
+    quint64 filterTime = uas->getUptime() / 1000;
+    int sec = static_cast<int>(filterTime - static_cast<int>(filterTime / 60) * 60);
+    int min = static_cast<int>(filterTime / 60);
+    int hours = static_cast<int>(filterTime - min * 60 - sec);
+    QString timeText;
+    timeText = timeText.sprintf("%02d:%02d:%02d", hours, min, sec);
+    updateText(m_ui->timeElapsedLabel, timeText);
 
     QString colorstyle("QGroupBox { border-radius: 5px; padding: 2px; margin: 0px; border: 0px; background-color: %1; }");
 
@@ -617,34 +664,26 @@ void UASView::refresh()
             borderColor = "#FA4A4F";
         }
 
-        if (iconIsRed)
-        {
-            QColor warnColor(Qt::red);
-            m_ui->heartbeatIcon->setStyleSheet(colorstyle.arg(warnColor.name()));
-            QString style = QString("QGroupBox { border-radius: 12px; padding: 0px; margin: 0px; border: 2px solid %1; background-color: %2; }").arg(borderColor, warnColor.name());
-            m_ui->uasViewFrame->setStyleSheet(style);
-        }
-        else
-        {
-            QColor warnColor(Qt::black);
-            m_ui->heartbeatIcon->setStyleSheet(colorstyle.arg(warnColor.name()));
-            QString style = QString("QGroupBox { border-radius: 12px; padding: 0px; margin: 0px; border: 2px solid %1; background-color: %2; }").arg(borderColor, warnColor.name());
-            m_ui->uasViewFrame->setStyleSheet(style);
-        }
+        QColor warnColor(iconIsRed ? Qt::red : Qt::black);
+        updateStyleSheet(m_ui->heartbeatIcon, colorstyle.arg(warnColor.name()));
+        QString style = QString("QGroupBox { border-radius: 12px; padding: 0px; margin: 0px; border: 2px solid %1; background-color: %2; }").arg(borderColor, warnColor.name());
+        updateStyleSheet(m_ui->uasViewFrame, style);
         iconIsRed = !iconIsRed;
     }
     else
     {
-        // Fade heartbeat icon
-        // Make color darker
-        heartbeatColor = heartbeatColor.darker(150);
-
+        // Fade heartbeat icon, show the current color
+        // and make it darker for the next refresh
         //m_ui->heartbeatIcon->setAutoFillBackground(true);
-        m_ui->heartbeatIcon->setStyleSheet(colorstyle.arg(heartbeatColor.name()));
+        updateStyleSheet(m_ui->heartbeatIcon, colorstyle.arg(heartbeatColor.name()));
+        heartbeatColor = heartbeatColor.darker(150);
     }
-    //setUpdatesEnabled(true);
 
-    //setUpdatesEnabled(false);
+    // Keep blinking or fading out
+    if (timeout || heartbeatColor.value() > 10)
+    {
+        QGCFrameScheduler::instance()->markDirty(this);
+    }
 }
 
 void UASView::changeEvent(QEvent *e)
@@ -36,6 +36,7 @@ This file is part of the QGROUNDCONTROL project
 #include <QString>
 #include <QTimer>
 #include <QMouseEvent>
+#include <QLabel>
 #include <UASInterface.h>
 
 namespace Ui {
@@ -63,6 +64,7 @@ public slots:
     void updateMode(int sysId, QString status, QString description);
     void updateLoad(UASInterface* uas, double load);
     //void receiveValue(int uasid, QString id, double value, quint64 time);
+    /** @brief Apply all values received since the last refresh */
     void refresh();
     /** @brief Receive new waypoint information */
     void setWaypoint(int uasId, int id, double x, double y, double z, double yaw, bool autocontinue, bool current);
@@ -93,7 +95,6 @@ public slots:
 
 protected:
     void changeEvent(QEvent *e);
-    QTimer* refreshTimer;
     QColor heartbeatColor;
     quint64 startTime;
     bool timeout;
@@ -105,6 +106,8 @@ protected:
     QString state;
     QString stateDesc;
     QString mode;
+    QString navMode;
+    QString waypoint; ///< Text of the current waypoint, empty if unknown
     double thrust; ///< Current vehicle thrust: 0 - 1.0 for 100% thrust
     bool isActive; ///< Is this MAV selected by the user?
     float x;
@@ -116,14 +119,20 @@ protected:
     float alt;
     float groundDistance;
     bool localFrame;
+    double filteredTimeRemaining; ///< Low-pass filtered remaining flight time in seconds
     QAction* removeAction;
     QAction* renameAction;
     QAction* selectAction;
     QAction* selectAirframeAction;
     QAction* setBatterySpecsAction;
-    static const int updateInterval = 300;
+    static const int updateInterval = 300; ///< Minimum refresh interval in milliseconds
 
 
+    /** @brief Set the text of a label only if it changed */
+    static void updateText(QLabel* label, const QString& text);
+    /** @brief Set the style sheet of a widget only if it changed */
+    static void updateStyleSheet(QWidget* widget, const QString& style);
+
     void mouseDoubleClickEvent (QMouseEvent * event);
     /** @brief Mouse enters the widget */
     void enterEvent(QEvent* event);